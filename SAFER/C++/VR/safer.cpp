@@ -3,7 +3,10 @@
 
 // SAFER.cpp
 #include "SAFER.hpp"
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <ctime>
 #include <iostream>
 
 namespace SAFER {
@@ -55,9 +58,29 @@ void SAFERSystem::Update() {
     // Update subsystems
     m_safetySystem->Update(m_trackedDevicePoses);
     m_riskAssessment->UpdateRiskLevels(m_trackedDevicePoses);
+    if (m_eventBridge) {
+        m_eventBridge->Update();
+    }
+}
+
+void SAFERSystem::ConnectServiceBridge(const std::string& crewId, const char* name) {
+    m_eventBridge = std::make_shared<EventBridge>(crewId, name);
+    std::weak_ptr<EventBridge> bridge = m_eventBridge;
+    m_safetySystem->SetWarningCallback([bridge](const std::string& zoneId, float level) {
+        if (auto b = bridge.lock()) {
+            b->ReportZoneLevel(zoneId, level);
+        }
+    });
+    m_trainingModule->SetCompletionCallback(
+        [bridge](const TrainingModule::Scenario& scenario, float score, bool passed) {
+            if (auto b = bridge.lock()) {
+                b->PublishTrainingComplete(scenario.id, score, passed);
+            }
+        });
 }
 
 void SAFERSystem::Shutdown() {
+    m_eventBridge.reset();
     if (m_vrSystem) {
         vr::VR_Shutdown();
         m_vrSystem = nullptr;
@@ -114,6 +137,20 @@ void TrainingModule::AddScenario(const Scenario& scenario) {
     m_scenarios[scenario.id] = scenario;
 }
 
+void TrainingModule::CompleteScenario(float score, bool passed) {
+    if (!m_currentScenario) {
+        return;
+    }
+    if (m_completionCallback) {
+        m_completionCallback(*m_currentScenario, score, passed);
+    }
+    m_currentScenario = nullptr;
+}
+
+void TrainingModule::SetCompletionCallback(std::function<void(const Scenario&, float, bool)> callback) {
+    m_completionCallback = callback;
+}
+
 // RiskAssessment Implementation
 RiskAssessment::RiskAssessment() {}
 
@@ -141,6 +178,62 @@ float RiskAssessment::CalculateRisk(const vr::HmdMatrix34_t& pose, const RiskZon
     return std::max(0.0f, std::min(1.0f, 1.0f - distance));
 }
 
+// EventBridge Implementation
+static const uint32_t kBridgeRetryFrames = 90;
+
+EventBridge::EventBridge(const std::string& crewId, const char* name)
+    : m_bridge(vr_bridge_open(name)), m_crewId(crewId), m_name(name),
+      m_framesUntilRetry(kBridgeRetryFrames) {}
+
+EventBridge::~EventBridge() {
+    vr_bridge_close(m_bridge);
+}
+
+void EventBridge::Update() {
+    if (!m_bridge) {
+        // Opening is a system call, so it is not tried every frame
+        if (--m_framesUntilRetry > 0) {
+            return;
+        }
+        m_framesUntilRetry = kBridgeRetryFrames;
+        m_bridge = vr_bridge_open(m_name.c_str());
+        if (!m_bridge) {
+            return;
+        }
+    }
+    for (auto& entry : m_zones) {
+        ZoneState& zone = entry.second;
+        int band = static_cast<int>(zone.frameLevel * 10.0f);
+        if (band != zone.sentBand) {
+            zone.sentBand = band;
+            Publish(VR_EVENT_ZONE_WARNING, entry.first, zone.frameLevel, 0);
+        }
+        zone.frameLevel = 0.0f;
+    }
+}
+
+void EventBridge::ReportZoneLevel(const std::string& zoneId, float level) {
+    ZoneState& zone = m_zones[zoneId];
+    zone.frameLevel = std::max(zone.frameLevel, level);
+}
+
+void EventBridge::PublishTrainingComplete(const std::string& scenarioId, float score, bool passed) {
+    if (m_bridge) {
+        Publish(VR_EVENT_TRAINING_COMPLETE, scenarioId, score, passed ? VR_EVENT_PASSED : 0);
+    }
+}
+
+void EventBridge::Publish(VREventType type, const std::string& subjectId, float level, uint32_t flags) {
+    VREvent event = {};
+    event.type = type;
+    event.flags = flags;
+    event.level = level;
+    std::strncpy(event.crew_id, m_crewId.c_str(), sizeof(event.crew_id));
+    std::strncpy(event.subject_id, subjectId.c_str(), sizeof(event.subject_id));
+    event.wall_time = static_cast<int64_t>(std::time(nullptr));
+    vr_bridge_publish(m_bridge, &event);
+}
+
 } 
 // namespace SAFER
 
@@ -6,12 +6,15 @@
 #include <map>
 #include <string>
 #include <functional>
+#include <cstdint>
+#include "vr_bridge.h" // C/Safety; link vr_bridge.c (and -lrt on older glibc)
 
 namespace SAFER {
 
 class SafetySystem;
 class TrainingModule;
 class RiskAssessment;
+class EventBridge;
 
 class SAFERSystem {
 public:
@@ -27,11 +30,17 @@ public:
     std::shared_ptr<TrainingModule> GetTrainingModule() { return m_trainingModule; }
     std::shared_ptr<RiskAssessment> GetRiskAssessment() { return m_riskAssessment; }
 
+    // After Initialize: send zone warnings and training results for crewId
+    // to the safety service, in place of any warning and completion
+    // callbacks. The service need not be up yet; the bridge attaches when it is.
+    void ConnectServiceBridge(const std::string& crewId, const char* name = VR_BRIDGE_DEFAULT_NAME);
+
 private:
     vr::IVRSystem* m_vrSystem;
     std::shared_ptr<SafetySystem> m_safetySystem;
     std::shared_ptr<TrainingModule> m_trainingModule;
     std::shared_ptr<RiskAssessment> m_riskAssessment;
+    std::shared_ptr<EventBridge> m_eventBridge;
 
     std::vector<vr::TrackedDevicePose_t> m_trackedDevicePoses;
     bool InitializeOpenVR();
@@ -80,11 +89,15 @@ public:
     bool LoadScenario(const std::string& scenarioId);
     void UpdateScenario();
     void AddScenario(const Scenario& scenario);
+    // Finish the current scenario with a 0-1 score
+    void CompleteScenario(float score, bool passed);
+    void SetCompletionCallback(std::function<void(const Scenario&, float, bool)> callback);
 
 private:
     vr::IVRSystem* m_vrSystem;
     std::map<std::string, Scenario> m_scenarios;
     Scenario* m_currentScenario;
+    std::function<void(const Scenario&, float, bool)> m_completionCallback;
 };
 
 class RiskAssessment {
@@ -104,3 +117,38 @@ private:
     std::vector<RiskZone> m_riskZones;
     float CalculateRisk(const vr::HmdMatrix34_t& pose, const RiskZone& zone);
 };
+
+// Publisher end of the shared-memory ring the safety service consumes.
+// Publishing never blocks or enters the kernel, so it is called straight
+// from the frame loop; events are dropped if the service falls behind.
+class EventBridge {
+public:
+    EventBridge(const std::string& crewId, const char* name);
+    ~EventBridge();
+    EventBridge(const EventBridge&) = delete;
+    EventBridge& operator=(const EventBridge&) = delete;
+
+    // Once per frame, after the subsystems have reported. Sends zones whose
+    // level moved into another tenth, and retries attaching about once a
+    // second until the service has created the ring.
+    void Update();
+    bool IsConnected() const { return m_bridge != nullptr; }
+
+    // Any number of times per frame; the highest level per zone counts
+    void ReportZoneLevel(const std::string& zoneId, float level);
+    void PublishTrainingComplete(const std::string& scenarioId, float score, bool passed);
+
+private:
+    struct ZoneState {
+        float frameLevel = 0.0f;
+        int sentBand = 0;
+    };
+
+    VRBridge* m_bridge;
+    std::string m_crewId;
+    std::string m_name;
+    uint32_t m_framesUntilRetry;
+    std::map<std::string, ZoneState> m_zones;
+
+    void Publish(VREventType type, const std::string& subjectId, float level, uint32_t flags);
+};
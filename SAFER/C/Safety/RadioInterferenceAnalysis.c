@@ -1,35 +1,388 @@
 // api_server.c
 #include "api_server.h"
+#include "radio_interference.h"
+#include "propagation.h"
+#include "read_pool.h"
+#include "hydrate.h"
+#include "request_body.h"
+#include "json_writer.h"
+#include "risk_batch.h"
+#include "radio_wire.h"
+#include "metrics.h"
+#include "persistence.h"
+#include "risk_rules.h"
+#include "snapshot.h"
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <strings.h>
+#include <unistd.h>
 
-static struct MHD_Daemon *daemon;
+#define MAX_MISSION_CREW 32
+#define DEFAULT_REQUEST_TIMEOUT_S 30
+#define DEFAULT_BULK_BODY_BYTES ((size_t)256 << 10)
+#define DEFAULT_BULK_TARGET_DELAY_MS 100
+#define DEFAULT_BULK_INTERVAL_MS 500
+
+// Admission classes; mission checks are the critical class and run inline
+enum {
+    ADMISSION_CLASS_RADIO,
+    ADMISSION_CLASS_BULK,
+    NUM_ADMISSION_CLASSES
+};
+
+// Routes with their own request metrics; everything else counts as other
+typedef enum {
+    ROUTE_MISSION,
+    ROUTE_RADIO_ANALYSIS,
+    ROUTE_MISSIONS_BATCH,
+    ROUTE_RISK_EVENTS,
+    ROUTE_METRICS,
+    ROUTE_RISK_RULES,
+    ROUTE_SNAPSHOT,
+    ROUTE_OTHER,
+    NUM_ROUTES
+} Route;
+
+static const char *route_paths[NUM_ROUTES] = {
+    "/api/mission", "/api/radio-analysis", "/api/missions/batch", "/api/risk-events", "/metrics",
+    "/api/risk-rules", "/api/snapshot", "other"
+};
+
+typedef struct {
+    MetricCounter started;
+    MetricCounter finished;
+    MetricCounter aborted;          // Ended by a timeout, disconnect or error instead of a sent response
+    MetricHistogram latency;        // Headers received to response sent
+} RouteMetrics;
+
+// Updated from the request path through per-thread shards
+struct APIMetrics {
+    RouteMetrics routes[NUM_ROUTES];
+    MetricCounter sources_analyzed;
+    MetricCounter missions_assessed;
+};
+
+static Route route_of(const char *url) {
+    for (int route = 0; route < ROUTE_OTHER; route++) {
+        if (strcmp(url, route_paths[route]) == 0) {
+            return route;
+        }
+    }
+    return ROUTE_OTHER;
+}
 
 // API endpoint handlers
 static int handle_mission_request(struct MHD_Connection *connection, 
                                 const char *method,
                                 json_object *request_json,
-                                SafetyManagementSystem *sms);
+                                APIServer *server);
 
 static int handle_radio_analysis_request(struct MHD_Connection *connection,
                                        const char *method,
-                                       json_object *request_json);
+                                       RequestBody *body,
+                                       APIServer *server);
+
+static int handle_mission_batch_request(struct MHD_Connection *connection,
+                                      const char *method,
+                                      json_object *request_json,
+                                      APIServer *server);
+
+static int handle_risk_events_request(struct MHD_Connection *connection,
+                                    const char *method,
+                                    APIServer *server);
+
+static int handle_metrics_request(struct MHD_Connection *connection,
+                                const char *method,
+                                APIServer *server);
+static int handle_risk_rules_request(struct MHD_Connection *connection,
+                                   const char *method,
+                                   json_object *request_json);
+static int handle_snapshot_request(struct MHD_Connection *connection,
+                                 const char *method,
+                                 APIServer *server);
+
+// Optional "propagation" object: model name plus model parameters
+static int parse_propagation(json_object *request_json, PropagationConfig *config) {
+    json_object *propagation_obj, *field;
+    if (!json_object_object_get_ex(request_json, "propagation", &propagation_obj)) {
+        return 0;
+    }
+    if (!json_object_object_get_ex(propagation_obj, "model", &field) ||
+        (config->model = propagation_model_by_name(json_object_get_string(field))) == NULL) {
+        return -1;
+    }
+    if (json_object_object_get_ex(propagation_obj, "transmitter_height_m", &field)) {
+        config->params.transmitter_height_m = json_object_get_double(field);
+    }
+    if (json_object_object_get_ex(propagation_obj, "receiver_height_m", &field)) {
+        config->params.receiver_height_m = json_object_get_double(field);
+    }
+    if (json_object_object_get_ex(propagation_obj, "rain_rate_mm_h", &field)) {
+        config->params.rain_rate_mm_h = json_object_get_double(field);
+    }
+    if (json_object_object_get_ex(propagation_obj, "polarization", &field)) {
+        config->params.vertical_polarization = strcmp(json_object_get_string(field), "vertical") == 0;
+    }
+    if (json_object_object_get_ex(propagation_obj, "environment", &field)) {
+        const char *environment = json_object_get_string(field);
+        if (strcmp(environment, "suburban") == 0) config->params.environment = HATA_SUBURBAN;
+        else if (strcmp(environment, "open") == 0) config->params.environment = HATA_OPEN;
+        else if (strcmp(environment, "metropolitan") == 0) config->params.environment = HATA_METROPOLITAN;
+        else config->params.environment = HATA_URBAN;
+    }
+    return 1;
+}
+
+// Storage for count zeroed sources
+typedef RadioSource *(*SourceBufferFn)(int count);
+
+static RadioSource *heap_sources(int count) {
+    return calloc(count > 0 ? count : 1, sizeof(RadioSource));
+}
+
+// Per-thread source buffer reused across requests; freed when the thread exits
+typedef struct {
+    RadioSource *sources;
+    int capacity;
+} SourceScratch;
+
+static pthread_key_t source_scratch_key;
+static pthread_once_t source_scratch_once = PTHREAD_ONCE_INIT;
+
+static void free_source_scratch(void *arg) {
+    SourceScratch *scratch = arg;
+    free(scratch->sources);
+    free(scratch);
+}
+
+static void create_source_scratch_key(void) {
+    pthread_key_create(&source_scratch_key, free_source_scratch);
+}
+
+static RadioSource *thread_scratch_sources(int count) {
+    pthread_once(&source_scratch_once, create_source_scratch_key);
+    SourceScratch *scratch = pthread_getspecific(source_scratch_key);
+    if (scratch == NULL) {
+        scratch = calloc(1, sizeof(SourceScratch));
+        if (scratch == NULL || pthread_setspecific(source_scratch_key, scratch) != 0) {
+            free(scratch);
+            return NULL;
+        }
+    }
+    if (count > scratch->capacity) {
+        int capacity = scratch->capacity > 0 ? scratch->capacity : 64;
+        while (capacity < count) {
+            capacity *= 2;
+        }
+        RadioSource *sources = realloc(scratch->sources, sizeof(RadioSource) * capacity);
+        if (sources == NULL) {
+            return NULL;
+        }
+        scratch->sources = sources;
+        scratch->capacity = capacity;
+    }
+    if (count > 0) {
+        memset(scratch->sources, 0, sizeof(RadioSource) * count);
+    }
+    return scratch->sources;
+}
+
+// Radio environment fields of a request object, with env->sources taken
+// from allocate. Returns 0 on success, -1 for an unknown propagation model,
+// -2 when out of memory, -3 when "sources" is not an array.
+static int parse_radio_environment(json_object *env_json, RadioEnvironment *env, PropagationConfig *propagation,
+                                   SourceBufferFn allocate) {
+    int has_propagation = parse_propagation(env_json, propagation);
+    if (has_propagation < 0) {
+        return -1;
+    }
+    if (has_propagation) {
+        env->propagation = propagation;
+    }
+    json_object *noise_obj, *weather_obj;
+    if (json_object_object_get_ex(env_json, "background_noise", &noise_obj)) {
+        env->background_noise = json_object_get_double(noise_obj);
+    }
+    if (json_object_object_get_ex(env_json, "weather_factor", &weather_obj)) {
+        env->weather_factor = json_object_get_double(weather_obj);
+    }
+    json_object *sources_array;
+    if (json_object_object_get_ex(env_json, "sources", &sources_array)) {
+        if (!json_object_is_type(sources_array, json_type_array)) {
+            return -3;
+        }
+        env->num_sources = json_object_array_length(sources_array);
+        env->sources = allocate(env->num_sources);
+        if (env->sources == NULL) {
+            env->num_sources = 0;
+            return -2;
+        }
+        
+        for (int i = 0; i < env->num_sources; i++) {
+            json_object *source_obj = json_object_array_get_idx(sources_array, i);
+            json_object *freq_obj, *power_obj, *distance_obj, *terrain_obj;
+            
+            if (json_object_object_get_ex(source_obj, "frequency", &freq_obj)) {
+                env->sources[i].frequency = json_object_get_double(freq_obj);
+            }
+            if (json_object_object_get_ex(source_obj, "power", &power_obj)) {
+                env->sources[i].power = json_object_get_double(power_obj);
+            }
+            if (json_object_object_get_ex(source_obj, "distance", &distance_obj)) {
+                env->sources[i].distance = json_object_get_double(distance_obj);
+            }
+            if (json_object_object_get_ex(source_obj, "terrain_factor", &terrain_obj)) {
+                env->sources[i].terrain_factor = json_object_get_double(terrain_obj);
+            }
+        }
+    }
+    return 0;
+}
+
+static void parse_weather(json_object *weather_json, WeatherCondition *weather) {
+    json_object *field;
+    if (json_object_object_get_ex(weather_json, "temperature", &field)) {
+        weather->temperature = json_object_get_double(field);
+    }
+    if (json_object_object_get_ex(weather_json, "visibility", &field)) {
+        weather->visibility = json_object_get_double(field);
+    }
+    if (json_object_object_get_ex(weather_json, "wind_speed", &field)) {
+        weather->wind_speed = json_object_get_double(field);
+    }
+    if (json_object_object_get_ex(weather_json, "precipitation", &field)) {
+        weather->precipitation = json_object_get_double(field);
+    }
+}
+
+// Mission fields of a request object; referenced aircraft and crew are
+// resolved through the in-memory id index into crew[0..max_crew). Returns
+// -1 when "crew" is not an array.
+static int parse_mission(SafetyManagementSystem *sms, json_object *mission_json, Mission *mission,
+                         CrewMember **crew, int max_crew) {
+    json_object *mission_id_obj, *aircraft_id_obj, *crew_array, *type_obj, *weather_obj;
+    if (json_object_object_get_ex(mission_json, "id", &mission_id_obj)) {
+        strncpy(mission->id, json_object_get_string(mission_id_obj), sizeof(mission->id) - 1);
+    }
+    if (json_object_object_get_ex(mission_json, "mission_type", &type_obj)) {
+        strncpy(mission->mission_type, json_object_get_string(type_obj), sizeof(mission->mission_type) - 1);
+    }
+    if (json_object_object_get_ex(mission_json, "weather", &weather_obj)) {
+        parse_weather(weather_obj, &mission->weather);
+    }
+    
+    if (json_object_object_get_ex(mission_json, "aircraft_id", &aircraft_id_obj)) {
+        mission->aircraft = find_aircraft(sms, json_object_get_string(aircraft_id_obj));
+    }
+    if (json_object_object_get_ex(mission_json, "crew", &crew_array)) {
+        if (!json_object_is_type(crew_array, json_type_array)) {
+            return -1;
+        }
+        int crew_size = json_object_array_length(crew_array);
+        for (int i = 0; i < crew_size && mission->crew_size < max_crew; i++) {
+            const char *crew_id = json_object_get_string(json_object_array_get_idx(crew_array, i));
+            CrewMember *member = crew_id != NULL ? find_crew_member(sms, crew_id) : NULL;
+            if (member != NULL) {
+                crew[mission->crew_size++] = member;
+            }
+        }
+        mission->crew = crew;
+    }
+    return 0;
+}
+
+// Response whose body is the writer's buffer, not a copy of it; microhttpd
+// hands the buffer back to the pool once it has been sent
+static struct MHD_Response *create_json_response(JsonWriter *writer) {
+    const char *json_str;
+    size_t length;
+    JsonBuffer *buffer = json_writer_detach(writer, &json_str, &length);
+    if (buffer == NULL) {
+        return NULL;
+    }
+    struct MHD_Response *response_obj = MHD_create_response_from_buffer_with_free_callback_cls(
+        length,
+        json_str,
+        &json_buffer_release,
+        buffer
+    );
+    if (response_obj == NULL) {
+        json_buffer_release(buffer);
+        return NULL;
+    }
+    MHD_add_response_header(response_obj, "Content-Type", "application/json");
+    return response_obj;
+}
 
 static int send_json_response(struct MHD_Connection *connection,
-                            json_object *response,
+                            JsonWriter *writer,
                             int status_code) {
-    const char *json_str = json_object_to_json_string(response);
-    struct MHD_Response *response_obj = MHD_create_response_from_buffer(
-        strlen(json_str),
-        (void*)json_str,
-        MHD_RESPMEM_MUST_COPY
-    );
+    struct MHD_Response *response_obj = create_json_response(writer);
+    if (response_obj == NULL) {
+        return MHD_NO;
+    }
     
-    MHD_add_response_header(response_obj, "Content-Type", "application/json");
     int ret = MHD_queue_response(connection, status_code, response_obj);
     MHD_destroy_response(response_obj);
     
     return ret;
 }
 
+static int send_error(struct MHD_Connection *connection, const char *message, int status_code) {
+    JsonWriter writer;
+    if (json_writer_init(&writer) != 0) {
+        return MHD_NO;
+    }
+    json_writer_begin_object(&writer);
+    json_writer_key(&writer, "error");
+    json_writer_string(&writer, message);
+    json_writer_end_object(&writer);
+    return send_json_response(connection, &writer, status_code);
+}
+
+// Reserve an in-flight slot; fails when the endpoint is at its cap
+static int endpoint_acquire(EndpointLimit *limit) {
+    if (limit->max_concurrent <= 0) {
+        return 1;
+    }
+    if (__atomic_add_fetch(&limit->in_flight, 1, __ATOMIC_ACQ_REL) > limit->max_concurrent) {
+        __atomic_sub_fetch(&limit->in_flight, 1, __ATOMIC_ACQ_REL);
+        __atomic_add_fetch(&limit->rejected, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    return 1;
+}
+
+static void endpoint_release(EndpointLimit *limit) {
+    if (limit->max_concurrent > 0) {
+        __atomic_sub_fetch(&limit->in_flight, 1, __ATOMIC_ACQ_REL);
+    }
+}
+
+// Whether a Content-Type value names media_type, ignoring parameters
+static int is_media_type(const char *value, const char *media_type) {
+    size_t length = strlen(media_type);
+    return value != NULL && strncasecmp(value, media_type, length) == 0 &&
+           (value[length] == '\0' || value[length] == ';' || value[length] == ' ');
+}
+
+static int accepts_media_type(struct MHD_Connection *connection, const char *media_type) {
+    const char *accept = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, "Accept");
+    return accept != NULL && strstr(accept, media_type) != NULL;
+}
+
+static int send_overloaded(struct MHD_Connection *connection) {
+    const char *body = "{\"error\":\"Endpoint busy\"}";
+    struct MHD_Response *response = MHD_create_response_from_buffer(strlen(body), (void *)body,
+                                                                    MHD_RESPMEM_PERSISTENT);
+    MHD_add_response_header(response, "Content-Type", "application/json");
+    MHD_add_response_header(response, MHD_HTTP_HEADER_RETRY_AFTER, "1");
+    int ret = MHD_queue_response(connection, MHD_HTTP_SERVICE_UNAVAILABLE, response);
+    MHD_destroy_response(response);
+    return ret;
+}
+
 static int request_handler(void *cls,
                          struct MHD_Connection *connection,
                          const char *url,
@@ -39,173 +392,1274 @@ static int request_handler(void *cls,
                          size_t *upload_data_size,
                          void **con_cls) {
     APIServer *server = (APIServer*)cls;
+    (void)version;
     
     // Handle only POST and GET methods
     if (strcmp(method, "POST") != 0 && strcmp(method, "GET") != 0) {
         return MHD_NO;
     }
     
-    // Parse JSON request body for POST requests
-    json_object *request_json = NULL;
-    if (strcmp(method, "POST") == 0 && upload_data != NULL) {
-        request_json = json_tokener_parse(upload_data);
-        if (request_json == NULL) {
-            json_object *error = json_object_new_object();
-            json_object_object_add(error, "error", json_object_new_string("Invalid JSON"));
-            return send_json_response(connection, error, MHD_HTTP_BAD_REQUEST);
+    // First call carries only the headers: reject oversized uploads up front
+    // and set up the incremental parser for the chunks that follow. Binary
+    // radio requests are collected whole instead, in a buffer they can be
+    // analysed from in place.
+    RequestBody *body = *con_cls;
+    if (body == NULL) {
+        size_t max_bytes = server->max_body_bytes ? server->max_body_bytes : REQUEST_BODY_DEFAULT_MAX_BYTES;
+        const char *content_length = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, "Content-Length");
+        unsigned long long announced = content_length != NULL ? strtoull(content_length, NULL, 10) : 0;
+        const char *content_type = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, "Content-Type");
+        RequestBodyFormat format = is_media_type(content_type, RADIO_WIRE_CONTENT_TYPE) ? REQUEST_BODY_RAW
+                                                                                        : REQUEST_BODY_JSON;
+        body = request_body_acquire(max_bytes, format);
+        if (body == NULL) {
+            return MHD_NO;
+        }
+        *con_cls = body;
+        body->route = route_of(url);
+        body->started_ns = metrics_now_ns();
+        metric_counter_add(&server->metrics->routes[body->route].started, 1);
+        if (announced > max_bytes) {
+            return send_error(connection, "Request body too large", MHD_HTTP_PAYLOAD_TOO_LARGE);
+        }
+        if (format == REQUEST_BODY_RAW && request_body_reserve(body, announced) != 0) {
+            return send_error(connection, "Out of memory", MHD_HTTP_INTERNAL_SERVER_ERROR);
         }
+        return MHD_YES;
+    }
+    
+    // Parse each upload chunk as it arrives
+    if (*upload_data_size > 0) {
+        request_body_feed(body, upload_data, *upload_data_size);
+        *upload_data_size = 0;
+        return MHD_YES;
+    }
+    
+    switch (request_body_finish(body)) {
+    case REQUEST_BODY_TOO_LARGE:
+        return send_error(connection, "Request body too large", MHD_HTTP_PAYLOAD_TOO_LARGE);
+    case REQUEST_BODY_INVALID:
+        // Raw bodies only fail to be stored
+        if (body->format == REQUEST_BODY_RAW) {
+            return send_error(connection, "Out of memory", MHD_HTTP_INTERNAL_SERVER_ERROR);
+        }
+        return send_error(connection, "Invalid JSON", MHD_HTTP_BAD_REQUEST);
+    default:
+        break;
+    }
+    if (body->format == REQUEST_BODY_RAW && strcmp(url, "/api/radio-analysis") != 0) {
+        return send_error(connection, "Unsupported media type", MHD_HTTP_UNSUPPORTED_MEDIA_TYPE);
+    }
+    // Owned by body; freed when the request completes
+    json_object *request_json = body->json;
+    if (strcmp(method, "POST") == 0 && body->format == REQUEST_BODY_JSON && request_json == NULL) {
+        return send_error(connection, "Request body required", MHD_HTTP_BAD_REQUEST);
     }
     
     // Route requests to appropriate handlers
     if (strcmp(url, "/api/mission") == 0) {
-        return handle_mission_request(connection, method, request_json, server->sms);
+        if (!endpoint_acquire(&server->mission_limit)) {
+            return send_overloaded(connection);
+        }
+        int ret = handle_mission_request(connection, method, request_json, server);
+        endpoint_release(&server->mission_limit);
+        return ret;
     } else if (strcmp(url, "/api/radio-analysis") == 0) {
-        return handle_radio_analysis_request(connection, method, request_json);
+        // Holds its radio_limit slot from submission until it responds
+        return handle_radio_analysis_request(connection, method, body, server);
+    } else if (strcmp(url, "/api/missions/batch") == 0) {
+        // Batches are bulk work: refuse them while bulk analyses are already
+        // queueing past their target. The slot is held until the streamed
+        // response is freed.
+        if (admission_shedding(server->admission, ADMISSION_CLASS_BULK) ||
+            !endpoint_acquire(&server->batch_limit)) {
+            return send_overloaded(connection);
+        }
+        return handle_mission_batch_request(connection, method, request_json, server);
+    } else if (strcmp(url, "/api/risk-events") == 0) {
+        return handle_risk_events_request(connection, method, server);
+    } else if (strcmp(url, "/metrics") == 0) {
+        return handle_metrics_request(connection, method, server);
+    } else if (strcmp(url, "/api/risk-rules") == 0) {
+        return handle_risk_rules_request(connection, method, request_json);
+    } else if (strcmp(url, "/api/snapshot") == 0) {
+        return handle_snapshot_request(connection, method, server);
     }
     
     // Handle unknown endpoints
-    json_object *error = json_object_new_object();
-    json_object_object_add(error, "error", json_object_new_string("Endpoint not found"));
-    return send_json_response(connection, error, MHD_HTTP_NOT_FOUND);
+    return send_error(connection, "Endpoint not found", MHD_HTTP_NOT_FOUND);
+}
+
+static void request_completed(void *cls, struct MHD_Connection *connection, void **con_cls,
+                              enum MHD_RequestTerminationCode toe) {
+    APIServer *server = cls;
+    RequestBody *body = *con_cls;
+    (void)connection;
+    if (body != NULL) {
+        RouteMetrics *route = &server->metrics->routes[body->route];
+        metric_histogram_observe_ns(&route->latency, metrics_now_ns() - body->started_ns);
+        metric_counter_add(&route->finished, 1);
+        if (toe != MHD_REQUEST_TERMINATED_COMPLETED_OK) {
+            metric_counter_add(&route->aborted, 1);
+        }
+    }
+    request_body_release(body);
+    *con_cls = NULL;
 }
 
 int start_api_server(APIServer *server) {
-    daemon = MHD_start_daemon(
-        MHD_USE_SELECT_INTERNALLY,
+    unsigned int flags;
+    struct MHD_OptionItem options[5];
+    int num_options = 0;
+    
+    switch (server->mode) {
+    case API_MODE_THREAD_PER_CONNECTION:
+        flags = MHD_USE_THREAD_PER_CONNECTION | MHD_USE_AUTO_INTERNAL_THREAD;
+        break;
+    case API_MODE_SINGLE_THREAD:
+        flags = MHD_USE_SELECT_INTERNALLY;
+        break;
+    default: {
+        // MHD_USE_AUTO picks epoll on Linux; each pool thread polls its own share
+        unsigned int pool_size = server->thread_pool_size;
+        if (pool_size == 0) {
+            long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+            pool_size = cpus > 0 ? (unsigned int)cpus : 1;
+        }
+        flags = MHD_USE_AUTO_INTERNAL_THREAD;
+        if (pool_size > 1) {
+            options[num_options++] = (struct MHD_OptionItem){MHD_OPTION_THREAD_POOL_SIZE, pool_size, NULL};
+        }
+        break;
+    }
+    }
+    
+    // Idle event subscribers and queued radio analyses park their
+    // connections suspended; microhttpd refuses suspension with a thread
+    // per connection, where both block their own thread instead
+    if (server->mode != API_MODE_THREAD_PER_CONNECTION) {
+        flags |= MHD_ALLOW_SUSPEND_RESUME;
+    }
+    if (server->risk_rules_path != NULL) {
+        char error[256];
+        RiskRules *rules = risk_rules_load(server->risk_rules_path, error, sizeof(error));
+        if (rules == NULL) {
+            fprintf(stderr, "Failed to load risk rules: %s\n", error);
+            return -1;
+        }
+        risk_rules_install(rules);
+    }
+    // Shards are cache-line aligned, which calloc does not promise
+    void *metrics = NULL;
+    if (posix_memalign(&metrics, METRICS_CACHE_LINE, sizeof(struct APIMetrics)) != 0) {
+        return -1;
+    }
+    server->metrics = memset(metrics, 0, sizeof(struct APIMetrics));
+    server->risk_events = risk_events_create(server->risk_event_history);
+    if (server->risk_events == NULL) {
+        free(server->metrics);
+        server->metrics = NULL;
+        return -1;
+    }
+    if (server->radio_cache_entries >= 0) {
+        RadioCacheConfig cache_config = { .max_entries = server->radio_cache_entries };
+        server->radio_cache = radio_cache_create(&cache_config);
+    }
+    if (server->radio_admission.workers >= 0 && server->mode != API_MODE_THREAD_PER_CONNECTION) {
+        AdmissionClassConfig classes[NUM_ADMISSION_CLASSES] = {
+            [ADMISSION_CLASS_RADIO] = server->radio_admission,
+            [ADMISSION_CLASS_BULK] = server->bulk_admission
+        };
+        AdmissionClassConfig *bulk = &classes[ADMISSION_CLASS_BULK];
+        if (bulk->workers <= 0) {
+            long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+            bulk->workers = cpus / 4 > 1 ? (int)(cpus / 4) : 1;
+        }
+        if (bulk->target_delay_ms <= 0) bulk->target_delay_ms = DEFAULT_BULK_TARGET_DELAY_MS;
+        if (bulk->interval_ms <= 0) bulk->interval_ms = DEFAULT_BULK_INTERVAL_MS;
+        server->admission = admission_create(classes, NUM_ADMISSION_CLASSES);
+        if (server->admission == NULL) {
+            risk_events_destroy(server->risk_events);
+            server->risk_events = NULL;
+            radio_cache_destroy(server->radio_cache);
+            server->radio_cache = NULL;
+            free(server->metrics);
+            server->metrics = NULL;
+            return -1;
+        }
+    }
+    if (server->vr_bridge_name != NULL) {
+        VRIngestConfig vr_config = {
+            .name = server->vr_bridge_name,
+            .sms = server->sms,
+            .db = server->db,
+            .risk_events = server->risk_events
+        };
+        // The service runs without the trainer if the segment cannot be made
+        server->vr_ingest = vr_ingest_start(&vr_config);
+        if (server->vr_ingest == NULL) {
+            fprintf(stderr, "VR bridge %s unavailable, training events will not be applied\n",
+                    server->vr_bridge_name);
+        }
+    }
+    
+    unsigned int timeout = server->request_timeout_s ? server->request_timeout_s : DEFAULT_REQUEST_TIMEOUT_S;
+    options[num_options++] = (struct MHD_OptionItem){MHD_OPTION_CONNECTION_TIMEOUT, timeout, NULL};
+    if (server->connection_limit > 0) {
+        options[num_options++] = (struct MHD_OptionItem){MHD_OPTION_CONNECTION_LIMIT, server->connection_limit, NULL};
+    }
+    options[num_options++] = (struct MHD_OptionItem){MHD_OPTION_NOTIFY_COMPLETED,
+                                                     (intptr_t)&request_completed, server};
+    options[num_options] = (struct MHD_OptionItem){MHD_OPTION_END, 0, NULL};
+    
+    server->daemon = MHD_start_daemon(
+        flags,
         server->port,
         NULL,
         NULL,
         &request_handler,
         server,
+        MHD_OPTION_ARRAY, options,
         MHD_OPTION_END
     );
-    
-    return daemon != NULL ? 0 : -1;
+    if (server->daemon == NULL) {
+        vr_ingest_stop(server->vr_ingest);
+        server->vr_ingest = NULL;
+        admission_destroy(server->admission);
+        server->admission = NULL;
+        risk_events_destroy(server->risk_events);
+        server->risk_events = NULL;
+        radio_cache_destroy(server->radio_cache);
+        server->radio_cache = NULL;
+        free(server->metrics);
+        server->metrics = NULL;
+        return -1;
+    }
+    return 0;
 }
 
 void stop_api_server(APIServer *server) {
-    if (daemon != NULL) {
-        MHD_stop_daemon(daemon);
+    // Suspended subscribers and queued analyses must be resumed before the
+    // daemon can stop
+    if (server->risk_events != NULL) {
+        risk_events_close(server->risk_events);
+    }
+    admission_shutdown(server->admission);
+    if (server->daemon != NULL) {
+        MHD_stop_daemon(server->daemon);
+        server->daemon = NULL;
     }
+    // Publishes into the hub, so it stops first
+    vr_ingest_stop(server->vr_ingest);
+    server->vr_ingest = NULL;
+    risk_events_destroy(server->risk_events);
+    server->risk_events = NULL;
+    radio_cache_destroy(server->radio_cache);
+    server->radio_cache = NULL;
+    admission_destroy(server->admission);
+    server->admission = NULL;
+    free(server->metrics);
+    server->metrics = NULL;
 }
 
 // Example API endpoint implementation
 static int handle_mission_request(struct MHD_Connection *connection,
                                 const char *method,
                                 json_object *request_json,
-                                SafetyManagementSystem *sms) {
+                                APIServer *server) {
+    SafetyManagementSystem *sms = server->sms;
     if (strcmp(method, "POST") == 0) {
         // Create new mission from JSON
         Mission mission = {0};
-        json_object *mission_id_obj;
-        if (json_object_object_get_ex(request_json, "id", &mission_id_obj)) {
-            strncpy(mission.id, json_object_get_string(mission_id_obj), sizeof(mission.id) - 1);
+        CrewMember *crew[MAX_MISSION_CREW];
+        if (parse_mission(sms, request_json, &mission, crew, MAX_MISSION_CREW) != 0) {
+            return send_error(connection, "crew must be an array", MHD_HTTP_BAD_REQUEST);
         }
         
-        // Perform risk assessment including radio interference
+        // Radio counts only when the request names emitters, as in a batch
         RadioEnvironment radio_env = {0};
-        // Populate radio environment from JSON...
-        RadioInterferenceAnalysis radio_analysis = analyze_radio_interference(&radio_env);
-        
-        // Combine all risk assessments
-        perform_risk_assessment(&mission);
-        if (radio_analysis.risk_level > mission.risk_level) {
-            mission.risk_level = radio_analysis.risk_level;
+        PropagationConfig propagation = {0};
+        json_object *env_obj;
+        if (json_object_object_get_ex(request_json, "environment", &env_obj)) {
+            switch (parse_radio_environment(env_obj, &radio_env, &propagation, thread_scratch_sources)) {
+            case -1:
+                return send_error(connection, "Unknown propagation model", MHD_HTTP_BAD_REQUEST);
+            case -2:
+                return send_error(connection, "Out of memory", MHD_HTTP_INTERNAL_SERVER_ERROR);
+            case -3:
+                return send_error(connection, "sources must be an array", MHD_HTTP_BAD_REQUEST);
+            }
         }
+        RadioInterferenceAnalysis radio_analysis;
+        // Graded from the request body alone, so the registry mission of the
+        // same id keeps its own level and no transition is published
+        risk_assess_mission(&mission, &radio_env, &radio_analysis);
+        metric_counter_add(&server->metrics->missions_assessed, 1);
         
         // Create response
-        json_object *response = json_object_new_object();
-        json_object_object_add(response, "mission_id", json_object_new_string(mission.id));
-        json_object_object_add(response, "risk_level", json_object_new_int(mission.risk_level));
-        json_object_object_add(response, "radio_interference", json_object_new_double(radio_analysis.interference_level));
+        JsonWriter response;
+        if (json_writer_init(&response) != 0) {
+            return MHD_NO;
+        }
+        json_writer_begin_object(&response);
+        json_writer_key(&response, "mission_id");
+        json_writer_string(&response, mission.id);
+        json_writer_key(&response, "risk_level");
+        json_writer_int(&response, mission.risk_level);
+        json_writer_key(&response, "radio_interference");
+        json_writer_double(&response, radio_env.num_sources > 0 ? radio_analysis.interference_level : NAN);
+        json_writer_end_object(&response);
         
-        return send_json_response(connection, response, MHD_HTTP_OK);
+        return send_json_response(connection, &response, MHD_HTTP_OK);
     } else if (strcmp(method, "GET") == 0) {
         // Retrieve mission details
         const char *mission_id = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "id");
         if (mission_id == NULL) {
-            json_object *error = json_object_new_object();
-            json_object_object_add(error, "error", json_object_new_string("Mission ID required"));
-            return send_json_response(connection, error, MHD_HTTP_BAD_REQUEST);
+            return send_error(connection, "Mission ID required", MHD_HTTP_BAD_REQUEST);
+        }
+        
+        // In-memory registry first, then the database through the read pool
+        Mission *loaded = NULL;
+        Mission *mission = find_mission(sms, mission_id);
+        if (mission == NULL && server->db != NULL) {
+            mission = loaded = load_mission(server->db, mission_id);
+        }
+        if (mission == NULL) {
+            return send_error(connection, "Mission not found", MHD_HTTP_NOT_FOUND);
         }
         
         // Create response with mission details
-        json_object *response = json_object_new_object();
-        // Populate response with mission data...
+        JsonWriter response;
+        if (json_writer_init(&response) != 0) {
+            free_mission(loaded);
+            return MHD_NO;
+        }
+        json_writer_begin_object(&response);
+        json_writer_key(&response, "mission_id");
+        json_writer_string(&response, mission->id);
+        if (mission->aircraft != NULL) {
+            json_writer_key(&response, "aircraft_id");
+            json_writer_string(&response, mission->aircraft->id);
+        }
+        json_writer_key(&response, "mission_type");
+        json_writer_string(&response, mission->mission_type);
+        json_writer_key(&response, "departure_time");
+        json_writer_int(&response, mission->departure_time);
+        json_writer_key(&response, "estimated_duration");
+        json_writer_double(&response, mission->estimated_duration);
+        json_writer_key(&response, "risk_level");
+        json_writer_int(&response, mission->risk_level);
+        json_writer_key(&response, "crew");
+        json_writer_begin_array(&response);
+        for (int i = 0; i < mission->crew_size; i++) {
+            json_writer_string(&response, mission->crew[i]->id);
+        }
+        json_writer_end_array(&response);
+        json_writer_end_object(&response);
+        free_mission(loaded);
         
-        return send_json_response(connection, response, MHD_HTTP_OK);
+        return send_json_response(connection, &response, MHD_HTTP_OK);
     }
     
     return MHD_NO;
 }
 
+// SRR1 response for clients that sent Accept: application/x-safer-radio
+static struct MHD_Response *create_radio_wire_response(const RadioInterferenceAnalysis *analysis) {
+    size_t size = radio_wire_result_size(analysis);
+    void *encoded = malloc(size);
+    if (encoded == NULL) {
+        return NULL;
+    }
+    radio_wire_encode_result(analysis, encoded);
+    struct MHD_Response *response = MHD_create_response_from_buffer(size, encoded, MHD_RESPMEM_MUST_FREE);
+    if (response == NULL) {
+        free(encoded);
+        return NULL;
+    }
+    MHD_add_response_header(response, "Content-Type", RADIO_WIRE_CONTENT_TYPE);
+    return response;
+}
+
+typedef enum {
+    RADIO_JOB_OK,
+    RADIO_JOB_BAD_ENCODING,
+    RADIO_JOB_UNKNOWN_MODEL,
+    RADIO_JOB_BAD_SOURCES,
+    RADIO_JOB_NO_MEMORY,
+    RADIO_JOB_SHED              // Refused or dropped by admission control
+} RadioJobResult;
+
+// One /api/radio-analysis request, analysed on an admission worker while
+// its connection is suspended
+typedef struct {
+    AdmissionJob job;
+    APIServer *server;
+    struct MHD_Connection *connection;
+    const RequestBody *body;
+    RadioJobResult result;
+    RadioInterferenceAnalysis analysis;
+    int cached;
+} RadioAnalysisJob;
+
+// Analyse an SRB1 request from the collected body; its columns are used in place
+static RadioJobResult analyze_radio_wire_request(APIServer *server, const RequestBody *body,
+                                                 RadioInterferenceAnalysis *analysis, int *cached) {
+    RadioWireRequest request;
+    switch (radio_wire_decode_request(body->raw, body->bytes, &request)) {
+    case -1:
+        return RADIO_JOB_BAD_ENCODING;
+    case -2:
+        return RADIO_JOB_UNKNOWN_MODEL;
+    case -3:
+        return RADIO_JOB_NO_MEMORY;
+    }
+    if (server->radio_cache != NULL) {
+        *cached = radio_cache_analyze_batch(server->radio_cache, &request.env, &request.batch, analysis);
+    } else {
+        *analysis = analyze_radio_environment_batch(&request.env, &request.batch);
+    }
+    metric_counter_add(&server->metrics->sources_analyzed, request.batch.count);
+    radio_wire_request_free(&request);
+    return RADIO_JOB_OK;
+}
+
+// Perform analysis; identical requests are answered from the cache
+static void compute_radio_analysis(RadioAnalysisJob *job) {
+    APIServer *server = job->server;
+    if (job->body->format == REQUEST_BODY_RAW) {
+        job->result = analyze_radio_wire_request(server, job->body, &job->analysis, &job->cached);
+        return;
+    }
+    // Parse radio environment from JSON into this thread's reusable buffer
+    RadioEnvironment env = {0};
+    PropagationConfig propagation = {0};
+    switch (parse_radio_environment(job->body->json, &env, &propagation, thread_scratch_sources)) {
+    case -1:
+        job->result = RADIO_JOB_UNKNOWN_MODEL;
+        return;
+    case -2:
+        job->result = RADIO_JOB_NO_MEMORY;
+        return;
+    case -3:
+        job->result = RADIO_JOB_BAD_SOURCES;
+        return;
+    }
+    if (server->radio_cache != NULL) {
+        job->cached = radio_cache_analyze(server->radio_cache, &env, &job->analysis);
+    } else {
+        job->analysis = analyze_radio_interference(&env);
+    }
+    metric_counter_add(&server->metrics->sources_analyzed, env.num_sources);
+    job->result = RADIO_JOB_OK;
+}
+
+// Admission callbacks; resuming makes microhttpd call the handler again to respond
+static void run_radio_job(AdmissionJob *admission_job) {
+    RadioAnalysisJob *job = (RadioAnalysisJob *)admission_job;
+    compute_radio_analysis(job);
+    MHD_resume_connection(job->connection);
+}
+
+static void shed_radio_job(AdmissionJob *admission_job) {
+    RadioAnalysisJob *job = (RadioAnalysisJob *)admission_job;
+    job->result = RADIO_JOB_SHED;
+    MHD_resume_connection(job->connection);
+}
+
+static int send_radio_analysis(struct MHD_Connection *connection, const RadioAnalysisJob *job) {
+    switch (job->result) {
+    case RADIO_JOB_OK:
+        break;
+    case RADIO_JOB_BAD_ENCODING:
+        return send_error(connection, "Invalid radio request encoding", MHD_HTTP_BAD_REQUEST);
+    case RADIO_JOB_UNKNOWN_MODEL:
+        return send_error(connection, "Unknown propagation model", MHD_HTTP_BAD_REQUEST);
+    case RADIO_JOB_BAD_SOURCES:
+        return send_error(connection, "sources must be an array", MHD_HTTP_BAD_REQUEST);
+    case RADIO_JOB_NO_MEMORY:
+        return send_error(connection, "Out of memory", MHD_HTTP_INTERNAL_SERVER_ERROR);
+    case RADIO_JOB_SHED:
+        return send_overloaded(connection);
+    }
+    const RadioInterferenceAnalysis *analysis = &job->analysis;
+    
+    // Either encoding can be asked for regardless of the request's
+    if (accepts_media_type(connection, RADIO_WIRE_CONTENT_TYPE)) {
+        struct MHD_Response *response_obj = create_radio_wire_response(analysis);
+        if (response_obj == NULL) {
+            return MHD_NO;
+        }
+        MHD_add_response_header(response_obj, "Vary", "Accept");
+        MHD_add_response_header(response_obj, "X-Cache", job->cached ? "HIT" : "MISS");
+        int ret = MHD_queue_response(connection, MHD_HTTP_OK, response_obj);
+        MHD_destroy_response(response_obj);
+        return ret;
+    }
+    
+    // Create response
+    JsonWriter response;
+    if (json_writer_init(&response) != 0) {
+        return MHD_NO;
+    }
+    json_writer_begin_object(&response);
+    json_writer_key(&response, "interference_level");
+    json_writer_double(&response, analysis->interference_level);
+    json_writer_key(&response, "signal_to_noise");
+    json_writer_double(&response, analysis->signal_to_noise);
+    json_writer_key(&response, "risk_level");
+    json_writer_int(&response, analysis->risk_level);
+    json_writer_key(&response, "recommendations");
+    json_writer_string(&response, analysis->recommendations);
+    json_writer_end_object(&response);
+    
+    struct MHD_Response *response_obj = create_json_response(&response);
+    if (response_obj == NULL) {
+        return MHD_NO;
+    }
+    MHD_add_response_header(response_obj, "Vary", "Accept");
+    MHD_add_response_header(response_obj, "X-Cache", job->cached ? "HIT" : "MISS");
+    int ret = MHD_queue_response(connection, MHD_HTTP_OK, response_obj);
+    MHD_destroy_response(response_obj);
+    return ret;
+}
+
+// Analyses never run on the connection threads, which stay free for the
+// cheap mission checks: the request is queued by size on the radio or bulk
+// class and the connection suspended until a worker is done with it
 static int handle_radio_analysis_request(struct MHD_Connection *connection,
                                        const char *method,
-                                       json_object *request_json) {
+                                       RequestBody *body,
+                                       APIServer *server) {
     if (strcmp(method, "POST") != 0) {
-        json_object *error = json_object_new_object();
-        json_object_object_add(error, "error", json_object_new_string("Method not allowed"));
-        return send_json_response(connection, error, MHD_HTTP_METHOD_NOT_ALLOWED);
+        return send_error(connection, "Method not allowed", MHD_HTTP_METHOD_NOT_ALLOWED);
     }
     
-    // Parse radio environment from JSON
-    RadioEnvironment env = {0};
-    json_object *sources_array;
-    if (json_object_object_get_ex(request_json, "sources", &sources_array)) {
-        env.num_sources = json_object_array_length(sources_array);
-        env.sources = malloc(sizeof(RadioSource) * env.num_sources);
+    RadioAnalysisJob *job = body->work;
+    if (job == NULL) {
+        if (!endpoint_acquire(&server->radio_limit)) {
+            return send_overloaded(connection);
+        }
+        job = calloc(1, sizeof(RadioAnalysisJob));
+        if (job == NULL) {
+            endpoint_release(&server->radio_limit);
+            return send_error(connection, "Out of memory", MHD_HTTP_INTERNAL_SERVER_ERROR);
+        }
+        job->job.run = run_radio_job;
+        job->job.shed = shed_radio_job;
+        job->server = server;
+        job->connection = connection;
+        job->body = body;
+        body->work = job;
         
-        for (int i = 0; i < env.num_sources; i++) {
-            json_object *source_obj = json_object_array_get_idx(sources_array, i);
-            json_object *freq_obj, *power_obj, *distance_obj, *terrain_obj;
-            
-            if (json_object_object_get_ex(source_obj, "frequency", &freq_obj)) {
-                env.sources[i].frequency = json_object_get_double(freq_obj);
-            }
-            if (json_object_object_get_ex(source_obj, "power", &power_obj)) {
-                env.sources[i].power = json_object_get_double(power_obj);
-            }
-            if (json_object_object_get_ex(source_obj, "distance", &distance_obj)) {
-                env.sources[i].distance = json_object_get_double(distance_obj);
+        if (server->admission == NULL) {
+            compute_radio_analysis(job);
+        } else {
+            size_t bulk_bytes = server->bulk_body_bytes ? server->bulk_body_bytes : DEFAULT_BULK_BODY_BYTES;
+            int class_index = body->bytes >= bulk_bytes ? ADMISSION_CLASS_BULK : ADMISSION_CLASS_RADIO;
+            MHD_suspend_connection(connection);
+            if (admission_submit(server->admission, class_index, &job->job) != 0) {
+                job->result = RADIO_JOB_SHED;
+                MHD_resume_connection(connection);
             }
-            if (json_object_object_get_ex(source_obj, "terrain_factor", &terrain_obj)) {
-                env.sources[i].terrain_factor = json_object_get_double(terrain_obj);
+            return MHD_YES;
+        }
+    }
+    
+    body->work = NULL;
+    endpoint_release(&server->radio_limit);
+    int ret = send_radio_analysis(connection, job);
+    free(job);
+    return ret;
+}
+
+// State of one streamed /api/missions/batch response
+typedef struct {
+    APIServer *server;
+    Mission *missions;
+    int num_missions;
+    CrewMember **crew;
+    MissionRisk *results;
+    RadioEnvironment env;
+    PropagationConfig propagation;
+    RiskBatch *batch;
+    struct timespec start;
+    
+    JsonBuffer *pending;      // Serialised lines not yet handed to microhttpd
+    const char *pending_data;
+    size_t pending_length;
+    size_t pending_offset;
+    int done;                 // Summary line written
+} MissionBatchStream;
+
+static void free_mission_batch_stream(void *cls) {
+    MissionBatchStream *stream = cls;
+    risk_batch_finish(stream->batch);
+    json_buffer_release(stream->pending);
+    endpoint_release(&stream->server->batch_limit);
+    free(stream->env.sources);
+    free(stream->results);
+    free(stream->crew);
+    free(stream->missions);
+    free(stream);
+}
+
+// One line per mission for the chunk starting at first
+static void write_batch_chunk(MissionBatchStream *stream, JsonWriter *writer, int first, int count) {
+    metric_counter_add(&stream->server->metrics->missions_assessed, count);
+    for (int i = first; i < first + count; i++) {
+        const MissionRisk *risk = &stream->results[i];
+        json_writer_begin_object(writer);
+        json_writer_key(writer, "index");
+        json_writer_int(writer, i);
+        json_writer_key(writer, "mission_id");
+        json_writer_string(writer, stream->missions[i].id);
+        json_writer_key(writer, "risk_level");
+        json_writer_int(writer, risk->overall);
+        json_writer_key(writer, "weather_risk");
+        json_writer_int(writer, risk->weather);
+        json_writer_key(writer, "maintenance_risk");
+        json_writer_int(writer, risk->maintenance);
+        json_writer_key(writer, "crew_risk");
+        json_writer_int(writer, risk->crew);
+        json_writer_key(writer, "radio_risk");
+        json_writer_int(writer, risk->radio);
+        json_writer_end_object(writer);
+        json_writer_end_line(writer);
+    }
+}
+
+static void write_batch_summary(MissionBatchStream *stream, JsonWriter *writer) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    json_writer_begin_object(writer);
+    json_writer_key(writer, "done");
+    json_writer_bool(writer, 1);
+    json_writer_key(writer, "missions");
+    json_writer_int(writer, stream->num_missions);
+    if (stream->env.num_sources > 0) {
+        const RadioInterferenceAnalysis *radio = risk_batch_radio(stream->batch);
+        json_writer_key(writer, "radio_interference");
+        json_writer_double(writer, radio->interference_level);
+        json_writer_key(writer, "signal_to_noise");
+        json_writer_double(writer, radio->signal_to_noise);
+    }
+    json_writer_key(writer, "elapsed_ms");
+    json_writer_double(writer, (now.tv_sec - stream->start.tv_sec) * 1000.0 +
+                               (now.tv_nsec - stream->start.tv_nsec) / 1e6);
+    json_writer_end_object(writer);
+    json_writer_end_line(writer);
+}
+
+// Content reader: hand out chunks of results in the order they complete,
+// waiting on the batch when none are ready
+static ssize_t read_mission_batch_stream(void *cls, uint64_t pos, char *buf, size_t max) {
+    MissionBatchStream *stream = cls;
+    (void)pos;
+    
+    if (stream->pending == NULL) {
+        if (stream->done) {
+            return MHD_CONTENT_READER_END_OF_STREAM;
+        }
+        JsonWriter writer;
+        if (json_writer_init(&writer) != 0) {
+            return MHD_CONTENT_READER_END_WITH_ERROR;
+        }
+        int first;
+        int count = risk_batch_next(stream->batch, &first);
+        if (count > 0) {
+            write_batch_chunk(stream, &writer, first, count);
+        } else {
+            write_batch_summary(stream, &writer);
+            stream->done = 1;
+        }
+        stream->pending = json_writer_detach(&writer, &stream->pending_data, &stream->pending_length);
+        stream->pending_offset = 0;
+        if (stream->pending == NULL) {
+            return MHD_CONTENT_READER_END_WITH_ERROR;
+        }
+    }
+    
+    size_t n = stream->pending_length - stream->pending_offset;
+    if (n > max) {
+        n = max;
+    }
+    memcpy(buf, stream->pending_data + stream->pending_offset, n);
+    stream->pending_offset += n;
+    if (stream->pending_offset == stream->pending_length) {
+        json_buffer_release(stream->pending);
+        stream->pending = NULL;
+    }
+    return n;
+}
+
+// Assess many missions against one shared environment. Results stream back
+// as newline-delimited JSON, a chunk at a time in completion order, followed
+// by a summary line.
+static int handle_mission_batch_request(struct MHD_Connection *connection,
+                                      const char *method,
+                                      json_object *request_json,
+                                      APIServer *server) {
+    json_object *missions_array, *env_obj, *weather_obj;
+    if (strcmp(method, "POST") != 0) {
+        endpoint_release(&server->batch_limit);
+        return send_error(connection, "Method not allowed", MHD_HTTP_METHOD_NOT_ALLOWED);
+    }
+    if (!json_object_object_get_ex(request_json, "missions", &missions_array) ||
+        !json_object_is_type(missions_array, json_type_array)) {
+        endpoint_release(&server->batch_limit);
+        return send_error(connection, "missions array required", MHD_HTTP_BAD_REQUEST);
+    }
+    
+    MissionBatchStream *stream = calloc(1, sizeof(MissionBatchStream));
+    if (stream == NULL) {
+        endpoint_release(&server->batch_limit);
+        return send_error(connection, "Out of memory", MHD_HTTP_INTERNAL_SERVER_ERROR);
+    }
+    stream->server = server;
+    clock_gettime(CLOCK_MONOTONIC, &stream->start);
+    
+    // From here on free_mission_batch_stream releases the endpoint slot
+    int env_status = 0;
+    if (json_object_object_get_ex(request_json, "environment", &env_obj)) {
+        env_status = parse_radio_environment(env_obj, &stream->env, &stream->propagation, heap_sources);
+    }
+    if (env_status == -1) {
+        free_mission_batch_stream(stream);
+        return send_error(connection, "Unknown propagation model", MHD_HTTP_BAD_REQUEST);
+    }
+    if (env_status == -3) {
+        free_mission_batch_stream(stream);
+        return send_error(connection, "sources must be an array", MHD_HTTP_BAD_REQUEST);
+    }
+    
+    // Crew pointers for every mission share one allocation
+    int num_missions = json_object_array_length(missions_array);
+    size_t total_crew = 0;
+    for (int i = 0; i < num_missions; i++) {
+        json_object *crew_array;
+        if (json_object_object_get_ex(json_object_array_get_idx(missions_array, i), "crew", &crew_array)) {
+            if (!json_object_is_type(crew_array, json_type_array)) {
+                free_mission_batch_stream(stream);
+                return send_error(connection, "crew must be an array", MHD_HTTP_BAD_REQUEST);
             }
+            size_t crew_size = json_object_array_length(crew_array);
+            total_crew += crew_size < MAX_MISSION_CREW ? crew_size : MAX_MISSION_CREW;
         }
     }
+    stream->num_missions = num_missions;
+    stream->missions = calloc(num_missions > 0 ? num_missions : 1, sizeof(Mission));
+    stream->results = calloc(num_missions > 0 ? num_missions : 1, sizeof(MissionRisk));
+    stream->crew = malloc(sizeof(CrewMember *) * (total_crew > 0 ? total_crew : 1));
+    if (env_status != 0 || stream->missions == NULL || stream->results == NULL || stream->crew == NULL) {
+        free_mission_batch_stream(stream);
+        return send_error(connection, "Out of memory", MHD_HTTP_INTERNAL_SERVER_ERROR);
+    }
     
-    // Perform analysis
-    RadioInterferenceAnalysis analysis = analyze_radio_interference(&env);
+    // Missions without their own weather take the shared one
+    WeatherCondition shared_weather = {0};
+    if (json_object_object_get_ex(request_json, "weather", &weather_obj)) {
+        parse_weather(weather_obj, &shared_weather);
+    }
+    CrewMember **crew = stream->crew;
+    for (int i = 0; i < num_missions; i++) {
+        Mission *mission = &stream->missions[i];
+        mission->weather = shared_weather;
+        // Every crew field was checked to be an array above
+        parse_mission(server->sms, json_object_array_get_idx(missions_array, i), mission, crew,
+                      MAX_MISSION_CREW);
+        crew += mission->crew_size;
+    }
     
-    // Create response
-    json_object *response = json_object_new_object();
-    json_object_object_add(response, "interference_level", json_object_new_double(analysis.interference_level));
-    json_object_object_add(response, "signal_to_noise", json_object_new_double(analysis.signal_to_noise));
-    json_object_object_add(response, "risk_level", json_object_new_int(analysis.risk_level));
-    json_object_object_add(response, "recommendations", json_object_new_string(analysis.recommendations));
+    stream->batch = risk_batch_start(stream->missions, num_missions,
+                                     stream->env.num_sources > 0 ? &stream->env : NULL,
+                                     server->batch_threads, stream->results);
+    if (stream->batch == NULL) {
+        free_mission_batch_stream(stream);
+        return send_error(connection, "Out of memory", MHD_HTTP_INTERNAL_SERVER_ERROR);
+    }
+    metric_counter_add(&server->metrics->sources_analyzed, stream->env.num_sources);
+    
+    struct MHD_Response *response = MHD_create_response_from_callback(
+        MHD_SIZE_UNKNOWN,
+        16 * 1024,
+        &read_mission_batch_stream,
+        stream,
+        &free_mission_batch_stream
+    );
+    if (response == NULL) {
+        free_mission_batch_stream(stream);
+        return MHD_NO;
+    }
+    MHD_add_response_header(response, "Content-Type", "application/x-ndjson");
+    int ret = MHD_queue_response(connection, MHD_HTTP_OK, response);
+    MHD_destroy_response(response);
+    return ret;
+}
+
+static void suspend_connection(void *connection) {
+    MHD_suspend_connection(connection);
+}
+
+static void resume_connection(void *connection) {
+    MHD_resume_connection(connection);
+}
+
+// An idle subscriber is a suspended connection: no polling and no thread
+// until an event it wants is published
+static ssize_t read_risk_events(void *cls, uint64_t pos, char *buf, size_t max) {
+    (void)pos;
+    ssize_t n = risk_events_read(cls, buf, max);
+    return n < 0 ? MHD_CONTENT_READER_END_OF_STREAM : n;
+}
+
+static void free_risk_events(void *cls) {
+    risk_events_unsubscribe(cls);
+}
+
+// With a thread per connection there is no suspending: the connection's
+// thread sleeps on a condition variable between events, and sends an SSE
+// comment every RISK_EVENTS_KEEPALIVE_S so a departed client is noticed
+#define RISK_EVENTS_KEEPALIVE_S 15
+
+typedef struct {
+    RiskSubscriber *subscriber;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int ready;
+} BlockingSubscriber;
+
+static void blocking_subscriber_wait(void *context) {
+    BlockingSubscriber *blocking = context;
+    pthread_mutex_lock(&blocking->lock);
+    blocking->ready = 0;
+    pthread_mutex_unlock(&blocking->lock);
+}
+
+static void blocking_subscriber_wake(void *context) {
+    BlockingSubscriber *blocking = context;
+    pthread_mutex_lock(&blocking->lock);
+    blocking->ready = 1;
+    pthread_cond_signal(&blocking->cond);
+    pthread_mutex_unlock(&blocking->lock);
+}
+
+static ssize_t read_risk_events_blocking(void *cls, uint64_t pos, char *buf, size_t max) {
+    (void)pos;
+    BlockingSubscriber *blocking = cls;
+    static const char keepalive[] = ": keepalive\n\n";
+    for (;;) {
+        ssize_t n = risk_events_read(blocking->subscriber, buf, max);
+        if (n != 0) {
+            return n < 0 ? MHD_CONTENT_READER_END_OF_STREAM : n;
+        }
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += RISK_EVENTS_KEEPALIVE_S;
+        int timed_out = 0;
+        pthread_mutex_lock(&blocking->lock);
+        while (!blocking->ready && !timed_out) {
+            timed_out = pthread_cond_timedwait(&blocking->cond, &blocking->lock, &deadline) == ETIMEDOUT;
+        }
+        pthread_mutex_unlock(&blocking->lock);
+        if (timed_out && max >= sizeof(keepalive) - 1) {
+            memcpy(buf, keepalive, sizeof(keepalive) - 1);
+            return sizeof(keepalive) - 1;
+        }
+    }
+}
+
+static void free_blocking_subscriber(BlockingSubscriber *blocking) {
+    if (blocking->subscriber != NULL) {
+        risk_events_unsubscribe(blocking->subscriber);
+    }
+    pthread_cond_destroy(&blocking->cond);
+    pthread_mutex_destroy(&blocking->lock);
+    free(blocking);
+}
+
+static void free_risk_events_blocking(void *cls) {
+    free_blocking_subscriber(cls);
+}
+
+static BlockingSubscriber *create_blocking_subscriber(void) {
+    BlockingSubscriber *blocking = calloc(1, sizeof(BlockingSubscriber));
+    if (blocking == NULL) {
+        return NULL;
+    }
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&blocking->lock, NULL);
+    pthread_cond_init(&blocking->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    return blocking;
+}
+
+// Server-Sent Events stream of risk level transitions, optionally limited to
+// ?missions=ID,ID,... and to transitions touching ?min_level= or above.
+// Transitions are those of registry missions as vr_ingest reassesses them;
+// POST /api/mission and /api/missions/batch grade request bodies and
+// publish none.
+// Reconnecting clients resume from Last-Event-ID while it is still kept.
+static int handle_risk_events_request(struct MHD_Connection *connection,
+                                    const char *method,
+                                    APIServer *server) {
+    if (strcmp(method, "GET") != 0) {
+        return send_error(connection, "Method not allowed", MHD_HTTP_METHOD_NOT_ALLOWED);
+    }
     
-    // Cleanup
-    free(env.sources);
+    char ids_copy[RISK_EVENTS_MAX_FILTER_IDS * 17];
+    const char *ids[RISK_EVENTS_MAX_FILTER_IDS];
+    int num_ids = 0;
+    const char *missions = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "missions");
+    if (missions != NULL) {
+        if (strlen(missions) >= sizeof(ids_copy)) {
+            return send_error(connection, "Too many missions", MHD_HTTP_BAD_REQUEST);
+        }
+        strcpy(ids_copy, missions);
+        char *save = NULL;
+        for (char *id = strtok_r(ids_copy, ",", &save); id != NULL; id = strtok_r(NULL, ",", &save)) {
+            if (num_ids == RISK_EVENTS_MAX_FILTER_IDS) {
+                return send_error(connection, "Too many missions", MHD_HTTP_BAD_REQUEST);
+            }
+            ids[num_ids++] = id;
+        }
+    }
+    const char *min_level = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "min_level");
+    const char *last_event_id = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, "Last-Event-ID");
     
-    return send_json_response(connection, response, MHD_HTTP_OK);
+    RiskLevel min = min_level != NULL ? (RiskLevel)atoi(min_level) : RISK_LOW;
+    uint64_t resume_from = last_event_id != NULL ? strtoull(last_event_id, NULL, 10) : 0;
+    struct MHD_Response *response;
+    if (server->mode == API_MODE_THREAD_PER_CONNECTION) {
+        BlockingSubscriber *blocking = create_blocking_subscriber();
+        if (blocking != NULL) {
+            blocking->subscriber = risk_events_subscribe(server->risk_events, ids, num_ids, min, resume_from,
+                                                         &blocking_subscriber_wait, &blocking_subscriber_wake,
+                                                         blocking);
+        }
+        if (blocking == NULL || blocking->subscriber == NULL) {
+            if (blocking != NULL) {
+                free_blocking_subscriber(blocking);
+            }
+            return send_error(connection, "Out of memory", MHD_HTTP_INTERNAL_SERVER_ERROR);
+        }
+        response = MHD_create_response_from_callback(MHD_SIZE_UNKNOWN, 4096, &read_risk_events_blocking,
+                                                     blocking, &free_risk_events_blocking);
+        if (response == NULL) {
+            free_blocking_subscriber(blocking);
+            return MHD_NO;
+        }
+    } else {
+        RiskSubscriber *subscriber = risk_events_subscribe(server->risk_events, ids, num_ids, min, resume_from,
+                                                           &suspend_connection, &resume_connection, connection);
+        if (subscriber == NULL) {
+            return send_error(connection, "Out of memory", MHD_HTTP_INTERNAL_SERVER_ERROR);
+        }
+        response = MHD_create_response_from_callback(MHD_SIZE_UNKNOWN, 4096, &read_risk_events,
+                                                     subscriber, &free_risk_events);
+        if (response == NULL) {
+            risk_events_unsubscribe(subscriber);
+            return MHD_NO;
+        }
+    }
+    MHD_add_response_header(response, "Content-Type", "text/event-stream");
+    MHD_add_response_header(response, MHD_HTTP_HEADER_CACHE_CONTROL, "no-cache");
+    int ret = MHD_queue_response(connection, MHD_HTTP_OK, response);
+    MHD_destroy_response(response);
+    return ret;
 }
 
-// main.c (updated with API and radio interference)
-int main() {
-    // Initialize safety management system and database
-    SafetyManagementSystem sms = {0};
-    Database db = {0};
+static void write_route_metrics(FILE *out, APIServer *server) {
+    char labels[NUM_ROUTES][64];
+    for (int route = 0; route < NUM_ROUTES; route++) {
+        snprintf(labels[route], sizeof(labels[route]), "route=\"%s\"", route_paths[route]);
+    }
+    const RouteMetrics *routes = server->metrics->routes;
+
+    metrics_write_family(out, "safer_http_requests_total", "counter", "Requests received, by route");
+    for (int route = 0; route < NUM_ROUTES; route++) {
+        metrics_write_sample(out, "safer_http_requests_total", labels[route],
+                             metric_counter_value(&routes[route].started));
+    }
+    metrics_write_family(out, "safer_http_requests_in_flight", "gauge", "Requests not yet completed, by route");
+    for (int route = 0; route < NUM_ROUTES; route++) {
+        // Read finished first so a request completing in between is not counted negative
+        uint64_t finished = metric_counter_value(&routes[route].finished);
+        uint64_t started = metric_counter_value(&routes[route].started);
+        metrics_write_sample(out, "safer_http_requests_in_flight", labels[route],
+                             started > finished ? (double)(started - finished) : 0);
+    }
+    metrics_write_family(out, "safer_http_requests_aborted_total", "counter",
+                         "Requests ended by a timeout, disconnect or error, by route");
+    for (int route = 0; route < NUM_ROUTES; route++) {
+        metrics_write_sample(out, "safer_http_requests_aborted_total", labels[route],
+                             metric_counter_value(&routes[route].aborted));
+    }
+    metrics_write_family(out, "safer_http_requests_rejected_total", "counter",
+                         "Requests refused with 503 by the endpoint's concurrency limit");
+    metrics_write_sample(out, "safer_http_requests_rejected_total", labels[ROUTE_MISSION],
+                         __atomic_load_n(&server->mission_limit.rejected, __ATOMIC_RELAXED));
+    metrics_write_sample(out, "safer_http_requests_rejected_total", labels[ROUTE_RADIO_ANALYSIS],
+                         __atomic_load_n(&server->radio_limit.rejected, __ATOMIC_RELAXED));
+    metrics_write_sample(out, "safer_http_requests_rejected_total", labels[ROUTE_MISSIONS_BATCH],
+                         __atomic_load_n(&server->batch_limit.rejected, __ATOMIC_RELAXED));
+    metrics_write_family(out, "safer_http_request_duration_seconds", "histogram",
+                         "Time from request headers to the end of the response, by route");
+    for (int route = 0; route < NUM_ROUTES; route++) {
+        MetricHistogramSnapshot latency;
+        metric_histogram_snapshot(&routes[route].latency, &latency);
+        metrics_write_histogram(out, "safer_http_request_duration_seconds", labels[route], &latency);
+    }
+}
+
+static void write_engine_metrics(FILE *out, APIServer *server) {
+    metrics_write_family(out, "safer_radio_sources_analyzed_total", "counter",
+                         "Emitters in radio analyses served, cache hits included");
+    metrics_write_sample(out, "safer_radio_sources_analyzed_total", NULL,
+                         metric_counter_value(&server->metrics->sources_analyzed));
+    metrics_write_family(out, "safer_missions_assessed_total", "counter", "Missions risk assessed");
+    metrics_write_sample(out, "safer_missions_assessed_total", NULL,
+                         metric_counter_value(&server->metrics->missions_assessed));
+
+    if (server->radio_cache != NULL) {
+        RadioCacheStats cache;
+        radio_cache_stats(server->radio_cache, &cache);
+        metrics_write_family(out, "safer_radio_cache_requests_total", "counter",
+                             "Radio analysis cache lookups, by result");
+        metrics_write_sample(out, "safer_radio_cache_requests_total", "result=\"hit\"", cache.hits - cache.coalesced);
+        metrics_write_sample(out, "safer_radio_cache_requests_total", "result=\"coalesced\"", cache.coalesced);
+        metrics_write_sample(out, "safer_radio_cache_requests_total", "result=\"miss\"", cache.misses);
+        metrics_write_family(out, "safer_radio_cache_evictions_total", "counter", "Radio analysis cache evictions");
+        metrics_write_sample(out, "safer_radio_cache_evictions_total", NULL, cache.evictions);
+        metrics_write_family(out, "safer_radio_cache_entries", "gauge", "Radio analyses cached");
+        metrics_write_sample(out, "safer_radio_cache_entries", NULL, cache.entries);
+    }
+
+    if (server->admission != NULL) {
+        static const char *class_labels[NUM_ADMISSION_CLASSES] = {
+            [ADMISSION_CLASS_RADIO] = "class=\"radio\"", [ADMISSION_CLASS_BULK] = "class=\"bulk\""
+        };
+        AdmissionClassStats classes[NUM_ADMISSION_CLASSES];
+        for (int c = 0; c < NUM_ADMISSION_CLASSES; c++) {
+            admission_stats(server->admission, c, &classes[c]);
+        }
+        metrics_write_family(out, "safer_admission_queue_depth", "gauge", "Analyses waiting for a worker, by class");
+        for (int c = 0; c < NUM_ADMISSION_CLASSES; c++) {
+            metrics_write_sample(out, "safer_admission_queue_depth", class_labels[c], classes[c].queued);
+        }
+        metrics_write_family(out, "safer_admission_busy_workers", "gauge", "Workers running an analysis, by class");
+        for (int c = 0; c < NUM_ADMISSION_CLASSES; c++) {
+            metrics_write_sample(out, "safer_admission_busy_workers", class_labels[c], classes[c].busy);
+        }
+        metrics_write_family(out, "safer_admission_shedding", "gauge",
+                             "1 while queue delay has stayed above target, by class");
+        for (int c = 0; c < NUM_ADMISSION_CLASSES; c++) {
+            metrics_write_sample(out, "safer_admission_shedding", class_labels[c], classes[c].shedding);
+        }
+        metrics_write_family(out, "safer_admission_jobs_total", "counter", "Analyses by class and outcome");
+        for (int c = 0; c < NUM_ADMISSION_CLASSES; c++) {
+            char labels[64];
+            const struct { const char *result; uint64_t value; } outcomes[] = {
+                {"completed", classes[c].completed}, {"shed", classes[c].shed},
+                {"refused_full", classes[c].refused_full}, {"refused_delay", classes[c].refused_delay}
+            };
+            for (size_t i = 0; i < sizeof(outcomes) / sizeof(outcomes[0]); i++) {
+                snprintf(labels, sizeof(labels), "%s,result=\"%s\"", class_labels[c], outcomes[i].result);
+                metrics_write_sample(out, "safer_admission_jobs_total", labels, outcomes[i].value);
+            }
+        }
+        metrics_write_family(out, "safer_admission_queue_delay_seconds", "histogram",
+                             "Time analyses waited for a worker, by class");
+        for (int c = 0; c < NUM_ADMISSION_CLASSES; c++) {
+            metrics_write_histogram(out, "safer_admission_queue_delay_seconds", class_labels[c],
+                                    &classes[c].queue_delay);
+        }
+    }
+
+    WriteBehind *write_behind = server->db != NULL ? server->db->write_behind : NULL;
+    if (write_behind != NULL) {
+        WriteBehindStats db;
+        write_behind_stats(write_behind, &db);
+        metrics_write_family(out, "safer_db_queue_depth", "gauge", "Saves waiting for the write-behind writer");
+        metrics_write_sample(out, "safer_db_queue_depth", NULL, db.queue_depth);
+        metrics_write_family(out, "safer_db_rows_total", "counter", "Rows written by the write-behind writer");
+        metrics_write_sample(out, "safer_db_rows_total", "result=\"committed\"", db.committed);
+        metrics_write_sample(out, "safer_db_rows_total", "result=\"failed\"", db.failed);
+        metrics_write_family(out, "safer_db_batch_duration_seconds", "histogram",
+                             "Write and commit time of each write-behind batch");
+        metrics_write_histogram(out, "safer_db_batch_duration_seconds", NULL, &db.batch_latency);
+    }
+
+    if (server->vr_ingest != NULL) {
+        VRIngestStats vr;
+        vr_ingest_stats(server->vr_ingest, &vr);
+        metrics_write_family(out, "safer_vr_events_total", "counter", "VR bridge events, by outcome");
+        metrics_write_sample(out, "safer_vr_events_total", "result=\"consumed\"", vr.bridge.consumed);
+        metrics_write_sample(out, "safer_vr_events_total", "result=\"dropped\"", vr.bridge.dropped);
+        metrics_write_family(out, "safer_vr_events_pending", "gauge", "VR bridge events waiting to be applied");
+        metrics_write_sample(out, "safer_vr_events_pending", NULL, vr.bridge.pending);
+        metrics_write_family(out, "safer_vr_applied_total", "counter", "VR bridge events handled, by kind");
+        metrics_write_sample(out, "safer_vr_applied_total", "kind=\"zone_warning\"", vr.zone_warnings);
+        metrics_write_sample(out, "safer_vr_applied_total", "kind=\"training\"", vr.trainings);
+        metrics_write_sample(out, "safer_vr_applied_total", "kind=\"unknown_crew\"", vr.unknown_crew);
+        metrics_write_family(out, "safer_vr_missions_reassessed_total", "counter",
+                             "Missions reassessed after crew training changed");
+        metrics_write_sample(out, "safer_vr_missions_reassessed_total", NULL, vr.missions_reassessed);
+        metrics_write_family(out, "safer_vr_event_lag_seconds", "histogram",
+                             "Time from VR publish to the service applying the event");
+        metrics_write_histogram(out, "safer_vr_event_lag_seconds", NULL, &vr.lag);
+    }
+}
+
+// Prometheus scrape endpoint
+static int handle_metrics_request(struct MHD_Connection *connection,
+                                const char *method,
+                                APIServer *server) {
+    if (strcmp(method, "GET") != 0) {
+        return send_error(connection, "Method not allowed", MHD_HTTP_METHOD_NOT_ALLOWED);
+    }
+    char *text = NULL;
+    size_t length = 0;
+    FILE *out = open_memstream(&text, &length);
+    if (out == NULL) {
+        return send_error(connection, "Out of memory", MHD_HTTP_INTERNAL_SERVER_ERROR);
+    }
+    write_route_metrics(out, server);
+    write_engine_metrics(out, server);
+    if (fclose(out) != 0) {
+        free(text);
+        return send_error(connection, "Out of memory", MHD_HTTP_INTERNAL_SERVER_ERROR);
+    }
+
+    struct MHD_Response *response = MHD_create_response_from_buffer(length, text, MHD_RESPMEM_MUST_FREE);
+    if (response == NULL) {
+        free(text);
+        return MHD_NO;
+    }
+    MHD_add_response_header(response, "Content-Type", "text/plain; version=0.0.4");
+    int ret = MHD_queue_response(connection, MHD_HTTP_OK, response);
+    MHD_destroy_response(response);
+    return ret;
+}
+
+// Hot swap of the risk rule set: {"rules": "<rule text>"}, see risk_rules.h.
+// Assessments already running finish under the rules they started with.
+static int handle_risk_rules_request(struct MHD_Connection *connection,
+                                   const char *method,
+                                   json_object *request_json) {
+    if (strcmp(method, "POST") != 0) {
+        return send_error(connection, "Method not allowed", MHD_HTTP_METHOD_NOT_ALLOWED);
+    }
+    json_object *text;
+    if (!json_object_object_get_ex(request_json, "rules", &text) || !json_object_is_type(text, json_type_string)) {
+        return send_error(connection, "rules must be a string", MHD_HTTP_BAD_REQUEST);
+    }
+    char error[256];
+    RiskRules *rules = risk_rules_parse(json_object_get_string(text), error, sizeof(error));
+    if (rules == NULL) {
+        return send_error(connection, error, MHD_HTTP_BAD_REQUEST);
+    }
+    int num_profiles = rules->num_profiles;
+    risk_rules_install(rules);
+
+    JsonWriter response;
+    if (json_writer_init(&response) != 0) {
+        return MHD_NO;
+    }
+    json_writer_begin_object(&response);
+    json_writer_key(&response, "generation");
+    json_writer_int(&response, (long long)risk_rules_generation());
+    json_writer_key(&response, "aircraft_profiles");
+    json_writer_int(&response, num_profiles - 1);
+    json_writer_end_object(&response);
+    return send_json_response(connection, &response, MHD_HTTP_OK);
+}
+
+// Checkpoint the registry to server->snapshot_path, see snapshot.h. One at
+// a time; a request while another is writing gets 409.
+static int handle_snapshot_request(struct MHD_Connection *connection,
+                                 const char *method,
+                                 APIServer *server) {
+    if (strcmp(method, "POST") != 0) {
+        return send_error(connection, "Method not allowed", MHD_HTTP_METHOD_NOT_ALLOWED);
+    }
+    if (server->snapshot_path == NULL || server->sms->registry == NULL) {
+        return send_error(connection, "Snapshots not configured", MHD_HTTP_NOT_FOUND);
+    }
+    int idle = 0;
+    if (!__atomic_compare_exchange_n(&server->snapshot_running, &idle, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return send_error(connection, "Snapshot already in progress", MHD_HTTP_CONFLICT);
+    }
+    SnapshotStats stats;
+    int rc = snapshot_write(server->sms->registry, server->db, server->snapshot_path, &stats);
+    __atomic_store_n(&server->snapshot_running, 0, __ATOMIC_RELEASE);
+    if (rc != 0) {
+        return send_error(connection, "Snapshot failed", MHD_HTTP_INTERNAL_SERVER_ERROR);
+    }
+
+    JsonWriter response;
+    if (json_writer_init(&response) != 0) {
+        return MHD_NO;
+    }
+    json_writer_begin_object(&response);
+    json_writer_key(&response, "aircraft");
+    json_writer_int(&response, stats.num_aircraft);
+    json_writer_key(&response, "crew");
+    json_writer_int(&response, stats.num_crew);
+    json_writer_key(&response, "missions");
+    json_writer_int(&response, stats.num_missions);
+    json_writer_key(&response, "high_water_mark");
+    json_writer_int(&response, (long long)stats.high_water_mark);
+    json_writer_key(&response, "bytes");
+    json_writer_int(&response, (long long)stats.file_bytes);
+    json_writer_key(&response, "elapsed_ms");
+    json_writer_double(&response, stats.total_ms);
+    json_writer_end_object(&response);
+    return send_json_response(connection, &response, MHD_HTTP_OK);
+}
+
+// Load the fleet, serve until Enter and checkpoint. Returns the exit
+// status; main owns the database and registry and releases them either way.
+static int run_server(SafetyManagementSystem *sms, FleetRegistry *registry, Database *db) {
+    // Resume from the last checkpoint plus the changes logged since;
+    // without a usable one, load the fleet in one pass per table
+    SnapshotStats snapshot_stats;
+    HydrateStats load_stats;
+    if (snapshot_restore(registry, db, SNAPSHOT_DEFAULT_PATH, &snapshot_stats) == 0) {
+        printf("Restored %d aircraft, %d crew, %d missions from snapshot in %.1f ms "
+               "(%d aircraft, %d crew, %d missions replayed)\n",
+               snapshot_stats.num_aircraft, snapshot_stats.num_crew, snapshot_stats.num_missions,
+               snapshot_stats.total_ms, snapshot_stats.replay.num_aircraft,
+               snapshot_stats.replay.num_crew, snapshot_stats.replay.num_missions);
+    } else if (hydrate_registry(db, registry, &load_stats) == SQLITE_OK) {
+        printf("Loaded %d aircraft, %d crew, %d missions in %.1f ms\n",
+               load_stats.num_aircraft, load_stats.num_crew, load_stats.num_missions,
+               load_stats.total_ms);
+    } else {
+        fprintf(stderr, "Failed to load fleet from database\n");
+        return 1;
+    }
     
-    if (init_database(&db) != SQLITE_OK) {
-        fprintf(stderr, "Failed to initialize database\n");
+    // Handlers read through per-thread connections; the writer stays single
+    if (read_pool_open(db, 0) != 0) {
+        fprintf(stderr, "Failed to open read pool\n");
         return 1;
     }
     
     // Initialize and start API server
     APIServer api_server = {
         .port = 8080,
-        .sms = &sms,
-        .db = &db
+        .sms = sms,
+        .db = db,
+        .mode = API_MODE_THREAD_POOL,
+        // Radio analyses are CPU bound; cap them so a burst cannot hold every worker
+        .radio_limit = { .max_concurrent = 64 },
+        // Each batch already uses every core, and its response holds a worker while streaming
+        .batch_limit = { .max_concurrent = 4 },
+        .vr_bridge_name = VR_BRIDGE_DEFAULT_NAME,
+        .snapshot_path = SNAPSHOT_DEFAULT_PATH
     };
     
     if (start_api_server(&api_server) != 0) {
@@ -250,9 +1704,32 @@ int main() {
     printf("\nPress Enter to exit...\n");
     getchar();
     
-    // Cleanup
+    // The checkpoint makes the next start a restore
     stop_api_server(&api_server);
-    sqlite3_close(db.db);
-    
+    snapshot_write(registry, db, SNAPSHOT_DEFAULT_PATH, NULL);
     return 0;
+}
+
+// main.c (updated with API and radio interference)
+int main() {
+    // Initialize safety management system and database
+    SafetyManagementSystem sms = {0};
+    FleetRegistry registry;
+    Database db = {0};
+    int status = 1;
+    
+    if (init_database(&db) != SQLITE_OK) {
+        fprintf(stderr, "Failed to initialize database\n");
+    } else if (registry_init(&registry, &sms) != 0) {
+        fprintf(stderr, "Failed to initialize registry\n");
+    } else {
+        status = run_server(&sms, &registry, &db);
+        registry_destroy(&registry);
+    }
+    
+    // Every exit comes through here; close_database also copes with a
+    // handle init_database left half set up
+    close_database(&db);
+    risk_rules_cleanup();
+    return status;
 }
\ No newline at end of file
@@ -1,15 +1,23 @@
 // main.c - Example usage
 #include "safer.h"
 #include "database.h"
+#include "registry.h"
 
 int main() {
     // Initialize safety management system
     SafetyManagementSystem sms = {0};
+    FleetRegistry registry;
     Database db = {0};
     
+    if (registry_init(&registry, &sms) != 0) {
+        fprintf(stderr, "Failed to initialize registry\n");
+        return 1;
+    }
+    
     // Initialize database
     if (init_database(&db) != SQLITE_OK) {
         fprintf(stderr, "Failed to initialize database\n");
+        registry_destroy(&registry);
         return 1;
     }
     
@@ -69,14 +77,35 @@ int main() {
         }
     };
     
+    // Register entities so lookups and reports see them
+    Aircraft *registered_aircraft = registry_add_aircraft(&registry, &aircraft);
+    crew[0] = registry_add_crew_member(&registry, &pilot);
+    crew[1] = registry_add_crew_member(&registry, &copilot);
+    mission.aircraft = registered_aircraft;
+    Mission *registered_mission = NULL;
+    if (registered_aircraft != NULL && crew[0] != NULL && crew[1] != NULL) {
+        registered_mission = registry_add_mission(&registry, &mission);
+    }
+    if (registered_mission == NULL) {
+        fprintf(stderr, "Failed to register fleet entities\n");
+        registry_destroy(&registry);
+        close_database(&db);
+        return 1;
+    }
+    
     // Perform risk assessment
-    perform_risk_assessment(&mission);
+    perform_risk_assessment(registered_mission);
     
     // Save to database
-    save_aircraft(&db, &aircraft);
-    save_crew_member(&db, &pilot);
-    save_crew_member(&db, &copilot);
-    save_mission(&db, &mission);
+    if (save_aircraft(&db, &aircraft) != SQLITE_OK ||
+        save_crew_member(&db, &pilot) != SQLITE_OK ||
+        save_crew_member(&db, &copilot) != SQLITE_OK ||
+        save_mission(&db, registered_mission) != SQLITE_OK) {
+        fprintf(stderr, "Failed to save fleet data\n");
+        registry_destroy(&registry);
+        close_database(&db);
+        return 1;
+    }
     
     // Generate safety report
     time_t start_date = time(NULL) - 30 * 24 * 3600; // 30 days ago
@@ -84,7 +113,8 @@ int main() {
     generate_safety_report(&sms, start_date, end_date);
     
     // Cleanup
-    sqlite3_close(db.db);
+    registry_destroy(&registry);
+    close_database(&db);
     
     return 0;
 }
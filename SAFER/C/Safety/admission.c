@@ -0,0 +1,282 @@
+// admission.c - CoDel-managed job queues, one worker pool per class
+#define _POSIX_C_SOURCE 200809L
+#include "admission.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEFAULT_QUEUE_CAPACITY 1024
+#define DEFAULT_TARGET_DELAY_MS 10
+#define DEFAULT_INTERVAL_MS 100
+
+typedef struct {
+    AdmissionClassConfig config;
+    uint64_t target_ns, interval_ns;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    AdmissionJob *head, *tail;
+    pthread_t *threads;
+    int num_threads;
+    int stopping;
+
+    // CoDel state
+    uint64_t first_above_ns;    // When the delay may count as persistently high, 0 while below target
+    uint64_t drop_next_ns;
+    uint32_t drop_count;
+    int dropping;               // Read without the lock by admission_shedding
+
+    AdmissionClassStats stats;
+} AdmissionClass;
+
+struct AdmissionController {
+    AdmissionClass classes[ADMISSION_MAX_CLASSES];
+    int num_classes;
+};
+
+static void set_dropping(AdmissionClass *cls, int dropping) {
+    __atomic_store_n(&cls->dropping, dropping, __ATOMIC_RELAXED);
+}
+
+static AdmissionJob *pop(AdmissionClass *cls) {
+    AdmissionJob *job = cls->head;
+    if (job != NULL) {
+        cls->head = job->next;
+        if (cls->head == NULL) {
+            cls->tail = NULL;
+        }
+        cls->stats.queued--;
+    }
+    return job;
+}
+
+// Record job's queue delay; true once delay has stayed above target for an interval
+static int above_target(AdmissionClass *cls, const AdmissionJob *job, uint64_t now) {
+    uint64_t delay = now - job->enqueued_ns;
+    metric_snapshot_observe_ns(&cls->stats.queue_delay, delay);
+    if (delay < cls->target_ns) {
+        cls->first_above_ns = 0;
+        return 0;
+    }
+    if (cls->first_above_ns == 0) {
+        cls->first_above_ns = now + cls->interval_ns;
+        return 0;
+    }
+    return now >= cls->first_above_ns;
+}
+
+// Drops come closer together the longer delay stays high
+static uint64_t control_law(const AdmissionClass *cls, uint64_t t) {
+    return t + (uint64_t)(cls->interval_ns / sqrt(cls->drop_count));
+}
+
+static void shed_later(AdmissionClass *cls, AdmissionJob *job, AdmissionJob **shed) {
+    job->next = *shed;
+    *shed = job;
+    cls->stats.shed++;
+}
+
+// Next job to run, with the jobs CoDel drops on the way added to shed
+static AdmissionJob *dequeue(AdmissionClass *cls, uint64_t now, AdmissionJob **shed) {
+    AdmissionJob *job = pop(cls);
+    if (job == NULL) {
+        return NULL;
+    }
+    int drop = above_target(cls, job, now);
+    if (cls->dropping) {
+        if (!drop) {
+            set_dropping(cls, 0);
+        }
+        while (cls->dropping && now >= cls->drop_next_ns) {
+            shed_later(cls, job, shed);
+            cls->drop_count++;
+            job = pop(cls);
+            if (job == NULL || !above_target(cls, job, now)) {
+                set_dropping(cls, 0);
+            } else {
+                cls->drop_next_ns = control_law(cls, cls->drop_next_ns);
+            }
+        }
+    } else if (drop) {
+        shed_later(cls, job, shed);
+        job = pop(cls);
+        if (job != NULL) {
+            above_target(cls, job, now);
+        }
+        set_dropping(cls, 1);
+        // Resume near the previous drop rate if shedding stopped only briefly
+        int recent = (int64_t)(now - cls->drop_next_ns) < (int64_t)(16 * cls->interval_ns);
+        cls->drop_count = recent && cls->drop_count > 2 ? cls->drop_count - 2 : 1;
+        cls->drop_next_ns = control_law(cls, now);
+    }
+    return job;
+}
+
+static void shed_all(AdmissionJob *job) {
+    while (job != NULL) {
+        AdmissionJob *next = job->next;
+        job->shed(job);
+        job = next;
+    }
+}
+
+static void *worker_thread(void *arg) {
+    AdmissionClass *cls = arg;
+    pthread_mutex_lock(&cls->lock);
+    for (;;) {
+        while (cls->head == NULL && !cls->stopping) {
+            // An idle class has no standing queue
+            cls->first_above_ns = 0;
+            set_dropping(cls, 0);
+            pthread_cond_wait(&cls->work_ready, &cls->lock);
+        }
+        if (cls->head == NULL) {
+            break;
+        }
+        AdmissionJob *shed = NULL;
+        AdmissionJob *job = dequeue(cls, metrics_now_ns(), &shed);
+        if (job != NULL) {
+            cls->stats.busy++;
+        }
+        pthread_mutex_unlock(&cls->lock);
+
+        shed_all(shed);
+        if (job != NULL) {
+            job->run(job);
+        }
+
+        pthread_mutex_lock(&cls->lock);
+        if (job != NULL) {
+            cls->stats.busy--;
+            cls->stats.completed++;
+        }
+    }
+    pthread_mutex_unlock(&cls->lock);
+    return NULL;
+}
+
+static void stop_class(AdmissionClass *cls) {
+    pthread_mutex_lock(&cls->lock);
+    cls->stopping = 1;
+    AdmissionJob *shed = NULL, *job;
+    while ((job = pop(cls)) != NULL) {
+        shed_later(cls, job, &shed);
+    }
+    pthread_cond_broadcast(&cls->work_ready);
+    pthread_mutex_unlock(&cls->lock);
+
+    shed_all(shed);
+    for (int i = 0; i < cls->num_threads; i++) {
+        pthread_join(cls->threads[i], NULL);
+    }
+    cls->num_threads = 0;
+}
+
+AdmissionController *admission_create(const AdmissionClassConfig *classes, int num_classes) {
+    if (num_classes < 1 || num_classes > ADMISSION_MAX_CLASSES) {
+        return NULL;
+    }
+    AdmissionController *controller = calloc(1, sizeof(AdmissionController));
+    if (controller == NULL) {
+        return NULL;
+    }
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int c = 0; c < num_classes; c++) {
+        AdmissionClass *cls = &controller->classes[c];
+        cls->config = classes != NULL ? classes[c] : (AdmissionClassConfig){0};
+        if (cls->config.workers <= 0) cls->config.workers = cpus > 0 ? (int)cpus : 1;
+        if (cls->config.queue_capacity <= 0) cls->config.queue_capacity = DEFAULT_QUEUE_CAPACITY;
+        if (cls->config.target_delay_ms <= 0) cls->config.target_delay_ms = DEFAULT_TARGET_DELAY_MS;
+        if (cls->config.interval_ms <= 0) cls->config.interval_ms = DEFAULT_INTERVAL_MS;
+        cls->target_ns = (uint64_t)cls->config.target_delay_ms * 1000000;
+        cls->interval_ns = (uint64_t)cls->config.interval_ms * 1000000;
+        pthread_mutex_init(&cls->lock, NULL);
+        pthread_cond_init(&cls->work_ready, NULL);
+        controller->num_classes = c + 1;
+
+        cls->threads = malloc(sizeof(pthread_t) * cls->config.workers);
+        if (cls->threads == NULL) {
+            admission_destroy(controller);
+            return NULL;
+        }
+        for (int i = 0; i < cls->config.workers; i++) {
+            if (pthread_create(&cls->threads[i], NULL, worker_thread, cls) != 0) {
+                fprintf(stderr, "Failed to start admission worker\n");
+                admission_destroy(controller);
+                return NULL;
+            }
+            cls->num_threads++;
+        }
+    }
+    return controller;
+}
+
+int admission_submit(AdmissionController *controller, int class_index, AdmissionJob *job) {
+    AdmissionClass *cls = &controller->classes[class_index];
+    uint64_t now = metrics_now_ns();
+    pthread_mutex_lock(&cls->lock);
+    // While shedding, refuse up front anything that would queue behind a
+    // job already past the target instead of queueing it only to drop it
+    if (cls->stopping ||
+        (cls->dropping && cls->head != NULL && now - cls->head->enqueued_ns >= cls->target_ns)) {
+        cls->stats.refused_delay++;
+        pthread_mutex_unlock(&cls->lock);
+        return -1;
+    }
+    if (cls->stats.queued >= cls->config.queue_capacity) {
+        cls->stats.refused_full++;
+        pthread_mutex_unlock(&cls->lock);
+        return -1;
+    }
+    job->enqueued_ns = now;
+    job->next = NULL;
+    if (cls->tail != NULL) {
+        cls->tail->next = job;
+    } else {
+        cls->head = job;
+    }
+    cls->tail = job;
+    cls->stats.queued++;
+    cls->stats.admitted++;
+    pthread_cond_signal(&cls->work_ready);
+    pthread_mutex_unlock(&cls->lock);
+    return 0;
+}
+
+int admission_shedding(AdmissionController *controller, int class_index) {
+    return controller != NULL &&
+           __atomic_load_n(&controller->classes[class_index].dropping, __ATOMIC_RELAXED);
+}
+
+void admission_shutdown(AdmissionController *controller) {
+    if (controller == NULL) {
+        return;
+    }
+    for (int c = 0; c < controller->num_classes; c++) {
+        stop_class(&controller->classes[c]);
+    }
+}
+
+void admission_destroy(AdmissionController *controller) {
+    if (controller == NULL) {
+        return;
+    }
+    admission_shutdown(controller);
+    for (int c = 0; c < controller->num_classes; c++) {
+        AdmissionClass *cls = &controller->classes[c];
+        pthread_mutex_destroy(&cls->lock);
+        pthread_cond_destroy(&cls->work_ready);
+        free(cls->threads);
+    }
+    free(controller);
+}
+
+void admission_stats(AdmissionController *controller, int class_index, AdmissionClassStats *stats) {
+    AdmissionClass *cls = &controller->classes[class_index];
+    pthread_mutex_lock(&cls->lock);
+    *stats = cls->stats;
+    stats->shedding = cls->dropping;
+    pthread_mutex_unlock(&cls->lock);
+}
@@ -0,0 +1,62 @@
+// admission.h - Per-class work queues with delay-based load shedding
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include "metrics.h"
+#include <stdint.h>
+
+#define ADMISSION_MAX_CLASSES 8
+
+// Caller-owned unit of work; embed it in the request state
+typedef struct AdmissionJob {
+    void (*run)(struct AdmissionJob *job);   // On a worker of the job's class
+    void (*shed)(struct AdmissionJob *job);  // Instead of run, when dropped from the queue or at shutdown
+    uint64_t enqueued_ns;
+    struct AdmissionJob *next;
+} AdmissionJob;
+
+// Zero fields take the defaults noted
+typedef struct {
+    int workers;            // Threads serving the class (default: online CPUs)
+    int queue_capacity;     // Waiting jobs beyond which submissions are refused (default 1024)
+    int target_delay_ms;    // Queue delay the class should stay under (default 10)
+    int interval_ms;        // How long delay may exceed the target before shedding starts (default 100)
+} AdmissionClassConfig;
+
+typedef struct {
+    uint64_t admitted;
+    uint64_t completed;
+    uint64_t refused_full;  // Submissions refused with the queue at capacity
+    uint64_t refused_delay; // Submissions refused while the class was shedding
+    uint64_t shed;          // Queued jobs dropped instead of run
+    int queued;
+    int busy;               // Workers running a job
+    int shedding;
+    MetricHistogramSnapshot queue_delay;
+} AdmissionClassStats;
+
+typedef struct AdmissionController AdmissionController;
+
+// Each class gets its own queue and workers, so a backlog in one never
+// delays another. Overload is judged CoDel style on queue delay rather than
+// length: once every job leaving a queue has waited longer than the target
+// for a whole interval, the class starts shedding. It then drops jobs that
+// waited too long, at a rate that rises until the delay is back under the
+// target, and refuses new submissions outright. Returns NULL on failure.
+AdmissionController *admission_create(const AdmissionClassConfig *classes, int num_classes);
+
+// Queue job on class. Returns 0 once queued; -1 when the queue is full or
+// the class is shedding, in which case neither callback is made.
+int admission_submit(AdmissionController *controller, int class_index, AdmissionJob *job);
+
+// Whether the class is currently shedding; lets callers refuse related work
+// before they commit to it. Safe with a NULL controller.
+int admission_shedding(AdmissionController *controller, int class_index);
+
+// Shed everything still queued, then stop and join the workers
+void admission_shutdown(AdmissionController *controller);
+void admission_destroy(AdmissionController *controller);
+
+void admission_stats(AdmissionController *controller, int class_index, AdmissionClassStats *stats);
+
+#endif // ADMISSION_H
@@ -5,12 +5,69 @@
 #include <microhttpd.h>
 #include <json-c/json.h>
 #include "safer.h"
+#include "database.h"
+#include "risk_events.h"
+#include "radio_cache.h"
+#include "admission.h"
+#include "vr_ingest.h"
 
-// API server configuration
+// How microhttpd serves connections. A thread per connection cannot
+// suspend connections, so in that mode radio analyses run inline rather
+// than on admission workers and event streams block their own thread.
+typedef enum {
+    API_MODE_THREAD_POOL,           // epoll where available, one polling thread per pool slot (default)
+    API_MODE_THREAD_PER_CONNECTION, // A thread per connection, for long blocking handlers
+    API_MODE_SINGLE_THREAD          // One internal select() thread
+} APIServerMode;
+
+// In-flight cap for one endpoint; requests over it get 503 with Retry-After
+typedef struct {
+    int max_concurrent;             // 0 for unlimited
+    int in_flight;                  // Updated atomically
+    unsigned long rejected;
+} EndpointLimit;
+
+// API server configuration; zero fields take the defaults noted
 typedef struct {
     int port;
     SafetyManagementSystem *sms;
     Database *db;
+
+    APIServerMode mode;
+    unsigned int thread_pool_size;  // API_MODE_THREAD_POOL (default: online CPUs)
+    unsigned int connection_limit;  // Concurrent connections (default: microhttpd's)
+    unsigned int request_timeout_s; // Idle connection timeout (default 30)
+    size_t max_body_bytes;          // Larger uploads get 413 (default 64 MiB)
+    EndpointLimit mission_limit;
+    EndpointLimit radio_limit;
+    EndpointLimit batch_limit;
+    int batch_threads;              // Workers per /api/missions/batch request (default: online CPUs)
+    int risk_event_history;         // Events replayable by reconnecting subscribers (default 1024)
+    int radio_cache_entries;        // Cached /api/radio-analysis results (default 4096, -1 disables)
+    // Radio analyses run on admission workers rather than connection threads,
+    // which are left to mission checks. Requests of at least bulk_body_bytes
+    // (default 256 KiB) are bulk. Radio defaults: online CPUs, 10 ms target;
+    // bulk: a quarter of the CPUs, 100 ms target, 500 ms interval. Setting
+    // radio_admission.workers to -1 analyses inline instead.
+    AdmissionClassConfig radio_admission;
+    AdmissionClassConfig bulk_admission;
+    size_t bulk_body_bytes;
+    // Shared-memory ring the VR trainer publishes to; passed trainings
+    // update crew records and mission risk (NULL: not consumed)
+    const char *vr_bridge_name;
+    // Risk rule file installed at start (NULL: built-in rules); replaced
+    // at run time through POST /api/risk-rules
+    const char *risk_rules_path;
+    // Registry checkpoint written by POST /api/snapshot (NULL: disabled)
+    const char *snapshot_path;
+
+    struct MHD_Daemon *daemon;
+    RiskEventHub *risk_events;      // Risk level transitions for /api/risk-events
+    RadioCache *radio_cache;
+    struct APIMetrics *metrics;     // Served in Prometheus text format at /metrics
+    AdmissionController *admission;
+    VRIngest *vr_ingest;
+    int snapshot_running;           // Updated atomically
 } APIServer;
 
 // Function declarations
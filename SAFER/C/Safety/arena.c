@@ -0,0 +1,171 @@
+// arena.c - Block arena allocator implementation
+#include "arena.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ArenaBlock {
+    ArenaBlock *next;
+    size_t size;
+    size_t used;
+    // Payload follows, aligned to max_align_t
+};
+
+#define BLOCK_HEADER_SIZE \
+    ((sizeof(ArenaBlock) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
+static unsigned char *block_data(ArenaBlock *block) {
+    return (unsigned char *)block + BLOCK_HEADER_SIZE;
+}
+
+static ArenaBlock *new_block(size_t size) {
+    ArenaBlock *block = malloc(BLOCK_HEADER_SIZE + size);
+    if (block == NULL) {
+        return NULL;
+    }
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+void arena_init(Arena *arena, size_t block_size) {
+    arena->head = NULL;
+    arena->block_size = block_size > 0 ? block_size : ARENA_DEFAULT_BLOCK_SIZE;
+    arena->bytes_used = 0;
+    arena->bytes_reserved = 0;
+}
+
+void *arena_alloc(Arena *arena, size_t size, size_t align) {
+    if (align == 0) {
+        align = _Alignof(max_align_t);
+    }
+
+    ArenaBlock *block = arena->head;
+    if (block != NULL) {
+        uintptr_t base = (uintptr_t)block_data(block);
+        size_t offset = ((base + block->used + align - 1) & ~(uintptr_t)(align - 1)) - base;
+        if (offset + size <= block->size) {
+            block->used = offset + size;
+            arena->bytes_used += size;
+            return block_data(block) + offset;
+        }
+    }
+
+    // Oversized requests get a dedicated block placed behind the current
+    // head so the partially used head block keeps serving small requests.
+    size_t needed = size + align;
+    if (needed > arena->block_size / 4 && block != NULL) {
+        ArenaBlock *big = new_block(needed);
+        if (big == NULL) {
+            return NULL;
+        }
+        big->next = block->next;
+        block->next = big;
+        arena->bytes_reserved += needed;
+
+        uintptr_t base = (uintptr_t)block_data(big);
+        size_t offset = ((base + align - 1) & ~(uintptr_t)(align - 1)) - base;
+        big->used = offset + size;
+        arena->bytes_used += size;
+        return block_data(big) + offset;
+    }
+
+    size_t block_size = needed > arena->block_size ? needed : arena->block_size;
+    block = new_block(block_size);
+    if (block == NULL) {
+        return NULL;
+    }
+    block->next = arena->head;
+    arena->head = block;
+    arena->bytes_reserved += block_size;
+
+    uintptr_t base = (uintptr_t)block_data(block);
+    size_t offset = ((base + align - 1) & ~(uintptr_t)(align - 1)) - base;
+    block->used = offset + size;
+    arena->bytes_used += size;
+    return block_data(block) + offset;
+}
+
+void *arena_calloc(Arena *arena, size_t count, size_t size, size_t align) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        return NULL;
+    }
+    void *ptr = arena_alloc(arena, count * size, align);
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+char *arena_strdup(Arena *arena, const char *str) {
+    size_t len = strlen(str) + 1;
+    char *copy = arena_alloc(arena, len, 1);
+    if (copy != NULL) {
+        memcpy(copy, str, len);
+    }
+    return copy;
+}
+
+void arena_reset(Arena *arena) {
+    // Keep the most recent block around for reuse, release the rest
+    ArenaBlock *block = arena->head;
+    if (block == NULL) {
+        return;
+    }
+    ArenaBlock *next = block->next;
+    while (next != NULL) {
+        ArenaBlock *tmp = next->next;
+        free(next);
+        next = tmp;
+    }
+    block->next = NULL;
+    block->used = 0;
+    arena->bytes_used = 0;
+    arena->bytes_reserved = block->size;
+}
+
+ArenaMark arena_mark(const Arena *arena) {
+    ArenaMark mark = {arena->head, NULL, 0, arena->bytes_used, arena->bytes_reserved};
+    if (arena->head != NULL) {
+        mark.head_next = arena->head->next;
+        mark.head_used = arena->head->used;
+    }
+    return mark;
+}
+
+void arena_rewind(Arena *arena, ArenaMark mark) {
+    // Blocks started since the mark sit in front of its head; oversized
+    // blocks taken while it was still the head sit right behind it
+    ArenaBlock *block = arena->head;
+    while (block != mark.head) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    if (mark.head != NULL) {
+        block = mark.head->next;
+        while (block != mark.head_next) {
+            ArenaBlock *next = block->next;
+            free(block);
+            block = next;
+        }
+        mark.head->next = mark.head_next;
+        mark.head->used = mark.head_used;
+    }
+    arena->head = mark.head;
+    arena->bytes_used = mark.bytes_used;
+    arena->bytes_reserved = mark.bytes_reserved;
+}
+
+void arena_destroy(Arena *arena) {
+    ArenaBlock *block = arena->head;
+    while (block != NULL) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+    arena->bytes_used = 0;
+    arena->bytes_reserved = 0;
+}
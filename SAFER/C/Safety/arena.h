@@ -0,0 +1,42 @@
+// arena.h - Block arena allocator for bulk-loaded fleet data
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_DEFAULT_BLOCK_SIZE (1 << 20) // 1 MiB
+
+typedef struct ArenaBlock ArenaBlock;
+
+// Bump allocator over a chain of large blocks. Individual allocations are
+// never freed; everything is released at once by arena_reset/arena_destroy.
+typedef struct {
+    ArenaBlock *head;
+    size_t block_size;
+    size_t bytes_used;     // Payload bytes handed out
+    size_t bytes_reserved; // Bytes obtained from malloc
+} Arena;
+
+// Position to roll back to with arena_rewind
+typedef struct {
+    ArenaBlock *head;
+    ArenaBlock *head_next;
+    size_t head_used;
+    size_t bytes_used;
+    size_t bytes_reserved;
+} ArenaMark;
+
+void arena_init(Arena *arena, size_t block_size);
+void *arena_alloc(Arena *arena, size_t size, size_t align);
+void *arena_calloc(Arena *arena, size_t count, size_t size, size_t align);
+char *arena_strdup(Arena *arena, const char *str);
+void arena_reset(Arena *arena);
+
+// Release everything allocated since mark, for undoing a multi-part
+// insert that failed part way. Marks taken after it become invalid, and
+// an arena_reset in between invalidates it.
+ArenaMark arena_mark(const Arena *arena);
+void arena_rewind(Arena *arena, ArenaMark mark);
+void arena_destroy(Arena *arena);
+
+#endif // ARENA_H
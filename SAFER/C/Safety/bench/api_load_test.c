@@ -0,0 +1,236 @@
+// api_load_test.c - Closed-loop HTTP load generator for the SAFER API
+//
+// Each client thread keeps one HTTP/1.1 keep-alive connection and sends
+// the next request as soon as the previous response is read, so
+// requests/sec at increasing client counts shows how the server scales
+// with cores. Run the server pinned to N cores (taskset -c 0-N) and
+// compare the tables.
+//
+// Build from this directory:
+//   gcc -O2 api_load_test.c -lpthread -o api_load_test
+// Usage:
+//   api_load_test [host] [port] [seconds] [sources_per_request] [clients...]
+//   api_load_test 127.0.0.1 8080 5 100 1 2 4 8 16 32
+#define _POSIX_C_SOURCE 200809L
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_CLIENTS 1024
+#define MAX_LATENCIES 1000000
+#define RESPONSE_BUFFER 65536
+
+typedef struct {
+    const char *host;
+    int port;
+    const char *request;
+    size_t request_length;
+    double deadline;
+
+    double *latencies_ms;   // Per client, up to MAX_LATENCIES / clients
+    int max_latencies;
+    int completed;
+    int failed;
+    int overloaded;         // 503 responses
+} Client;
+
+static double now_s(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static int connect_to(const char *host, int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(port)};
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1 ||
+        connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+static int send_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            return -1;
+        }
+        data += n;
+        length -= n;
+    }
+    return 0;
+}
+
+// Read one response; returns the status code, or -1 when the connection failed
+static int read_response(int fd, char *buffer) {
+    size_t used = 0;
+    char *body = NULL;
+    while (body == NULL) {
+        if (used == RESPONSE_BUFFER - 1) return -1;
+        ssize_t n = recv(fd, buffer + used, RESPONSE_BUFFER - 1 - used, 0);
+        if (n <= 0) return -1;
+        used += n;
+        buffer[used] = '\0';
+        body = strstr(buffer, "\r\n\r\n");
+    }
+    body += 4;
+
+    int status = 0;
+    if (sscanf(buffer, "HTTP/1.%*d %d", &status) != 1) return -1;
+    const char *length_header = strstr(buffer, "Content-Length:");
+    if (length_header == NULL) length_header = strstr(buffer, "content-length:");
+    size_t content_length = length_header != NULL ? strtoul(length_header + 15, NULL, 10) : 0;
+
+    // Drain the rest of the body
+    size_t have = used - (body - buffer);
+    while (have < content_length) {
+        ssize_t n = recv(fd, buffer, RESPONSE_BUFFER - 1 < content_length - have ? RESPONSE_BUFFER - 1
+                                                                                : content_length - have, 0);
+        if (n <= 0) return -1;
+        have += n;
+    }
+    return status;
+}
+
+static void *client_thread(void *arg) {
+    Client *client = arg;
+    char *buffer = malloc(RESPONSE_BUFFER);
+    int fd = -1;
+    while (buffer != NULL && now_s() < client->deadline) {
+        if (fd < 0 && (fd = connect_to(client->host, client->port)) < 0) {
+            client->failed++;
+            nanosleep(&(struct timespec){.tv_nsec = 1000000}, NULL);
+            continue;
+        }
+        double start = now_s();
+        int status = send_all(fd, client->request, client->request_length) == 0 ? read_response(fd, buffer) : -1;
+        if (status < 0) {
+            client->failed++;
+            close(fd);
+            fd = -1;
+            continue;
+        }
+        if (status == 503) {
+            client->overloaded++;
+        } else if (status != 200) {
+            client->failed++;
+        } else {
+            if (client->completed < client->max_latencies) {
+                client->latencies_ms[client->completed] = (now_s() - start) * 1000;
+            }
+            client->completed++;
+        }
+    }
+    if (fd >= 0) close(fd);
+    free(buffer);
+    return NULL;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static char *build_request(const char *host, int port, int sources, size_t *length) {
+    size_t body_capacity = 128 + (size_t)sources * 96;
+    char *body = malloc(body_capacity);
+    if (body == NULL) return NULL;
+    size_t used = snprintf(body, body_capacity, "{\"background_noise\":-100,\"sources\":[");
+    for (int i = 0; i < sources; i++) {
+        used += snprintf(body + used, body_capacity - used,
+                         "%s{\"frequency\":%.1f,\"power\":%.1f,\"distance\":%.2f,\"terrain_factor\":%.1f}",
+                         i ? "," : "", 225.0 + (i % 700) * 0.25, 10.0 + i % 30, 1.0 + (i % 50) * 0.5, (i % 5) * 0.5);
+    }
+    used += snprintf(body + used, body_capacity - used, "]}");
+
+    size_t request_capacity = used + 256;
+    char *request = malloc(request_capacity);
+    if (request != NULL) {
+        *length = snprintf(request, request_capacity,
+                           "POST /api/radio-analysis HTTP/1.1\r\n"
+                           "Host: %s:%d\r\n"
+                           "Content-Type: application/json\r\n"
+                           "Content-Length: %zu\r\n"
+                           "\r\n%s", host, port, used, body);
+    }
+    free(body);
+    return request;
+}
+
+int main(int argc, char **argv) {
+    const char *host = argc > 1 ? argv[1] : "127.0.0.1";
+    int port = argc > 2 ? atoi(argv[2]) : 8080;
+    double seconds = argc > 3 ? atof(argv[3]) : 5;
+    int sources = argc > 4 ? atoi(argv[4]) : 100;
+    int default_clients[] = {1, 2, 4, 8, 16, 32};
+    int num_runs = argc > 5 ? argc - 5 : (int)(sizeof(default_clients) / sizeof(default_clients[0]));
+
+    size_t request_length;
+    char *request = build_request(host, port, sources, &request_length);
+    double *latencies = malloc(sizeof(double) * MAX_LATENCIES);
+    if (request == NULL || latencies == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    printf("POST /api/radio-analysis, %d sources, %zu byte requests, %.0f s per run\n",
+           sources, request_length, seconds);
+    printf("%8s %12s %10s %10s %10s %8s %8s\n", "clients", "requests/s", "p50 ms", "p99 ms", "max ms", "503", "errors");
+    for (int run = 0; run < num_runs; run++) {
+        int clients = argc > 5 ? atoi(argv[5 + run]) : default_clients[run];
+        if (clients < 1 || clients > MAX_CLIENTS) continue;
+
+        Client pool[MAX_CLIENTS];
+        pthread_t threads[MAX_CLIENTS];
+        double start = now_s();
+        for (int i = 0; i < clients; i++) {
+            pool[i] = (Client){
+                .host = host, .port = port, .request = request, .request_length = request_length,
+                .deadline = start + seconds,
+                .latencies_ms = latencies + (size_t)i * (MAX_LATENCIES / clients),
+                .max_latencies = MAX_LATENCIES / clients
+            };
+            pthread_create(&threads[i], NULL, client_thread, &pool[i]);
+        }
+
+        int completed = 0, failed = 0, overloaded = 0, recorded = 0;
+        for (int i = 0; i < clients; i++) {
+            pthread_join(threads[i], NULL);
+            completed += pool[i].completed;
+            failed += pool[i].failed;
+            overloaded += pool[i].overloaded;
+        }
+        double elapsed = now_s() - start;
+
+        // Compact the per-client latency slices before sorting
+        for (int i = 0; i < clients; i++) {
+            int n = pool[i].completed < pool[i].max_latencies ? pool[i].completed : pool[i].max_latencies;
+            memmove(latencies + recorded, pool[i].latencies_ms, sizeof(double) * n);
+            recorded += n;
+        }
+        qsort(latencies, recorded, sizeof(double), compare_double);
+        double p50 = recorded ? latencies[recorded / 2] : 0;
+        double p99 = recorded ? latencies[(int)(recorded * 0.99)] : 0;
+        double max = recorded ? latencies[recorded - 1] : 0;
+        printf("%8d %12.0f %10.2f %10.2f %10.2f %8d %8d\n", clients, completed / elapsed, p50, p99, max,
+               overloaded, failed);
+    }
+
+    free(request);
+    free(latencies);
+    return 0;
+}
@@ -0,0 +1,633 @@
+// fleet_load_test.c - End-to-end load harness over a generated fleet
+//
+// Generates a fleet with fleet_generate and drives it through each stage
+// at every thread count: the risk engine (per mission, then risk_batch),
+// SQLite (write-behind saves, read-pool loads, full hydrate and snapshot
+// checkpoint/restore) and, given the server binary, the HTTP API with
+// closed-loop keep-alive clients as in api_load_test.c. Every stage reports
+// throughput, p50/p99/max latency and resident memory, so a run with a
+// fixed seed is comparable across builds and machines.
+//
+// The server is started in the work directory against the database and
+// snapshot the SQLite stage left there; it listens on 8080 and is stopped
+// by closing its stdin.
+//
+// Build from this directory:
+//   gcc -O2 -I.. fleet_load_test.c ../fleet_gen.c ../safer.c ../registry.c ../arena.c
+//       ../database.c ../persistence.c ../read_pool.c ../hydrate.c ../snapshot.c
+//       ../risk_batch.c ../risk_rules.c ../radio_interference.c ../radio_batch.c ../propagation.c
+//       ../path_loss_table.c ../metrics.c
+//       -lsqlite3 -lpthread -lm -o fleet_load_test
+// Usage:
+//   fleet_load_test [-s seed] [-a aircraft] [-c crew] [-m missions] [-t threads,...]
+//                   [-d seconds] [-w work_dir] [-S server_binary]
+//   fleet_load_test -a 10000 -t 1,2,4,8 -S ../safer_server
+#define _XOPEN_SOURCE 700 // realpath
+#include "fleet_gen.h"
+#include "hydrate.h"
+#include "persistence.h"
+#include "read_pool.h"
+#include "risk_batch.h"
+#include "snapshot.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <limits.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_THREADS 256
+#define MAX_RUNS 16
+#define MAX_LATENCIES 1000000
+#define RESPONSE_BUFFER 65536
+#define REQUEST_BUFFER 65536
+#define BATCH_MISSIONS 32
+#define SERVER_PORT 8080
+
+typedef struct {
+    FleetRegistry *reg;
+    Database *db;
+    int index;
+    int threads;
+    double deadline;            // Timed stages; 0 for one pass over a slice
+    uint64_t rng;
+
+    double *latencies_ms;       // Per thread, up to max_latencies
+    int max_latencies;
+    int completed;
+    int failed;
+    int overloaded;             // 503 responses
+    const char *route;          // HTTP stage: "get", "post" or "batch"
+} Worker;
+
+static double now_s(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static uint64_t next_u64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void record_latency(Worker *worker, double start) {
+    if (worker->completed < worker->max_latencies) {
+        worker->latencies_ms[worker->completed] = (now_s() - start) * 1000;
+    }
+    worker->completed++;
+}
+
+// Resident set now and at its peak, in MB
+static void memory_mb(double *rss, double *peak) {
+    long pages = 0;
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (statm != NULL) {
+        if (fscanf(statm, "%*s %ld", &pages) != 1) pages = 0;
+        fclose(statm);
+    }
+    *rss = pages * (double)sysconf(_SC_PAGESIZE) / (1 << 20);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    *peak = usage.ru_maxrss / 1024.0;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void print_header(const char *title) {
+    printf("\n%s\n%-22s %8s %12s %10s %10s %10s %8s %9s %9s\n", title, "stage", "threads", "ops/s",
+           "p50 ms", "p99 ms", "max ms", "errors", "rss MB", "peak MB");
+}
+
+// Compact the per-thread latency slices, sort and print one row
+static void report(const char *stage, Worker *workers, int threads, double *latencies, double elapsed) {
+    int completed = 0, failed = 0, recorded = 0;
+    for (int i = 0; i < threads; i++) {
+        int n = workers[i].completed < workers[i].max_latencies ? workers[i].completed : workers[i].max_latencies;
+        memmove(latencies + recorded, workers[i].latencies_ms, sizeof(double) * n);
+        recorded += n;
+        completed += workers[i].completed;
+        failed += workers[i].failed + workers[i].overloaded;
+    }
+    qsort(latencies, recorded, sizeof(double), compare_double);
+    double rss, peak;
+    memory_mb(&rss, &peak);
+    printf("%-22s %8d %12.0f %10.4f %10.4f %10.4f %8d %9.1f %9.1f\n", stage, threads,
+           elapsed > 0 ? completed / elapsed : 0, recorded ? latencies[recorded / 2] : 0,
+           recorded ? latencies[(int)(recorded * 0.99)] : 0, recorded ? latencies[recorded - 1] : 0,
+           failed, rss, peak);
+}
+
+// Run fn on threads workers and report them as one row
+static void run_stage(const char *stage, void *(*fn)(void *), const Worker *base, int threads,
+                      double *latencies, double seconds) {
+    Worker workers[MAX_THREADS];
+    pthread_t ids[MAX_THREADS];
+    double start = now_s();
+    for (int i = 0; i < threads; i++) {
+        workers[i] = *base;
+        workers[i].index = i;
+        workers[i].threads = threads;
+        workers[i].deadline = seconds > 0 ? start + seconds : 0;
+        workers[i].rng = base->rng + (uint64_t)i * 0x100000001ULL;
+        workers[i].latencies_ms = latencies + (size_t)i * (MAX_LATENCIES / threads);
+        workers[i].max_latencies = MAX_LATENCIES / threads;
+        pthread_create(&ids[i], NULL, fn, &workers[i]);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    report(stage, workers, threads, latencies, now_s() - start);
+}
+
+// Row for a stage timed as a whole; ops is 0 when it failed
+static void report_once(const char *stage, int threads, int ops, double ms) {
+    double rss, peak;
+    memory_mb(&rss, &peak);
+    printf("%-22s %8d %12.0f %10.4f %10.4f %10.4f %8d %9.1f %9.1f\n", stage, threads,
+           ms > 0 ? ops / (ms / 1000) : 0, ms, ms, ms, ops == 0, rss, peak);
+}
+
+// Risk engine
+
+static void *assess_worker(void *arg) {
+    Worker *worker = arg;
+    SafetyManagementSystem *sms = worker->reg->sms;
+    for (int i = worker->index; i < sms->num_missions; i += worker->threads) {
+        double start = now_s();
+        perform_risk_assessment(sms->missions[i]);
+        record_latency(worker, start);
+    }
+    return NULL;
+}
+
+static void run_risk_stage(FleetRegistry *reg, const int *thread_counts, int runs, double *latencies) {
+    SafetyManagementSystem *sms = reg->sms;
+    print_header("Risk engine");
+    for (int r = 0; r < runs; r++) {
+        Worker base = {.reg = reg};
+        run_stage("perform_risk_assessment", assess_worker, &base, thread_counts[r], latencies, 0);
+    }
+
+    // risk_batch wants the missions contiguous, as the batch route builds them
+    Mission *copy = malloc(sizeof(Mission) * sms->num_missions);
+    MissionRisk *results = malloc(sizeof(MissionRisk) * sms->num_missions);
+    if (copy == NULL || results == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        free(copy);
+        free(results);
+        return;
+    }
+    for (int i = 0; i < sms->num_missions; i++) {
+        copy[i] = *sms->missions[i];
+    }
+    for (int r = 0; r < runs; r++) {
+        double start = now_s();
+        int rc = risk_batch_assess(copy, sms->num_missions, NULL, thread_counts[r], results);
+        report_once("risk_batch_assess", thread_counts[r], rc == 0 ? sms->num_missions : 0,
+                    (now_s() - start) * 1000);
+    }
+    free(copy);
+    free(results);
+}
+
+// SQLite
+
+static void *save_worker(void *arg) {
+    Worker *worker = arg;
+    SafetyManagementSystem *sms = worker->reg->sms;
+    WriteBehind *wb = worker->db->write_behind;
+    for (int i = worker->index; i < sms->num_aircraft; i += worker->threads) {
+        double start = now_s();
+        worker->failed += write_behind_save_aircraft(wb, sms->aircraft_registry[i]) != 0;
+        record_latency(worker, start);
+    }
+    for (int i = worker->index; i < sms->num_crew; i += worker->threads) {
+        double start = now_s();
+        worker->failed += write_behind_save_crew_member(wb, sms->crew_registry[i]) != 0;
+        record_latency(worker, start);
+    }
+    for (int i = worker->index; i < sms->num_missions; i += worker->threads) {
+        double start = now_s();
+        worker->failed += write_behind_save_mission(wb, sms->missions[i]) != 0;
+        record_latency(worker, start);
+    }
+    return NULL;
+}
+
+static void *load_worker(void *arg) {
+    Worker *worker = arg;
+    int num_missions = worker->reg->sms->num_missions;
+    while (now_s() < worker->deadline) {
+        char id[16];
+        snprintf(id, sizeof(id), "M%07d", (int)(next_u64(&worker->rng) % num_missions));
+        double start = now_s();
+        Mission *mission = load_mission(worker->db, id);
+        if (mission == NULL) {
+            worker->failed++;
+            continue;
+        }
+        record_latency(worker, start);
+        free_mission(mission);
+    }
+    return NULL;
+}
+
+static int run_sqlite_stage(FleetRegistry *reg, Database *db, const char *snapshot_path,
+                            const int *thread_counts, int runs, double seconds, double *latencies) {
+    SafetyManagementSystem *sms = reg->sms;
+    int entities = sms->num_aircraft + sms->num_crew + sms->num_missions;
+    print_header("SQLite (save rows are enqueue latency; flush is the commit of everything queued)");
+
+    // Each run rewrites every row, so later runs measure upserts
+    for (int r = 0; r < runs; r++) {
+        if (write_behind_start(db, NULL) != 0) {
+            fprintf(stderr, "Failed to start write-behind queue\n");
+            return -1;
+        }
+        double start = now_s();
+        Worker base = {.reg = reg, .db = db};
+        run_stage("write_behind_save", save_worker, &base, thread_counts[r], latencies, 0);
+        double flush_start = now_s();
+        write_behind_flush(db->write_behind);
+        double end = now_s();
+        WriteBehindStats wb_stats;
+        write_behind_stats(db->write_behind, &wb_stats);
+        write_behind_stop(db->write_behind);
+        printf("%-22s %8d %12.0f %10.1f %10s %10s %8llu   (%llu batches, flush %.1f ms)\n", "  end to end",
+               thread_counts[r], entities / (end - start), (end - start) * 1000, "", "",
+               (unsigned long long)wb_stats.failed, (unsigned long long)wb_stats.batches,
+               (end - flush_start) * 1000);
+    }
+
+    int max_threads = 0;
+    for (int r = 0; r < runs; r++) {
+        max_threads = thread_counts[r] > max_threads ? thread_counts[r] : max_threads;
+    }
+    if (read_pool_open(db, max_threads) != 0) {
+        fprintf(stderr, "Failed to open read pool\n");
+        return -1;
+    }
+    for (int r = 0; r < runs; r++) {
+        Worker base = {.reg = reg, .db = db, .rng = 42};
+        run_stage("load_mission", load_worker, &base, thread_counts[r], latencies, seconds);
+    }
+
+    FleetRegistry loaded;
+    HydrateStats hydrate_stats;
+    registry_init(&loaded, NULL);
+    int rc = hydrate_registry(db, &loaded, &hydrate_stats);
+    report_once("hydrate_registry", 1, rc == SQLITE_OK ? entities : 0, hydrate_stats.total_ms);
+    printf("%-22s %8s %12s   registry %.1f MB\n", "", "", "", registry_memory_usage(&loaded) / 1048576.0);
+    registry_destroy(&loaded);
+
+    // Left in place for the server to restore from
+    SnapshotStats snapshot_stats;
+    rc = snapshot_write(reg, db, snapshot_path, &snapshot_stats);
+    report_once("snapshot_write", 1, rc == 0 ? entities : 0, snapshot_stats.total_ms);
+    printf("%-22s %8s %12s   file %.1f MB\n", "", "", "", snapshot_stats.file_bytes / 1048576.0);
+    registry_init(&loaded, NULL);
+    rc = snapshot_restore(&loaded, db, snapshot_path, &snapshot_stats);
+    report_once("snapshot_restore", 1, rc == 0 ? entities : 0, snapshot_stats.total_ms);
+    registry_destroy(&loaded);
+    return 0;
+}
+
+// HTTP
+
+static int connect_to(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(port)};
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+static int send_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            return -1;
+        }
+        data += n;
+        length -= n;
+    }
+    return 0;
+}
+
+// Read one response; returns the status code, or -1 when the connection failed
+static int read_response(int fd, char *buffer) {
+    size_t used = 0;
+    char *body = NULL;
+    while (body == NULL) {
+        if (used == RESPONSE_BUFFER - 1) return -1;
+        ssize_t n = recv(fd, buffer + used, RESPONSE_BUFFER - 1 - used, 0);
+        if (n <= 0) return -1;
+        used += n;
+        buffer[used] = '\0';
+        body = strstr(buffer, "\r\n\r\n");
+    }
+    body += 4;
+
+    int status = 0;
+    if (sscanf(buffer, "HTTP/1.%*d %d", &status) != 1) return -1;
+    const char *length_header = strstr(buffer, "Content-Length:");
+    if (length_header == NULL) length_header = strstr(buffer, "content-length:");
+    size_t content_length = length_header != NULL ? strtoul(length_header + 15, NULL, 10) : 0;
+
+    size_t have = used - (body - buffer);
+    while (have < content_length) {
+        ssize_t n = recv(fd, buffer, RESPONSE_BUFFER - 1 < content_length - have ? RESPONSE_BUFFER - 1
+                                                                                : content_length - have, 0);
+        if (n <= 0) return -1;
+        have += n;
+    }
+    return status;
+}
+
+// Mission as the API takes it, written at out; returns its length
+static size_t write_mission_json(char *out, size_t capacity, const Mission *mission) {
+    size_t used = snprintf(out, capacity,
+                           "{\"id\":\"%s\",\"mission_type\":\"%s\",\"aircraft_id\":\"%s\","
+                           "\"weather\":{\"temperature\":%.1f,\"visibility\":%.0f,\"wind_speed\":%.1f,"
+                           "\"precipitation\":%.1f},\"crew\":[",
+                           mission->id, mission->mission_type, mission->aircraft ? mission->aircraft->id : "",
+                           mission->weather.temperature, mission->weather.visibility,
+                           mission->weather.wind_speed, mission->weather.precipitation);
+    for (int i = 0; i < mission->crew_size && used < capacity; i++) {
+        used += snprintf(out + used, capacity - used, "%s\"%s\"", i ? "," : "", mission->crew[i]->id);
+    }
+    if (used < capacity) {
+        used += snprintf(out + used, capacity - used, "]}");
+    }
+    return used < capacity ? used : capacity;
+}
+
+// Next request for the worker's route, over a random mission of the fleet
+static size_t build_request(Worker *worker, char *request, char *body) {
+    SafetyManagementSystem *sms = worker->reg->sms;
+    int first = (int)(next_u64(&worker->rng) % sms->num_missions);
+    if (strcmp(worker->route, "get") == 0) {
+        return snprintf(request, REQUEST_BUFFER,
+                        "GET /api/mission?id=%s HTTP/1.1\r\nHost: 127.0.0.1:%d\r\n\r\n",
+                        sms->missions[first]->id, SERVER_PORT);
+    }
+
+    const char *path = "/api/mission";
+    size_t length;
+    if (strcmp(worker->route, "batch") == 0) {
+        path = "/api/missions/batch";
+        length = snprintf(body, REQUEST_BUFFER, "{\"missions\":[");
+        for (int i = 0; i < BATCH_MISSIONS && length < REQUEST_BUFFER; i++) {
+            length += snprintf(body + length, REQUEST_BUFFER - length, i ? "," : "");
+            length += write_mission_json(body + length, REQUEST_BUFFER - length,
+                                         sms->missions[(first + i) % sms->num_missions]);
+        }
+        length += snprintf(body + length, length < REQUEST_BUFFER ? REQUEST_BUFFER - length : 0, "]}");
+    } else {
+        length = write_mission_json(body, REQUEST_BUFFER, sms->missions[first]);
+    }
+    return snprintf(request, REQUEST_BUFFER,
+                    "POST %s HTTP/1.1\r\nHost: 127.0.0.1:%d\r\nContent-Type: application/json\r\n"
+                    "Content-Length: %zu\r\n\r\n%s", path, SERVER_PORT, length, body);
+}
+
+static void *http_worker(void *arg) {
+    Worker *worker = arg;
+    char *buffer = malloc(RESPONSE_BUFFER);
+    char *request = malloc(REQUEST_BUFFER);
+    char *body = malloc(REQUEST_BUFFER);
+    int fd = -1;
+    while (buffer != NULL && request != NULL && body != NULL && now_s() < worker->deadline) {
+        if (fd < 0 && (fd = connect_to(SERVER_PORT)) < 0) {
+            worker->failed++;
+            nanosleep(&(struct timespec){.tv_nsec = 1000000}, NULL);
+            continue;
+        }
+        size_t length = build_request(worker, request, body);
+        double start = now_s();
+        int status = send_all(fd, request, length) == 0 ? read_response(fd, buffer) : -1;
+        if (status < 0) {
+            worker->failed++;
+            close(fd);
+            fd = -1;
+        } else if (status == 503) {
+            worker->overloaded++;
+        } else if (status != 200) {
+            worker->failed++;
+        } else {
+            record_latency(worker, start);
+        }
+    }
+    if (fd >= 0) close(fd);
+    free(buffer);
+    free(request);
+    free(body);
+    return NULL;
+}
+
+// Server memory from /proc/<pid>/status, in MB
+static void server_memory_mb(pid_t pid, double *rss, double *peak) {
+    char path[64], line[256];
+    snprintf(path, sizeof(path), "/proc/%d/status", (int)pid);
+    *rss = *peak = 0;
+    FILE *status = fopen(path, "r");
+    if (status == NULL) return;
+    while (fgets(line, sizeof(line), status) != NULL) {
+        long kb;
+        if (sscanf(line, "VmRSS: %ld", &kb) == 1) *rss = kb / 1024.0;
+        if (sscanf(line, "VmHWM: %ld", &kb) == 1) *peak = kb / 1024.0;
+    }
+    fclose(status);
+}
+
+// Start the server in work_dir with its stdin on a pipe; stdout goes to
+// server.log there. Returns its pid once it accepts connections, or -1.
+static pid_t start_server(const char *server, const char *work_dir, int *stdin_fd) {
+    int fds[2];
+    if (pipe(fds) != 0) return -1;
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(fds[0], STDIN_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        if (chdir(work_dir) == 0 && freopen("server.log", "w", stdout) != NULL) {
+            execl(server, server, (char *)NULL);
+        }
+        _exit(127);
+    }
+    close(fds[0]);
+    if (pid < 0) {
+        close(fds[1]);
+        return -1;
+    }
+    *stdin_fd = fds[1];
+
+    // Restoring or hydrating a large fleet takes a while
+    double deadline = now_s() + 60;
+    while (now_s() < deadline) {
+        int fd = connect_to(SERVER_PORT);
+        if (fd >= 0) {
+            close(fd);
+            return pid;
+        }
+        if (waitpid(pid, NULL, WNOHANG) == pid) break;
+        nanosleep(&(struct timespec){.tv_nsec = 50000000}, NULL);
+    }
+    fprintf(stderr, "Server did not start; see %s/server.log\n", work_dir);
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+    close(fds[1]);
+    return -1;
+}
+
+static void run_http_stage(FleetRegistry *reg, const char *server, const char *work_dir,
+                           const int *thread_counts, int runs, double seconds, double *latencies) {
+    int stdin_fd;
+    double start = now_s();
+    pid_t pid = start_server(server, work_dir, &stdin_fd);
+    if (pid < 0) return;
+    double rss, peak;
+    server_memory_mb(pid, &rss, &peak);
+    printf("\nHTTP (server up in %.0f ms, %.1f MB resident)\n", (now_s() - start) * 1000, rss);
+
+    const char *routes[] = {"get", "post", "batch"};
+    const char *stages[] = {"GET /api/mission", "POST /api/mission", "POST /missions/batch"};
+    for (int route = 0; route < 3; route++) {
+        print_header(stages[route]);
+        for (int r = 0; r < runs; r++) {
+            Worker base = {.reg = reg, .rng = 7, .route = routes[route]};
+            run_stage(stages[route], http_worker, &base, thread_counts[r], latencies, seconds);
+            server_memory_mb(pid, &rss, &peak);
+            printf("%-22s %8s %12s   server %.1f MB resident, %.1f MB peak\n", "", "", "", rss, peak);
+        }
+    }
+
+    // Enter stops the server, which checkpoints on the way out
+    if (write(stdin_fd, "\n", 1) != 1) kill(pid, SIGTERM);
+    close(stdin_fd);
+    waitpid(pid, NULL, 0);
+}
+
+static int parse_threads(const char *list, int *thread_counts) {
+    int runs = 0;
+    char *end;
+    for (const char *p = list; *p != '\0' && runs < MAX_RUNS; p = *end == ',' ? end + 1 : end) {
+        long n = strtol(p, &end, 10);
+        if (end == p) break;
+        if (n >= 1 && n <= MAX_THREADS) thread_counts[runs++] = (int)n;
+    }
+    return runs;
+}
+
+int main(int argc, char **argv) {
+    FleetGenConfig config = {0};
+    const char *threads = "1,2,4,8";
+    const char *work_dir = "fleet_load";
+    const char *server = NULL;
+    double seconds = 3;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:a:c:m:t:d:w:S:")) != -1) {
+        switch (opt) {
+        case 's': config.seed = strtoull(optarg, NULL, 10); break;
+        case 'a': config.num_aircraft = atoi(optarg); break;
+        case 'c': config.num_crew = atoi(optarg); break;
+        case 'm': config.num_missions = atoi(optarg); break;
+        case 't': threads = optarg; break;
+        case 'd': seconds = atof(optarg); break;
+        case 'w': work_dir = optarg; break;
+        case 'S': server = optarg; break;
+        default:
+            fprintf(stderr, "Usage: %s [-s seed] [-a aircraft] [-c crew] [-m missions] [-t threads,...] "
+                            "[-d seconds] [-w work_dir] [-S server_binary]\n", argv[0]);
+            return 1;
+        }
+    }
+    int thread_counts[MAX_RUNS];
+    int runs = parse_threads(threads, thread_counts);
+    double *latencies = malloc(sizeof(double) * MAX_LATENCIES);
+    if (runs == 0 || latencies == NULL) {
+        fprintf(stderr, "No thread counts, or out of memory\n");
+        return 1;
+    }
+
+    // The server runs from the work directory, so it needs the binary's full path
+    char server_path[PATH_MAX], db_path[PATH_MAX], snapshot_path[PATH_MAX];
+    if (server != NULL && realpath(server, server_path) == NULL) {
+        fprintf(stderr, "Server binary %s not found\n", server);
+        return 1;
+    }
+    if (mkdir(work_dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Cannot create %s: %s\n", work_dir, strerror(errno));
+        return 1;
+    }
+    snprintf(db_path, sizeof(db_path), "%s/safer.db", work_dir);
+    snprintf(snapshot_path, sizeof(snapshot_path), "%s/%s", work_dir, SNAPSHOT_DEFAULT_PATH);
+    const char *suffixes[] = {"", "-wal", "-shm"};
+    for (int i = 0; i < 3; i++) {
+        char path[PATH_MAX + 8];
+        snprintf(path, sizeof(path), "%s%s", db_path, suffixes[i]);
+        unlink(path);
+    }
+    unlink(snapshot_path);
+
+    SafetyManagementSystem sms = {0};
+    FleetRegistry reg;
+    FleetGenStats gen_stats;
+    if (registry_init(&reg, &sms) != 0) {
+        fprintf(stderr, "Failed to initialize registry\n");
+        return 1;
+    }
+    print_header("Generate");
+    double start = now_s();
+    if (fleet_generate(&reg, &config, &gen_stats) != 0) {
+        fprintf(stderr, "Failed to generate fleet\n");
+        return 1;
+    }
+    int entities = gen_stats.num_aircraft + gen_stats.num_crew + gen_stats.num_missions;
+    report_once("fleet_generate", 1, entities, (now_s() - start) * 1000);
+    printf("%-22s %8s %12s   %d aircraft (%d records, %d issues), %d crew, %d missions (%d crew slots), "
+           "registry %.1f MB\n", "", "", "", gen_stats.num_aircraft, gen_stats.num_records, gen_stats.num_issues,
+           gen_stats.num_crew, gen_stats.num_missions, gen_stats.num_mission_crew,
+           registry_memory_usage(&reg) / 1048576.0);
+
+    run_risk_stage(&reg, thread_counts, runs, latencies);
+
+    Database db = {.path = db_path};
+    if (init_database(&db) != SQLITE_OK) {
+        fprintf(stderr, "Failed to initialize database %s\n", db_path);
+        return 1;
+    }
+    int rc = run_sqlite_stage(&reg, &db, snapshot_path, thread_counts, runs, seconds, latencies);
+    close_database(&db);
+
+    if (rc == 0 && server != NULL) {
+        run_http_stage(&reg, server_path, work_dir, thread_counts, runs, seconds, latencies);
+    }
+
+    registry_destroy(&reg);
+    free(latencies);
+    return rc == 0 ? 0 : 1;
+}
@@ -0,0 +1,121 @@
+// json_response_bench.c - Allocations and time per mission response body
+//
+// Compares the json-c object tree serialised with json_object_to_json_string
+// and copied for MHD_RESPMEM_MUST_COPY against JsonWriter with a pooled
+// buffer. Allocations are counted by interposing glibc's malloc family.
+//
+// Build from this directory:
+//   gcc -O2 -I.. json_response_bench.c ../json_writer.c -ljson-c -lpthread
+//       -o json_response_bench
+#define _GNU_SOURCE
+#include "json_writer.h"
+#include <json-c/json.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ITERATIONS 200000
+#define CREW 4
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static unsigned long allocations;
+
+void *malloc(size_t size) {
+    allocations++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    allocations++;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+static double now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static const char *crew_ids[CREW] = {"CRW-0001", "CRW-0002", "CRW-0003", "CRW-0004"};
+
+// What send_json_response used to do, including the copy microhttpd made
+static size_t tree_response(void) {
+    json_object *response = json_object_new_object();
+    json_object_object_add(response, "mission_id", json_object_new_string("MSN-000042"));
+    json_object_object_add(response, "aircraft_id", json_object_new_string("ACF-0007"));
+    json_object_object_add(response, "mission_type", json_object_new_string("Reconnaissance"));
+    json_object_object_add(response, "departure_time", json_object_new_int64(1760000000));
+    json_object_object_add(response, "estimated_duration", json_object_new_double(3.5));
+    json_object_object_add(response, "risk_level", json_object_new_int(1));
+    json_object *crew = json_object_new_array();
+    for (int i = 0; i < CREW; i++) {
+        json_object_array_add(crew, json_object_new_string(crew_ids[i]));
+    }
+    json_object_object_add(response, "crew", crew);
+
+    const char *text = json_object_to_json_string(response);
+    size_t length = strlen(text);
+    char *copy = malloc(length);
+    memcpy(copy, text, length);
+    free(copy);
+    json_object_put(response);
+    return length;
+}
+
+static size_t writer_response(void) {
+    JsonWriter response;
+    json_writer_init(&response);
+    json_writer_begin_object(&response);
+    json_writer_key(&response, "mission_id");
+    json_writer_string(&response, "MSN-000042");
+    json_writer_key(&response, "aircraft_id");
+    json_writer_string(&response, "ACF-0007");
+    json_writer_key(&response, "mission_type");
+    json_writer_string(&response, "Reconnaissance");
+    json_writer_key(&response, "departure_time");
+    json_writer_int(&response, 1760000000);
+    json_writer_key(&response, "estimated_duration");
+    json_writer_double(&response, 3.5);
+    json_writer_key(&response, "risk_level");
+    json_writer_int(&response, 1);
+    json_writer_key(&response, "crew");
+    json_writer_begin_array(&response);
+    for (int i = 0; i < CREW; i++) {
+        json_writer_string(&response, crew_ids[i]);
+    }
+    json_writer_end_array(&response);
+    json_writer_end_object(&response);
+
+    const char *text;
+    size_t length;
+    JsonBuffer *buffer = json_writer_detach(&response, &text, &length);
+    json_buffer_release(buffer);
+    return length;
+}
+
+static void run(const char *name, size_t (*build)(void)) {
+    size_t length = build(); // Warm the pool
+    unsigned long before = allocations;
+    double start = now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        build();
+    }
+    double elapsed = now_ns() - start;
+    printf("%-22s %5zu bytes %8.1f allocations %8.0f ns\n", name, length,
+           (double)(allocations - before) / ITERATIONS, elapsed / ITERATIONS);
+}
+
+int main(void) {
+    run("json-c tree + copy", tree_response);
+    run("JsonWriter", writer_response);
+    return 0;
+}
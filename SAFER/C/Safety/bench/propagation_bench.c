@@ -0,0 +1,88 @@
+// propagation_bench.c - Cost per million sources of each propagation model
+//
+// Build from this directory:
+//   gcc -O2 -I.. propagation_bench.c ../propagation.c ../radio_interference.c
+//       ../radio_batch.c ../path_loss_table.c ../risk_rules.c -lm -lpthread -o propagation_bench
+#define _POSIX_C_SOURCE 200809L
+#include "propagation.h"
+#include <stdint.h>
+#include <time.h>
+
+#define NUM_SOURCES 1000000
+#define REPEATS 5
+
+static double now_ms(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000.0 + t.tv_nsec / 1e6;
+}
+
+// xorshift64, enough for benchmark inputs
+static double uniform(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return (*state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double time_environment(RadioEnvironment *env, double *level) {
+    double best = 0;
+    for (int r = 0; r < REPEATS; r++) {
+        double start = now_ms();
+        RadioInterferenceAnalysis analysis = analyze_radio_interference(env);
+        double elapsed = now_ms() - start;
+        if (r == 0 || elapsed < best) best = elapsed;
+        *level = analysis.interference_level;
+    }
+    return best;
+}
+
+int main(void) {
+    RadioSource *sources = malloc(sizeof(RadioSource) * NUM_SOURCES);
+    if (sources == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    // 150-2000 MHz keeps every source inside the Hata/COST-231 range; a
+    // handful of bands mimics real emitter clustering
+    uint64_t state = 88172645463325252ULL;
+    static const double bands[] = {225, 430, 900, 1500, 1800};
+    for (int i = 0; i < NUM_SOURCES; i++) {
+        sources[i] = (RadioSource){
+            .frequency = bands[i % 5] + uniform(&state) * 25,
+            .power = -10 + uniform(&state) * 60,
+            .distance = 1 + uniform(&state) * 19,
+            .terrain_factor = uniform(&state) * 5
+        };
+    }
+
+    RadioEnvironment env = {
+        .sources = sources,
+        .num_sources = NUM_SOURCES,
+        .background_noise = -100,
+        .weather_factor = 0.01
+    };
+
+    double level;
+    double baseline = time_environment(&env, &level);
+    printf("%-28s %8.1f ms  %6.1f ns/source  level %.3f dBm\n", "calculate_path_loss (fast)",
+           baseline, baseline * 1e6 / NUM_SOURCES, level);
+
+    const PropagationModel *models[] = {
+        &propagation_free_space, &propagation_terrain, &propagation_hata,
+        &propagation_two_ray, &propagation_itu_rain
+    };
+    for (size_t m = 0; m < sizeof(models) / sizeof(models[0]); m++) {
+        PropagationConfig config = {
+            .model = models[m],
+            .params = {.rain_rate_mm_h = 25, .environment = HATA_SUBURBAN}
+        };
+        env.propagation = &config;
+        double elapsed = time_environment(&env, &level);
+        printf("%-28s %8.1f ms  %6.1f ns/source  level %.3f dBm\n", models[m]->name,
+               elapsed, elapsed * 1e6 / NUM_SOURCES, level);
+    }
+
+    free(sources);
+    return 0;
+}
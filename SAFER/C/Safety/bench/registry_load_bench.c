@@ -0,0 +1,292 @@
+// registry_load_bench.c - Bulk load into the fleet registry vs one malloc per object
+//
+// Builds the same synthetic fleet three ways, each in its own forked
+// child so peak RSS is per run:
+//   malloc    - what the code did before the registry: one malloc per
+//               entity, record array, issue string and crew list, the
+//               sms arrays grown by doubling, references taken directly
+//               since there is no index to resolve them by
+//   registry  - registry_add_* one entity at a time, resolving each
+//               mission's aircraft and crew by id as hydrate does
+//   reserved  - as registry, after registry_reserve with the counts
+// Each run reports load time, teardown time and peak RSS.
+//
+// Build from this directory:
+//   gcc -O2 -I.. registry_load_bench.c ../registry.c ../arena.c -o registry_load_bench
+// Usage:
+//   registry_load_bench [aircraft] [crew] [missions] [runs]
+#define _DEFAULT_SOURCE // wait4
+#include "registry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RECORDS_PER_AIRCRAFT 8
+#define ISSUES_PER_RECORD 3
+#define CREW_PER_MISSION 3
+
+typedef struct {
+    int aircraft;
+    int crew;
+    int missions;
+} FleetSize;
+
+static double now_s(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+// Ids as the database hands them over, without a printf per field so the
+// formatting does not swamp what is being measured
+static void format_id(char id[16], char prefix, int digits, int value) {
+    memset(id, 0, 16);
+    id[0] = prefix;
+    for (int i = digits; i > 0; i--) {
+        id[i] = (char)('0' + value % 10);
+        value /= 10;
+    }
+}
+
+static void make_aircraft(Aircraft *aircraft, MaintenanceRecord *records, char issues[][ISSUES_PER_RECORD][32],
+                          char *issue_lists[][ISSUES_PER_RECORD], int i) {
+    memset(aircraft, 0, sizeof(*aircraft));
+    format_id(aircraft->id, 'A', 6, i);
+    strcpy(aircraft->model, i % 3 ? "C-130J" : "KC-135");
+    aircraft->manufacture_date = 946684800 + (time_t)i * 3600;
+    aircraft->total_flight_hours = 1000 + i % 20000;
+    for (int r = 0; r < RECORDS_PER_AIRCRAFT; r++) {
+        memset(&records[r], 0, sizeof(records[r]));
+        memcpy(records[r].aircraft_id, aircraft->id, sizeof(aircraft->id));
+        records[r].last_inspection = 1700000000 - (time_t)(i + r) * 86400;
+        records[r].maintenance_due = records[r].last_inspection + 90 * 86400;
+        for (int k = 0; k < ISSUES_PER_RECORD; k++) {
+            snprintf(issues[r][k], sizeof(issues[r][k]), "Issue %d-%d-%d", i, r, k);
+            issue_lists[r][k] = issues[r][k];
+        }
+        records[r].reported_issues = issue_lists[r];
+        records[r].num_issues = ISSUES_PER_RECORD;
+    }
+    aircraft->maintenance_records = records;
+    aircraft->num_records = RECORDS_PER_AIRCRAFT;
+}
+
+static void make_crew(CrewMember *crew, int i) {
+    memset(crew, 0, sizeof(*crew));
+    format_id(crew->id, 'C', 6, i);
+    memcpy(crew->name, "Crew ", 5);
+    memcpy(crew->name + 5, crew->id, 8);
+    strcpy(crew->role, i % 2 ? "Pilot" : "Navigator");
+    crew->flight_hours = 50 + i % 5000;
+    crew->last_training = 1700000000 - (time_t)(i % 365) * 86400;
+}
+
+// Mission i flies aircraft i % aircraft with crew i * 7 + k
+static void make_mission(Mission *mission, const FleetSize *size, int i, int *aircraft_index, int *crew_index) {
+    memset(mission, 0, sizeof(*mission));
+    format_id(mission->id, 'M', 7, i);
+    strcpy(mission->mission_type, "Transport");
+    mission->departure_time = 1700000000 + (time_t)i * 60;
+    mission->estimated_duration = 2 + i % 10;
+    mission->weather = (WeatherCondition){ .temperature = 15, .visibility = 8000, .wind_speed = i % 40 };
+    *aircraft_index = i % size->aircraft;
+    for (int k = 0; k < CREW_PER_MISSION; k++) {
+        crew_index[k] = (int)(((long long)i * 7 + k) % size->crew);
+    }
+}
+
+static int append(void ***array, int *count, int *capacity, void *ptr) {
+    if (*count == *capacity) {
+        int new_capacity = *capacity ? *capacity * 2 : 64;
+        void **grown = realloc(*array, sizeof(void *) * new_capacity);
+        if (grown == NULL) {
+            return -1;
+        }
+        *array = grown;
+        *capacity = new_capacity;
+    }
+    (*array)[(*count)++] = ptr;
+    return 0;
+}
+
+static int load_malloc(const FleetSize *size, double *load_s, double *teardown_s) {
+    SafetyManagementSystem sms = {0};
+    int aircraft_capacity = 0, crew_capacity = 0, mission_capacity = 0;
+    MaintenanceRecord records[RECORDS_PER_AIRCRAFT];
+    char issues[RECORDS_PER_AIRCRAFT][ISSUES_PER_RECORD][32];
+    char *issue_lists[RECORDS_PER_AIRCRAFT][ISSUES_PER_RECORD];
+    double start = now_s();
+
+    for (int i = 0; i < size->aircraft; i++) {
+        Aircraft *aircraft = malloc(sizeof(Aircraft));
+        MaintenanceRecord *copies = malloc(sizeof(MaintenanceRecord) * RECORDS_PER_AIRCRAFT);
+        if (aircraft == NULL || copies == NULL) return -1;
+        make_aircraft(aircraft, records, issues, issue_lists, i);
+        for (int r = 0; r < RECORDS_PER_AIRCRAFT; r++) {
+            copies[r] = records[r];
+            copies[r].reported_issues = malloc(sizeof(char *) * ISSUES_PER_RECORD);
+            if (copies[r].reported_issues == NULL) return -1;
+            for (int k = 0; k < ISSUES_PER_RECORD; k++) {
+                copies[r].reported_issues[k] = strdup(issues[r][k]);
+            }
+        }
+        aircraft->maintenance_records = copies;
+        if (append((void ***)&sms.aircraft_registry, &sms.num_aircraft, &aircraft_capacity, aircraft) != 0) return -1;
+    }
+    for (int i = 0; i < size->crew; i++) {
+        CrewMember *crew = malloc(sizeof(CrewMember));
+        if (crew == NULL) return -1;
+        make_crew(crew, i);
+        if (append((void ***)&sms.crew_registry, &sms.num_crew, &crew_capacity, crew) != 0) return -1;
+    }
+    for (int i = 0; i < size->missions; i++) {
+        Mission *mission = malloc(sizeof(Mission));
+        CrewMember **crew = malloc(sizeof(CrewMember *) * CREW_PER_MISSION);
+        if (mission == NULL || crew == NULL) return -1;
+        int aircraft_index, crew_index[CREW_PER_MISSION];
+        make_mission(mission, size, i, &aircraft_index, crew_index);
+        mission->aircraft = sms.aircraft_registry[aircraft_index];
+        for (int k = 0; k < CREW_PER_MISSION; k++) {
+            crew[k] = sms.crew_registry[crew_index[k]];
+        }
+        mission->crew = crew;
+        mission->crew_size = CREW_PER_MISSION;
+        if (append((void ***)&sms.missions, &sms.num_missions, &mission_capacity, mission) != 0) return -1;
+    }
+    *load_s = now_s() - start;
+
+    start = now_s();
+    for (int i = 0; i < sms.num_missions; i++) {
+        free(sms.missions[i]->crew);
+        free(sms.missions[i]);
+    }
+    for (int i = 0; i < sms.num_crew; i++) {
+        free(sms.crew_registry[i]);
+    }
+    for (int i = 0; i < sms.num_aircraft; i++) {
+        Aircraft *aircraft = sms.aircraft_registry[i];
+        for (int r = 0; r < aircraft->num_records; r++) {
+            for (int k = 0; k < aircraft->maintenance_records[r].num_issues; k++) {
+                free(aircraft->maintenance_records[r].reported_issues[k]);
+            }
+            free(aircraft->maintenance_records[r].reported_issues);
+        }
+        free(aircraft->maintenance_records);
+        free(aircraft);
+    }
+    free(sms.missions);
+    free(sms.crew_registry);
+    free(sms.aircraft_registry);
+    *teardown_s = now_s() - start;
+    return 0;
+}
+
+static int load_registry(const FleetSize *size, int reserve, double *load_s, double *teardown_s) {
+    SafetyManagementSystem sms = {0};
+    FleetRegistry reg;
+    MaintenanceRecord records[RECORDS_PER_AIRCRAFT];
+    char issues[RECORDS_PER_AIRCRAFT][ISSUES_PER_RECORD][32];
+    char *issue_lists[RECORDS_PER_AIRCRAFT][ISSUES_PER_RECORD];
+    double start = now_s();
+
+    if (registry_init(&reg, &sms) != 0) return -1;
+    if (reserve && registry_reserve(&reg, size->aircraft, size->crew, size->missions) != 0) return -1;
+    for (int i = 0; i < size->aircraft; i++) {
+        Aircraft aircraft;
+        make_aircraft(&aircraft, records, issues, issue_lists, i);
+        if (registry_add_aircraft(&reg, &aircraft) == NULL) return -1;
+    }
+    for (int i = 0; i < size->crew; i++) {
+        CrewMember crew;
+        make_crew(&crew, i);
+        if (registry_add_crew_member(&reg, &crew) == NULL) return -1;
+    }
+    for (int i = 0; i < size->missions; i++) {
+        Mission mission;
+        CrewMember *crew[CREW_PER_MISSION];
+        int aircraft_index, crew_index[CREW_PER_MISSION];
+        char id[16];
+        make_mission(&mission, size, i, &aircraft_index, crew_index);
+        format_id(id, 'A', 6, aircraft_index);
+        mission.aircraft = registry_find_aircraft_id(&reg, safer_id_load(id));
+        for (int k = 0; k < CREW_PER_MISSION; k++) {
+            format_id(id, 'C', 6, crew_index[k]);
+            crew[k] = registry_find_crew_member_id(&reg, safer_id_load(id));
+        }
+        mission.crew = crew;
+        mission.crew_size = CREW_PER_MISSION;
+        if (mission.aircraft == NULL || crew[0] == NULL || registry_add_mission(&reg, &mission) == NULL) return -1;
+    }
+    *load_s = now_s() - start;
+
+    start = now_s();
+    registry_destroy(&reg);
+    *teardown_s = now_s() - start;
+    return 0;
+}
+
+// Runs mode in a child and reports its own peak RSS, not the parent's
+static int run(const char *mode, const FleetSize *size) {
+    int pipefd[2];
+    if (pipe(pipefd) != 0) {
+        perror("pipe");
+        return -1;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return -1;
+    }
+    if (pid == 0) {
+        double times[2] = {0, 0};
+        int rc = strcmp(mode, "malloc") == 0 ? load_malloc(size, &times[0], &times[1])
+                                              : load_registry(size, strcmp(mode, "reserved") == 0,
+                                                              &times[0], &times[1]);
+        if (rc != 0 || write(pipefd[1], times, sizeof(times)) != sizeof(times)) {
+            _exit(1);
+        }
+        _exit(0);
+    }
+    close(pipefd[1]);
+    double times[2];
+    ssize_t got = read(pipefd[0], times, sizeof(times));
+    close(pipefd[0]);
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ||
+        got != sizeof(times)) {
+        fprintf(stderr, "%s run failed\n", mode);
+        return -1;
+    }
+    printf("%-10s %8.3f %10.3f %10.1f\n", mode, times[0], times[1], usage.ru_maxrss / 1024.0);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    FleetSize size = {
+        .aircraft = argc > 1 ? atoi(argv[1]) : 20000,
+        .crew = argc > 2 ? atoi(argv[2]) : 50000,
+        .missions = argc > 3 ? atoi(argv[3]) : 1000000
+    };
+    int runs = argc > 4 ? atoi(argv[4]) : 3;
+    if (size.aircraft < 1 || size.crew < 1 || size.missions < 0 || runs < 1) {
+        fprintf(stderr, "Usage: %s [aircraft] [crew] [missions] [runs]\n", argv[0]);
+        return 1;
+    }
+    printf("%d aircraft x %d records x %d issues, %d crew, %d missions x %d crew\n\n",
+           size.aircraft, RECORDS_PER_AIRCRAFT, ISSUES_PER_RECORD, size.crew, size.missions, CREW_PER_MISSION);
+    printf("%-10s %8s %10s %10s\n", "mode", "load s", "teardown s", "peak MB");
+    static const char *modes[] = {"malloc", "registry", "reserved"};
+    for (int r = 0; r < runs; r++) {
+        for (int m = 0; m < 3; m++) {
+            if (run(modes[m], &size) != 0) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
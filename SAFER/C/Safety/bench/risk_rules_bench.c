@@ -0,0 +1,289 @@
+// risk_rules_bench.c - Compiled risk rules vs the hard-coded assessments they replaced
+//
+// The reference functions below are the if-chains assess_weather_risk,
+// assess_maintenance_risk, assess_crew_risk and assess_radio_risk used
+// before the rules existed. Every input is graded both ways and must
+// agree; inputs are drawn around the built-in thresholds, and include
+// exact threshold values, so each boundary is checked. Then the public
+// entry points, claim and clock included, are timed against those
+// if-chains as they were called before, one call per input; the
+// baseline_ copies are kept out of line as the originals in safer.c
+// were. A last run grades weather on one thread, claiming the rules for
+// each input, while another installs a new rule set in a loop; replaced
+// sets must be reclaimed as it goes.
+//
+// Build from this directory:
+//   gcc -O2 -I.. risk_rules_bench.c ../risk_rules.c ../safer.c ../registry.c ../arena.c
+//       ../radio_interference.c ../radio_batch.c ../propagation.c ../path_loss_table.c
+//       -lm -lpthread -o risk_rules_bench
+// Usage:
+//   risk_rules_bench [inputs]
+#define _POSIX_C_SOURCE 200809L
+#include "radio_interference.h"
+#include "risk_rules.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+static double now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static RiskLevel reference_weather(const WeatherCondition *weather) {
+    int risk_score = 0;
+    if (weather->visibility < 1000) risk_score += 3;
+    else if (weather->visibility < 3000) risk_score += 2;
+    else if (weather->visibility < 5000) risk_score += 1;
+    if (weather->wind_speed > 50) risk_score += 3;
+    else if (weather->wind_speed > 30) risk_score += 2;
+    else if (weather->wind_speed > 15) risk_score += 1;
+    if (risk_score >= 5) return RISK_CRITICAL;
+    if (risk_score >= 3) return RISK_HIGH;
+    if (risk_score >= 1) return RISK_MEDIUM;
+    return RISK_LOW;
+}
+
+static RiskLevel reference_maintenance(const MaintenanceRecord *record, time_t now) {
+    double days_since_inspection = difftime(now, record->last_inspection) / (24 * 3600);
+    if (days_since_inspection > 180 || record->num_issues > 2) return RISK_CRITICAL;
+    if (days_since_inspection > 90 || record->num_issues > 0) return RISK_HIGH;
+    if (days_since_inspection > 45) return RISK_MEDIUM;
+    return RISK_LOW;
+}
+
+static RiskLevel reference_crew(const CrewMember *crew, time_t now) {
+    double days_since_training = difftime(now, crew->last_training) / (24 * 3600);
+    if (days_since_training > 180) return RISK_CRITICAL;
+    if (crew->flight_hours < 100) return RISK_HIGH;
+    if (crew->flight_hours < 500) return RISK_MEDIUM;
+    return RISK_LOW;
+}
+
+static RiskLevel reference_radio(double signal_to_noise) {
+    if (signal_to_noise > 30) return RISK_LOW;
+    if (signal_to_noise > 20) return RISK_MEDIUM;
+    if (signal_to_noise > 10) return RISK_HIGH;
+    return RISK_CRITICAL;
+}
+
+// The public functions as they were, each reading its own clock
+__attribute__((noinline)) static RiskLevel baseline_weather(WeatherCondition *weather) {
+    return reference_weather(weather);
+}
+
+__attribute__((noinline)) static RiskLevel baseline_maintenance(MaintenanceRecord *record) {
+    return reference_maintenance(record, time(NULL));
+}
+
+__attribute__((noinline)) static RiskLevel baseline_crew(CrewMember *crew) {
+    return reference_crew(crew, time(NULL));
+}
+
+__attribute__((noinline)) static RiskLevel baseline_radio(RadioInterferenceAnalysis *analysis) {
+    return reference_radio(analysis->signal_to_noise);
+}
+
+__attribute__((noinline)) static void baseline_mission(Mission *mission) {
+    RiskLevel risk = baseline_weather(&mission->weather);
+    if (mission->aircraft != NULL && mission->aircraft->maintenance_records != NULL) {
+        RiskLevel maintenance_risk = baseline_maintenance(mission->aircraft->maintenance_records);
+        if (maintenance_risk > risk) risk = maintenance_risk;
+    }
+    for (int i = 0; i < mission->crew_size; i++) {
+        if (mission->crew[i] == NULL) continue;
+        RiskLevel crew_risk = baseline_crew(mission->crew[i]);
+        if (crew_risk > risk) risk = crew_risk;
+    }
+    mission->risk_level = risk;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// Mostly uniform over [0, max), one in four exactly on a threshold
+static double sample(double max, const double *thresholds, int count) {
+    uint64_t r = next_random();
+    if (r % 4 == 0) {
+        return thresholds[(r >> 8) % count];
+    }
+    return (double)(r >> 11) / 9007199254740992.0 * max;
+}
+
+// Missions fly input i's weather, an aircraft with record i and crew i
+// and i + 1
+typedef struct {
+    WeatherCondition *weather;
+    MaintenanceRecord *records;
+    CrewMember *crew;
+    double *snr;
+    Aircraft *aircraft;
+    CrewMember **crew_lists;
+    Mission *missions;
+    int count;
+} Inputs;
+
+static void make_inputs(Inputs *in, int count, time_t now) {
+    static const double visibility[] = {1000, 3000, 5000}, wind[] = {15, 30, 50}, days[] = {45, 90, 180},
+                        issues[] = {0, 1, 2, 3}, hours[] = {100, 500}, snr[] = {10, 20, 30};
+    in->count = count;
+    in->weather = malloc(sizeof(WeatherCondition) * count);
+    in->records = malloc(sizeof(MaintenanceRecord) * count);
+    in->crew = malloc(sizeof(CrewMember) * count);
+    in->snr = malloc(sizeof(double) * count);
+    in->aircraft = malloc(sizeof(Aircraft) * count);
+    in->crew_lists = malloc(sizeof(CrewMember *) * 2 * count);
+    in->missions = malloc(sizeof(Mission) * count);
+    if (in->weather == NULL || in->records == NULL || in->crew == NULL || in->snr == NULL ||
+        in->aircraft == NULL || in->crew_lists == NULL || in->missions == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    for (int i = 0; i < count; i++) {
+        in->weather[i] = (WeatherCondition){ .visibility = (float)sample(8000, visibility, 3),
+                                             .wind_speed = (float)sample(70, wind, 3) };
+        in->records[i] = (MaintenanceRecord){ .last_inspection = now - (time_t)(sample(250, days, 3) * 86400),
+                                              .num_issues = (int)sample(5, issues, 4) };
+        in->crew[i] = (CrewMember){ .last_training = now - (time_t)(sample(250, days, 3) * 86400),
+                                    .flight_hours = (int)sample(800, hours, 2) };
+        in->snr[i] = sample(45, snr, 3) - 5;
+    }
+    for (int i = 0; i < count; i++) {
+        in->aircraft[i] = (Aircraft){ .maintenance_records = &in->records[i], .num_records = 1 };
+        in->crew_lists[2 * i] = &in->crew[i];
+        in->crew_lists[2 * i + 1] = &in->crew[(i + 1) % count];
+        in->missions[i] = (Mission){ .weather = in->weather[i], .aircraft = &in->aircraft[i],
+                                     .crew = &in->crew_lists[2 * i], .crew_size = 2 };
+    }
+}
+
+static int check(const Inputs *in, const RiskRules *rules, time_t now) {
+    const RiskProfile *profile = risk_rules_profile(rules, NULL);
+    int mismatches = 0;
+    for (int i = 0; i < in->count; i++) {
+        mismatches += risk_rules_weather(profile, &in->weather[i]) != reference_weather(&in->weather[i]);
+        mismatches += risk_rules_maintenance(profile, &in->records[i], now) != reference_maintenance(&in->records[i], now);
+        mismatches += risk_rules_crew(rules, &in->crew[i], now) != reference_crew(&in->crew[i], now);
+        mismatches += risk_rules_radio(rules, in->snr[i]) != reference_radio(in->snr[i]);
+        Mission mission = in->missions[i];
+        perform_risk_assessment(&mission);
+        RiskLevel assessed = mission.risk_level;
+        baseline_mission(&mission);
+        mismatches += assessed != mission.risk_level;
+    }
+    return mismatches;
+}
+
+static volatile int sink;
+
+static RiskLevel grade(const Inputs *in, int i, int which, int rules) {
+    RadioInterferenceAnalysis analysis = {.signal_to_noise = in->snr[i]};
+    switch (which) {
+    case 0: return rules ? assess_weather_risk(&in->weather[i]) : baseline_weather(&in->weather[i]);
+    case 1: return rules ? assess_maintenance_risk(&in->records[i]) : baseline_maintenance(&in->records[i]);
+    case 2: return rules ? assess_crew_risk(&in->crew[i]) : baseline_crew(&in->crew[i]);
+    case 3: return rules ? assess_radio_risk(&analysis) : baseline_radio(&analysis);
+    default:
+        if (rules) {
+            perform_risk_assessment(&in->missions[i]);
+        } else {
+            baseline_mission(&in->missions[i]);
+        }
+        return in->missions[i].risk_level;
+    }
+}
+
+// Best of ten runs each, alternating, so neither side gets the warm cache
+static void time_both(const char *name, const Inputs *in, int which) {
+    double best[2] = {0, 0};
+    int total = 0;
+    for (int run = 0; run < 20; run++) {
+        int rules = run % 2;
+        double start = now_ns();
+        for (int i = 0; i < in->count; i++) {
+            total += grade(in, i, which, rules);
+        }
+        double ns = (now_ns() - start) / in->count;
+        if (run < 2 || ns < best[rules]) best[rules] = ns;
+    }
+    sink = total;
+    printf("%-12s %12.2f %12.2f %9.2fx\n", name, best[0], best[1], best[0] / best[1]);
+}
+
+static int swapping = 1;
+
+static void *swap_rules(void *arg) {
+    unsigned long *installs = arg;
+    char error[128];
+    while (__atomic_load_n(&swapping, __ATOMIC_RELAXED)) {
+        RiskRules *rules = risk_rules_parse(risk_rules_default_text, error, sizeof(error));
+        if (rules != NULL) {
+            risk_rules_install(rules);
+            (*installs)++;
+        }
+    }
+    return NULL;
+}
+
+// Graders keep reading whichever set was current when they looked
+static void bench_swap(const Inputs *in) {
+    unsigned long installs = 0;
+    int graded = 0, mismatches = 0;
+    pthread_t swapper;
+    pthread_create(&swapper, NULL, swap_rules, &installs);
+    double start = now_ns();
+    for (int r = 0; r < 20; r++) {
+        for (int i = 0; i < in->count; i++) {
+            const RiskRules *rules = risk_rules_acquire();
+            mismatches += risk_rules_weather(risk_rules_profile(rules, NULL), &in->weather[i]) !=
+                          reference_weather(&in->weather[i]);
+            risk_rules_release();
+            graded++;
+        }
+    }
+    double elapsed_ns = now_ns() - start;
+    // Let the installs still to come reclaim the set this thread last read
+    risk_rules_quiesce();
+    __atomic_store_n(&swapping, 0, __ATOMIC_RELAXED);
+    pthread_join(swapper, NULL);
+    printf("\nweather under hot swap: %.2f ns/assessment, %lu installs, %d mismatches, %d sets retired\n",
+           elapsed_ns / graded, installs, mismatches, risk_rules_retired());
+    risk_rules_cleanup();
+}
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 1000000;
+    if (count < 1) count = 1;
+    time_t now = time(NULL);
+    Inputs in;
+    make_inputs(&in, count, now);
+
+    const RiskRules *rules = risk_rules_acquire();
+    int mismatches = check(&in, rules, now);
+    risk_rules_release();
+    printf("%d inputs, %d mismatches against the hard-coded assessments\n\n", count, mismatches);
+
+    printf("%-12s %12s %12s %10s\n", "entry point", "if-chain ns", "rules ns", "speedup");
+    time_both("weather", &in, 0);
+    time_both("maintenance", &in, 1);
+    time_both("crew", &in, 2);
+    time_both("radio", &in, 3);
+    time_both("mission", &in, 4);
+
+    bench_swap(&in);
+    free(in.weather);
+    free(in.records);
+    free(in.crew);
+    free(in.snr);
+    free(in.aircraft);
+    free(in.crew_lists);
+    free(in.missions);
+    return mismatches != 0;
+}
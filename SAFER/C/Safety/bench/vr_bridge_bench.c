@@ -0,0 +1,185 @@
+// vr_bridge_bench.c - Throughput and latency of the VR shared-memory event bridge
+//
+// Three runs over a real shared memory segment:
+//   publish   - cost of vr_bridge_publish in one process, draining the
+//               ring whenever it fills, which is what the frame loop pays
+//   saturate  - a forked producer publishes as fast as it can (retrying
+//               when the ring is full) while the parent drains in batches
+//               of 256, as vr_ingest does; events per second end to end
+//   paced     - the producer publishes a burst per 90 Hz frame and the
+//               consumer polls at the given interval, sleeping while the
+//               ring is empty; publish-to-consume lag percentiles
+//
+// Build from this directory:
+//   gcc -O2 -I.. vr_bridge_bench.c ../vr_bridge.c -o vr_bridge_bench   (add -lrt on glibc < 2.34)
+// Usage:
+//   vr_bridge_bench [poll_ms] [events_per_frame] [seconds]
+#define _POSIX_C_SOURCE 200809L
+#include "vr_bridge.h"
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_NAME "/safer-vr-bridge-bench"
+#define BATCH 256
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+static void sleep_ns(uint64_t ns) {
+    struct timespec t = { .tv_sec = (time_t)(ns / 1000000000ULL), .tv_nsec = (long)(ns % 1000000000ULL) };
+    nanosleep(&t, NULL);
+}
+
+static VREvent sample_event(uint64_t i) {
+    VREvent event = { .type = i % 16 == 0 ? VR_EVENT_TRAINING_COMPLETE : VR_EVENT_ZONE_WARNING,
+                      .flags = VR_EVENT_PASSED, .level = (float)(i % 10) / 10.0f,
+                      .wall_time = (int64_t)time(NULL) };
+    snprintf(event.crew_id, sizeof(event.crew_id), "C%06llu", (unsigned long long)(i % 1000));
+    memcpy(event.subject_id, "main_zone", 9);
+    return event;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Producer in a child process; returns its pid
+static pid_t spawn_producer(uint64_t count, int per_frame) {
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+    VRBridge *bridge = NULL;
+    while ((bridge = vr_bridge_open(BENCH_NAME)) == NULL) {
+        sched_yield();
+    }
+    uint64_t frame_ns = 1000000000ULL / 90, next_frame = now_ns();
+    for (uint64_t i = 0; i < count; i++) {
+        VREvent event = sample_event(i);
+        if (per_frame > 0 && i % per_frame == 0) {
+            next_frame += frame_ns;
+            uint64_t now = now_ns();
+            if (next_frame > now) {
+                sleep_ns(next_frame - now);
+            }
+        }
+        while (vr_bridge_publish(bridge, &event) != 0) {
+            if (per_frame > 0) {
+                break; // The frame loop drops rather than waits
+            }
+            sched_yield();
+        }
+    }
+    vr_bridge_close(bridge);
+    _exit(0);
+}
+
+static void bench_publish(void) {
+    VRBridge *consumer = vr_bridge_create(BENCH_NAME, 0);
+    VRBridge *producer = vr_bridge_open(BENCH_NAME);
+    VREvent *events = malloc(sizeof(VREvent) * VR_BRIDGE_DEFAULT_CAPACITY);
+    if (consumer == NULL || producer == NULL || events == NULL) {
+        fprintf(stderr, "Failed to set up bridge\n");
+        exit(1);
+    }
+    VREvent event = sample_event(1);
+    const int rounds = 2000;
+    uint64_t publish_ns = 0, published = 0;
+    for (int r = 0; r < rounds; r++) {
+        uint64_t start = now_ns();
+        while (vr_bridge_publish(producer, &event) == 0) {
+            published++;
+        }
+        publish_ns += now_ns() - start;
+        vr_bridge_consume(consumer, events, VR_BRIDGE_DEFAULT_CAPACITY);
+    }
+    printf("publish:  %.1f ns/event over %llu events\n", (double)publish_ns / published,
+           (unsigned long long)published);
+    free(events);
+    vr_bridge_close(producer);
+    vr_bridge_close(consumer);
+    vr_bridge_unlink(BENCH_NAME);
+}
+
+static void bench_saturate(void) {
+    const uint64_t count = 20000000;
+    VRBridge *consumer = vr_bridge_create(BENCH_NAME, 0);
+    if (consumer == NULL) {
+        exit(1);
+    }
+    VREvent events[BATCH];
+    uint64_t consumed = 0, batches = 0, start = now_ns();
+    pid_t pid = spawn_producer(count, 0);
+    while (consumed < count) {
+        int n = vr_bridge_consume(consumer, events, BATCH);
+        if (n == 0) {
+            sched_yield();
+            continue;
+        }
+        consumed += n;
+        batches++;
+    }
+    double seconds = (now_ns() - start) / 1e9;
+    waitpid(pid, NULL, 0);
+    printf("saturate: %.1f M events/s, %.1f events/batch, %.1f MB/s\n", count / seconds / 1e6,
+           (double)consumed / batches, count * sizeof(VREvent) / seconds / 1e6);
+    vr_bridge_close(consumer);
+    vr_bridge_unlink(BENCH_NAME);
+}
+
+static void bench_paced(int poll_ms, int per_frame, int seconds) {
+    uint64_t count = (uint64_t)per_frame * 90 * seconds;
+    VRBridge *consumer = vr_bridge_create(BENCH_NAME, 0);
+    uint64_t *lags = malloc(sizeof(uint64_t) * count);
+    if (consumer == NULL || lags == NULL) {
+        exit(1);
+    }
+    VREvent events[BATCH];
+    uint64_t consumed = 0, deadline = now_ns() + (uint64_t)(seconds + 2) * 1000000000ULL;
+    pid_t pid = spawn_producer(count, per_frame);
+    while (consumed < count && now_ns() < deadline) {
+        int n = vr_bridge_consume(consumer, events, BATCH);
+        if (n == 0) {
+            sleep_ns((uint64_t)poll_ms * 1000000);
+            continue;
+        }
+        uint64_t now = now_ns();
+        for (int i = 0; i < n; i++) {
+            lags[consumed++] = now - events[i].published_ns;
+        }
+    }
+    waitpid(pid, NULL, 0);
+    VRBridgeStats stats;
+    vr_bridge_stats(consumer, &stats);
+    qsort(lags, consumed, sizeof(uint64_t), compare_u64);
+    if (consumed > 0) {
+        printf("paced:    %d events/frame at 90 Hz, poll %d ms: lag p50 %.3f ms, p99 %.3f ms, max %.3f ms, "
+               "%llu dropped\n", per_frame, poll_ms, lags[consumed / 2] / 1e6, lags[consumed * 99 / 100] / 1e6,
+               lags[consumed - 1] / 1e6, (unsigned long long)stats.dropped);
+    }
+    free(lags);
+    vr_bridge_close(consumer);
+    vr_bridge_unlink(BENCH_NAME);
+}
+
+int main(int argc, char **argv) {
+    int poll_ms = argc > 1 ? atoi(argv[1]) : 10;
+    int per_frame = argc > 2 ? atoi(argv[2]) : 8;
+    int seconds = argc > 3 ? atoi(argv[3]) : 3;
+    if (per_frame < 1) per_frame = 1;
+
+    vr_bridge_unlink(BENCH_NAME);
+    bench_publish();
+    bench_saturate();
+    bench_paced(poll_ms, per_frame, seconds);
+    return 0;
+}
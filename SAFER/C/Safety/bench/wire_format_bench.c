@@ -0,0 +1,155 @@
+// wire_format_bench.c - JSON vs SRB1 request decoding for /api/radio-analysis
+//
+// The JSON path is what the handler does for application/json: parse the
+// body with json-c, pull each source's fields out with
+// json_object_object_get_ex, then analyze_radio_interference. The binary
+// path decodes an SRB1 body held in a 64-byte aligned buffer, as the
+// request body pool keeps it, and analyses its columns in place. The
+// last column is the difference between the two results; it is nonzero
+// only where the JSON path uses the path-loss table, and stays within
+// the table's error bound.
+//
+// Build from this directory:
+//   gcc -O2 -I.. wire_format_bench.c ../radio_wire.c ../radio_batch.c ../radio_interference.c
+//       ../path_loss_table.c ../propagation.c ../risk_rules.c ../safer.c ../registry.c ../arena.c
+//       -ljson-c -lm -lpthread -o wire_format_bench
+// Usage:
+//   wire_format_bench [sources...]
+#define _POSIX_C_SOURCE 200809L
+#include "radio_wire.h"
+#include <json-c/json.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static void make_sources(RadioSource *sources, int count) {
+    for (int i = 0; i < count; i++) {
+        sources[i] = (RadioSource){
+            .frequency = 225.0 + (i % 700) * 0.25, .power = 10.0 + i % 30,
+            .distance = 1.0 + (i % 50) * 0.5, .terrain_factor = (i % 5) * 0.5
+        };
+    }
+}
+
+static char *json_body(const RadioSource *sources, int count, size_t *length) {
+    size_t capacity = 128 + (size_t)count * 112;
+    char *body = malloc(capacity);
+    if (body == NULL) return NULL;
+    size_t used = snprintf(body, capacity, "{\"background_noise\":-100,\"sources\":[");
+    for (int i = 0; i < count; i++) {
+        used += snprintf(body + used, capacity - used,
+                         "%s{\"frequency\":%.17g,\"power\":%.17g,\"distance\":%.17g,\"terrain_factor\":%.17g}",
+                         i ? "," : "", sources[i].frequency, sources[i].power, sources[i].distance,
+                         sources[i].terrain_factor);
+    }
+    used += snprintf(body + used, capacity - used, "]}");
+    *length = used;
+    return body;
+}
+
+// Field extraction as in parse_radio_environment
+static RadioInterferenceAnalysis analyze_json(const char *body, size_t length, RadioSource *scratch) {
+    RadioInterferenceAnalysis analysis = {0};
+    json_tokener *tokener = json_tokener_new();
+    json_object *request = json_tokener_parse_ex(tokener, body, (int)length);
+    json_tokener_free(tokener);
+    if (request == NULL) return analysis;
+
+    RadioEnvironment env = {0};
+    json_object *field, *sources_array;
+    if (json_object_object_get_ex(request, "background_noise", &field)) {
+        env.background_noise = json_object_get_double(field);
+    }
+    if (json_object_object_get_ex(request, "sources", &sources_array)) {
+        env.num_sources = json_object_array_length(sources_array);
+        env.sources = scratch;
+        memset(scratch, 0, sizeof(RadioSource) * env.num_sources);
+        for (int i = 0; i < env.num_sources; i++) {
+            json_object *source = json_object_array_get_idx(sources_array, i);
+            if (json_object_object_get_ex(source, "frequency", &field)) {
+                scratch[i].frequency = json_object_get_double(field);
+            }
+            if (json_object_object_get_ex(source, "power", &field)) {
+                scratch[i].power = json_object_get_double(field);
+            }
+            if (json_object_object_get_ex(source, "distance", &field)) {
+                scratch[i].distance = json_object_get_double(field);
+            }
+            if (json_object_object_get_ex(source, "terrain_factor", &field)) {
+                scratch[i].terrain_factor = json_object_get_double(field);
+            }
+        }
+    }
+    analysis = analyze_radio_interference(&env);
+    json_object_put(request);
+    return analysis;
+}
+
+static RadioInterferenceAnalysis analyze_wire(const void *body, size_t length) {
+    RadioInterferenceAnalysis analysis = {0};
+    RadioWireRequest request;
+    if (radio_wire_decode_request(body, length, &request) == 0) {
+        analysis = analyze_radio_environment_batch(&request.env, &request.batch);
+        radio_wire_request_free(&request);
+    }
+    return analysis;
+}
+
+static void run(int count) {
+    RadioSource *sources = malloc(sizeof(RadioSource) * (count > 0 ? count : 1));
+    RadioSource *scratch = malloc(sizeof(RadioSource) * (count > 0 ? count : 1));
+    size_t json_length, wire_length = radio_wire_request_size(count);
+    void *wire = NULL;
+    if (sources == NULL || scratch == NULL || wire_length == 0 ||
+        posix_memalign(&wire, RADIO_WIRE_ALIGN, wire_length) != 0) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    make_sources(sources, count);
+    char *json = json_body(sources, count, &json_length);
+    RadioEnvironment env = { .sources = sources, .num_sources = count, .background_noise = -100 };
+    if (json == NULL || radio_wire_encode_request(&env, wire, wire_length) != 0) {
+        fprintf(stderr, "Encoding failed\n");
+        exit(1);
+    }
+
+    int iterations = count >= 100000 ? 20 : count >= 10000 ? 200 : 5000;
+    RadioInterferenceAnalysis json_result = {0}, wire_result = {0};
+    double start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        json_result = analyze_json(json, json_length, scratch);
+    }
+    double json_ns = (now_ns() - start) / iterations;
+    start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        wire_result = analyze_wire(wire, wire_length);
+    }
+    double wire_ns = (now_ns() - start) / iterations;
+
+    printf("%8d %12zu %12zu %12.1f %12.1f %8.1fx %12.3g\n", count, json_length, wire_length,
+           json_ns / 1000, wire_ns / 1000, json_ns / wire_ns,
+           json_result.interference_level - wire_result.interference_level);
+    free(json);
+    free(wire);
+    free(scratch);
+    free(sources);
+}
+
+int main(int argc, char **argv) {
+    int default_counts[] = {10, 100, 1000, 10000, 100000};
+    int num_counts = argc > 1 ? argc - 1 : (int)(sizeof(default_counts) / sizeof(default_counts[0]));
+
+    printf("%8s %12s %12s %12s %12s %9s %12s\n", "sources", "JSON bytes", "SRB1 bytes", "JSON us",
+           "SRB1 us", "speedup", "dBm delta");
+    for (int i = 0; i < num_counts; i++) {
+        run(argc > 1 ? atoi(argv[1 + i]) : default_counts[i]);
+    }
+    return 0;
+}
@@ -1,13 +1,73 @@
 // database.c - Database implementation
+#define _POSIX_C_SOURCE 200809L
 #include "database.h"
+#include "persistence.h"
+#include "read_pool.h"
+
+static int exec_sql(Database *db, const char *sql) {
+    char *err_msg = 0;
+    int rc = sqlite3_exec(db->db, sql, 0, 0, &err_msg);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", err_msg);
+        sqlite3_free(err_msg);
+    }
+    return rc;
+}
+
+static int prepare(Database *db, const char *sql, sqlite3_stmt **stmt) {
+    int rc = sqlite3_prepare_v3(db->db, sql, -1, SQLITE_PREPARE_PERSISTENT, stmt, NULL);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db->db));
+    }
+    return rc;
+}
+
+static int prepare_statements(Database *db) {
+    int rc;
+    if ((rc = prepare(db,
+            "INSERT OR REPLACE INTO aircraft (id, model, manufacture_date, total_flight_hours) "
+            "VALUES (?1, ?2, ?3, ?4)", &db->upsert_aircraft_stmt)) != SQLITE_OK ||
+        (rc = prepare(db,
+            "DELETE FROM maintenance_records WHERE aircraft_id = ?1",
+            &db->delete_maintenance_stmt)) != SQLITE_OK ||
+        (rc = prepare(db,
+            "INSERT INTO maintenance_records (aircraft_id, last_inspection, maintenance_due, reported_issues) "
+            "VALUES (?1, ?2, ?3, ?4)", &db->insert_maintenance_stmt)) != SQLITE_OK ||
+        (rc = prepare(db,
+            "INSERT OR REPLACE INTO crew_members (id, name, role, certification, flight_hours, last_training) "
+            "VALUES (?1, ?2, ?3, ?4, ?5, ?6)", &db->upsert_crew_stmt)) != SQLITE_OK ||
+        (rc = prepare(db,
+            "INSERT OR REPLACE INTO missions (id, aircraft_id, departure_time, estimated_duration, "
+            "mission_type, risk_level, temperature, visibility, wind_speed, precipitation) "
+            "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10)", &db->upsert_mission_stmt)) != SQLITE_OK ||
+        (rc = prepare(db,
+            "DELETE FROM mission_crew WHERE mission_id = ?1",
+            &db->delete_mission_crew_stmt)) != SQLITE_OK ||
+        (rc = prepare(db,
+            "INSERT OR IGNORE INTO mission_crew (mission_id, crew_id) VALUES (?1, ?2)",
+            &db->insert_mission_crew_stmt)) != SQLITE_OK) {
+        return rc;
+    }
+    return SQLITE_OK;
+}
 
 int init_database(Database *db) {
-    int rc = sqlite3_open("safer.db", &db->db);
+    int rc = sqlite3_open(db->path != NULL ? db->path : "safer.db", &db->db);
     if (rc) {
         fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db->db));
         return rc;
     }
     
+    // WAL lets readers proceed while the writer commits, and with
+    // synchronous=NORMAL a commit appends to the log without an fsync;
+    // durability points are set by the write-behind flush policy.
+    rc = exec_sql(db, "PRAGMA journal_mode=WAL;"
+                      "PRAGMA synchronous=NORMAL;"
+                      "PRAGMA foreign_keys=OFF;");
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    
     // Create tables
     const char *sql = 
         "CREATE TABLE IF NOT EXISTS aircraft ("
@@ -33,17 +93,505 @@ int init_database(Database *db) {
         "estimated_duration REAL,"
         "mission_type TEXT,"
         "risk_level INTEGER,"
+        "temperature REAL,"
+        "visibility REAL,"
+        "wind_speed REAL,"
+        "precipitation REAL,"
         "FOREIGN KEY(aircraft_id) REFERENCES aircraft(id)"
-        ");";
-    
-    char *err_msg = 0;
-    rc = sqlite3_exec(db->db, sql, 0, 0, &err_msg);
+        ");"
+        
+        // reported_issues holds the issue strings joined with '\n'
+        "CREATE TABLE IF NOT EXISTS maintenance_records ("
+        "id INTEGER PRIMARY KEY,"
+        "aircraft_id TEXT REFERENCES aircraft(id),"
+        "last_inspection INTEGER,"
+        "maintenance_due INTEGER,"
+        "reported_issues TEXT"
+        ");"
+        "CREATE INDEX IF NOT EXISTS maintenance_records_aircraft ON maintenance_records(aircraft_id);"
+        
+        "CREATE TABLE IF NOT EXISTS mission_crew ("
+        "mission_id TEXT REFERENCES missions(id),"
+        "crew_id TEXT REFERENCES crew_members(id),"
+        "PRIMARY KEY (mission_id, crew_id)"
+        ") WITHOUT ROWID;"
+        
+        // Every aircraft, crew member and mission write appends its id here,
+        // so a restored snapshot replays only what changed after its
+        // high-water mark. Maintenance records and crew lists are always
+        // written along with their aircraft or mission row.
+        "CREATE TABLE IF NOT EXISTS change_log ("
+        "seq INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "kind TEXT NOT NULL,"
+        "entity_id TEXT NOT NULL"
+        ");"
+        "CREATE TRIGGER IF NOT EXISTS aircraft_inserted AFTER INSERT ON aircraft BEGIN "
+        "INSERT INTO change_log (kind, entity_id) VALUES ('aircraft', NEW.id); END;"
+        "CREATE TRIGGER IF NOT EXISTS aircraft_updated AFTER UPDATE ON aircraft BEGIN "
+        "INSERT INTO change_log (kind, entity_id) VALUES ('aircraft', NEW.id); END;"
+        "CREATE TRIGGER IF NOT EXISTS crew_inserted AFTER INSERT ON crew_members BEGIN "
+        "INSERT INTO change_log (kind, entity_id) VALUES ('crew', NEW.id); END;"
+        "CREATE TRIGGER IF NOT EXISTS crew_updated AFTER UPDATE ON crew_members BEGIN "
+        "INSERT INTO change_log (kind, entity_id) VALUES ('crew', NEW.id); END;"
+        "CREATE TRIGGER IF NOT EXISTS mission_inserted AFTER INSERT ON missions BEGIN "
+        "INSERT INTO change_log (kind, entity_id) VALUES ('mission', NEW.id); END;"
+        "CREATE TRIGGER IF NOT EXISTS mission_updated AFTER UPDATE ON missions BEGIN "
+        "INSERT INTO change_log (kind, entity_id) VALUES ('mission', NEW.id); END;";
     
+    rc = exec_sql(db, sql);
     if (rc != SQLITE_OK) {
-        fprintf(stderr, "SQL error: %s\n", err_msg);
-        sqlite3_free(err_msg);
         return rc;
     }
     
+    return prepare_statements(db);
+}
+
+void close_database(Database *db) {
+    if (db->write_behind != NULL) {
+        write_behind_stop(db->write_behind);
+    }
+    if (db->read_pool != NULL) {
+        read_pool_close(db->read_pool);
+    }
+    sqlite3_finalize(db->upsert_aircraft_stmt);
+    sqlite3_finalize(db->delete_maintenance_stmt);
+    sqlite3_finalize(db->insert_maintenance_stmt);
+    sqlite3_finalize(db->upsert_crew_stmt);
+    sqlite3_finalize(db->upsert_mission_stmt);
+    sqlite3_finalize(db->delete_mission_crew_stmt);
+    sqlite3_finalize(db->insert_mission_crew_stmt);
+    sqlite3_close(db->db);
+    db->db = NULL;
+}
+
+static int step_and_reset(Database *db, sqlite3_stmt *stmt) {
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db->db));
+        return rc;
+    }
     return SQLITE_OK;
 }
+
+static void bind_id(sqlite3_stmt *stmt, int index, const char *id) {
+    // Ids are char[16] fields and may fill all 16 bytes without a terminator
+    sqlite3_bind_text(stmt, index, id, (int)strnlen(id, 16), SQLITE_STATIC);
+}
+
+static int write_maintenance_record(Database *db, const char *aircraft_id,
+                                    const MaintenanceRecord *record) {
+    sqlite3_stmt *stmt = db->insert_maintenance_stmt;
+    char local[512];
+    char *issues = local;
+    size_t length = 0;
+
+    for (int i = 0; i < record->num_issues; i++) {
+        length += strlen(record->reported_issues[i]) + 1;
+    }
+    if (length > sizeof(local)) {
+        issues = malloc(length);
+        if (issues == NULL) {
+            return SQLITE_NOMEM;
+        }
+    }
+    size_t offset = 0;
+    for (int i = 0; i < record->num_issues; i++) {
+        size_t n = strlen(record->reported_issues[i]);
+        memcpy(issues + offset, record->reported_issues[i], n);
+        offset += n;
+        if (i + 1 < record->num_issues) {
+            issues[offset++] = '\n';
+        }
+    }
+
+    bind_id(stmt, 1, aircraft_id);
+    sqlite3_bind_int64(stmt, 2, record->last_inspection);
+    sqlite3_bind_int64(stmt, 3, record->maintenance_due);
+    sqlite3_bind_text(stmt, 4, issues, (int)offset, SQLITE_STATIC);
+    int rc = step_and_reset(db, stmt);
+
+    if (issues != local) {
+        free(issues);
+    }
+    return rc;
+}
+
+int write_aircraft_row(Database *db, const Aircraft *aircraft) {
+    sqlite3_stmt *stmt = db->upsert_aircraft_stmt;
+    bind_id(stmt, 1, aircraft->id);
+    sqlite3_bind_text(stmt, 2, aircraft->model, (int)strnlen(aircraft->model, sizeof(aircraft->model)), SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 3, aircraft->manufacture_date);
+    sqlite3_bind_int(stmt, 4, aircraft->total_flight_hours);
+    int rc = step_and_reset(db, stmt);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+
+    // Maintenance history is replaced as a whole
+    bind_id(db->delete_maintenance_stmt, 1, aircraft->id);
+    rc = step_and_reset(db, db->delete_maintenance_stmt);
+    for (int i = 0; rc == SQLITE_OK && i < aircraft->num_records; i++) {
+        rc = write_maintenance_record(db, aircraft->id, &aircraft->maintenance_records[i]);
+    }
+    return rc;
+}
+
+int write_crew_member_row(Database *db, const CrewMember *crew) {
+    sqlite3_stmt *stmt = db->upsert_crew_stmt;
+    bind_id(stmt, 1, crew->id);
+    sqlite3_bind_text(stmt, 2, crew->name, (int)strnlen(crew->name, sizeof(crew->name)), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, crew->role, (int)strnlen(crew->role, sizeof(crew->role)), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, crew->certification,
+                      (int)strnlen(crew->certification, sizeof(crew->certification)), SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 5, crew->flight_hours);
+    sqlite3_bind_int64(stmt, 6, crew->last_training);
+    return step_and_reset(db, stmt);
+}
+
+int write_mission_row(Database *db, const Mission *mission, const char *aircraft_id,
+                      const char (*crew_ids)[16], int crew_size) {
+    sqlite3_stmt *stmt = db->upsert_mission_stmt;
+    bind_id(stmt, 1, mission->id);
+    if (aircraft_id != NULL && aircraft_id[0] != '\0') {
+        bind_id(stmt, 2, aircraft_id);
+    } else {
+        sqlite3_bind_null(stmt, 2);
+    }
+    sqlite3_bind_int64(stmt, 3, mission->departure_time);
+    sqlite3_bind_double(stmt, 4, mission->estimated_duration);
+    sqlite3_bind_text(stmt, 5, mission->mission_type,
+                      (int)strnlen(mission->mission_type, sizeof(mission->mission_type)), SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 6, mission->risk_level);
+    sqlite3_bind_double(stmt, 7, mission->weather.temperature);
+    sqlite3_bind_double(stmt, 8, mission->weather.visibility);
+    sqlite3_bind_double(stmt, 9, mission->weather.wind_speed);
+    sqlite3_bind_double(stmt, 10, mission->weather.precipitation);
+    int rc = step_and_reset(db, stmt);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+
+    bind_id(db->delete_mission_crew_stmt, 1, mission->id);
+    rc = step_and_reset(db, db->delete_mission_crew_stmt);
+    for (int i = 0; rc == SQLITE_OK && i < crew_size; i++) {
+        bind_id(db->insert_mission_crew_stmt, 1, mission->id);
+        bind_id(db->insert_mission_crew_stmt, 2, crew_ids[i]);
+        rc = step_and_reset(db, db->insert_mission_crew_stmt);
+    }
+    return rc;
+}
+
+// Synchronous saves: one transaction per call
+
+static int commit_or_rollback(Database *db, int rc) {
+    if (rc == SQLITE_OK) {
+        return exec_sql(db, "COMMIT");
+    }
+    exec_sql(db, "ROLLBACK");
+    return rc;
+}
+
+int save_aircraft(Database *db, Aircraft *aircraft) {
+    if (db->write_behind != NULL) {
+        return write_behind_save_aircraft(db->write_behind, aircraft);
+    }
+    int rc = exec_sql(db, "BEGIN");
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    return commit_or_rollback(db, write_aircraft_row(db, aircraft));
+}
+
+int save_crew_member(Database *db, CrewMember *crew) {
+    if (db->write_behind != NULL) {
+        return write_behind_save_crew_member(db->write_behind, crew);
+    }
+    return write_crew_member_row(db, crew);
+}
+
+int save_mission(Database *db, Mission *mission) {
+    if (db->write_behind != NULL) {
+        return write_behind_save_mission(db->write_behind, mission);
+    }
+
+    char crew_ids[8][16];
+    char (*ids)[16] = crew_ids;
+    if (mission->crew_size > 8) {
+        ids = malloc(sizeof(*ids) * mission->crew_size);
+        if (ids == NULL) {
+            return SQLITE_NOMEM;
+        }
+    }
+    int crew_size = 0;
+    for (int i = 0; i < mission->crew_size; i++) {
+        if (mission->crew[i] != NULL) {
+            memcpy(ids[crew_size++], mission->crew[i]->id, 16);
+        }
+    }
+
+    int rc = exec_sql(db, "BEGIN");
+    if (rc == SQLITE_OK) {
+        rc = write_mission_row(db, mission, mission->aircraft != NULL ? mission->aircraft->id : NULL,
+                               (const char (*)[16])ids, crew_size);
+        rc = commit_or_rollback(db, rc);
+    }
+
+    if (ids != crew_ids) {
+        free(ids);
+    }
+    return rc;
+}
+
+// Loads
+
+// Statement for a load query: cached on the calling thread's read connection
+// when the pool is open, otherwise prepared on the writer connection.
+static sqlite3_stmt *load_statement(Database *db, const char *sql, int *owned) {
+    sqlite3_stmt *stmt = NULL;
+    if (db->read_pool != NULL) {
+        *owned = 0;
+        return read_pool_statement(db->read_pool, sql);
+    }
+    *owned = 1;
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db->db));
+        return NULL;
+    }
+    return stmt;
+}
+
+static void finish_statement(sqlite3_stmt *stmt, int owned) {
+    if (owned) {
+        sqlite3_finalize(stmt);
+    } else {
+        read_pool_release(stmt);
+    }
+}
+
+static void copy_column(char *dst, size_t size, sqlite3_stmt *stmt, int column) {
+    const unsigned char *text = sqlite3_column_text(stmt, column);
+    memset(dst, 0, size);
+    if (text != NULL) {
+        strncpy(dst, (const char *)text, size - 1);
+    }
+}
+
+static void read_crew_member(CrewMember *crew, sqlite3_stmt *stmt, int first) {
+    copy_column(crew->id, sizeof(crew->id), stmt, first);
+    copy_column(crew->name, sizeof(crew->name), stmt, first + 1);
+    copy_column(crew->role, sizeof(crew->role), stmt, first + 2);
+    copy_column(crew->certification, sizeof(crew->certification), stmt, first + 3);
+    crew->flight_hours = sqlite3_column_int(stmt, first + 4);
+    crew->last_training = sqlite3_column_int64(stmt, first + 5);
+}
+
+CrewMember* load_crew_member(Database *db, const char *crew_id) {
+    int owned;
+    sqlite3_stmt *stmt = load_statement(db,
+        "SELECT id, name, role, certification, flight_hours, last_training "
+        "FROM crew_members WHERE id = ?1", &owned);
+    if (stmt == NULL) {
+        return NULL;
+    }
+    sqlite3_bind_text(stmt, 1, crew_id, -1, SQLITE_STATIC);
+
+    CrewMember *crew = NULL;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        crew = malloc(sizeof(CrewMember));
+        if (crew != NULL) {
+            read_crew_member(crew, stmt, 0);
+        }
+    }
+    finish_statement(stmt, owned);
+    return crew;
+}
+
+Aircraft* load_aircraft(Database *db, const char *aircraft_id) {
+    int owned, sizes_owned, records_owned;
+    sqlite3_stmt *stmt = load_statement(db,
+        "SELECT id, model, manufacture_date, total_flight_hours FROM aircraft WHERE id = ?1", &owned);
+    if (stmt == NULL) {
+        return NULL;
+    }
+    sqlite3_bind_text(stmt, 1, aircraft_id, -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        finish_statement(stmt, owned);
+        return NULL;
+    }
+
+    // Size the maintenance history so the aircraft is one allocation:
+    // Aircraft | MaintenanceRecord[n] | char *[issues] | issue text.
+    // length() of text counts characters; the copy needs UTF-8 bytes.
+    sqlite3_stmt *sizes = load_statement(db,
+        "SELECT count(*), total(length(CAST(reported_issues AS BLOB))), "
+        "total(length(reported_issues) - length(replace(reported_issues, char(10), '')) "
+        "+ (length(reported_issues) > 0)) "
+        "FROM maintenance_records WHERE aircraft_id = ?1", &sizes_owned);
+    if (sizes == NULL) {
+        finish_statement(stmt, owned);
+        return NULL;
+    }
+    sqlite3_bind_text(sizes, 1, aircraft_id, -1, SQLITE_STATIC);
+    int num_records = 0, num_issues = 0;
+    size_t text_size = 0;
+    if (sqlite3_step(sizes) == SQLITE_ROW) {
+        num_records = sqlite3_column_int(sizes, 0);
+        text_size = (size_t)sqlite3_column_double(sizes, 1);
+        num_issues = (int)sqlite3_column_double(sizes, 2);
+    }
+    finish_statement(sizes, sizes_owned);
+
+    size_t size = sizeof(Aircraft) + sizeof(MaintenanceRecord) * num_records +
+                  sizeof(char *) * num_issues + text_size + num_records;
+    Aircraft *aircraft = malloc(size);
+    if (aircraft == NULL) {
+        finish_statement(stmt, owned);
+        return NULL;
+    }
+    copy_column(aircraft->id, sizeof(aircraft->id), stmt, 0);
+    copy_column(aircraft->model, sizeof(aircraft->model), stmt, 1);
+    aircraft->manufacture_date = sqlite3_column_int64(stmt, 2);
+    aircraft->total_flight_hours = sqlite3_column_int(stmt, 3);
+    aircraft->maintenance_records = num_records > 0 ? (MaintenanceRecord *)(aircraft + 1) : NULL;
+    aircraft->num_records = 0;
+    finish_statement(stmt, owned);
+
+    if (num_records == 0) {
+        return aircraft;
+    }
+
+    sqlite3_stmt *records = load_statement(db,
+        "SELECT last_inspection, maintenance_due, reported_issues "
+        "FROM maintenance_records WHERE aircraft_id = ?1 ORDER BY id", &records_owned);
+    if (records == NULL) {
+        free(aircraft);
+        return NULL;
+    }
+    sqlite3_bind_text(records, 1, aircraft_id, -1, SQLITE_STATIC);
+
+    char **issue_slots = (char **)(aircraft->maintenance_records + num_records);
+    char *text = (char *)(issue_slots + num_issues);
+    char *text_end = text + text_size + num_records;
+    int issues_used = 0, overflow = 0;
+    size_t id_length = strnlen(aircraft->id, sizeof(aircraft->maintenance_records->aircraft_id) - 1);
+    // Rows added between the sizing query and this one are ignored; issue
+    // text that grew in between no longer fits and fails the load
+    while (!overflow && aircraft->num_records < num_records && sqlite3_step(records) == SQLITE_ROW) {
+        MaintenanceRecord *record = &aircraft->maintenance_records[aircraft->num_records++];
+        memset(record, 0, sizeof(*record));
+        memcpy(record->aircraft_id, aircraft->id, id_length);
+        record->aircraft_id[id_length] = '\0';
+        record->last_inspection = sqlite3_column_int64(records, 0);
+        record->maintenance_due = sqlite3_column_int64(records, 1);
+        record->reported_issues = issue_slots + issues_used;
+
+        const char *issues = (const char *)sqlite3_column_text(records, 2);
+        size_t length = (size_t)sqlite3_column_bytes(records, 2);
+        if (issues == NULL || length == 0) {
+            continue;
+        }
+        if (text + length + 1 > text_end) {
+            overflow = 1;
+            break;
+        }
+        memcpy(text, issues, length);
+        text[length] = '\0';
+        char *issue = text;
+        for (char *p = text; p <= text + length && !overflow; p++) {
+            if (*p == '\n' || *p == '\0') {
+                overflow = issues_used == num_issues;
+                *p = '\0';
+                if (!overflow) {
+                    issue_slots[issues_used++] = issue;
+                    record->num_issues++;
+                }
+                issue = p + 1;
+            }
+        }
+        text += length + 1;
+    }
+    finish_statement(records, records_owned);
+    if (overflow) {
+        fprintf(stderr, "Maintenance history of %s changed while loading\n", aircraft_id);
+        free(aircraft);
+        return NULL;
+    }
+    return aircraft;
+}
+
+Mission* load_mission(Database *db, const char *mission_id) {
+    int owned, count_owned, crew_owned;
+    sqlite3_stmt *stmt = load_statement(db,
+        "SELECT id, aircraft_id, departure_time, estimated_duration, mission_type, risk_level, "
+        "temperature, visibility, wind_speed, precipitation FROM missions WHERE id = ?1", &owned);
+    if (stmt == NULL) {
+        return NULL;
+    }
+    sqlite3_bind_text(stmt, 1, mission_id, -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        finish_statement(stmt, owned);
+        return NULL;
+    }
+
+    sqlite3_stmt *count = load_statement(db,
+        "SELECT count(*) FROM mission_crew WHERE mission_id = ?1", &count_owned);
+    if (count == NULL) {
+        finish_statement(stmt, owned);
+        return NULL;
+    }
+    sqlite3_bind_text(count, 1, mission_id, -1, SQLITE_STATIC);
+    int crew_size = sqlite3_step(count) == SQLITE_ROW ? sqlite3_column_int(count, 0) : 0;
+    finish_statement(count, count_owned);
+
+    // Mission | CrewMember *[n] | CrewMember[n]
+    Mission *mission = malloc(sizeof(Mission) + (sizeof(CrewMember *) + sizeof(CrewMember)) * crew_size);
+    if (mission == NULL) {
+        finish_statement(stmt, owned);
+        return NULL;
+    }
+    memset(mission, 0, sizeof(*mission));
+    copy_column(mission->id, sizeof(mission->id), stmt, 0);
+    char aircraft_id[16];
+    copy_column(aircraft_id, sizeof(aircraft_id), stmt, 1);
+    mission->departure_time = sqlite3_column_int64(stmt, 2);
+    mission->estimated_duration = (float)sqlite3_column_double(stmt, 3);
+    copy_column(mission->mission_type, sizeof(mission->mission_type), stmt, 4);
+    mission->risk_level = (RiskLevel)sqlite3_column_int(stmt, 5);
+    mission->weather.temperature = (float)sqlite3_column_double(stmt, 6);
+    mission->weather.visibility = (float)sqlite3_column_double(stmt, 7);
+    mission->weather.wind_speed = (float)sqlite3_column_double(stmt, 8);
+    mission->weather.precipitation = (float)sqlite3_column_double(stmt, 9);
+    finish_statement(stmt, owned);
+
+    if (crew_size > 0) {
+        CrewMember **crew = (CrewMember **)(mission + 1);
+        CrewMember *members = (CrewMember *)(crew + crew_size);
+        sqlite3_stmt *crew_stmt = load_statement(db,
+            "SELECT c.id, c.name, c.role, c.certification, c.flight_hours, c.last_training "
+            "FROM mission_crew mc JOIN crew_members c ON c.id = mc.crew_id "
+            "WHERE mc.mission_id = ?1", &crew_owned);
+        if (crew_stmt != NULL) {
+            sqlite3_bind_text(crew_stmt, 1, mission_id, -1, SQLITE_STATIC);
+            while (mission->crew_size < crew_size && sqlite3_step(crew_stmt) == SQLITE_ROW) {
+                read_crew_member(&members[mission->crew_size], crew_stmt, 0);
+                crew[mission->crew_size] = &members[mission->crew_size];
+                mission->crew_size++;
+            }
+            finish_statement(crew_stmt, crew_owned);
+        }
+        mission->crew = crew;
+    }
+
+    if (aircraft_id[0] != '\0') {
+        mission->aircraft = load_aircraft(db, aircraft_id);
+    }
+    return mission;
+}
+
+void free_mission(Mission *mission) {
+    if (mission != NULL) {
+        free(mission->aircraft);
+        free(mission);
+    }
+}
\ No newline at end of file
@@ -5,18 +5,49 @@
 #include "safer.h"
 #include <sqlite3.h>
 
+struct WriteBehind;
+struct ReadPool;
+
 typedef struct {
     sqlite3 *db;
     char *err_msg;
+    const char *path;              // Database file, "safer.db" when NULL
+    struct WriteBehind *write_behind; // Set while a write-behind queue owns the writer
+    struct ReadPool *read_pool;       // Per-thread read connections, see read_pool.h
+
+    // Cached prepared statements for the writer connection
+    sqlite3_stmt *upsert_aircraft_stmt;
+    sqlite3_stmt *delete_maintenance_stmt;
+    sqlite3_stmt *insert_maintenance_stmt;
+    sqlite3_stmt *upsert_crew_stmt;
+    sqlite3_stmt *upsert_mission_stmt;
+    sqlite3_stmt *delete_mission_crew_stmt;
+    sqlite3_stmt *insert_mission_crew_stmt;
 } Database;
 
 // Database function declarations
 int init_database(Database *db);
+void close_database(Database *db);
+
+// Saves are queued when a write-behind queue is running (see persistence.h),
+// otherwise each save runs in its own transaction.
 int save_mission(Database *db, Mission *mission);
 int save_aircraft(Database *db, Aircraft *aircraft);
 int save_crew_member(Database *db, CrewMember *crew);
+
+// Loads read through db->read_pool when open. Each returns a single
+// allocation released with free(), except load_mission whose aircraft is
+// loaded separately; release missions with free_mission().
 Mission* load_mission(Database *db, const char *mission_id);
 Aircraft* load_aircraft(Database *db, const char *aircraft_id);
 CrewMember* load_crew_member(Database *db, const char *crew_id);
+void free_mission(Mission *mission);
+
+// Row writers over the cached statements. They do not open transactions;
+// callers batch them between BEGIN and COMMIT.
+int write_aircraft_row(Database *db, const Aircraft *aircraft);
+int write_crew_member_row(Database *db, const CrewMember *crew);
+int write_mission_row(Database *db, const Mission *mission, const char *aircraft_id,
+                      const char (*crew_ids)[16], int crew_size);
 
 #endif // DATABASE_H
\ No newline at end of file
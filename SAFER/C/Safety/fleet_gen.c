@@ -0,0 +1,282 @@
+// fleet_gen.c - Synthetic fleet generator implementation
+#include "fleet_gen.h"
+#include <math.h>
+
+#define DAY (24 * 3600)
+#define MAX_MODEL_CREW 6
+
+typedef struct {
+    const char *name;
+    int weight;                     // Relative share of the fleet
+    int annual_hours;
+    int min_crew;
+    int max_crew;
+} ModelProfile;
+
+static const ModelProfile models[] = {
+    {"C-130J", 5, 600, 3, 5},
+    {"UH-60M", 6, 350, 2, 4},
+    {"F-35A", 4, 250, 1, 1},
+    {"KC-135R", 2, 450, 3, 3},
+    {"CH-47F", 2, 300, 3, 4},
+    {"A400M", 1, 550, 3, 4},
+};
+#define NUM_MODELS (int)(sizeof(models) / sizeof(models[0]))
+
+static const char *issue_catalog[] = {
+    "Hydraulic pressure fluctuation on system B",
+    "Bird strike inspection pending",
+    "Avionics fault code intermittent",
+    "Tire wear beyond limits, left main gear",
+    "Fuel quantity indication error",
+    "Cabin pressurisation slow to build",
+    "Engine 2 vibration above trend",
+    "Corrosion found on aft fuselage panel",
+    "Deferred: cockpit lighting dimmer inoperative",
+    "Radar altimeter erratic below 500 ft",
+};
+#define NUM_ISSUES (int)(sizeof(issue_catalog) / sizeof(issue_catalog[0]))
+
+static const char *roles[] = {"Pilot", "Co-Pilot", "Flight Engineer", "Loadmaster", "Crew Chief", "Navigator"};
+static const char *certifications[] = {"Junior", "Mid-Level", "Senior", "Instructor"};
+static const char *first_names[] = {"Alex", "Sam", "Jordan", "Taylor", "Morgan", "Casey", "Riley", "Jamie",
+                                    "Avery", "Quinn", "Robin", "Drew"};
+static const char *last_names[] = {"Nakamura", "Okafor", "Lindqvist", "Moreau", "Haddad", "Kowalski",
+                                   "Fernandes", "Brennan", "Castillo", "Novak", "Adeyemi", "Sato"};
+
+typedef struct {
+    const char *name;
+    float min_hours;
+    float max_hours;
+} MissionKind;
+
+static const MissionKind mission_kinds[] = {
+    {"Training", 1.0f, 3.0f},
+    {"Transport", 2.0f, 10.0f},
+    {"Patrol", 3.0f, 8.0f},
+    {"Reconnaissance", 2.0f, 6.0f},
+    {"Medevac", 0.5f, 3.0f},
+    {"Refuelling", 3.0f, 9.0f},
+};
+#define NUM_MISSION_KINDS (int)(sizeof(mission_kinds) / sizeof(mission_kinds[0]))
+
+// splitmix64: every seed gives a full-period, well mixed stream
+static uint64_t next_u64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, 1)
+static double next_unit(uint64_t *state) {
+    return (double)(next_u64(state) >> 11) / 9007199254740992.0;
+}
+
+static int next_below(uint64_t *state, int n) {
+    return (int)(next_unit(state) * n);
+}
+
+static double next_range(uint64_t *state, double low, double high) {
+    return low + next_unit(state) * (high - low);
+}
+
+static const ModelProfile *pick_model(uint64_t *rng) {
+    int total = 0;
+    for (int i = 0; i < NUM_MODELS; i++) {
+        total += models[i].weight;
+    }
+    int pick = next_below(rng, total);
+    for (int i = 0; i < NUM_MODELS; i++) {
+        if ((pick -= models[i].weight) < 0) {
+            return &models[i];
+        }
+    }
+    return &models[0];
+}
+
+static const ModelProfile *model_named(const char *name) {
+    for (int i = 0; i < NUM_MODELS; i++) {
+        if (strcmp(models[i].name, name) == 0) {
+            return &models[i];
+        }
+    }
+    return &models[0];
+}
+
+// Inspections every 30 to 120 days back from the latest, which is usually
+// recent but overdue on about one airframe in ten. Open issues sit on the
+// latest record only; older ones were signed off.
+static int generate_aircraft(FleetRegistry *reg, uint64_t *rng, int index, const FleetGenConfig *config,
+                             MaintenanceRecord *records, Aircraft **registered, FleetGenStats *stats) {
+    const ModelProfile *model = pick_model(rng);
+    Aircraft aircraft = {0};
+    snprintf(aircraft.id, sizeof(aircraft.id), "A%06d", index);
+    snprintf(aircraft.model, sizeof(aircraft.model), "%s", model->name);
+    double age_years = next_range(rng, 1, 30);
+    aircraft.manufacture_date = config->now - (time_t)(age_years * 365 * DAY);
+    aircraft.total_flight_hours = (int)(age_years * model->annual_hours * next_range(rng, 0.7, 1.3));
+
+    const char *issues[3];
+    int num_records = 1 + next_below(rng, config->max_records);
+    double days_ago = next_unit(rng) < 0.9 ? next_range(rng, 0, 90) : next_range(rng, 90, 240);
+    for (int r = 0; r < num_records; r++) {
+        MaintenanceRecord *record = &records[r];
+        memset(record, 0, sizeof(*record));
+        memcpy(record->aircraft_id, aircraft.id, sizeof(record->aircraft_id));
+        double interval = next_range(rng, 30, 120);
+        record->last_inspection = config->now - (time_t)(days_ago * DAY);
+        record->maintenance_due = record->last_inspection + (time_t)(interval * DAY);
+        days_ago += interval;
+    }
+    if (next_unit(rng) < 0.25) {
+        records[0].num_issues = 1 + next_below(rng, 3);
+        for (int i = 0; i < records[0].num_issues; i++) {
+            issues[i] = issue_catalog[next_below(rng, NUM_ISSUES)];
+        }
+        records[0].reported_issues = (char **)issues;
+    }
+    aircraft.maintenance_records = records;
+    aircraft.num_records = num_records;
+
+    *registered = registry_add_aircraft(reg, &aircraft);
+    if (*registered == NULL) {
+        return -1;
+    }
+    stats->num_aircraft++;
+    stats->num_records += num_records;
+    stats->num_issues += records[0].num_issues;
+    return 0;
+}
+
+// Hours are log-uniform from 50 to 6000, so juniors are common and
+// certification follows experience. Training is recent for most and
+// lapsed past 180 days for a few.
+static int generate_crew(FleetRegistry *reg, uint64_t *rng, int index, const FleetGenConfig *config,
+                         CrewMember **registered, FleetGenStats *stats) {
+    CrewMember crew = {0};
+    snprintf(crew.id, sizeof(crew.id), "C%06d", index);
+    snprintf(crew.name, sizeof(crew.name), "%s %s",
+             first_names[next_below(rng, (int)(sizeof(first_names) / sizeof(first_names[0])))],
+             last_names[next_below(rng, (int)(sizeof(last_names) / sizeof(last_names[0])))]);
+    snprintf(crew.role, sizeof(crew.role), "%s", roles[next_below(rng, (int)(sizeof(roles) / sizeof(roles[0])))]);
+    crew.flight_hours = (int)exp(next_range(rng, log(50), log(6000)));
+    int level = crew.flight_hours < 300 ? 0 : crew.flight_hours < 1500 ? 1 : crew.flight_hours < 4000 ? 2 : 3;
+    snprintf(crew.certification, sizeof(crew.certification), "%s", certifications[level]);
+    double days_ago = next_unit(rng) < 0.92 ? next_range(rng, 0, 170) : next_range(rng, 180, 400);
+    crew.last_training = config->now - (time_t)(days_ago * DAY);
+
+    *registered = registry_add_crew_member(reg, &crew);
+    if (*registered == NULL) {
+        return -1;
+    }
+    stats->num_crew++;
+    return 0;
+}
+
+// Weather for one day: mostly fair, with a front now and then that brings
+// low visibility, wind and rain together
+static WeatherCondition day_weather(uint64_t *rng, double severity) {
+    WeatherCondition weather;
+    weather.visibility = (float)fmax(200, 10000 * (1 - severity) * next_range(rng, 0.8, 1.1));
+    weather.wind_speed = (float)(5 + 55 * severity * next_range(rng, 0.6, 1.2));
+    weather.precipitation = (float)(severity > 0.5 ? (severity - 0.5) * 40 * next_unit(rng) : 0);
+    weather.temperature = (float)next_range(rng, -10, 35);
+    return weather;
+}
+
+static int generate_mission(FleetRegistry *reg, uint64_t *rng, int index, const FleetGenConfig *config,
+                            const double *fronts, Aircraft **fleet, int num_aircraft,
+                            CrewMember **roster, int num_crew, FleetGenStats *stats) {
+    Mission mission = {0};
+    snprintf(mission.id, sizeof(mission.id), "M%07d", index);
+    const MissionKind *kind = &mission_kinds[next_below(rng, NUM_MISSION_KINDS)];
+    snprintf(mission.mission_type, sizeof(mission.mission_type), "%s", kind->name);
+    mission.estimated_duration = (float)next_range(rng, kind->min_hours, kind->max_hours);
+
+    int day = next_below(rng, config->schedule_days);
+    mission.departure_time = config->now + (time_t)day * DAY + (time_t)next_below(rng, DAY);
+    mission.weather = day_weather(rng, fronts[day]);
+
+    CrewMember *crew[MAX_MODEL_CREW];
+    if (num_aircraft > 0) {
+        mission.aircraft = fleet[next_below(rng, num_aircraft)];
+        const ModelProfile *model = model_named(mission.aircraft->model);
+        int wanted = model->min_crew + next_below(rng, model->max_crew - model->min_crew + 1);
+        if (wanted > num_crew) {
+            wanted = num_crew;
+        }
+        // Distinct members; the roster is far larger than a crew
+        while (mission.crew_size < wanted) {
+            CrewMember *member = roster[next_below(rng, num_crew)];
+            int taken = 0;
+            for (int i = 0; i < mission.crew_size; i++) {
+                taken |= crew[i] == member;
+            }
+            if (!taken) {
+                crew[mission.crew_size++] = member;
+            }
+        }
+        mission.crew = mission.crew_size > 0 ? crew : NULL;
+    }
+
+    if (registry_add_mission(reg, &mission) == NULL) {
+        return -1;
+    }
+    stats->num_missions++;
+    stats->num_mission_crew += mission.crew_size;
+    return 0;
+}
+
+int fleet_generate(FleetRegistry *reg, const FleetGenConfig *config, FleetGenStats *stats) {
+    FleetGenConfig c = config != NULL ? *config : (FleetGenConfig){0};
+    if (c.seed == 0) c.seed = 1;
+    if (c.num_aircraft <= 0) c.num_aircraft = 100;
+    if (c.num_crew <= 0) c.num_crew = c.num_aircraft * 4;
+    if (c.num_missions <= 0) c.num_missions = c.num_aircraft * 10;
+    if (c.max_records <= 0) c.max_records = 8;
+    if (c.schedule_days <= 0) c.schedule_days = 30;
+    if (c.now == 0) c.now = time(NULL);
+
+    FleetGenStats local;
+    if (stats == NULL) {
+        stats = &local;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    Aircraft **fleet = malloc(sizeof(Aircraft *) * c.num_aircraft);
+    CrewMember **roster = malloc(sizeof(CrewMember *) * c.num_crew);
+    MaintenanceRecord *records = malloc(sizeof(MaintenanceRecord) * c.max_records);
+    double *fronts = malloc(sizeof(double) * c.schedule_days);
+    int rc = fleet == NULL || roster == NULL || records == NULL || fronts == NULL ? -1 : 0;
+    if (rc == 0) {
+        rc = registry_reserve(reg, reg->aircraft.count + c.num_aircraft, reg->crew.count + c.num_crew,
+                              reg->missions.count + c.num_missions);
+    }
+
+    uint64_t aircraft_rng = c.seed ^ 0xA1C0000000000001ULL;
+    uint64_t crew_rng = c.seed ^ 0xC4E0000000000002ULL;
+    uint64_t mission_rng = c.seed ^ 0x3155000000000003ULL;
+    for (int i = 0; rc == 0 && i < c.num_aircraft; i++) {
+        rc = generate_aircraft(reg, &aircraft_rng, i, &c, records, &fleet[i], stats);
+    }
+    for (int i = 0; rc == 0 && i < c.num_crew; i++) {
+        rc = generate_crew(reg, &crew_rng, i, &c, &roster[i], stats);
+    }
+    if (rc == 0) {
+        // Squaring skews days towards fair weather
+        for (int d = 0; d < c.schedule_days; d++) {
+            double u = next_unit(&mission_rng);
+            fronts[d] = u * u;
+        }
+    }
+    for (int i = 0; rc == 0 && i < c.num_missions; i++) {
+        rc = generate_mission(reg, &mission_rng, i, &c, fronts, fleet, c.num_aircraft, roster, c.num_crew, stats);
+    }
+
+    free(fleet);
+    free(roster);
+    free(records);
+    free(fronts);
+    return rc;
+}
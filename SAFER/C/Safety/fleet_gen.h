@@ -0,0 +1,39 @@
+// fleet_gen.h - Deterministic synthetic fleets for load tests and sizing
+#ifndef FLEET_GEN_H
+#define FLEET_GEN_H
+
+#include "safer.h"
+#include "registry.h"
+#include <stdint.h>
+
+// Zero fields take the defaults noted
+typedef struct {
+    uint64_t seed;                  // Same seed and sizes, same fleet (default 1)
+    int num_aircraft;               // default 100
+    int num_crew;                   // default 4 per aircraft
+    int num_missions;               // default 10 per aircraft
+    int max_records;                // Inspection history per aircraft, 1 to this (default 8)
+    int schedule_days;              // Missions depart over this many days from now (default 30)
+    time_t now;                     // Dates are relative to this (default: time(NULL))
+} FleetGenConfig;
+
+typedef struct {
+    int num_aircraft;
+    int num_records;
+    int num_issues;
+    int num_crew;
+    int num_missions;
+    int num_mission_crew;
+} FleetGenStats;
+
+// Add a fleet to reg: aircraft of a handful of models with inspection
+// histories, newest first, and open issues on some; crew whose roles,
+// hours and training dates vary; missions crewed from the roster for the
+// model flown, under weather fronts that change day to day. Aircraft, crew
+// and missions draw from separate streams of the seed, so growing one
+// count leaves the others' entities unchanged. Ids are A%06d, C%06d and
+// M%07d. stats may be NULL. Returns 0, or -1 when the registry runs out
+// of memory.
+int fleet_generate(FleetRegistry *reg, const FleetGenConfig *config, FleetGenStats *stats);
+
+#endif // FLEET_GEN_H
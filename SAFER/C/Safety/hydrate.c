@@ -0,0 +1,449 @@
+// hydrate.c - Bulk registry load implementation
+#define _POSIX_C_SOURCE 200809L
+#include "hydrate.h"
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void copy_column(char *dst, size_t size, sqlite3_stmt *stmt, int column) {
+    const unsigned char *text = sqlite3_column_text(stmt, column);
+    memset(dst, 0, size);
+    if (text != NULL) {
+        strncpy(dst, (const char *)text, size - 1);
+    }
+}
+
+// The whole table when since < 0, otherwise only rows whose key column
+// names an entity of this kind logged in change_log after since
+static sqlite3_stmt *prepare_scan(sqlite3 *conn, const char *select, const char *key,
+                                  const char *kind, const char *order, int64_t since) {
+    char sql[512];
+    if (since < 0) {
+        snprintf(sql, sizeof(sql), "%s%s", select, order);
+    } else {
+        snprintf(sql, sizeof(sql),
+                 "%s WHERE %s IN (SELECT entity_id FROM change_log WHERE kind = '%s' AND seq > ?1)%s",
+                 select, key, kind, order);
+    }
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_prepare_v2(conn, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare scan: %s\n", sqlite3_errmsg(conn));
+        return NULL;
+    }
+    if (since >= 0) {
+        sqlite3_bind_int64(stmt, 1, since);
+    }
+    return stmt;
+}
+
+static int finish_scan(sqlite3 *conn, sqlite3_stmt *stmt, int rc) {
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Scan failed: %s\n", sqlite3_errmsg(conn));
+        return rc;
+    }
+    return SQLITE_OK;
+}
+
+static int scan_aircraft(sqlite3 *conn, FleetRegistry *reg, HydrateStats *stats, int64_t since) {
+    sqlite3_stmt *stmt = prepare_scan(conn,
+        "SELECT id, model, manufacture_date, total_flight_hours FROM aircraft",
+        "id", "aircraft", "", since);
+    if (stmt == NULL) {
+        return SQLITE_ERROR;
+    }
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        Aircraft aircraft = {0};
+        copy_column(aircraft.id, sizeof(aircraft.id), stmt, 0);
+        copy_column(aircraft.model, sizeof(aircraft.model), stmt, 1);
+        aircraft.manufacture_date = sqlite3_column_int64(stmt, 2);
+        aircraft.total_flight_hours = sqlite3_column_int(stmt, 3);
+        if (registry_add_aircraft(reg, &aircraft) == NULL) {
+            rc = SQLITE_NOMEM;
+            break;
+        }
+        stats->num_aircraft++;
+    }
+    return finish_scan(conn, stmt, rc);
+}
+
+// Maintenance rows for one aircraft, gathered before handing them to the
+// registry. Issue text is kept as offsets into `text` until the flush.
+typedef struct {
+    MaintenanceRecord *records;
+    int num_records;
+    int records_capacity;
+    size_t *issue_offsets;
+    int num_issues;
+    int issues_capacity;
+    char **issue_ptrs;
+    char *text;
+    size_t text_used;
+    size_t text_capacity;
+} MaintenanceGroup;
+
+static int grow(void **array, int *capacity, int needed, size_t elem_size) {
+    if (needed <= *capacity) {
+        return 0;
+    }
+    int new_capacity = *capacity ? *capacity : 16;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    void *grown = realloc(*array, elem_size * new_capacity);
+    if (grown == NULL) {
+        return -1;
+    }
+    *array = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+static int group_add_row(MaintenanceGroup *group, sqlite3_stmt *stmt) {
+    if (grow((void **)&group->records, &group->records_capacity,
+             group->num_records + 1, sizeof(MaintenanceRecord)) != 0) {
+        return -1;
+    }
+    MaintenanceRecord *record = &group->records[group->num_records++];
+    memset(record, 0, sizeof(*record));
+    copy_column(record->aircraft_id, sizeof(record->aircraft_id), stmt, 0);
+    record->last_inspection = sqlite3_column_int64(stmt, 1);
+    record->maintenance_due = sqlite3_column_int64(stmt, 2);
+
+    const char *issues = (const char *)sqlite3_column_text(stmt, 3);
+    size_t length = (size_t)sqlite3_column_bytes(stmt, 3);
+    if (issues == NULL || length == 0) {
+        return 0;
+    }
+    while (group->text_used + length + 1 > group->text_capacity) {
+        size_t capacity = group->text_capacity ? group->text_capacity * 2 : 4096;
+        char *grown = realloc(group->text, capacity);
+        if (grown == NULL) {
+            return -1;
+        }
+        group->text = grown;
+        group->text_capacity = capacity;
+    }
+
+    // reported_issues is stored '\n'-joined; split it in place
+    char *text = group->text + group->text_used;
+    memcpy(text, issues, length);
+    text[length] = '\0';
+    size_t start = group->text_used;
+    for (size_t i = 0; i <= length; i++) {
+        if (text[i] == '\n' || text[i] == '\0') {
+            text[i] = '\0';
+            if (grow((void **)&group->issue_offsets, &group->issues_capacity,
+                     group->num_issues + 1, sizeof(size_t)) != 0) {
+                return -1;
+            }
+            group->issue_offsets[group->num_issues++] = start;
+            record->num_issues++;
+            start = group->text_used + i + 1;
+        }
+    }
+    group->text_used += length + 1;
+    return 0;
+}
+
+static int group_flush(MaintenanceGroup *group, FleetRegistry *reg, HydrateStats *stats) {
+    if (group->num_records == 0) {
+        return 0;
+    }
+    int ptrs_capacity = group->issues_capacity;
+    group->issue_ptrs = realloc(group->issue_ptrs, sizeof(char *) * (ptrs_capacity ? ptrs_capacity : 1));
+    if (group->issue_ptrs == NULL) {
+        return -1;
+    }
+    int next_issue = 0;
+    for (int i = 0; i < group->num_records; i++) {
+        MaintenanceRecord *record = &group->records[i];
+        record->reported_issues = group->issue_ptrs + next_issue;
+        for (int j = 0; j < record->num_issues; j++) {
+            group->issue_ptrs[next_issue] = group->text + group->issue_offsets[next_issue];
+            next_issue++;
+        }
+    }
+
+    Aircraft *aircraft = registry_find_aircraft(reg, group->records[0].aircraft_id);
+    if (aircraft == NULL) {
+        stats->unresolved_references += group->num_records;
+    } else {
+        // Re-adding copies the history into the arena next to the aircraft
+        Aircraft updated = *aircraft;
+        updated.maintenance_records = group->records;
+        updated.num_records = group->num_records;
+        if (registry_add_aircraft(reg, &updated) == NULL) {
+            return -1;
+        }
+        stats->num_maintenance_records += group->num_records;
+    }
+
+    group->num_records = 0;
+    group->num_issues = 0;
+    group->text_used = 0;
+    return 0;
+}
+
+static int scan_maintenance_records(sqlite3 *conn, FleetRegistry *reg, HydrateStats *stats, int64_t since) {
+    sqlite3_stmt *stmt = prepare_scan(conn,
+        "SELECT aircraft_id, last_inspection, maintenance_due, reported_issues FROM maintenance_records",
+        "aircraft_id", "aircraft", " ORDER BY aircraft_id, id", since);
+    if (stmt == NULL) {
+        return SQLITE_ERROR;
+    }
+
+    MaintenanceGroup group = {0};
+    char current[16] = {0};
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        char aircraft_id[16];
+        copy_column(aircraft_id, sizeof(aircraft_id), stmt, 0);
+        if (memcmp(aircraft_id, current, sizeof(current)) != 0) {
+            if (group_flush(&group, reg, stats) != 0) {
+                rc = SQLITE_NOMEM;
+                break;
+            }
+            memcpy(current, aircraft_id, sizeof(current));
+        }
+        if (group_add_row(&group, stmt) != 0) {
+            rc = SQLITE_NOMEM;
+            break;
+        }
+    }
+    if (rc == SQLITE_DONE && group_flush(&group, reg, stats) != 0) {
+        rc = SQLITE_NOMEM;
+    }
+
+    free(group.records);
+    free(group.issue_offsets);
+    free(group.issue_ptrs);
+    free(group.text);
+    return finish_scan(conn, stmt, rc);
+}
+
+static int scan_crew(sqlite3 *conn, FleetRegistry *reg, HydrateStats *stats, int64_t since) {
+    sqlite3_stmt *stmt = prepare_scan(conn,
+        "SELECT id, name, role, certification, flight_hours, last_training FROM crew_members",
+        "id", "crew", "", since);
+    if (stmt == NULL) {
+        return SQLITE_ERROR;
+    }
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        CrewMember crew;
+        copy_column(crew.id, sizeof(crew.id), stmt, 0);
+        copy_column(crew.name, sizeof(crew.name), stmt, 1);
+        copy_column(crew.role, sizeof(crew.role), stmt, 2);
+        copy_column(crew.certification, sizeof(crew.certification), stmt, 3);
+        crew.flight_hours = sqlite3_column_int(stmt, 4);
+        crew.last_training = sqlite3_column_int64(stmt, 5);
+        if (registry_add_crew_member(reg, &crew) == NULL) {
+            rc = SQLITE_NOMEM;
+            break;
+        }
+        stats->num_crew++;
+    }
+    return finish_scan(conn, stmt, rc);
+}
+
+static int scan_missions(sqlite3 *conn, FleetRegistry *reg, HydrateStats *stats, int64_t since) {
+    sqlite3_stmt *stmt = prepare_scan(conn,
+        "SELECT id, aircraft_id, departure_time, estimated_duration, mission_type, risk_level, "
+        "temperature, visibility, wind_speed, precipitation FROM missions",
+        "id", "mission", "", since);
+    if (stmt == NULL) {
+        return SQLITE_ERROR;
+    }
+
+    char last_aircraft_id[16] = {0};
+    Aircraft *last_aircraft = NULL;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        Mission mission = {0};
+        copy_column(mission.id, sizeof(mission.id), stmt, 0);
+
+        char aircraft_id[16];
+        copy_column(aircraft_id, sizeof(aircraft_id), stmt, 1);
+        if (aircraft_id[0] != '\0') {
+            // Schedules tend to repeat the same airframe back to back
+            if (last_aircraft == NULL || memcmp(aircraft_id, last_aircraft_id, 16) != 0) {
+                last_aircraft = registry_find_aircraft_id(reg, safer_id_load(aircraft_id));
+                memcpy(last_aircraft_id, aircraft_id, 16);
+            }
+            mission.aircraft = last_aircraft;
+            if (last_aircraft == NULL) {
+                stats->unresolved_references++;
+            }
+        }
+
+        mission.departure_time = sqlite3_column_int64(stmt, 2);
+        mission.estimated_duration = (float)sqlite3_column_double(stmt, 3);
+        copy_column(mission.mission_type, sizeof(mission.mission_type), stmt, 4);
+        mission.risk_level = (RiskLevel)sqlite3_column_int(stmt, 5);
+        mission.weather.temperature = (float)sqlite3_column_double(stmt, 6);
+        mission.weather.visibility = (float)sqlite3_column_double(stmt, 7);
+        mission.weather.wind_speed = (float)sqlite3_column_double(stmt, 8);
+        mission.weather.precipitation = (float)sqlite3_column_double(stmt, 9);
+        if (registry_add_mission(reg, &mission) == NULL) {
+            rc = SQLITE_NOMEM;
+            break;
+        }
+        stats->num_missions++;
+    }
+    return finish_scan(conn, stmt, rc);
+}
+
+static int scan_mission_crew(sqlite3 *conn, FleetRegistry *reg, HydrateStats *stats, int64_t since) {
+    // mission_crew is clustered on (mission_id, crew_id), so this is a plain
+    // table walk that yields each mission's crew contiguously
+    sqlite3_stmt *stmt = prepare_scan(conn, "SELECT mission_id, crew_id FROM mission_crew",
+                                      "mission_id", "mission", " ORDER BY mission_id", since);
+    if (stmt == NULL) {
+        return SQLITE_ERROR;
+    }
+
+    CrewMember **crew = NULL;
+    int crew_size = 0, crew_capacity = 0;
+    Mission *mission = NULL;
+    char current[16] = {0};
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        char mission_id[16], crew_id[16];
+        copy_column(mission_id, sizeof(mission_id), stmt, 0);
+        copy_column(crew_id, sizeof(crew_id), stmt, 1);
+
+        if (memcmp(mission_id, current, sizeof(current)) != 0) {
+            if (mission != NULL && registry_set_mission_crew(reg, mission, crew, crew_size) != 0) {
+                rc = SQLITE_NOMEM;
+                break;
+            }
+            memcpy(current, mission_id, sizeof(current));
+            mission = registry_find_mission_id(reg, safer_id_load(mission_id));
+            crew_size = 0;
+        }
+
+        CrewMember *member = registry_find_crew_member_id(reg, safer_id_load(crew_id));
+        if (mission == NULL || member == NULL) {
+            stats->unresolved_references++;
+            continue;
+        }
+        if (grow((void **)&crew, &crew_capacity, crew_size + 1, sizeof(CrewMember *)) != 0) {
+            rc = SQLITE_NOMEM;
+            break;
+        }
+        crew[crew_size++] = member;
+        stats->num_mission_crew++;
+    }
+    if (rc == SQLITE_DONE && mission != NULL &&
+        registry_set_mission_crew(reg, mission, crew, crew_size) != 0) {
+        rc = SQLITE_NOMEM;
+    }
+    free(crew);
+    return finish_scan(conn, stmt, rc);
+}
+
+// Size the registry for a full load, so filling it never rehashes an index
+static int reserve_rows(sqlite3 *conn, FleetRegistry *reg) {
+    sqlite3_stmt *stmt = NULL;
+    int rc = sqlite3_prepare_v2(conn,
+        "SELECT (SELECT COUNT(*) FROM aircraft), (SELECT COUNT(*) FROM crew_members), "
+        "(SELECT COUNT(*) FROM missions)", -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Failed to count rows: %s\n", sqlite3_errmsg(conn));
+        return rc;
+    }
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        sqlite3_int64 aircraft = reg->aircraft.count + sqlite3_column_int64(stmt, 0);
+        sqlite3_int64 crew = reg->crew.count + sqlite3_column_int64(stmt, 1);
+        sqlite3_int64 missions = reg->missions.count + sqlite3_column_int64(stmt, 2);
+        rc = aircraft > INT32_MAX || crew > INT32_MAX || missions > INT32_MAX ||
+             registry_reserve(reg, (int)aircraft, (int)crew, (int)missions) != 0 ? SQLITE_NOMEM : SQLITE_OK;
+    }
+    sqlite3_finalize(stmt);
+    return rc;
+}
+
+// Last change_log seq ever issued, and the last one no longer in the log
+static int read_change_log(sqlite3 *conn, int64_t *last_seq, int64_t *pruned_through) {
+    sqlite3_stmt *stmt = NULL;
+    int rc = sqlite3_prepare_v2(conn,
+        "SELECT COALESCE((SELECT seq FROM sqlite_sequence WHERE name = 'change_log'), 0), "
+        "(SELECT MIN(seq) - 1 FROM change_log)", -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Failed to read change log: %s\n", sqlite3_errmsg(conn));
+        return rc;
+    }
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        *last_seq = sqlite3_column_int64(stmt, 0);
+        // An empty log has been pruned through everything issued
+        *pruned_through = sqlite3_column_type(stmt, 1) == SQLITE_NULL ? *last_seq : sqlite3_column_int64(stmt, 1);
+        rc = SQLITE_OK;
+    }
+    sqlite3_finalize(stmt);
+    return rc;
+}
+
+static int load(Database *db, FleetRegistry *reg, int64_t since, HydrateStats *stats) {
+    HydrateStats local;
+    if (stats == NULL) {
+        stats = &local;
+    }
+    memset(stats, 0, sizeof(*stats));
+    double started = now_ms();
+
+    sqlite3 *conn = NULL;
+    int rc = sqlite3_open_v2(db->path != NULL ? db->path : "safer.db", &conn,
+                             SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, NULL);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Cannot open database for hydrate: %s\n", sqlite3_errmsg(conn));
+        sqlite3_close(conn);
+        return rc;
+    }
+    // One snapshot for all scans so references are consistent, and the
+    // change log read first so every change it counts is in the scans
+    int64_t pruned_through = 0;
+    rc = sqlite3_exec(conn, "BEGIN", 0, 0, NULL);
+    if (rc == SQLITE_OK) rc = read_change_log(conn, &stats->high_water_mark, &pruned_through);
+    if (rc == SQLITE_OK && since >= 0 && (since < pruned_through || since > stats->high_water_mark)) {
+        // Changes after since were pruned, or since is from another database
+        fprintf(stderr, "Change log cannot replay from %lld (pruned through %lld, last %lld)\n",
+                (long long)since, (long long)pruned_through, (long long)stats->high_water_mark);
+        rc = SQLITE_NOTFOUND;
+    }
+
+    if (rc == SQLITE_OK && since < 0) rc = reserve_rows(conn, reg);
+
+    double phase = now_ms();
+    if (rc == SQLITE_OK) rc = scan_aircraft(conn, reg, stats, since);
+    if (rc == SQLITE_OK) rc = scan_maintenance_records(conn, reg, stats, since);
+    stats->aircraft_ms = now_ms() - phase;
+
+    phase = now_ms();
+    if (rc == SQLITE_OK) rc = scan_crew(conn, reg, stats, since);
+    stats->crew_ms = now_ms() - phase;
+
+    phase = now_ms();
+    if (rc == SQLITE_OK) rc = scan_missions(conn, reg, stats, since);
+    if (rc == SQLITE_OK) rc = scan_mission_crew(conn, reg, stats, since);
+    stats->missions_ms = now_ms() - phase;
+
+    sqlite3_exec(conn, "COMMIT", 0, 0, NULL);
+    sqlite3_close(conn);
+    stats->total_ms = now_ms() - started;
+    return rc;
+}
+
+int hydrate_registry(Database *db, FleetRegistry *reg, HydrateStats *stats) {
+    return load(db, reg, -1, stats);
+}
+
+int hydrate_registry_changes(Database *db, FleetRegistry *reg, int64_t since, HydrateStats *stats) {
+    return load(db, reg, since, stats);
+}
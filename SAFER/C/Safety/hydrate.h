@@ -0,0 +1,34 @@
+// hydrate.h - Bulk load of the SQLite tables into a FleetRegistry
+#ifndef HYDRATE_H
+#define HYDRATE_H
+
+#include "database.h"
+#include "registry.h"
+
+typedef struct {
+    int num_aircraft;
+    int num_maintenance_records;
+    int num_crew;
+    int num_missions;
+    int num_mission_crew;
+    int unresolved_references; // Rows naming an aircraft, crew member or mission not loaded
+    int64_t high_water_mark;   // Last change_log seq the load reflects
+    double aircraft_ms;
+    double crew_ms;
+    double missions_ms;
+    double total_ms;
+} HydrateStats;
+
+// Populate reg from db with one sequential scan per table inside a single
+// read transaction, resolving aircraft and crew references in memory.
+// Uses its own read-only connection, so it can run while a write-behind
+// queue owns the writer. stats may be NULL.
+int hydrate_registry(Database *db, FleetRegistry *reg, HydrateStats *stats);
+
+// Reload only the aircraft, crew and missions changed after change_log
+// seq since, over a registry that reflects every change up to it. Fails
+// with SQLITE_NOTFOUND when the log no longer holds every change after
+// since, or never reached it; the caller should hydrate in full instead.
+int hydrate_registry_changes(Database *db, FleetRegistry *reg, int64_t since, HydrateStats *stats);
+
+#endif // HYDRATE_H
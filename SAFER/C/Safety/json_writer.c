@@ -0,0 +1,225 @@
+// json_writer.c - JSON writer and response buffer pool
+#include "json_writer.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct JsonBuffer {
+    char *data;
+    size_t length;
+    size_t capacity;
+    struct JsonBuffer *next_free;
+};
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static JsonBuffer *free_list;
+static int num_free;
+
+static JsonBuffer *acquire_buffer(void) {
+    pthread_mutex_lock(&pool_lock);
+    JsonBuffer *buffer = free_list;
+    if (buffer != NULL) {
+        free_list = buffer->next_free;
+        num_free--;
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    if (buffer == NULL) {
+        buffer = malloc(sizeof(JsonBuffer));
+        if (buffer == NULL) {
+            return NULL;
+        }
+        buffer->data = malloc(JSON_BUFFER_INITIAL_SIZE);
+        if (buffer->data == NULL) {
+            free(buffer);
+            return NULL;
+        }
+        buffer->capacity = JSON_BUFFER_INITIAL_SIZE;
+    }
+    buffer->length = 0;
+    buffer->next_free = NULL;
+    return buffer;
+}
+
+void json_buffer_release(void *arg) {
+    JsonBuffer *buffer = arg;
+    if (buffer == NULL) {
+        return;
+    }
+    if (buffer->capacity <= JSON_BUFFER_POOL_MAX_SIZE) {
+        pthread_mutex_lock(&pool_lock);
+        if (num_free < JSON_BUFFER_POOL_MAX) {
+            buffer->next_free = free_list;
+            free_list = buffer;
+            num_free++;
+            buffer = NULL;
+        }
+        pthread_mutex_unlock(&pool_lock);
+    }
+    if (buffer != NULL) {
+        free(buffer->data);
+        free(buffer);
+    }
+}
+
+int json_writer_init(JsonWriter *writer) {
+    writer->buffer = acquire_buffer();
+    writer->need_comma = 0;
+    writer->failed = writer->buffer == NULL;
+    return writer->failed ? -1 : 0;
+}
+
+// Make room for size more bytes
+static char *reserve(JsonWriter *writer, size_t size) {
+    if (writer->failed) {
+        return NULL;
+    }
+    JsonBuffer *buffer = writer->buffer;
+    if (buffer->length + size > buffer->capacity) {
+        size_t capacity = buffer->capacity * 2;
+        while (capacity < buffer->length + size) {
+            capacity *= 2;
+        }
+        char *data = realloc(buffer->data, capacity);
+        if (data == NULL) {
+            writer->failed = 1;
+            return NULL;
+        }
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+    return buffer->data + buffer->length;
+}
+
+static void append(JsonWriter *writer, const char *text, size_t length) {
+    char *out = reserve(writer, length);
+    if (out != NULL) {
+        memcpy(out, text, length);
+        writer->buffer->length += length;
+    }
+}
+
+static void begin_value(JsonWriter *writer) {
+    if (writer->need_comma) {
+        append(writer, ",", 1);
+    }
+    writer->need_comma = 1;
+}
+
+void json_writer_begin_object(JsonWriter *writer) {
+    begin_value(writer);
+    append(writer, "{", 1);
+    writer->need_comma = 0;
+}
+
+void json_writer_end_object(JsonWriter *writer) {
+    append(writer, "}", 1);
+    writer->need_comma = 1;
+}
+
+void json_writer_begin_array(JsonWriter *writer) {
+    begin_value(writer);
+    append(writer, "[", 1);
+    writer->need_comma = 0;
+}
+
+void json_writer_end_array(JsonWriter *writer) {
+    append(writer, "]", 1);
+    writer->need_comma = 1;
+}
+
+static void append_escaped(JsonWriter *writer, const char *value) {
+    static const char hex[] = "0123456789abcdef";
+    size_t length = strlen(value);
+    // Worst case every byte becomes \u00XX
+    char *out = reserve(writer, length * 6 + 2);
+    if (out == NULL) {
+        return;
+    }
+    char *start = out;
+    *out++ = '"';
+    for (const unsigned char *p = (const unsigned char *)value; *p; p++) {
+        switch (*p) {
+        case '"':  *out++ = '\\'; *out++ = '"'; break;
+        case '\\': *out++ = '\\'; *out++ = '\\'; break;
+        case '\n': *out++ = '\\'; *out++ = 'n'; break;
+        case '\r': *out++ = '\\'; *out++ = 'r'; break;
+        case '\t': *out++ = '\\'; *out++ = 't'; break;
+        default:
+            if (*p < 0x20) {
+                *out++ = '\\'; *out++ = 'u'; *out++ = '0'; *out++ = '0';
+                *out++ = hex[*p >> 4];
+                *out++ = hex[*p & 15];
+            } else {
+                *out++ = *p;
+            }
+        }
+    }
+    *out++ = '"';
+    writer->buffer->length += out - start;
+}
+
+void json_writer_key(JsonWriter *writer, const char *key) {
+    begin_value(writer);
+    append_escaped(writer, key);
+    append(writer, ":", 1);
+    writer->need_comma = 0;
+}
+
+void json_writer_string(JsonWriter *writer, const char *value) {
+    begin_value(writer);
+    if (value == NULL) {
+        append(writer, "null", 4);
+    } else {
+        append_escaped(writer, value);
+    }
+}
+
+void json_writer_int(JsonWriter *writer, long long value) {
+    begin_value(writer);
+    char *out = reserve(writer, 24);
+    if (out != NULL) {
+        writer->buffer->length += snprintf(out, 24, "%lld", value);
+    }
+}
+
+void json_writer_double(JsonWriter *writer, double value) {
+    begin_value(writer);
+    if (!isfinite(value)) {
+        append(writer, "null", 4);
+        return;
+    }
+    char *out = reserve(writer, 32);
+    if (out != NULL) {
+        // Same round-trip precision as json-c
+        writer->buffer->length += snprintf(out, 32, "%.17g", value);
+    }
+}
+
+void json_writer_bool(JsonWriter *writer, int value) {
+    begin_value(writer);
+    if (value) {
+        append(writer, "true", 4);
+    } else {
+        append(writer, "false", 5);
+    }
+}
+
+void json_writer_end_line(JsonWriter *writer) {
+    append(writer, "\n", 1);
+    writer->need_comma = 0;
+}
+
+JsonBuffer *json_writer_detach(JsonWriter *writer, const char **data, size_t *length) {
+    JsonBuffer *buffer = writer->buffer;
+    writer->buffer = NULL;
+    if (writer->failed) {
+        json_buffer_release(buffer);
+        return NULL;
+    }
+    *data = buffer->data;
+    *length = buffer->length;
+    return buffer;
+}
@@ -0,0 +1,47 @@
+// json_writer.h - Direct JSON serialisation into pooled response buffers
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stddef.h>
+
+#define JSON_BUFFER_INITIAL_SIZE 4096
+#define JSON_BUFFER_POOL_MAX 64              // Idle buffers kept for reuse
+#define JSON_BUFFER_POOL_MAX_SIZE (256 << 10) // Larger buffers are freed, not pooled
+
+typedef struct JsonBuffer JsonBuffer;
+
+// Streaming writer: values are appended as text in call order, with commas
+// placed automatically. Keys must precede every value inside an object.
+// Errors (out of memory) are sticky and reported by json_writer_detach.
+typedef struct {
+    JsonBuffer *buffer;
+    int need_comma;
+    int failed;
+} JsonWriter;
+
+// Take a buffer from the pool. Returns 0 on success, -1 on failure.
+int json_writer_init(JsonWriter *writer);
+
+void json_writer_begin_object(JsonWriter *writer);
+void json_writer_end_object(JsonWriter *writer);
+void json_writer_begin_array(JsonWriter *writer);
+void json_writer_end_array(JsonWriter *writer);
+void json_writer_key(JsonWriter *writer, const char *key);
+void json_writer_string(JsonWriter *writer, const char *value); // NULL writes null
+void json_writer_int(JsonWriter *writer, long long value);
+void json_writer_double(JsonWriter *writer, double value);      // Non-finite writes null
+void json_writer_bool(JsonWriter *writer, int value);
+
+// End a top-level value with a newline, for newline-delimited JSON streams
+void json_writer_end_line(JsonWriter *writer);
+
+// Hand the serialised text over without copying. The caller owns the
+// returned buffer and releases it with json_buffer_release, which has the
+// signature of a microhttpd free callback. Returns NULL if any write failed,
+// in which case the buffer has already been released.
+JsonBuffer *json_writer_detach(JsonWriter *writer, const char **data, size_t *length);
+
+// Return a buffer to the pool; accepts NULL
+void json_buffer_release(void *buffer);
+
+#endif // JSON_WRITER_H
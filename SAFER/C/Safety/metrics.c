@@ -0,0 +1,117 @@
+// metrics.c - Per-thread sharded metrics
+#define _POSIX_C_SOURCE 200809L
+#include "metrics.h"
+#include <string.h>
+#include <time.h>
+
+const double metric_histogram_bounds_s[METRIC_HISTOGRAM_BUCKETS] = {
+    0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+    0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 7.5, 10
+};
+
+// Bounds in nanoseconds, so observing does no floating point
+static const uint64_t bounds_ns[METRIC_HISTOGRAM_BUCKETS] = {
+    50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000, 25000000,
+    50000000, 100000000, 250000000, 500000000, 1000000000, 2500000000ULL, 5000000000ULL,
+    7500000000ULL, 10000000000ULL
+};
+
+static unsigned int next_shard;
+static _Thread_local int thread_shard = -1;
+
+// Threads take shards round robin on first use
+static int current_shard(void) {
+    if (thread_shard < 0) {
+        thread_shard = (int)(__atomic_fetch_add(&next_shard, 1, __ATOMIC_RELAXED) % METRICS_SHARDS);
+    }
+    return thread_shard;
+}
+
+uint64_t metrics_now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+void metric_counter_add(MetricCounter *counter, uint64_t n) {
+    __atomic_fetch_add(&counter->shards[current_shard()].value, n, __ATOMIC_RELAXED);
+}
+
+uint64_t metric_counter_value(const MetricCounter *counter) {
+    uint64_t total = 0;
+    for (int i = 0; i < METRICS_SHARDS; i++) {
+        total += __atomic_load_n(&counter->shards[i].value, __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+static int bucket_index(uint64_t ns) {
+    int bucket = 0;
+    while (bucket < METRIC_HISTOGRAM_BUCKETS && ns > bounds_ns[bucket]) {
+        bucket++;
+    }
+    return bucket;
+}
+
+void metric_histogram_observe_ns(MetricHistogram *histogram, uint64_t ns) {
+    int bucket = bucket_index(ns);
+    MetricHistogramShard *shard = &histogram->shards[current_shard()];
+    __atomic_fetch_add(&shard->buckets[bucket], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&shard->sum_ns, ns, __ATOMIC_RELAXED);
+}
+
+void metric_histogram_snapshot(const MetricHistogram *histogram, MetricHistogramSnapshot *snapshot) {
+    uint64_t sum_ns = 0;
+    memset(snapshot, 0, sizeof(*snapshot));
+    for (int i = 0; i < METRICS_SHARDS; i++) {
+        const MetricHistogramShard *shard = &histogram->shards[i];
+        for (int b = 0; b <= METRIC_HISTOGRAM_BUCKETS; b++) {
+            snapshot->buckets[b] += __atomic_load_n(&shard->buckets[b], __ATOMIC_RELAXED);
+        }
+        sum_ns += __atomic_load_n(&shard->sum_ns, __ATOMIC_RELAXED);
+    }
+    for (int b = 1; b <= METRIC_HISTOGRAM_BUCKETS; b++) {
+        snapshot->buckets[b] += snapshot->buckets[b - 1];
+    }
+    snapshot->sum_seconds = sum_ns / 1e9;
+}
+
+void metric_snapshot_observe_ns(MetricHistogramSnapshot *snapshot, uint64_t ns) {
+    for (int b = bucket_index(ns); b <= METRIC_HISTOGRAM_BUCKETS; b++) {
+        snapshot->buckets[b]++;
+    }
+    snapshot->sum_seconds += ns / 1e9;
+}
+
+void metrics_write_family(FILE *out, const char *name, const char *type, const char *help) {
+    fprintf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+void metrics_write_sample(FILE *out, const char *name, const char *labels, double value) {
+    if (labels != NULL && labels[0] != '\0') {
+        fprintf(out, "%s{%s} %.17g\n", name, labels, value);
+    } else {
+        fprintf(out, "%s %.17g\n", name, value);
+    }
+}
+
+void metrics_write_histogram(FILE *out, const char *name, const char *labels,
+                             const MetricHistogramSnapshot *snapshot) {
+    const char *separator = labels != NULL && labels[0] != '\0' ? "," : "";
+    if (labels == NULL) {
+        labels = "";
+    }
+    for (int b = 0; b < METRIC_HISTOGRAM_BUCKETS; b++) {
+        fprintf(out, "%s_bucket{%s%sle=\"%g\"} %llu\n", name, labels, separator, metric_histogram_bounds_s[b],
+                (unsigned long long)snapshot->buckets[b]);
+    }
+    fprintf(out, "%s_bucket{%s%sle=\"+Inf\"} %llu\n", name, labels, separator,
+            (unsigned long long)snapshot->buckets[METRIC_HISTOGRAM_BUCKETS]);
+    if (labels[0] != '\0') {
+        fprintf(out, "%s_sum{%s} %.17g\n%s_count{%s} %llu\n", name, labels, snapshot->sum_seconds, name, labels,
+                (unsigned long long)snapshot->buckets[METRIC_HISTOGRAM_BUCKETS]);
+    } else {
+        fprintf(out, "%s_sum %.17g\n%s_count %llu\n", name, snapshot->sum_seconds, name,
+                (unsigned long long)snapshot->buckets[METRIC_HISTOGRAM_BUCKETS]);
+    }
+}
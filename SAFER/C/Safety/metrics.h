@@ -0,0 +1,64 @@
+// metrics.h - Sharded counters and latency histograms with Prometheus text output
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Each thread updates its own cache line, so instrumented hot paths do not
+// contend; readers sum the shards. Threads beyond the shard count share
+// lines but stay correct.
+#define METRICS_SHARDS 32
+#define METRICS_CACHE_LINE 64
+
+// Latency bucket upper bounds, 50 us to 10 s, plus +Inf
+#define METRIC_HISTOGRAM_BUCKETS 18
+
+typedef struct {
+    _Alignas(METRICS_CACHE_LINE) uint64_t value;
+} MetricCounterShard;
+
+// Monotonic count; a zeroed counter is ready to use
+typedef struct {
+    MetricCounterShard shards[METRICS_SHARDS];
+} MetricCounter;
+
+typedef struct {
+    _Alignas(METRICS_CACHE_LINE) uint64_t buckets[METRIC_HISTOGRAM_BUCKETS + 1]; // Last is +Inf
+    uint64_t sum_ns;
+} MetricHistogramShard;
+
+// Latency distribution; a zeroed histogram is ready to use
+typedef struct {
+    MetricHistogramShard shards[METRICS_SHARDS];
+} MetricHistogram;
+
+// Cumulative view for export. Shards are read without stopping writers, so
+// a snapshot taken under load can miss observations made while it ran.
+typedef struct {
+    uint64_t buckets[METRIC_HISTOGRAM_BUCKETS + 1]; // Cumulative, last is the total count
+    double sum_seconds;
+} MetricHistogramSnapshot;
+
+extern const double metric_histogram_bounds_s[METRIC_HISTOGRAM_BUCKETS];
+
+uint64_t metrics_now_ns(void);
+
+void metric_counter_add(MetricCounter *counter, uint64_t n);
+uint64_t metric_counter_value(const MetricCounter *counter);
+
+void metric_histogram_observe_ns(MetricHistogram *histogram, uint64_t ns);
+void metric_histogram_snapshot(const MetricHistogram *histogram, MetricHistogramSnapshot *snapshot);
+
+// Record straight into a snapshot, for a single writer that already holds
+// a lock around its statistics
+void metric_snapshot_observe_ns(MetricHistogramSnapshot *snapshot, uint64_t ns);
+
+// Prometheus text exposition. labels is a label list without braces, such
+// as route="/api/mission", or NULL.
+void metrics_write_family(FILE *out, const char *name, const char *type, const char *help);
+void metrics_write_sample(FILE *out, const char *name, const char *labels, double value);
+void metrics_write_histogram(FILE *out, const char *name, const char *labels,
+                             const MetricHistogramSnapshot *snapshot);
+
+#endif // METRICS_H
@@ -0,0 +1,435 @@
+// monte_carlo.c - Monte Carlo risk sampling with a Philox counter-based RNG
+#define _POSIX_C_SOURCE 200809L
+#include "monte_carlo.h"
+#include "radio_simd.h"
+#include "risk_rules.h"
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define DEFAULT_SAMPLES 1000000
+#define BLOCK_SAMPLES 256
+#define WEATHER_PAIRS 2 // Normal pairs 0 and 1: temperature/visibility, wind/precipitation
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+
+#define TWO_PI 6.28318530717958647693
+#define LN_2 0.69314718055994530942
+
+typedef struct {
+    uint32_t round_keys[PHILOX_ROUNDS][2];
+    const Mission *mission;
+    const RiskProfile *profile;    // Weather rules for the mission's aircraft
+    RiskLevel fixed_risk;          // Maintenance and crew, which are not sampled
+    WeatherCondition weather_stddev;
+
+    int num_sources;
+    const double *source_exponent; // log2 of mean received mW
+    const double *source_slope;    // log2 mW lost per standard deviation of terrain
+    const double *source_distance; // km, which scales the sampled weather attenuation
+    double weather_factor;         // Mean attenuation, dB/km
+    double weather_factor_stddev;  // 0 keeps the mean for every sample
+    RiskStep radio_power;          // The radio.signal_to_noise rule with thresholds in linear mW
+} SamplerSetup;
+
+typedef struct {
+    const SamplerSetup *setup;
+    uint64_t first_sample;
+    uint64_t end_sample;
+    uint64_t weather[4], radio[4], overall[4];
+} SamplerWork;
+
+static void philox_keys(uint64_t seed, uint32_t round_keys[PHILOX_ROUNDS][2]) {
+    uint32_t k0 = (uint32_t)seed, k1 = (uint32_t)(seed >> 32);
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+        round_keys[r][0] = k0;
+        round_keys[r][1] = k1;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+}
+
+static void philox4x32(uint32_t c[4], const uint32_t round_keys[PHILOX_ROUNDS][2]) {
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * c[0];
+        uint64_t p1 = (uint64_t)PHILOX_M1 * c[2];
+        uint32_t x0 = (uint32_t)(p1 >> 32) ^ c[1] ^ round_keys[r][0];
+        uint32_t x2 = (uint32_t)(p0 >> 32) ^ c[3] ^ round_keys[r][1];
+        c[1] = (uint32_t)p1;
+        c[3] = (uint32_t)p0;
+        c[0] = x0;
+        c[2] = x2;
+    }
+}
+
+// 52 random bits to a uniform in (0, 1), never 0 so log() is finite
+static double to_uniform(uint32_t high, uint32_t low) {
+    uint64_t bits = ((uint64_t)high << 20) | (low >> 12);
+    return ((double)bits + 0.5) * 0x1p-52;
+}
+
+// Box-Muller: two standard normals for counter (sample, pair)
+static void normal_pairs_scalar(const uint32_t round_keys[PHILOX_ROUNDS][2], uint64_t first_sample,
+                                int count, uint32_t pair, double *z0, double *z1) {
+    for (int i = 0; i < count; i++) {
+        uint64_t sample = first_sample + i;
+        uint32_t c[4] = {(uint32_t)sample, (uint32_t)(sample >> 32), pair, 0};
+        philox4x32(c, round_keys);
+        double r = sqrt(-2 * log(to_uniform(c[0], c[1])));
+        double angle = TWO_PI * to_uniform(c[2], c[3]);
+        z0[i] = r * cos(angle);
+        z1[i] = r * sin(angle);
+    }
+}
+
+// weather is each sample's attenuation above the mean in log2 mW per km,
+// or NULL when it is not sampled
+static void accumulate_source_scalar(double *total, const double *z, const double *weather, int count,
+                                     double exponent, double slope, double distance) {
+    if (weather == NULL) {
+        for (int i = 0; i < count; i++) {
+            total[i] += exp2(exponent - slope * z[i]);
+        }
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        total[i] += exp2(exponent - slope * z[i] - distance * weather[i]);
+    }
+}
+
+#ifdef RADIO_SIMD_AVX2
+
+// Four Philox streams at once, one 32-bit word in the low half of each
+// 64-bit lane so _mm256_mul_epu32 yields the full product
+__attribute__((target("avx2,fma")))
+static inline void philox4x32_avx2(__m256i c[4], const uint32_t round_keys[PHILOX_ROUNDS][2]) {
+    const __m256i low_mask = _mm256_set1_epi64x(0xFFFFFFFFLL);
+    const __m256i m0 = _mm256_set1_epi64x(PHILOX_M0);
+    const __m256i m1 = _mm256_set1_epi64x(PHILOX_M1);
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+        __m256i p0 = _mm256_mul_epu32(c[0], m0);
+        __m256i p1 = _mm256_mul_epu32(c[2], m1);
+        __m256i x0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p1, 32), c[1]),
+                                      _mm256_set1_epi64x(round_keys[r][0]));
+        __m256i x2 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p0, 32), c[3]),
+                                      _mm256_set1_epi64x(round_keys[r][1]));
+        c[1] = _mm256_and_si256(p1, low_mask);
+        c[3] = _mm256_and_si256(p0, low_mask);
+        c[0] = x0;
+        c[2] = x2;
+    }
+}
+
+// Same value as to_uniform: the 52 bits become the mantissa of [1, 2)
+__attribute__((target("avx2,fma")))
+static inline __m256d to_uniform_avx2(__m256i high, __m256i low) {
+    __m256i bits = _mm256_or_si256(_mm256_slli_epi64(high, 20), _mm256_srli_epi64(low, 12));
+    __m256d one_to_two = _mm256_castsi256_pd(_mm256_or_si256(bits, _mm256_set1_epi64x(0x3FF0000000000000LL)));
+    return _mm256_add_pd(_mm256_sub_pd(one_to_two, _mm256_set1_pd(1.0)), _mm256_set1_pd(0x1p-53));
+}
+
+// cos and sin of 2 pi u for u in (0, 1): quarter-turn reduction leaves
+// |phi| <= pi/4, where Taylor polynomials of degree 12/11 are within 1e-11
+__attribute__((target("avx2,fma")))
+static inline void sincos_turn_avx2(__m256d u, __m256d *cosine, __m256d *sine) {
+    __m256d quadrant = _mm256_round_pd(_mm256_mul_pd(u, _mm256_set1_pd(4.0)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d phi = _mm256_mul_pd(_mm256_fnmadd_pd(quadrant, _mm256_set1_pd(0.25), u), _mm256_set1_pd(TWO_PI));
+    __m256d phi2 = _mm256_mul_pd(phi, phi);
+
+    __m256d s = _mm256_set1_pd(-1.0 / 39916800);
+    s = _mm256_fmadd_pd(s, phi2, _mm256_set1_pd(1.0 / 362880));
+    s = _mm256_fmadd_pd(s, phi2, _mm256_set1_pd(-1.0 / 5040));
+    s = _mm256_fmadd_pd(s, phi2, _mm256_set1_pd(1.0 / 120));
+    s = _mm256_fmadd_pd(s, phi2, _mm256_set1_pd(-1.0 / 6));
+    s = _mm256_fmadd_pd(s, phi2, _mm256_set1_pd(1.0));
+    s = _mm256_mul_pd(s, phi);
+
+    __m256d c = _mm256_set1_pd(1.0 / 479001600);
+    c = _mm256_fmadd_pd(c, phi2, _mm256_set1_pd(-1.0 / 3628800));
+    c = _mm256_fmadd_pd(c, phi2, _mm256_set1_pd(1.0 / 40320));
+    c = _mm256_fmadd_pd(c, phi2, _mm256_set1_pd(-1.0 / 720));
+    c = _mm256_fmadd_pd(c, phi2, _mm256_set1_pd(1.0 / 24));
+    c = _mm256_fmadd_pd(c, phi2, _mm256_set1_pd(-0.5));
+    c = _mm256_fmadd_pd(c, phi2, _mm256_set1_pd(1.0));
+
+    // Quadrant q rotates (c, s) by q quarter turns; q == 4 is a full turn
+    __m256d q = _mm256_sub_pd(quadrant, _mm256_and_pd(_mm256_cmp_pd(quadrant, _mm256_set1_pd(4.0), _CMP_EQ_OQ),
+                                                      _mm256_set1_pd(4.0)));
+    __m256d q1 = _mm256_cmp_pd(q, _mm256_set1_pd(1.0), _CMP_EQ_OQ);
+    __m256d q2 = _mm256_cmp_pd(q, _mm256_set1_pd(2.0), _CMP_EQ_OQ);
+    __m256d q3 = _mm256_cmp_pd(q, _mm256_set1_pd(3.0), _CMP_EQ_OQ);
+    __m256d swap = _mm256_or_pd(q1, q3);
+    __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d cos_sign = _mm256_and_pd(_mm256_or_pd(q1, q2), sign);
+    __m256d sin_sign = _mm256_and_pd(_mm256_or_pd(q2, q3), sign);
+    *cosine = _mm256_xor_pd(_mm256_blendv_pd(c, s, swap), cos_sign);
+    *sine = _mm256_xor_pd(_mm256_blendv_pd(s, c, swap), sin_sign);
+}
+
+// count is a multiple of 4
+__attribute__((target("avx2,fma")))
+static void normal_pairs_avx2(const uint32_t round_keys[PHILOX_ROUNDS][2], uint64_t first_sample,
+                              int count, uint32_t pair, double *z0, double *z1) {
+    for (int i = 0; i < count; i += 4) {
+        uint64_t sample = first_sample + i;
+        __m256i c[4] = {
+            _mm256_set_epi64x((uint32_t)(sample + 3), (uint32_t)(sample + 2), (uint32_t)(sample + 1), (uint32_t)sample),
+            _mm256_set_epi64x((uint32_t)((sample + 3) >> 32), (uint32_t)((sample + 2) >> 32),
+                              (uint32_t)((sample + 1) >> 32), (uint32_t)(sample >> 32)),
+            _mm256_set1_epi64x(pair),
+            _mm256_setzero_si256()
+        };
+        philox4x32_avx2(c, round_keys);
+        // r = sqrt(-2 ln u1) = sqrt(-2 ln2 log2 u1)
+        __m256d log2_u1 = log2_lowp_pd(to_uniform_avx2(c[0], c[1]));
+        __m256d r = _mm256_sqrt_pd(_mm256_mul_pd(log2_u1, _mm256_set1_pd(-2 * LN_2)));
+        __m256d cosine, sine;
+        sincos_turn_avx2(to_uniform_avx2(c[2], c[3]), &cosine, &sine);
+        _mm256_storeu_pd(z0 + i, _mm256_mul_pd(r, cosine));
+        _mm256_storeu_pd(z1 + i, _mm256_mul_pd(r, sine));
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void accumulate_source_avx2(double *total, const double *z, const double *weather, int count,
+                                   double exponent, double slope, double distance) {
+    __m256d e = _mm256_set1_pd(exponent), g = _mm256_set1_pd(slope), d = _mm256_set1_pd(distance);
+    if (weather == NULL) {
+        for (int i = 0; i < count; i += 4) {
+            __m256d power = exp2_lowp_pd(_mm256_fnmadd_pd(g, _mm256_loadu_pd(z + i), e));
+            _mm256_storeu_pd(total + i, _mm256_add_pd(_mm256_loadu_pd(total + i), power));
+        }
+        return;
+    }
+    for (int i = 0; i < count; i += 4) {
+        __m256d x = _mm256_fnmadd_pd(g, _mm256_loadu_pd(z + i), e);
+        __m256d power = exp2_lowp_pd(_mm256_fnmadd_pd(d, _mm256_loadu_pd(weather + i), x));
+        _mm256_storeu_pd(total + i, _mm256_add_pd(_mm256_loadu_pd(total + i), power));
+    }
+}
+
+#endif // RADIO_SIMD_AVX2
+
+static void normal_pairs(int use_avx2, const uint32_t round_keys[PHILOX_ROUNDS][2], uint64_t first_sample,
+                         int count, uint32_t pair, double *z0, double *z1) {
+#ifdef RADIO_SIMD_AVX2
+    if (use_avx2) {
+        normal_pairs_avx2(round_keys, first_sample, count, pair, z0, z1);
+        return;
+    }
+#endif
+    (void)use_avx2;
+    normal_pairs_scalar(round_keys, first_sample, count, pair, z0, z1);
+}
+
+static void accumulate_source(int use_avx2, double *total, const double *z, const double *weather, int count,
+                              double exponent, double slope, double distance) {
+#ifdef RADIO_SIMD_AVX2
+    if (use_avx2) {
+        accumulate_source_avx2(total, z, weather, count, exponent, slope, distance);
+        return;
+    }
+#endif
+    (void)use_avx2;
+    accumulate_source_scalar(total, z, weather, count, exponent, slope, distance);
+}
+
+static float non_negative(float value) {
+    return value > 0 ? value : 0;
+}
+
+static void *sampler_thread(void *arg) {
+    SamplerWork *work = arg;
+    const SamplerSetup *setup = work->setup;
+    const WeatherCondition *mean = &setup->mission->weather;
+    int use_avx2 = radio_simd_have_avx2();
+    double z[4][BLOCK_SAMPLES], radio_z[2][BLOCK_SAMPLES], total[BLOCK_SAMPLES];
+    double weather_z[2][BLOCK_SAMPLES];
+    const double *weather = NULL;
+    // The pair after the last source's, so runs without weather spread
+    // draw exactly what they did before it existed
+    uint32_t weather_pair = WEATHER_PAIRS + (setup->num_sources + 1) / 2;
+
+    for (uint64_t start = work->first_sample; start < work->end_sample; start += BLOCK_SAMPLES) {
+        int count = work->end_sample - start < BLOCK_SAMPLES ? (int)(work->end_sample - start) : BLOCK_SAMPLES;
+        // Generate whole vectors; samples past count are computed and ignored
+        int padded = (count + 3) & ~3;
+
+        normal_pairs(use_avx2, setup->round_keys, start, padded, 0, z[0], z[1]);
+        normal_pairs(use_avx2, setup->round_keys, start, padded, 1, z[2], z[3]);
+
+        if (setup->num_sources > 0) {
+            if (setup->weather_factor_stddev > 0) {
+                // Attenuation cannot go below none, so the deviation is
+                // floored at minus the mean
+                normal_pairs(use_avx2, setup->round_keys, start, padded, weather_pair, weather_z[0], weather_z[1]);
+                for (int j = 0; j < padded; j++) {
+                    double deviation = setup->weather_factor_stddev * weather_z[0][j];
+                    weather_z[0][j] = fmax(deviation, -setup->weather_factor) * RADIO_LOG2_10 / 10;
+                }
+                weather = weather_z[0];
+            }
+            memset(total, 0, sizeof(double) * padded);
+            for (int i = 0; i < setup->num_sources; i += 2) {
+                normal_pairs(use_avx2, setup->round_keys, start, padded, WEATHER_PAIRS + i / 2,
+                             radio_z[0], radio_z[1]);
+                accumulate_source(use_avx2, total, radio_z[0], weather, padded,
+                                  setup->source_exponent[i], setup->source_slope[i], setup->source_distance[i]);
+                if (i + 1 < setup->num_sources) {
+                    accumulate_source(use_avx2, total, radio_z[1], weather, padded, setup->source_exponent[i + 1],
+                                      setup->source_slope[i + 1], setup->source_distance[i + 1]);
+                }
+            }
+        }
+
+        for (int j = 0; j < count; j++) {
+            WeatherCondition weather = {
+                .temperature = mean->temperature + setup->weather_stddev.temperature * (float)z[0][j],
+                .visibility = non_negative(mean->visibility + setup->weather_stddev.visibility * (float)z[1][j]),
+                .wind_speed = non_negative(mean->wind_speed + setup->weather_stddev.wind_speed * (float)z[2][j]),
+                .precipitation = non_negative(mean->precipitation + setup->weather_stddev.precipitation * (float)z[3][j])
+            };
+            RiskLevel weather_risk = risk_rules_weather(setup->profile, &weather);
+            RiskLevel risk = weather_risk > setup->fixed_risk ? weather_risk : setup->fixed_risk;
+            work->weather[weather_risk]++;
+
+            if (setup->num_sources > 0) {
+                RiskLevel radio_risk = (RiskLevel)risk_step_eval(&setup->radio_power, total[j]);
+                work->radio[radio_risk]++;
+                if (radio_risk > risk) risk = radio_risk;
+            }
+            work->overall[risk]++;
+        }
+    }
+    return NULL;
+}
+
+static RiskLevel deterministic_risk(const Mission *mission, const RiskRules *rules, const RiskProfile *profile) {
+    RiskLevel risk = RISK_LOW;
+    time_t now = time(NULL);
+    if (mission->aircraft != NULL && mission->aircraft->maintenance_records != NULL) {
+        risk = risk_rules_maintenance(profile, mission->aircraft->maintenance_records, now);
+    }
+    for (int i = 0; i < mission->crew_size; i++) {
+        if (mission->crew[i] == NULL) continue;
+        RiskLevel crew_risk = risk_rules_crew(rules, mission->crew[i], now);
+        if (crew_risk > risk) risk = crew_risk;
+    }
+    return risk;
+}
+
+int monte_carlo_risk(const Mission *mission, const RadioEnvironment *env,
+                     const MonteCarloConfig *config, RiskDistribution *result) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    memset(result, 0, sizeof(*result));
+
+    uint64_t samples = config->samples > 0 ? config->samples : DEFAULT_SAMPLES;
+    int threads = config->threads;
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+    if ((uint64_t)threads > samples / BLOCK_SAMPLES + 1) {
+        threads = (int)(samples / BLOCK_SAMPLES + 1);
+    }
+
+    // Claimed until the workers are done with the profile
+    const RiskRules *rules = risk_rules_acquire();
+    const RiskProfile *profile =
+        risk_rules_profile(rules, mission->aircraft != NULL ? mission->aircraft->model : NULL);
+    SamplerSetup setup = {
+        .mission = mission,
+        .profile = profile,
+        .fixed_risk = deterministic_risk(mission, rules, profile),
+        .weather_stddev = config->weather_stddev
+    };
+    philox_keys(config->seed, setup.round_keys);
+
+    // Each source reduces to 2^(exponent - slope * z - distance * w) mW for
+    // a standard normal z and the sample's weather deviation w
+    int num_sources = env != NULL ? env->num_sources : 0;
+    double *source_terms = malloc(sizeof(double) * 3 * (num_sources > 0 ? num_sources : 1));
+    SamplerWork *work = calloc(threads, sizeof(SamplerWork));
+    pthread_t *workers = malloc(sizeof(pthread_t) * threads);
+    if (source_terms == NULL || work == NULL || workers == NULL) {
+        free(source_terms);
+        free(work);
+        free(workers);
+        risk_rules_release();
+        return -1;
+    }
+    for (int i = 0; i < num_sources; i++) {
+        // Every model is linear in terrain_factor, so one more unit of
+        // terrain gives the slope for whichever model env selects
+        RadioSource source = env->sources[i];
+        double received_power = radio_received_power(env, &source);
+        source.terrain_factor += 1;
+        double terrain_loss = received_power - radio_received_power(env, &source);
+        source_terms[i] = received_power * RADIO_LOG2_10 / 10;
+        source_terms[num_sources + i] = config->terrain_factor_stddev * terrain_loss * RADIO_LOG2_10 / 10;
+        source_terms[2 * num_sources + i] = source.distance;
+    }
+    setup.num_sources = num_sources;
+    setup.source_exponent = source_terms;
+    setup.source_slope = source_terms + num_sources;
+    setup.source_distance = source_terms + 2 * num_sources;
+    if (env != NULL) {
+        setup.weather_factor = env->weather_factor;
+        setup.weather_factor_stddev = config->weather_factor_stddev;
+        // SNR above t dB is total power above 10^((noise + t) / 10) mW, so
+        // the rule grades linear power without a log per sample
+        setup.radio_power = rules->profiles[0].steps[RISK_FACTOR_SIGNAL_TO_NOISE];
+        for (int k = 0; k < setup.radio_power.count; k++) {
+            setup.radio_power.thresholds[k] = pow(10, (env->background_noise + setup.radio_power.thresholds[k]) / 10);
+        }
+    }
+
+    // Contiguous ranges aligned to whole vectors; results do not depend on the split
+    uint64_t per_thread = ((samples + threads - 1) / threads + 3) & ~(uint64_t)3;
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        work[t].setup = &setup;
+        work[t].first_sample = per_thread * t < samples ? per_thread * t : samples;
+        work[t].end_sample = per_thread * (t + 1) < samples ? per_thread * (t + 1) : samples;
+    }
+    for (int t = 1; t < threads; t++) {
+        if (pthread_create(&workers[t], NULL, sampler_thread, &work[t]) != 0) {
+            break;
+        }
+        started = t;
+    }
+    sampler_thread(&work[0]);
+    for (int t = 1; t <= started; t++) {
+        pthread_join(workers[t], NULL);
+    }
+    // Ranges whose thread could not be started run here
+    for (int t = started + 1; t < threads; t++) {
+        sampler_thread(&work[t]);
+    }
+
+    result->samples = samples;
+    for (int t = 0; t < threads; t++) {
+        for (int level = 0; level < 4; level++) {
+            result->weather[level] += work[t].weather[level];
+            result->radio[level] += work[t].radio[level];
+            result->overall[level] += work[t].overall[level];
+        }
+    }
+    for (int level = 0; level < 4; level++) {
+        result->probability[level] = (double)result->overall[level] / samples;
+    }
+
+    free(source_terms);
+    free(work);
+    free(workers);
+    risk_rules_release();
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    result->elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    return 0;
+}
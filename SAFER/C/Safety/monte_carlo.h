@@ -0,0 +1,37 @@
+// monte_carlo.h - Monte Carlo risk distributions under weather and terrain uncertainty
+#ifndef MONTE_CARLO_H
+#define MONTE_CARLO_H
+
+#include "safer.h"
+#include "radio_interference.h"
+#include <stdint.h>
+
+typedef struct {
+    uint64_t samples;                  // Default 1000000
+    uint64_t seed;
+    int threads;                       // Default: online CPUs
+    WeatherCondition weather_stddev;   // Normal spread around mission->weather, per field
+    double terrain_factor_stddev;      // Normal spread around every source's terrain_factor
+    double weather_factor_stddev;      // Normal spread around env->weather_factor (dB/km), floored at 0
+} MonteCarloConfig;
+
+// Sample counts per RiskLevel
+typedef struct {
+    uint64_t samples;
+    uint64_t weather[4];
+    uint64_t radio[4];                 // All zero without a radio environment
+    uint64_t overall[4];               // Highest of weather, radio, maintenance and crew risk
+    double probability[4];             // overall / samples
+    double elapsed_ms;
+} RiskDistribution;
+
+// Sample i draws its inputs from a Philox4x32-10 stream keyed by seed with
+// counter (i, variable), so a run is reproducible for a given seed and
+// independent of the thread count. The weather factor is one draw per
+// sample shared by every source, as the environment's weather is. Maintenance and crew risk are
+// deterministic and computed once. env may be NULL. Cost is
+// O(samples * sources). Returns 0 on success, -1 on failure.
+int monte_carlo_risk(const Mission *mission, const RadioEnvironment *env,
+                     const MonteCarloConfig *config, RiskDistribution *result);
+
+#endif // MONTE_CARLO_H
@@ -0,0 +1,114 @@
+// path_loss_table.c - Octave-subdivided log10 table for calculate_path_loss
+#include "path_loss_table.h"
+#include <stdint.h>
+
+#define C 299792458.0  // Speed of light in m/s
+#define PI 3.14159265359 // Matches radio_interference.c
+
+#define TABLE_MIN_EXPONENT -16
+#define TABLE_MAX_EXPONENT 24
+#define MAX_SUBDIVISION_BITS 16
+#define LOG2_10 3.32192809488736234787
+
+int path_loss_table_build(PathLossTable *table, double max_error_db, double max_terrain_factor) {
+    memset(table, 0, sizeof(*table));
+    if (!(max_error_db > 0) || !(max_terrain_factor >= 0)) {
+        fprintf(stderr, "Invalid path loss table bound %g dB\n", max_error_db);
+        return -1;
+    }
+
+    // Linear interpolation of log2(m) on [1, 2) with segments of width h is
+    // off by at most h^2 / (8 ln 2); log10 scales that by log10(2), and the
+    // path loss weights log10(f) by 20 and log10(d) by 20 + t
+    double weight = 40 + max_terrain_factor;
+    int bits = 0;
+    for (; bits < MAX_SUBDIVISION_BITS; bits++) {
+        double h = ldexp(1.0, -bits);
+        double error_db = weight * log10(2.0) * h * h / (8 * log(2.0));
+        if (error_db <= max_error_db) break;
+    }
+
+    int octaves = TABLE_MAX_EXPONENT - TABLE_MIN_EXPONENT;
+    size_t nodes = ((size_t)octaves << bits) + 1;
+    table->log10_nodes = malloc(sizeof(double) * nodes);
+    if (table->log10_nodes == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < nodes; i++) {
+        int exponent = TABLE_MIN_EXPONENT + (int)(i >> bits);
+        double mantissa = 1.0 + ldexp((double)(i & ((1u << bits) - 1)), -bits);
+        table->log10_nodes[i] = exponent * log10(2.0) + log10(mantissa);
+    }
+
+    table->max_error_db = max_error_db;
+    table->max_terrain_factor = max_terrain_factor;
+    table->subdivision_bits = bits;
+    table->min_exponent = TABLE_MIN_EXPONENT;
+    table->max_exponent = TABLE_MAX_EXPONENT;
+    table->fraction_scale = ldexp(1.0, -(52 - bits));
+    return 0;
+}
+
+void path_loss_table_free(PathLossTable *table) {
+    free(table->log10_nodes);
+    memset(table, 0, sizeof(*table));
+}
+
+// Interpolated log10, or the exact value outside the table (including
+// zero, negative and non-finite inputs)
+static inline double table_log10(const PathLossTable *table, double x) {
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    int exponent = (int)(bits >> 52) - 1023;
+    if (exponent < table->min_exponent || exponent >= table->max_exponent) {
+        return log10(x);
+    }
+    int shift = 52 - table->subdivision_bits;
+    uint64_t mantissa = bits & 0x000FFFFFFFFFFFFFULL;
+    size_t index = ((size_t)(exponent - table->min_exponent) << table->subdivision_bits) | (size_t)(mantissa >> shift);
+    double fraction = (double)(mantissa & ((1ULL << shift) - 1)) * table->fraction_scale;
+    double low = table->log10_nodes[index];
+    return low + fraction * (table->log10_nodes[index + 1] - low);
+}
+
+static double path_loss_constant(void) {
+    // 20 log10(4 pi d * 1000 / (C / (f * 1e6))) = K + 20 log10(f) + 20 log10(d)
+    return 20 * log10(4 * PI * 1e9 / C);
+}
+
+double path_loss_table_lookup(const PathLossTable *table, const RadioSource *source) {
+    if (fabs(source->terrain_factor) > table->max_terrain_factor) {
+        RadioSource copy = *source;
+        return calculate_path_loss(&copy);
+    }
+    return path_loss_constant() + 20 * table_log10(table, source->frequency) +
+           (20 + source->terrain_factor) * table_log10(table, source->distance);
+}
+
+double path_loss_table_total_power_mw(const PathLossTable *table, const RadioSource *sources, int count,
+                                      double weather_db_per_km) {
+    double k = path_loss_constant();
+    double sum = 0, compensation = 0;
+    for (int i = 0; i < count; i++) {
+        const RadioSource *source = &sources[i];
+        double path_loss;
+        if (fabs(source->terrain_factor) > table->max_terrain_factor) {
+            RadioSource copy = *source;
+            path_loss = calculate_path_loss(&copy);
+        } else {
+            path_loss = k + 20 * table_log10(table, source->frequency) +
+                        (20 + source->terrain_factor) * table_log10(table, source->distance);
+        }
+        // 10^(x / 10) through exp2, which is cheaper than pow
+        path_loss += weather_db_per_km * source->distance;
+        double linear_power = exp2((source->power - path_loss) * (LOG2_10 / 10));
+        double t = sum + linear_power;
+        if (fabs(sum) >= fabs(linear_power)) {
+            compensation += (sum - t) + linear_power;
+        } else {
+            compensation += (linear_power - t) + sum;
+        }
+        sum = t;
+    }
+    return sum + compensation;
+}
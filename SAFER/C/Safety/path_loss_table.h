@@ -0,0 +1,36 @@
+// path_loss_table.h - Interpolated path-loss lookup for large emitter sets
+#ifndef PATH_LOSS_TABLE_H
+#define PATH_LOSS_TABLE_H
+
+#include "radio_interference.h"
+
+// calculate_path_loss is K + 20 log10(f) + (20 + t) log10(d), separable in
+// frequency and distance, so a single log10 table serves every frequency
+// band and terrain factor. The table covers 2^-16..2^24 (MHz or km), each
+// octave split into 2^subdivision_bits linear segments indexed directly by
+// the exponent and top mantissa bits of the double; no log is evaluated.
+// Inputs outside that range, and terrain factors beyond
+// max_terrain_factor, fall back to the exact path.
+typedef struct {
+    double max_error_db;       // Bound on |lookup - calculate_path_loss|
+    double max_terrain_factor; // |t| the bound is guaranteed for
+    int subdivision_bits;
+    int min_exponent;
+    int max_exponent;
+    double fraction_scale;     // 2^-(52 - subdivision_bits)
+    double *log10_nodes;       // log10(2^e * (1 + j / 2^bits))
+} PathLossTable;
+
+// Picks the coarsest subdivision meeting max_error_db (at most 2^16 per
+// octave). Returns 0 on success, -1 on bad arguments or allocation failure.
+int path_loss_table_build(PathLossTable *table, double max_error_db, double max_terrain_factor);
+void path_loss_table_free(PathLossTable *table);
+
+double path_loss_table_lookup(const PathLossTable *table, const RadioSource *source);
+
+// Sum of linear received power (mW) with looked-up path losses, weather
+// attenuation of weather_db_per_km * distance and Neumaier summation
+double path_loss_table_total_power_mw(const PathLossTable *table, const RadioSource *sources, int count,
+                                      double weather_db_per_km);
+
+#endif // PATH_LOSS_TABLE_H
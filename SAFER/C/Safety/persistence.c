@@ -0,0 +1,386 @@
+// persistence.c - Write-behind batched persistence implementation
+#define _POSIX_C_SOURCE 200809L
+#include "persistence.h"
+#include <pthread.h>
+#include <errno.h>
+
+#define DEFAULT_BATCH_SIZE 10000
+#define DEFAULT_FLUSH_INTERVAL_MS 100
+#define DEFAULT_QUEUE_CAPACITY 65536
+#define INLINE_CREW 6
+
+typedef enum {
+    PENDING_AIRCRAFT,
+    PENDING_CREW_MEMBER,
+    PENDING_MISSION
+} PendingKind;
+
+// A queued save. Entities are copied by value; anything they point to
+// (maintenance records, issue strings, long crew lists) lives in `owned`.
+typedef struct {
+    PendingKind kind;
+    union {
+        Aircraft aircraft;
+        CrewMember crew;
+        Mission mission;
+    };
+    char aircraft_id[16];
+    char inline_crew[INLINE_CREW][16];
+    int crew_size;
+    void *owned;
+} PendingWrite;
+
+typedef struct {
+    PendingWrite *items;
+    int count;
+} PendingBuffer;
+
+struct WriteBehind {
+    Database *db;
+    WriteBehindConfig config;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready; // Writer: batch full, flush requested or stopping
+    pthread_cond_t not_full;   // Producers: queue drained
+    pthread_cond_t committed;  // Flushers: committed_seq advanced
+
+    PendingBuffer front; // Filled by producers
+    PendingBuffer back;  // Drained by the writer
+    uint64_t enqueued_seq;
+    uint64_t committed_seq;
+    uint64_t flush_seq;  // Highest sequence an explicit flush waits for
+    int stopping;
+
+    WriteBehindStats stats;
+};
+
+static double elapsed_ms(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1e3 + (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+static const char (*pending_crew_ids(const PendingWrite *item))[16] {
+    return item->crew_size > INLINE_CREW ? (const char (*)[16])item->owned
+                                          : (const char (*)[16])item->inline_crew;
+}
+
+static int write_pending(Database *db, const PendingWrite *item) {
+    switch (item->kind) {
+    case PENDING_AIRCRAFT:
+        return write_aircraft_row(db, &item->aircraft);
+    case PENDING_CREW_MEMBER:
+        return write_crew_member_row(db, &item->crew);
+    case PENDING_MISSION:
+        return write_mission_row(db, &item->mission, item->aircraft_id,
+                                 pending_crew_ids(item), item->crew_size);
+    }
+    return SQLITE_MISUSE;
+}
+
+static void set_synchronous(Database *db, WriteBehindDurability durability) {
+    static const char *pragmas[] = {
+        "PRAGMA synchronous=OFF",
+        "PRAGMA synchronous=NORMAL",
+        "PRAGMA synchronous=FULL"
+    };
+    sqlite3_exec(db->db, pragmas[durability], 0, 0, NULL);
+}
+
+// Write items[0..count) as transactions of at most batch_size rows
+static void write_batch(WriteBehind *wb, PendingWrite *items, int count, int durable) {
+    Database *db = wb->db;
+    for (int start = 0; start < count; start += wb->config.batch_size) {
+        int end = start + wb->config.batch_size < count ? start + wb->config.batch_size : count;
+        int last_chunk = end == count;
+        struct timespec began;
+        clock_gettime(CLOCK_MONOTONIC, &began);
+
+        if (durable && last_chunk) {
+            set_synchronous(db, WB_DURABILITY_BATCH);
+        }
+
+        uint64_t failed = 0;
+        int rc = sqlite3_exec(db->db, "BEGIN", 0, 0, NULL);
+        for (int i = start; rc == SQLITE_OK && i < end; i++) {
+            if (write_pending(db, &items[i]) != SQLITE_OK) {
+                failed++;
+            }
+        }
+        if (rc == SQLITE_OK) {
+            rc = sqlite3_exec(db->db, "COMMIT", 0, 0, NULL);
+        }
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "Write-behind batch failed: %s\n", sqlite3_errmsg(db->db));
+            sqlite3_exec(db->db, "ROLLBACK", 0, 0, NULL);
+            failed = end - start;
+        }
+
+        if (durable && last_chunk) {
+            set_synchronous(db, wb->config.durability);
+        }
+
+        pthread_mutex_lock(&wb->lock);
+        wb->stats.batches++;
+        wb->stats.failed += failed;
+        wb->stats.committed += (end - start) - failed;
+        wb->stats.last_batch_ms = elapsed_ms(&began);
+        metric_snapshot_observe_ns(&wb->stats.batch_latency, (uint64_t)(wb->stats.last_batch_ms * 1e6));
+        pthread_mutex_unlock(&wb->lock);
+    }
+
+    for (int i = 0; i < count; i++) {
+        free(items[i].owned);
+    }
+}
+
+static void *writer_thread(void *arg) {
+    WriteBehind *wb = arg;
+
+    pthread_mutex_lock(&wb->lock);
+    for (;;) {
+        while (wb->front.count == 0 && !wb->stopping) {
+            pthread_cond_wait(&wb->work_ready, &wb->lock);
+        }
+        if (wb->front.count == 0 && wb->stopping) {
+            break;
+        }
+
+        // Give the batch a chance to fill unless someone is waiting on it
+        if (wb->front.count < wb->config.batch_size && !wb->stopping &&
+            wb->flush_seq <= wb->committed_seq) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += (long)wb->config.flush_interval_ms * 1000000L;
+            deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+            deadline.tv_nsec %= 1000000000L;
+            while (wb->front.count < wb->config.batch_size && !wb->stopping &&
+                   wb->flush_seq <= wb->committed_seq) {
+                if (pthread_cond_timedwait(&wb->work_ready, &wb->lock, &deadline) == ETIMEDOUT) {
+                    break;
+                }
+            }
+        }
+
+        PendingBuffer batch = wb->front;
+        wb->front = wb->back;
+        wb->back = batch;
+        wb->front.count = 0;
+        uint64_t batch_seq = wb->enqueued_seq;
+        int durable = wb->config.durability == WB_DURABILITY_FLUSH && wb->flush_seq > wb->committed_seq;
+        pthread_cond_broadcast(&wb->not_full);
+        pthread_mutex_unlock(&wb->lock);
+
+        write_batch(wb, batch.items, batch.count, durable);
+
+        pthread_mutex_lock(&wb->lock);
+        wb->back.count = 0;
+        wb->committed_seq = batch_seq;
+        pthread_cond_broadcast(&wb->committed);
+    }
+    pthread_mutex_unlock(&wb->lock);
+    return NULL;
+}
+
+int write_behind_start(Database *db, const WriteBehindConfig *config) {
+    WriteBehind *wb = calloc(1, sizeof(WriteBehind));
+    if (wb == NULL) {
+        return -1;
+    }
+
+    wb->db = db;
+    if (config != NULL) {
+        wb->config = *config;
+    }
+    if (wb->config.batch_size <= 0) wb->config.batch_size = DEFAULT_BATCH_SIZE;
+    if (wb->config.flush_interval_ms <= 0) wb->config.flush_interval_ms = DEFAULT_FLUSH_INTERVAL_MS;
+    if (wb->config.queue_capacity <= 0) wb->config.queue_capacity = DEFAULT_QUEUE_CAPACITY;
+
+    wb->front.items = malloc(sizeof(PendingWrite) * wb->config.queue_capacity);
+    wb->back.items = malloc(sizeof(PendingWrite) * wb->config.queue_capacity);
+    if (wb->front.items == NULL || wb->back.items == NULL) {
+        free(wb->front.items);
+        free(wb->back.items);
+        free(wb);
+        return -1;
+    }
+
+    set_synchronous(db, wb->config.durability);
+    pthread_mutex_init(&wb->lock, NULL);
+    pthread_cond_init(&wb->work_ready, NULL);
+    pthread_cond_init(&wb->not_full, NULL);
+    pthread_cond_init(&wb->committed, NULL);
+
+    if (pthread_create(&wb->thread, NULL, writer_thread, wb) != 0) {
+        pthread_mutex_destroy(&wb->lock);
+        pthread_cond_destroy(&wb->work_ready);
+        pthread_cond_destroy(&wb->not_full);
+        pthread_cond_destroy(&wb->committed);
+        free(wb->front.items);
+        free(wb->back.items);
+        free(wb);
+        return -1;
+    }
+
+    db->write_behind = wb;
+    return 0;
+}
+
+void write_behind_stop(WriteBehind *wb) {
+    pthread_mutex_lock(&wb->lock);
+    wb->stopping = 1;
+    pthread_cond_signal(&wb->work_ready);
+    pthread_mutex_unlock(&wb->lock);
+    pthread_join(wb->thread, NULL);
+
+    wb->db->write_behind = NULL;
+    pthread_mutex_destroy(&wb->lock);
+    pthread_cond_destroy(&wb->work_ready);
+    pthread_cond_destroy(&wb->not_full);
+    pthread_cond_destroy(&wb->committed);
+    free(wb->front.items);
+    free(wb->back.items);
+    free(wb);
+}
+
+static int enqueue(WriteBehind *wb, const PendingWrite *item) {
+    pthread_mutex_lock(&wb->lock);
+    while (wb->front.count == wb->config.queue_capacity && !wb->stopping) {
+        pthread_cond_signal(&wb->work_ready);
+        pthread_cond_wait(&wb->not_full, &wb->lock);
+    }
+    if (wb->stopping) {
+        pthread_mutex_unlock(&wb->lock);
+        free(item->owned);
+        return SQLITE_MISUSE;
+    }
+
+    wb->front.items[wb->front.count++] = *item;
+    wb->enqueued_seq++;
+    wb->stats.enqueued++;
+    if (wb->front.count == wb->config.batch_size) {
+        pthread_cond_signal(&wb->work_ready);
+    }
+    pthread_mutex_unlock(&wb->lock);
+    return SQLITE_OK;
+}
+
+int write_behind_save_aircraft(WriteBehind *wb, const Aircraft *aircraft) {
+    PendingWrite item;
+    item.kind = PENDING_AIRCRAFT;
+    item.aircraft = *aircraft;
+    item.crew_size = 0;
+    item.owned = NULL;
+
+    if (aircraft->num_records <= 0 || aircraft->maintenance_records == NULL) {
+        item.aircraft.maintenance_records = NULL;
+        item.aircraft.num_records = 0;
+        return enqueue(wb, &item);
+    }
+
+    // One block: records, then issue pointer arrays, then issue strings
+    size_t size = sizeof(MaintenanceRecord) * aircraft->num_records;
+    for (int i = 0; i < aircraft->num_records; i++) {
+        const MaintenanceRecord *record = &aircraft->maintenance_records[i];
+        size += sizeof(char *) * record->num_issues;
+        for (int j = 0; j < record->num_issues; j++) {
+            size += strlen(record->reported_issues[j]) + 1;
+        }
+    }
+    char *block = malloc(size);
+    if (block == NULL) {
+        return SQLITE_NOMEM;
+    }
+
+    MaintenanceRecord *records = (MaintenanceRecord *)block;
+    char **issue_slots = (char **)(records + aircraft->num_records);
+    for (int i = 0; i < aircraft->num_records; i++) {
+        issue_slots += aircraft->maintenance_records[i].num_issues;
+    }
+    char *strings = (char *)issue_slots;
+    issue_slots = (char **)(records + aircraft->num_records);
+
+    for (int i = 0; i < aircraft->num_records; i++) {
+        const MaintenanceRecord *record = &aircraft->maintenance_records[i];
+        records[i] = *record;
+        records[i].reported_issues = issue_slots;
+        for (int j = 0; j < record->num_issues; j++) {
+            size_t length = strlen(record->reported_issues[j]) + 1;
+            memcpy(strings, record->reported_issues[j], length);
+            issue_slots[j] = strings;
+            strings += length;
+        }
+        issue_slots += record->num_issues;
+    }
+
+    item.aircraft.maintenance_records = records;
+    item.owned = block;
+    return enqueue(wb, &item);
+}
+
+int write_behind_save_crew_member(WriteBehind *wb, const CrewMember *crew) {
+    PendingWrite item;
+    item.kind = PENDING_CREW_MEMBER;
+    item.crew = *crew;
+    item.crew_size = 0;
+    item.owned = NULL;
+    return enqueue(wb, &item);
+}
+
+int write_behind_save_mission(WriteBehind *wb, const Mission *mission) {
+    PendingWrite item;
+    item.kind = PENDING_MISSION;
+    item.mission = *mission;
+    item.mission.aircraft = NULL;
+    item.mission.crew = NULL;
+    item.owned = NULL;
+    memset(item.aircraft_id, 0, sizeof(item.aircraft_id));
+    if (mission->aircraft != NULL) {
+        memcpy(item.aircraft_id, mission->aircraft->id, sizeof(item.aircraft_id));
+    }
+
+    char (*crew_ids)[16] = item.inline_crew;
+    if (mission->crew_size > INLINE_CREW) {
+        item.owned = malloc(sizeof(*crew_ids) * mission->crew_size);
+        if (item.owned == NULL) {
+            return SQLITE_NOMEM;
+        }
+        crew_ids = item.owned;
+    }
+    item.crew_size = 0;
+    for (int i = 0; i < mission->crew_size; i++) {
+        if (mission->crew[i] != NULL) {
+            memcpy(crew_ids[item.crew_size++], mission->crew[i]->id, 16);
+        }
+    }
+    if (item.owned != NULL && item.crew_size <= INLINE_CREW) {
+        // Some entries were NULL; the survivors fit inline after all
+        memcpy(item.inline_crew, crew_ids, sizeof(*crew_ids) * item.crew_size);
+        free(item.owned);
+        item.owned = NULL;
+    }
+    return enqueue(wb, &item);
+}
+
+int write_behind_flush(WriteBehind *wb) {
+    pthread_mutex_lock(&wb->lock);
+    uint64_t target = wb->enqueued_seq;
+    uint64_t failed_before = wb->stats.failed;
+    if (target > wb->flush_seq) {
+        wb->flush_seq = target;
+    }
+    pthread_cond_signal(&wb->work_ready);
+    while (wb->committed_seq < target) {
+        pthread_cond_wait(&wb->committed, &wb->lock);
+    }
+    int failed = wb->stats.failed > failed_before;
+    pthread_mutex_unlock(&wb->lock);
+    return failed ? SQLITE_ERROR : SQLITE_OK;
+}
+
+void write_behind_stats(WriteBehind *wb, WriteBehindStats *stats) {
+    pthread_mutex_lock(&wb->lock);
+    *stats = wb->stats;
+    stats->queue_depth = wb->front.count + wb->back.count;
+    pthread_mutex_unlock(&wb->lock);
+}
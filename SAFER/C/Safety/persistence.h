@@ -0,0 +1,53 @@
+// persistence.h - Write-behind batched persistence for the SQLite writer
+#ifndef PERSISTENCE_H
+#define PERSISTENCE_H
+
+#include "database.h"
+#include "metrics.h"
+#include <stdint.h>
+
+// When a commit counts as durable
+typedef enum {
+    WB_DURABILITY_NONE,  // synchronous=OFF, an OS crash may lose committed batches
+    WB_DURABILITY_FLUSH, // synchronous=NORMAL, write_behind_flush() commits with a full sync
+    WB_DURABILITY_BATCH  // synchronous=FULL, every batch commit is synced
+} WriteBehindDurability;
+
+typedef struct {
+    int batch_size;        // Rows per transaction (default 10000)
+    int flush_interval_ms; // Longest a queued save waits for a batch to fill (default 100)
+    int queue_capacity;    // Saves buffered before producers block (default 65536)
+    WriteBehindDurability durability;
+} WriteBehindConfig;
+
+typedef struct {
+    uint64_t enqueued;
+    uint64_t committed;
+    uint64_t failed;
+    uint64_t batches;
+    int queue_depth;
+    double last_batch_ms; // Write + commit time of the most recent batch
+    MetricHistogramSnapshot batch_latency; // Write + commit time of every batch
+} WriteBehindStats;
+
+typedef struct WriteBehind WriteBehind;
+
+// Start the background writer on db's connection. From then on save_* calls
+// on db are queued; the caller must not use db->db for writes directly.
+// config may be NULL for defaults.
+int write_behind_start(Database *db, const WriteBehindConfig *config);
+
+// Drain the queue, stop the writer and detach it from its Database
+void write_behind_stop(WriteBehind *wb);
+
+// Queue a copy of the entity; the caller keeps ownership of its arguments
+int write_behind_save_aircraft(WriteBehind *wb, const Aircraft *aircraft);
+int write_behind_save_crew_member(WriteBehind *wb, const CrewMember *crew);
+int write_behind_save_mission(WriteBehind *wb, const Mission *mission);
+
+// Durability point: block until every save queued before the call is committed
+int write_behind_flush(WriteBehind *wb);
+
+void write_behind_stats(WriteBehind *wb, WriteBehindStats *stats);
+
+#endif // PERSISTENCE_H
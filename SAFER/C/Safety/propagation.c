@@ -0,0 +1,232 @@
+// propagation.c - Free-space, terrain, Hata/COST-231, two-ray and ITU rain models
+#include "propagation.h"
+#include "radio_batch.h"
+
+#define C 299792458.0  // Speed of light in m/s
+#define PI 3.14159265359 // Matches radio_interference.c
+#define LOG2_10 3.32192809488736234787
+
+#define DEFAULT_TRANSMITTER_HEIGHT_M 30.0
+#define DEFAULT_RECEIVER_HEIGHT_M 1.5
+
+// 20 log10(4 pi 1e9 / c): free-space loss at 1 MHz and 1 km
+static double free_space_constant(void) {
+    return 20 * log10(4 * PI * 1e9 / C);
+}
+
+static void free_space_batch(const PropagationParams *params, const double *frequency, const double *distance,
+                             const double *terrain_factor, int count, double *path_loss) {
+    (void)params;
+    (void)terrain_factor;
+    double k = free_space_constant();
+    for (int i = 0; i < count; i++) {
+        path_loss[i] = k + 20 * log10(frequency[i] * distance[i]);
+    }
+}
+
+static void terrain_batch(const PropagationParams *params, const double *frequency, const double *distance,
+                          const double *terrain_factor, int count, double *path_loss) {
+    (void)params;
+    double k = free_space_constant();
+    for (int i = 0; i < count; i++) {
+        path_loss[i] = k + 20 * log10(frequency[i] * distance[i]) + terrain_factor[i] * log10(distance[i]);
+    }
+}
+
+static void hata_batch(const PropagationParams *params, const double *frequency, const double *distance,
+                       const double *terrain_factor, int count, double *path_loss) {
+    (void)terrain_factor;
+    double hb = params->transmitter_height_m > 0 ? params->transmitter_height_m : DEFAULT_TRANSMITTER_HEIGHT_M;
+    double hm = params->receiver_height_m > 0 ? params->receiver_height_m : DEFAULT_RECEIVER_HEIGHT_M;
+    double log_hb = log10(hb);
+    double distance_slope = 44.9 - 6.55 * log_hb;
+
+    for (int i = 0; i < count; i++) {
+        double log_f = log10(frequency[i]);
+        double mobile_correction;
+        if (params->environment == HATA_METROPOLITAN) {
+            mobile_correction = frequency[i] <= 300 ? 8.29 * pow(log10(1.54 * hm), 2) - 1.1
+                                                    : 3.2 * pow(log10(11.75 * hm), 2) - 4.97;
+        } else {
+            mobile_correction = (1.1 * log_f - 0.7) * hm - (1.56 * log_f - 0.8);
+        }
+
+        double loss;
+        if (frequency[i] <= 1500) {
+            loss = 69.55 + 26.16 * log_f;
+        } else {
+            // COST-231 extension to 2 GHz
+            loss = 46.3 + 33.9 * log_f + (params->environment == HATA_METROPOLITAN ? 3 : 0);
+        }
+        loss += -13.82 * log_hb - mobile_correction + distance_slope * log10(distance[i]);
+
+        if (params->environment == HATA_SUBURBAN) {
+            double l = log10(frequency[i] / 28);
+            loss -= 2 * l * l + 5.4;
+        } else if (params->environment == HATA_OPEN) {
+            loss -= 4.78 * log_f * log_f - 18.33 * log_f + 40.94;
+        }
+        path_loss[i] = loss;
+    }
+}
+
+static void two_ray_batch(const PropagationParams *params, const double *frequency, const double *distance,
+                          const double *terrain_factor, int count, double *path_loss) {
+    (void)terrain_factor;
+    double ht = params->transmitter_height_m > 0 ? params->transmitter_height_m : DEFAULT_TRANSMITTER_HEIGHT_M;
+    double hr = params->receiver_height_m > 0 ? params->receiver_height_m : DEFAULT_RECEIVER_HEIGHT_M;
+    double k = free_space_constant();
+    double height_gain = 20 * log10(ht * hr);
+    // Crossover distance 4 pi ht hr / lambda, in km, is crossover_per_mhz * f
+    double crossover_per_mhz = 4 * PI * ht * hr * 1e6 / C / 1000;
+
+    for (int i = 0; i < count; i++) {
+        if (distance[i] <= crossover_per_mhz * frequency[i]) {
+            path_loss[i] = k + 20 * log10(frequency[i] * distance[i]);
+        } else {
+            // 40 log10(d) - 20 log10(ht hr) with d in metres; continuous at the crossover
+            path_loss[i] = 40 * log10(distance[i] * 1000) - height_gain;
+        }
+    }
+}
+
+// ITU-R P.838-3 regression coefficients for k and alpha
+typedef struct {
+    double a[5], b[5], c[5];
+    int terms;
+    double m, offset;
+} RainCoefficients;
+
+static const RainCoefficients rain_k_horizontal = {
+    {-5.33980, -0.35351, -0.23789, -0.94158}, {-0.10008, 1.26970, 0.86036, 0.64552},
+    {1.13098, 0.45400, 0.15354, 0.16817}, 4, -0.18961, 0.71147
+};
+static const RainCoefficients rain_k_vertical = {
+    {-3.80595, -3.44965, -0.39902, 0.50167}, {0.56934, -0.22911, 0.73042, 1.07319},
+    {0.81061, 0.51059, 0.11899, 0.27195}, 4, -0.16398, 0.63297
+};
+static const RainCoefficients rain_alpha_horizontal = {
+    {-0.14318, 0.29591, 0.32177, -5.37610, 16.1721}, {1.82442, 0.77564, 0.63773, -0.96230, -3.29980},
+    {-0.55187, 0.19822, 0.13164, 1.47828, 3.43990}, 5, 0.67849, -1.95537
+};
+static const RainCoefficients rain_alpha_vertical = {
+    {-0.07771, 0.56727, -0.20238, -48.2991, 48.5833}, {2.33840, 0.95545, 1.14520, 0.791669, 0.791459},
+    {-0.76284, 0.54039, 0.26809, 0.116226, 0.116479}, 5, -0.053739, 0.83433
+};
+
+static double rain_regression(const RainCoefficients *rc, double log_f_ghz) {
+    double sum = rc->m * log_f_ghz + rc->offset;
+    for (int j = 0; j < rc->terms; j++) {
+        double x = (log_f_ghz - rc->b[j]) / rc->c[j];
+        sum += rc->a[j] * exp(-x * x);
+    }
+    return sum;
+}
+
+// P.838 covers 1-1000 GHz; lower frequencies are evaluated at 1 GHz where
+// rain loss is already negligible
+static double rain_frequency_ghz(double frequency_mhz) {
+    double f_ghz = frequency_mhz / 1000;
+    if (f_ghz < 1) return 1;
+    if (f_ghz > 1000) return 1000;
+    return f_ghz;
+}
+
+// Specific attenuation k R^alpha in dB/km
+static double rain_attenuation_db_per_km(double f_ghz, double log_rain_rate, int vertical) {
+    double log_f = log10(f_ghz);
+    double log10_k = rain_regression(vertical ? &rain_k_vertical : &rain_k_horizontal, log_f);
+    double alpha = rain_regression(vertical ? &rain_alpha_vertical : &rain_alpha_horizontal, log_f);
+    return pow(10, log10_k) * exp(alpha * log_rain_rate);
+}
+
+static void itu_rain_batch(const PropagationParams *params, const double *frequency, const double *distance,
+                           const double *terrain_factor, int count, double *path_loss) {
+    free_space_batch(params, frequency, distance, terrain_factor, count, path_loss);
+    if (!(params->rain_rate_mm_h > 0)) {
+        return;
+    }
+    // The coefficients only depend on frequency, and everything below 1 GHz
+    // shares them; reuse them while the clamped frequency repeats
+    double log_rain_rate = log(params->rain_rate_mm_h);
+    double last_f_ghz = NAN, gamma = 0;
+    for (int i = 0; i < count; i++) {
+        double f_ghz = rain_frequency_ghz(frequency[i]);
+        if (f_ghz != last_f_ghz) {
+            gamma = rain_attenuation_db_per_km(f_ghz, log_rain_rate, params->vertical_polarization);
+            last_f_ghz = f_ghz;
+        }
+        path_loss[i] += gamma * distance[i];
+    }
+}
+
+const PropagationModel propagation_free_space = {"free_space", free_space_batch};
+const PropagationModel propagation_terrain = {"terrain", terrain_batch};
+const PropagationModel propagation_hata = {"hata", hata_batch};
+const PropagationModel propagation_two_ray = {"two_ray", two_ray_batch};
+const PropagationModel propagation_itu_rain = {"itu_rain", itu_rain_batch};
+
+const PropagationModel *propagation_model_by_name(const char *name) {
+    static const PropagationModel *models[] = {
+        &propagation_free_space, &propagation_terrain, &propagation_hata,
+        &propagation_two_ray, &propagation_itu_rain
+    };
+    for (size_t i = 0; i < sizeof(models) / sizeof(models[0]); i++) {
+        if (strcmp(models[i]->name, name) == 0) {
+            return models[i];
+        }
+    }
+    return NULL;
+}
+
+// Add n sources given as columns to the compensated sum
+static void accumulate_columns(const PropagationConfig *config, const double *frequency, const double *power,
+                               const double *distance, const double *terrain_factor, int n,
+                               double weather_db_per_km, double *sum, double *compensation) {
+    double path_loss[RADIO_BATCH_CHUNK];
+    config->model->path_loss_batch(&config->params, frequency, distance, terrain_factor, n, path_loss);
+
+    for (int i = 0; i < n; i++) {
+        double received_power = power[i] - path_loss[i] - weather_db_per_km * distance[i];
+        double linear_power = exp2(received_power * (LOG2_10 / 10));
+        double t = *sum + linear_power;
+        if (fabs(*sum) >= fabs(linear_power)) {
+            *compensation += (*sum - t) + linear_power;
+        } else {
+            *compensation += (linear_power - t) + *sum;
+        }
+        *sum = t;
+    }
+}
+
+double propagation_total_power_mw(const PropagationConfig *config, const RadioSource *sources, int count,
+                                  double weather_db_per_km) {
+    double frequency[RADIO_BATCH_CHUNK], power[RADIO_BATCH_CHUNK];
+    double distance[RADIO_BATCH_CHUNK], terrain_factor[RADIO_BATCH_CHUNK];
+    double sum = 0, compensation = 0;
+
+    for (int start = 0; start < count; start += RADIO_BATCH_CHUNK) {
+        int n = count - start < RADIO_BATCH_CHUNK ? count - start : RADIO_BATCH_CHUNK;
+        for (int i = 0; i < n; i++) {
+            frequency[i] = sources[start + i].frequency;
+            power[i] = sources[start + i].power;
+            distance[i] = sources[start + i].distance;
+            terrain_factor[i] = sources[start + i].terrain_factor;
+        }
+        accumulate_columns(config, frequency, power, distance, terrain_factor, n, weather_db_per_km,
+                           &sum, &compensation);
+    }
+    return sum + compensation;
+}
+
+double propagation_batch_total_power_mw(const PropagationConfig *config, const RadioSourceBatch *batch,
+                                        double weather_db_per_km) {
+    double sum = 0, compensation = 0;
+    // Already columnar: hand the model slices of the batch without copying
+    for (int start = 0; start < batch->count; start += RADIO_BATCH_CHUNK) {
+        int n = batch->count - start < RADIO_BATCH_CHUNK ? batch->count - start : RADIO_BATCH_CHUNK;
+        accumulate_columns(config, batch->frequency + start, batch->power + start, batch->distance + start,
+                           batch->terrain_factor + start, n, weather_db_per_km, &sum, &compensation);
+    }
+    return sum + compensation;
+}
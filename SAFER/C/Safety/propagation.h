@@ -0,0 +1,58 @@
+// propagation.h - Pluggable propagation models evaluated per batch
+#ifndef PROPAGATION_H
+#define PROPAGATION_H
+
+#include "radio_interference.h"
+#include "radio_batch.h"
+
+typedef enum {
+    HATA_URBAN,
+    HATA_SUBURBAN,
+    HATA_OPEN,
+    HATA_METROPOLITAN   // COST-231 large-city correction above 1500 MHz
+} HataEnvironment;
+
+// Zero fields take the defaults noted
+typedef struct {
+    double transmitter_height_m; // Hata base station / two-ray transmitter (default 30)
+    double receiver_height_m;    // Hata mobile / two-ray receiver (default 1.5)
+    HataEnvironment environment;
+    double rain_rate_mm_h;       // ITU-R P.838 rain model
+    int vertical_polarization;   // ITU-R P.838 coefficients, horizontal otherwise
+} PropagationParams;
+
+// Path loss in dB for count sources given as columns (MHz, km). Called once
+// per batch so model dispatch is not paid per source.
+typedef void (*PathLossBatchFn)(const PropagationParams *params, const double *frequency,
+                                const double *distance, const double *terrain_factor,
+                                int count, double *path_loss);
+
+typedef struct {
+    const char *name;
+    PathLossBatchFn path_loss_batch;
+} PropagationModel;
+
+extern const PropagationModel propagation_free_space;
+extern const PropagationModel propagation_terrain;    // calculate_path_loss: free space + t log10(d)
+extern const PropagationModel propagation_hata;       // Okumura-Hata, COST-231 above 1500 MHz
+extern const PropagationModel propagation_two_ray;    // Free space inside the crossover distance
+extern const PropagationModel propagation_itu_rain;   // Free space + ITU-R P.838 rain attenuation
+
+// NULL when the name is unknown
+const PropagationModel *propagation_model_by_name(const char *name);
+
+typedef struct PropagationConfig {
+    const PropagationModel *model;
+    PropagationParams params;
+} PropagationConfig;
+
+// Sum of received power (mW) with weather attenuation of
+// weather_db_per_km * distance on every path
+double propagation_total_power_mw(const PropagationConfig *config, const RadioSource *sources, int count,
+                                  double weather_db_per_km);
+
+// Same for sources already in columns
+double propagation_batch_total_power_mw(const PropagationConfig *config, const RadioSourceBatch *batch,
+                                        double weather_db_per_km);
+
+#endif // PROPAGATION_H
@@ -0,0 +1,144 @@
+// radio_accumulator.c - Incremental interference accumulator
+#include "radio_accumulator.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_CAPACITY 64
+// A removal that leaves less than this fraction of its own size in the
+// total has cancelled most significant digits; resum straight away
+#define CANCELLATION_RATIO 1e-9
+
+static double source_contribution(const RadioSource *source) {
+    RadioSource copy = *source;
+    return pow(10, (copy.power - calculate_path_loss(&copy)) / 10);
+}
+
+// Neumaier compensated accumulation
+static void accumulate(double *sum, double *compensation, double value) {
+    double t = *sum + value;
+    if (fabs(*sum) >= fabs(value)) {
+        *compensation += (*sum - t) + value;
+    } else {
+        *compensation += (value - t) + *sum;
+    }
+    *sum = t;
+}
+
+static void refresh_analysis(RadioInterferenceAccumulator *acc) {
+    finish_radio_analysis(&acc->analysis, acc->total + acc->compensation, acc->background_noise);
+}
+
+// Apply a change of delta mW and keep drift bounded
+static void apply_delta(RadioInterferenceAccumulator *acc, double delta) {
+    accumulate(&acc->total, &acc->compensation, delta);
+    if (++acc->changes_since_resum >= acc->resum_interval ||
+        (delta < 0 && acc->total + acc->compensation < -delta * CANCELLATION_RATIO)) {
+        radio_accumulator_resum(acc);
+        return;
+    }
+    refresh_analysis(acc);
+}
+
+static int grow(RadioInterferenceAccumulator *acc) {
+    int capacity = acc->capacity ? acc->capacity * 2 : INITIAL_CAPACITY;
+    RadioSource *sources = realloc(acc->sources, sizeof(RadioSource) * capacity);
+    if (sources == NULL) return -1;
+    acc->sources = sources;
+    double *contribution = realloc(acc->contribution, sizeof(double) * capacity);
+    if (contribution == NULL) return -1;
+    acc->contribution = contribution;
+    unsigned char *active = realloc(acc->active, capacity);
+    if (active == NULL) return -1;
+    acc->active = active;
+    int *free_slots = realloc(acc->free_slots, sizeof(int) * capacity);
+    if (free_slots == NULL) return -1;
+    acc->free_slots = free_slots;
+
+    // New slots go on the free list highest first so they are handed out in order
+    for (int slot = capacity - 1; slot >= acc->capacity; slot--) {
+        acc->contribution[slot] = 0;
+        acc->active[slot] = 0;
+        acc->free_slots[acc->num_free++] = slot;
+    }
+    acc->capacity = capacity;
+    return 0;
+}
+
+int radio_accumulator_init(RadioInterferenceAccumulator *acc, double background_noise, int resum_interval) {
+    memset(acc, 0, sizeof(*acc));
+    acc->background_noise = background_noise;
+    acc->resum_interval = resum_interval > 0 ? resum_interval : RADIO_ACCUMULATOR_RESUM_INTERVAL;
+    if (grow(acc) != 0) {
+        radio_accumulator_free(acc);
+        return -1;
+    }
+    refresh_analysis(acc);
+    return 0;
+}
+
+void radio_accumulator_free(RadioInterferenceAccumulator *acc) {
+    free(acc->sources);
+    free(acc->contribution);
+    free(acc->active);
+    free(acc->free_slots);
+    memset(acc, 0, sizeof(*acc));
+}
+
+int radio_accumulator_add(RadioInterferenceAccumulator *acc, const RadioSource *source) {
+    if (acc->num_free == 0 && grow(acc) != 0) {
+        fprintf(stderr, "Radio accumulator: out of memory\n");
+        return -1;
+    }
+    int slot = acc->free_slots[--acc->num_free];
+    acc->sources[slot] = *source;
+    acc->contribution[slot] = source_contribution(source);
+    acc->active[slot] = 1;
+    acc->count++;
+    apply_delta(acc, acc->contribution[slot]);
+    return slot;
+}
+
+int radio_accumulator_update(RadioInterferenceAccumulator *acc, int handle, const RadioSource *source) {
+    if (handle < 0 || handle >= acc->capacity || !acc->active[handle]) {
+        return -1;
+    }
+    double previous = acc->contribution[handle];
+    acc->sources[handle] = *source;
+    acc->contribution[handle] = source_contribution(source);
+    apply_delta(acc, acc->contribution[handle] - previous);
+    return 0;
+}
+
+int radio_accumulator_remove(RadioInterferenceAccumulator *acc, int handle) {
+    if (handle < 0 || handle >= acc->capacity || !acc->active[handle]) {
+        return -1;
+    }
+    double previous = acc->contribution[handle];
+    acc->contribution[handle] = 0;
+    acc->active[handle] = 0;
+    acc->free_slots[acc->num_free++] = handle;
+    acc->count--;
+    apply_delta(acc, -previous);
+    return 0;
+}
+
+void radio_accumulator_set_background_noise(RadioInterferenceAccumulator *acc, double background_noise) {
+    acc->background_noise = background_noise;
+    refresh_analysis(acc);
+}
+
+void radio_accumulator_resum(RadioInterferenceAccumulator *acc) {
+    double total = 0, compensation = 0;
+    for (int slot = 0; slot < acc->capacity; slot++) {
+        accumulate(&total, &compensation, acc->contribution[slot]);
+    }
+    acc->total = total;
+    acc->compensation = compensation;
+    acc->changes_since_resum = 0;
+    acc->resums++;
+    refresh_analysis(acc);
+}
+
+const RadioInterferenceAnalysis *radio_accumulator_analysis(const RadioInterferenceAccumulator *acc) {
+    return &acc->analysis;
+}
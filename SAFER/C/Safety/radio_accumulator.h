@@ -0,0 +1,52 @@
+// radio_accumulator.h - Incrementally maintained interference total for a live emitter picture
+#ifndef RADIO_ACCUMULATOR_H
+#define RADIO_ACCUMULATOR_H
+
+#include "radio_interference.h"
+#include <stdint.h>
+
+// Exact resummation after this many changes unless configured otherwise
+#define RADIO_ACCUMULATOR_RESUM_INTERVAL 10000
+
+// Each source's linear power (mW) is cached in its slot and the total kept
+// as a compensated running sum, so add/remove/update cost one path-loss
+// evaluation plus an O(1) refresh of the analysis. Not thread safe; callers
+// sharing an accumulator hold their own lock.
+typedef struct {
+    RadioSource *sources;
+    double *contribution;   // mW, 0 for free slots
+    unsigned char *active;
+    int *free_slots;
+    int num_free;
+    int capacity;
+    int count;              // Active sources
+
+    double total;           // Neumaier sum of active contributions
+    double compensation;
+    int changes_since_resum;
+    int resum_interval;
+    uint64_t resums;
+
+    double background_noise;
+    RadioInterferenceAnalysis analysis;
+} RadioInterferenceAccumulator;
+
+// resum_interval <= 0 uses RADIO_ACCUMULATOR_RESUM_INTERVAL
+int radio_accumulator_init(RadioInterferenceAccumulator *acc, double background_noise, int resum_interval);
+void radio_accumulator_free(RadioInterferenceAccumulator *acc);
+
+// Returns a handle for later update/remove, or -1 on allocation failure.
+// Handles of removed sources are reused.
+int radio_accumulator_add(RadioInterferenceAccumulator *acc, const RadioSource *source);
+int radio_accumulator_update(RadioInterferenceAccumulator *acc, int handle, const RadioSource *source);
+int radio_accumulator_remove(RadioInterferenceAccumulator *acc, int handle);
+
+void radio_accumulator_set_background_noise(RadioInterferenceAccumulator *acc, double background_noise);
+
+// Recompute the total from the cached contributions, discarding drift
+void radio_accumulator_resum(RadioInterferenceAccumulator *acc);
+
+// Current analysis, valid until the next change
+const RadioInterferenceAnalysis *radio_accumulator_analysis(const RadioInterferenceAccumulator *acc);
+
+#endif // RADIO_ACCUMULATOR_H
@@ -0,0 +1,281 @@
+// radio_batch.c - SoA radio source batches and the AVX2 power kernel
+#define _POSIX_C_SOURCE 200809L
+#include "radio_batch.h"
+#include "radio_simd.h"
+#include "propagation.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define C 299792458.0  // Speed of light in m/s
+#define PI 3.14159265359 // Matches radio_interference.c
+
+#define COLUMN_ALIGN 64
+
+static int round_capacity(int capacity) {
+    return (capacity + 7) & ~7;
+}
+
+static double *alloc_column(int capacity) {
+    void *column = NULL;
+    if (posix_memalign(&column, COLUMN_ALIGN, sizeof(double) * (capacity > 0 ? capacity : 8)) != 0) {
+        return NULL;
+    }
+    return column;
+}
+
+int radio_batch_init(RadioSourceBatch *batch, int capacity) {
+    memset(batch, 0, sizeof(*batch));
+    return radio_batch_reserve(batch, capacity);
+}
+
+int radio_batch_reserve(RadioSourceBatch *batch, int capacity) {
+    if (capacity <= batch->capacity) {
+        return 0;
+    }
+    capacity = round_capacity(capacity);
+    double *columns[4] = {
+        alloc_column(capacity), alloc_column(capacity),
+        alloc_column(capacity), alloc_column(capacity)
+    };
+    if (!columns[0] || !columns[1] || !columns[2] || !columns[3]) {
+        for (int i = 0; i < 4; i++) free(columns[i]);
+        return -1;
+    }
+    double **fields[4] = { &batch->frequency, &batch->power, &batch->distance, &batch->terrain_factor };
+    for (int i = 0; i < 4; i++) {
+        if (*fields[i] != NULL) {
+            memcpy(columns[i], *fields[i], sizeof(double) * batch->count);
+            free(*fields[i]);
+        }
+        *fields[i] = columns[i];
+    }
+    batch->capacity = capacity;
+    return 0;
+}
+
+void radio_batch_free(RadioSourceBatch *batch) {
+    free(batch->frequency);
+    free(batch->power);
+    free(batch->distance);
+    free(batch->terrain_factor);
+    memset(batch, 0, sizeof(*batch));
+}
+
+int radio_batch_append(RadioSourceBatch *batch, const RadioSource *sources, int count) {
+    if (batch->count + count > batch->capacity) {
+        int capacity = batch->capacity ? batch->capacity : 64;
+        while (capacity < batch->count + count) {
+            capacity *= 2;
+        }
+        if (radio_batch_reserve(batch, capacity) != 0) {
+            return -1;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        int j = batch->count + i;
+        batch->frequency[j] = sources[i].frequency;
+        batch->power[j] = sources[i].power;
+        batch->distance[j] = sources[i].distance;
+        batch->terrain_factor[j] = sources[i].terrain_factor;
+    }
+    batch->count += count;
+    return 0;
+}
+
+// Neumaier compensated accumulation
+static inline void accumulate(double *sum, double *compensation, double value) {
+    double t = *sum + value;
+    if (fabs(*sum) >= fabs(value)) {
+        *compensation += (*sum - t) + value;
+    } else {
+        *compensation += (value - t) + *sum;
+    }
+    *sum = t;
+}
+
+int radio_batch_in_domain(const RadioSourceBatch *batch) {
+    for (int i = 0; i < batch->count; i++) {
+        if (!(batch->frequency[i] > 0) || !(batch->distance[i] > 0)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+double radio_batch_total_power_mw_scalar(const RadioSourceBatch *batch, double weather_db_per_km) {
+    if (!radio_batch_in_domain(batch)) {
+        return NAN;
+    }
+    double sum = 0.0, compensation = 0.0;
+    for (int i = 0; i < batch->count; i++) {
+        RadioSource source = {
+            .frequency = batch->frequency[i],
+            .power = batch->power[i],
+            .distance = batch->distance[i],
+            .terrain_factor = batch->terrain_factor[i]
+        };
+        double received_power = source.power - calculate_path_loss(&source) - weather_db_per_km * source.distance;
+        accumulate(&sum, &compensation, pow(10, received_power / 10));
+    }
+    return sum + compensation;
+}
+
+#ifdef RADIO_SIMD_AVX2
+
+__attribute__((target("avx2,fma")))
+static inline void accumulate_pd(__m256d *sum, __m256d *compensation, __m256d value) {
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+    __m256d t = _mm256_add_pd(*sum, value);
+    __m256d sum_larger = _mm256_cmp_pd(_mm256_andnot_pd(sign_mask, *sum),
+                                       _mm256_andnot_pd(sign_mask, value), _CMP_GE_OQ);
+    __m256d when_sum = _mm256_add_pd(_mm256_sub_pd(*sum, t), value);
+    __m256d when_value = _mm256_add_pd(_mm256_sub_pd(value, t), *sum);
+    *compensation = _mm256_add_pd(*compensation, _mm256_blendv_pd(when_value, when_sum, sum_larger));
+    *sum = t;
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d received_power_pd(__m256d frequency, __m256d power, __m256d distance,
+                                        __m256d terrain, __m256d power_offset, __m256d weather) {
+    // e = log2(10)/10 * (P - K - w*d) - 2*log2(f) - (2 + t/10)*log2(d),
+    // with weather already scaled by log2(10)/10
+    __m256d e = _mm256_fmadd_pd(power, _mm256_set1_pd(RADIO_LOG2_10 / 10), power_offset);
+    e = _mm256_fnmadd_pd(weather, distance, e);
+    e = _mm256_fnmadd_pd(_mm256_set1_pd(2.0), log2_pd(frequency), e);
+    __m256d distance_exponent = _mm256_fmadd_pd(terrain, _mm256_set1_pd(0.1), _mm256_set1_pd(2.0));
+    e = _mm256_fnmadd_pd(distance_exponent, log2_pd(distance), e);
+    return exp2_pd(e);
+}
+
+__attribute__((target("avx2,fma")))
+static double total_power_avx2(const RadioSourceBatch *batch, double power_offset, double weather_db_per_km) {
+    // log2_pd returns -1023 for zero and negative arguments where libm
+    // gives -inf or NaN, so both paths refuse the same sources up front
+    if (!radio_batch_in_domain(batch)) {
+        return NAN;
+    }
+    __m256d offset = _mm256_set1_pd(power_offset);
+    __m256d weather = _mm256_set1_pd(weather_db_per_km * RADIO_LOG2_10 / 10);
+    __m256d sum0 = _mm256_setzero_pd(), comp0 = _mm256_setzero_pd();
+    __m256d sum1 = _mm256_setzero_pd(), comp1 = _mm256_setzero_pd();
+    int n = batch->count;
+    int i = 0;
+
+    // Two independent accumulators keep both FMA pipes busy
+    for (; i + 8 <= n; i += 8) {
+        __m256d a = received_power_pd(_mm256_load_pd(batch->frequency + i), _mm256_load_pd(batch->power + i),
+                                      _mm256_load_pd(batch->distance + i), _mm256_load_pd(batch->terrain_factor + i),
+                                      offset, weather);
+        __m256d b = received_power_pd(_mm256_load_pd(batch->frequency + i + 4), _mm256_load_pd(batch->power + i + 4),
+                                      _mm256_load_pd(batch->distance + i + 4), _mm256_load_pd(batch->terrain_factor + i + 4),
+                                      offset, weather);
+        accumulate_pd(&sum0, &comp0, a);
+        accumulate_pd(&sum1, &comp1, b);
+    }
+    for (; i < n; i += 4) {
+        // Tail: inactive lanes evaluate a harmless source and are masked off
+        double frequency[4] = {1, 1, 1, 1}, power[4] = {0}, distance[4] = {1, 1, 1, 1}, terrain[4] = {0};
+        double active[4] = {0};
+        for (int j = 0; j < 4 && i + j < n; j++) {
+            frequency[j] = batch->frequency[i + j];
+            power[j] = batch->power[i + j];
+            distance[j] = batch->distance[i + j];
+            terrain[j] = batch->terrain_factor[i + j];
+            active[j] = 1.0;
+        }
+        __m256d value = received_power_pd(_mm256_loadu_pd(frequency), _mm256_loadu_pd(power),
+                                          _mm256_loadu_pd(distance), _mm256_loadu_pd(terrain), offset,
+                                          weather);
+        value = _mm256_mul_pd(value, _mm256_loadu_pd(active));
+        accumulate_pd(&sum0, &comp0, value);
+    }
+
+    double lanes[8], compensations[8];
+    _mm256_storeu_pd(lanes, sum0);
+    _mm256_storeu_pd(lanes + 4, sum1);
+    _mm256_storeu_pd(compensations, comp0);
+    _mm256_storeu_pd(compensations + 4, comp1);
+    double sum = 0.0, compensation = 0.0;
+    for (int j = 0; j < 8; j++) {
+        accumulate(&sum, &compensation, lanes[j]);
+        accumulate(&sum, &compensation, compensations[j]);
+    }
+    return sum + compensation;
+}
+
+#endif // RADIO_SIMD_AVX2
+
+// Path loss constant K = 20 log10(4 pi 1e9 / c), scaled into log2 units
+static double power_offset(void) {
+    return -20 * log10(4 * PI * 1e9 / C) * RADIO_LOG2_10 / 10;
+}
+
+int radio_batch_vectorized(void) {
+    return radio_simd_have_avx2();
+}
+
+double radio_batch_total_power_mw(const RadioSourceBatch *batch, double weather_db_per_km) {
+#ifdef RADIO_SIMD_AVX2
+    if (radio_simd_have_avx2()) {
+        return total_power_avx2(batch, power_offset(), weather_db_per_km);
+    }
+#endif
+    return radio_batch_total_power_mw_scalar(batch, weather_db_per_km);
+}
+
+double radio_sources_total_power_mw(const RadioSource *sources, int count, double weather_db_per_km) {
+    // Transpose through a small cache-resident SoA block instead of
+    // materialising a full batch
+    _Alignas(COLUMN_ALIGN) double frequency[RADIO_BATCH_CHUNK];
+    _Alignas(COLUMN_ALIGN) double power[RADIO_BATCH_CHUNK];
+    _Alignas(COLUMN_ALIGN) double distance[RADIO_BATCH_CHUNK];
+    _Alignas(COLUMN_ALIGN) double terrain_factor[RADIO_BATCH_CHUNK];
+    RadioSourceBatch chunk = {
+        .frequency = frequency, .power = power, .distance = distance,
+        .terrain_factor = terrain_factor, .capacity = RADIO_BATCH_CHUNK
+    };
+
+    int use_avx2 = radio_simd_have_avx2();
+    double sum = 0.0, compensation = 0.0;
+    for (int start = 0; start < count; start += RADIO_BATCH_CHUNK) {
+        chunk.count = count - start < RADIO_BATCH_CHUNK ? count - start : RADIO_BATCH_CHUNK;
+        for (int i = 0; i < chunk.count; i++) {
+            frequency[i] = sources[start + i].frequency;
+            power[i] = sources[start + i].power;
+            distance[i] = sources[start + i].distance;
+            terrain_factor[i] = sources[start + i].terrain_factor;
+        }
+#ifdef RADIO_SIMD_AVX2
+        if (use_avx2) {
+            accumulate(&sum, &compensation, total_power_avx2(&chunk, power_offset(), weather_db_per_km));
+            continue;
+        }
+#endif
+        (void)use_avx2;
+        accumulate(&sum, &compensation, radio_batch_total_power_mw_scalar(&chunk, weather_db_per_km));
+    }
+    return sum + compensation;
+}
+
+RadioInterferenceAnalysis analyze_radio_batch(const RadioSourceBatch *batch, double background_noise) {
+    RadioInterferenceAnalysis analysis = {0};
+    finish_radio_analysis(&analysis, radio_batch_total_power_mw(batch, 0), background_noise);
+    return analysis;
+}
+
+RadioInterferenceAnalysis analyze_radio_environment_batch(const RadioEnvironment *env,
+                                                          const RadioSourceBatch *batch) {
+    RadioInterferenceAnalysis analysis = {0};
+    if (!radio_batch_in_domain(batch)) {
+        finish_radio_analysis(&analysis, NAN, env->background_noise);
+        return analysis;
+    }
+    if (env->propagation == NULL || env->propagation->model == NULL) {
+        finish_radio_analysis(&analysis, radio_batch_total_power_mw(batch, env->weather_factor),
+                              env->background_noise);
+        return analysis;
+    }
+    finish_radio_analysis(&analysis, propagation_batch_total_power_mw(env->propagation, batch, env->weather_factor),
+                          env->background_noise);
+    return analysis;
+}
@@ -0,0 +1,65 @@
+// radio_batch.h - Structure-of-arrays radio source batches and the bulk power kernel
+#ifndef RADIO_BATCH_H
+#define RADIO_BATCH_H
+
+#include "radio_interference.h"
+
+// analyze_radio_interference switches to the batch kernel at this size
+#define RADIO_BATCH_MIN_SOURCES 256
+// Sources transposed per block by radio_sources_total_power_mw
+#define RADIO_BATCH_CHUNK 512
+
+// Columns are 64-byte aligned and padded to a multiple of 8 entries
+typedef struct {
+    double *frequency;      // MHz
+    double *power;          // dBm
+    double *distance;       // km
+    double *terrain_factor;
+    int count;
+    int capacity;
+} RadioSourceBatch;
+
+int radio_batch_init(RadioSourceBatch *batch, int capacity);
+int radio_batch_reserve(RadioSourceBatch *batch, int capacity);
+void radio_batch_free(RadioSourceBatch *batch);
+int radio_batch_append(RadioSourceBatch *batch, const RadioSource *sources, int count);
+
+// Whether radio_batch_total_power_mw runs the vectorised kernel on this CPU
+int radio_batch_vectorized(void);
+
+// Whether every source has a positive frequency and distance (see
+// radio_sources_in_domain)
+int radio_batch_in_domain(const RadioSourceBatch *batch);
+
+// Total received power in mW, sum over sources of
+// 10^((power - calculate_path_loss(source) - weather_db_per_km * distance) / 10).
+// NaN when the batch is not radio_batch_in_domain, on either path.
+//
+// The AVX2 path evaluates the exponent in base 2,
+//   e = log2(10)/10 * (P - K - w*d) - 2*log2(f) - (2 + t/10)*log2(d),
+// with log2 from an atanh series (|error| < 2e-13) and exp2 from a
+// degree-12 polynomial (relative error < 1e-15). Each source's power is
+// within 1e-12 relative of the libm result for path losses within the
+// double range. Lanes accumulate with Neumaier compensated summation,
+// so the total is accurate to a few ulp regardless of source count.
+double radio_batch_total_power_mw(const RadioSourceBatch *batch, double weather_db_per_km);
+
+// Same result for an array of structs, transposed block by block into a
+// stack buffer so no batch has to be allocated
+double radio_sources_total_power_mw(const RadioSource *sources, int count, double weather_db_per_km);
+
+// Reference implementation with libm log10/pow and the same summation
+double radio_batch_total_power_mw_scalar(const RadioSourceBatch *batch, double weather_db_per_km);
+
+// Full analysis of a batch, equivalent to analyze_radio_interference
+// without weather attenuation
+RadioInterferenceAnalysis analyze_radio_batch(const RadioSourceBatch *batch, double background_noise);
+
+// analyze_radio_interference for an environment whose sources arrive as a
+// batch; env->sources and env->num_sources are ignored. Without a
+// propagation model this is the batch kernel with env's weather_factor, so
+// small batches take the exact path instead of the lookup table.
+RadioInterferenceAnalysis analyze_radio_environment_batch(const RadioEnvironment *env,
+                                                          const RadioSourceBatch *batch);
+
+#endif // RADIO_BATCH_H
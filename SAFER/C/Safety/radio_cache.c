@@ -0,0 +1,359 @@
+// radio_cache.c - Content-addressed LRU with single-flight misses
+#include "radio_cache.h"
+#include "propagation.h"
+#include <pthread.h>
+
+#define DEFAULT_MAX_ENTRIES 4096
+#define DEFAULT_MAX_KEY_BYTES ((size_t)64 << 20)
+#define HEADER_WORDS 9
+#define SOURCE_WORDS 4
+
+typedef struct RadioCacheEntry {
+    uint64_t hash;
+    uint64_t *key;            // Canonical request words
+    size_t key_words;
+    unsigned long generation;
+    int ready;                // 0 while the first requester computes it
+    int waiters;              // Requesters blocked on it; pins the entry
+    RadioInterferenceAnalysis analysis;
+    struct RadioCacheEntry *hash_next;
+    struct RadioCacheEntry *lru_prev, *lru_next; // Ready entries only
+} RadioCacheEntry;
+
+// Sources come from env->sources, or from batch columns when batch is set;
+// both layouts produce the same key
+typedef struct {
+    RadioEnvironment *env;
+    const RadioSourceBatch *batch;
+} CacheRequest;
+
+struct RadioCache {
+    pthread_mutex_t lock;
+    pthread_cond_t ready_cond;
+    RadioCacheEntry **buckets;
+    size_t bucket_mask;
+    RadioCacheEntry *lru_head, *lru_tail;
+    int max_entries;
+    size_t max_key_bytes;
+    unsigned long generation;        // Bumped by radio_cache_invalidate
+    unsigned long engine_generation; // radio_engine_generation() last seen
+    RadioCacheStats stats;
+};
+
+// Bit pattern of v with -0 folded into 0 (-0 + 0 is +0)
+static uint64_t canonical_bits(double v) {
+    v += 0.0;
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+static void header_words(const RadioEnvironment *env, uint64_t *words) {
+    const PropagationConfig *propagation = env->propagation;
+    int has_model = propagation != NULL && propagation->model != NULL;
+    words[0] = canonical_bits(env->background_noise);
+    words[1] = canonical_bits(env->weather_factor);
+    // Models are static, so their address identifies them within the process
+    words[2] = has_model ? (uint64_t)(uintptr_t)propagation->model : 0;
+    words[3] = has_model ? canonical_bits(propagation->params.transmitter_height_m) : 0;
+    words[4] = has_model ? canonical_bits(propagation->params.receiver_height_m) : 0;
+    words[5] = has_model ? (uint64_t)propagation->params.environment : 0;
+    words[6] = has_model ? canonical_bits(propagation->params.rain_rate_mm_h) : 0;
+    words[7] = has_model ? (uint64_t)propagation->params.vertical_polarization : 0;
+    words[8] = (uint64_t)env->num_sources;
+}
+
+static void source_words(const CacheRequest *request, int i, uint64_t *words) {
+    const RadioSourceBatch *batch = request->batch;
+    if (batch != NULL) {
+        words[0] = canonical_bits(batch->frequency[i]);
+        words[1] = canonical_bits(batch->power[i]);
+        words[2] = canonical_bits(batch->distance[i]);
+        words[3] = canonical_bits(batch->terrain_factor[i]);
+        return;
+    }
+    const RadioSource *source = &request->env->sources[i];
+    words[0] = canonical_bits(source->frequency);
+    words[1] = canonical_bits(source->power);
+    words[2] = canonical_bits(source->distance);
+    words[3] = canonical_bits(source->terrain_factor);
+}
+
+static uint64_t mix(uint64_t h, uint64_t word) {
+    h ^= word;
+    h *= 0x9e3779b97f4a7c15ULL;
+    return h ^ (h >> 29);
+}
+
+static uint64_t hash_request(const CacheRequest *request) {
+    const RadioEnvironment *env = request->env;
+    const RadioSourceBatch *batch = request->batch;
+    uint64_t words[HEADER_WORDS];
+    uint64_t h = 0x243f6a8885a308d3ULL;
+    header_words(env, words);
+    for (int i = 0; i < HEADER_WORDS; i++) {
+        h = mix(h, words[i]);
+    }
+    // One lane per source field keeps four independent multiply chains in flight
+    uint64_t h0 = h, h1 = h ^ 1, h2 = h ^ 2, h3 = h ^ 3;
+    if (batch != NULL) {
+        for (int i = 0; i < env->num_sources; i++) {
+            h0 = mix(h0, canonical_bits(batch->frequency[i]));
+            h1 = mix(h1, canonical_bits(batch->power[i]));
+            h2 = mix(h2, canonical_bits(batch->distance[i]));
+            h3 = mix(h3, canonical_bits(batch->terrain_factor[i]));
+        }
+    } else {
+        for (int i = 0; i < env->num_sources; i++) {
+            const RadioSource *source = &env->sources[i];
+            h0 = mix(h0, canonical_bits(source->frequency));
+            h1 = mix(h1, canonical_bits(source->power));
+            h2 = mix(h2, canonical_bits(source->distance));
+            h3 = mix(h3, canonical_bits(source->terrain_factor));
+        }
+    }
+    h = mix(mix(mix(mix(h, h0), h1), h2), h3);
+    h ^= h >> 32;
+    h *= 0xd6e8feb86659fd93ULL;
+    return h ^ (h >> 32);
+}
+
+static int key_matches(const RadioCacheEntry *entry, const CacheRequest *request) {
+    const RadioEnvironment *env = request->env;
+    uint64_t words[HEADER_WORDS];
+    if (entry->key_words != HEADER_WORDS + (size_t)env->num_sources * SOURCE_WORDS) {
+        return 0;
+    }
+    header_words(env, words);
+    if (memcmp(entry->key, words, sizeof(words)) != 0) {
+        return 0;
+    }
+    const uint64_t *key = entry->key + HEADER_WORDS;
+    for (int i = 0; i < env->num_sources; i++, key += SOURCE_WORDS) {
+        source_words(request, i, words);
+        if (memcmp(key, words, SOURCE_WORDS * sizeof(uint64_t)) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static uint64_t *build_key(const CacheRequest *request, size_t key_words) {
+    uint64_t *key = malloc(key_words * sizeof(uint64_t));
+    if (key != NULL) {
+        header_words(request->env, key);
+        for (int i = 0; i < request->env->num_sources; i++) {
+            source_words(request, i, key + HEADER_WORDS + (size_t)i * SOURCE_WORDS);
+        }
+    }
+    return key;
+}
+
+RadioCache *radio_cache_create(const RadioCacheConfig *config) {
+    RadioCache *cache = calloc(1, sizeof(RadioCache));
+    if (cache == NULL) {
+        return NULL;
+    }
+    cache->max_entries = config != NULL && config->max_entries > 0 ? config->max_entries : DEFAULT_MAX_ENTRIES;
+    cache->max_key_bytes = config != NULL && config->max_key_bytes > 0 ? config->max_key_bytes
+                                                                      : DEFAULT_MAX_KEY_BYTES;
+    size_t buckets = 16;
+    while (buckets < (size_t)cache->max_entries * 2) {
+        buckets <<= 1;
+    }
+    cache->buckets = calloc(buckets, sizeof(RadioCacheEntry *));
+    if (cache->buckets == NULL) {
+        free(cache);
+        return NULL;
+    }
+    cache->bucket_mask = buckets - 1;
+    cache->engine_generation = radio_engine_generation();
+    pthread_mutex_init(&cache->lock, NULL);
+    pthread_cond_init(&cache->ready_cond, NULL);
+    return cache;
+}
+
+static void free_entry(RadioCacheEntry *entry) {
+    free(entry->key);
+    free(entry);
+}
+
+void radio_cache_destroy(RadioCache *cache) {
+    if (cache == NULL) {
+        return;
+    }
+    for (size_t i = 0; i <= cache->bucket_mask; i++) {
+        RadioCacheEntry *entry = cache->buckets[i];
+        while (entry != NULL) {
+            RadioCacheEntry *next = entry->hash_next;
+            free_entry(entry);
+            entry = next;
+        }
+    }
+    pthread_mutex_destroy(&cache->lock);
+    pthread_cond_destroy(&cache->ready_cond);
+    free(cache->buckets);
+    free(cache);
+}
+
+static void lru_unlink(RadioCache *cache, RadioCacheEntry *entry) {
+    if (entry->lru_prev != NULL) entry->lru_prev->lru_next = entry->lru_next;
+    else cache->lru_head = entry->lru_next;
+    if (entry->lru_next != NULL) entry->lru_next->lru_prev = entry->lru_prev;
+    else cache->lru_tail = entry->lru_prev;
+    entry->lru_prev = entry->lru_next = NULL;
+}
+
+static void lru_push_front(RadioCache *cache, RadioCacheEntry *entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = cache->lru_head;
+    if (cache->lru_head != NULL) cache->lru_head->lru_prev = entry;
+    else cache->lru_tail = entry;
+    cache->lru_head = entry;
+}
+
+// Remove a ready, unpinned entry; called with the lock held
+static void remove_entry(RadioCache *cache, RadioCacheEntry *entry) {
+    RadioCacheEntry **link = &cache->buckets[entry->hash & cache->bucket_mask];
+    while (*link != entry) {
+        link = &(*link)->hash_next;
+    }
+    *link = entry->hash_next;
+    lru_unlink(cache, entry);
+    cache->stats.entries--;
+    cache->stats.key_bytes -= entry->key_words * sizeof(uint64_t);
+    free_entry(entry);
+}
+
+static void evict(RadioCache *cache) {
+    RadioCacheEntry *victim = cache->lru_tail;
+    while (victim != NULL &&
+           (cache->stats.entries > cache->max_entries || cache->stats.key_bytes > cache->max_key_bytes)) {
+        RadioCacheEntry *prev = victim->lru_prev;
+        if (victim->waiters == 0) {
+            remove_entry(cache, victim);
+            cache->stats.evictions++;
+        }
+        victim = prev;
+    }
+}
+
+void radio_cache_invalidate(RadioCache *cache) {
+    pthread_mutex_lock(&cache->lock);
+    cache->generation++;
+    cache->stats.invalidations++;
+    // Pinned and in-flight entries go stale instead; lookups skip them
+    RadioCacheEntry *entry = cache->lru_head;
+    while (entry != NULL) {
+        RadioCacheEntry *next = entry->lru_next;
+        if (entry->waiters == 0) {
+            remove_entry(cache, entry);
+        }
+        entry = next;
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+static int cache_analyze(RadioCache *cache, const CacheRequest *request, RadioInterferenceAnalysis *analysis) {
+    unsigned long engine_generation = radio_engine_generation();
+    if (engine_generation != __atomic_load_n(&cache->engine_generation, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&cache->engine_generation, engine_generation, __ATOMIC_RELAXED);
+        radio_cache_invalidate(cache);
+    }
+    uint64_t hash = hash_request(request);
+    size_t key_words = HEADER_WORDS + (size_t)request->env->num_sources * SOURCE_WORDS;
+
+    pthread_mutex_lock(&cache->lock);
+    unsigned long generation = cache->generation;
+    RadioCacheEntry *entry = cache->buckets[hash & cache->bucket_mask];
+    while (entry != NULL) {
+        RadioCacheEntry *next = entry->hash_next;
+        if (entry->generation != generation) {
+            // Left behind by an invalidation while pinned; drop it once free
+            if (entry->ready && entry->waiters == 0) {
+                remove_entry(cache, entry);
+            }
+        } else if (entry->hash == hash && key_matches(entry, request)) {
+            break;
+        }
+        entry = next;
+    }
+    if (entry != NULL) {
+        if (!entry->ready) {
+            entry->waiters++;
+            cache->stats.coalesced++;
+            while (!entry->ready) {
+                pthread_cond_wait(&cache->ready_cond, &cache->lock);
+            }
+            entry->waiters--;
+        } else {
+            lru_unlink(cache, entry);
+            lru_push_front(cache, entry);
+        }
+        cache->stats.hits++;
+        *analysis = entry->analysis;
+        pthread_mutex_unlock(&cache->lock);
+        return 1;
+    }
+    cache->stats.misses++;
+
+    // Claim the key so identical requests wait for this computation
+    if (key_words * sizeof(uint64_t) <= cache->max_key_bytes) {
+        entry = calloc(1, sizeof(RadioCacheEntry));
+        if (entry != NULL && (entry->key = build_key(request, key_words)) == NULL) {
+            free(entry);
+            entry = NULL;
+        }
+    }
+    if (entry != NULL) {
+        entry->hash = hash;
+        entry->key_words = key_words;
+        entry->generation = generation;
+        RadioCacheEntry **bucket = &cache->buckets[hash & cache->bucket_mask];
+        entry->hash_next = *bucket;
+        *bucket = entry;
+        cache->stats.entries++;
+        cache->stats.key_bytes += key_words * sizeof(uint64_t);
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    *analysis = request->batch != NULL ? analyze_radio_environment_batch(request->env, request->batch)
+                                       : analyze_radio_interference(request->env);
+    if (entry == NULL) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    entry->analysis = *analysis;
+    entry->ready = 1;
+    lru_push_front(cache, entry);
+    if (entry->generation != cache->generation && entry->waiters == 0) {
+        // Invalidated while computing and nobody is waiting for it
+        remove_entry(cache, entry);
+    } else {
+        evict(cache);
+    }
+    pthread_cond_broadcast(&cache->ready_cond);
+    pthread_mutex_unlock(&cache->lock);
+    return 0;
+}
+
+int radio_cache_analyze(RadioCache *cache, RadioEnvironment *env, RadioInterferenceAnalysis *analysis) {
+    CacheRequest request = { .env = env };
+    return cache_analyze(cache, &request, analysis);
+}
+
+int radio_cache_analyze_batch(RadioCache *cache, const RadioEnvironment *env, const RadioSourceBatch *batch,
+                              RadioInterferenceAnalysis *analysis) {
+    RadioEnvironment header = *env;
+    header.sources = NULL;
+    header.num_sources = batch->count;
+    CacheRequest request = { .env = &header, .batch = batch };
+    return cache_analyze(cache, &request, analysis);
+}
+
+void radio_cache_stats(RadioCache *cache, RadioCacheStats *stats) {
+    pthread_mutex_lock(&cache->lock);
+    *stats = cache->stats;
+    pthread_mutex_unlock(&cache->lock);
+}
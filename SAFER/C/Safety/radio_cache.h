@@ -0,0 +1,53 @@
+// radio_cache.h - Bounded LRU cache of radio interference analyses
+#ifndef RADIO_CACHE_H
+#define RADIO_CACHE_H
+
+#include "radio_interference.h"
+#include "radio_batch.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Zero fields take the defaults noted
+typedef struct {
+    int max_entries;        // Default 4096
+    size_t max_key_bytes;   // Canonical keys kept, summed (default 64 MiB)
+} RadioCacheConfig;
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t coalesced;     // Hits that waited on an identical in-flight analysis
+    uint64_t evictions;
+    uint64_t invalidations;
+    int entries;
+    size_t key_bytes;
+} RadioCacheStats;
+
+typedef struct RadioCache RadioCache;
+
+// config may be NULL. Returns NULL on failure.
+RadioCache *radio_cache_create(const RadioCacheConfig *config);
+void radio_cache_destroy(RadioCache *cache);
+
+// analyze_radio_interference through the cache. The key is the canonical
+// request: background noise, weather factor, propagation model and
+// parameters, and each source's frequency, power, distance and terrain
+// factor, with -0 folded into 0. A hit costs one hash pass and one compare
+// pass over the sources and allocates nothing. Concurrent identical misses
+// run the analysis once; the others wait for it. Returns 1 on a hit, 0 on
+// a miss.
+int radio_cache_analyze(RadioCache *cache, RadioEnvironment *env, RadioInterferenceAnalysis *analysis);
+
+// The same for sources given as batch columns (analyze_radio_environment_batch
+// on a miss). Keys match radio_cache_analyze, so a request answers later
+// requests for the same environment in either layout.
+int radio_cache_analyze_batch(RadioCache *cache, const RadioEnvironment *env, const RadioSourceBatch *batch,
+                              RadioInterferenceAnalysis *analysis);
+
+// Drop every cached result. Also happens on the first lookup after
+// radio_engine_configure.
+void radio_cache_invalidate(RadioCache *cache);
+
+void radio_cache_stats(RadioCache *cache, RadioCacheStats *stats);
+
+#endif // RADIO_CACHE_H
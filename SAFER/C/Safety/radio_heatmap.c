@@ -0,0 +1,301 @@
+// radio_heatmap.c - Tiled, multi-threaded interference heatmaps
+#define _POSIX_C_SOURCE 200809L
+#include "radio_heatmap.h"
+#include "radio_simd.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define C 299792458.0  // Speed of light in m/s
+#define PI 3.14159265359 // Matches radio_interference.c
+
+#define DEFAULT_TILE_SIZE 64
+#define MAX_TILE_SIZE 512
+#define DEFAULT_CULL_MARGIN_DB 20.0
+#define MIN_DISTANCE_SQUARED 1e-6 // (1 m)^2 in km^2
+
+// Received power at squared distance d2 (km^2) is 2^(exponent - slope * log2(d2)),
+// the path loss of calculate_path_loss rewritten in base 2
+typedef struct {
+    double x, y, z;
+    double exponent;   // log2 of the power in mW received at 1 km
+    double slope;      // 1 + terrain_factor / 20
+    double scale;      // 2^exponent, for free-space emitters
+    int free_space;    // terrain_factor == 0: power is scale / d2
+} HeatmapEmitter;
+
+typedef struct {
+    const HeatmapGrid *grid;
+    const HeatmapEmitter *emitters;
+    int num_emitters;
+    int cull;
+    double cutoff;     // log2 mW below which a contribution is culled
+    double background_noise;
+    int tile_size;
+    int tiles_x, tiles_y, total_tiles;
+    float *interference;
+    float *signal_to_noise;
+
+    int next_tile;     // Claimed with __atomic_fetch_add
+    pthread_mutex_t stats_lock;
+    long long pairs_evaluated;
+    long long pairs_culled;
+} HeatmapJob;
+
+static double elapsed_ms_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+static double axis_gap(double value, double low, double high) {
+    if (value < low) return low - value;
+    if (value > high) return value - high;
+    return 0.0;
+}
+
+static void accumulate_emitter_scalar(double *acc, const double *xs, int cols, int rows,
+                                      double y0, double cell_size, double z, const HeatmapEmitter *e) {
+    double dz = z - e->z;
+    for (int r = 0; r < rows; r++) {
+        double dy = y0 + r * cell_size - e->y;
+        double base = dy * dy + dz * dz;
+        double *row = acc + (size_t)r * cols;
+        for (int c = 0; c < cols; c++) {
+            double dx = xs[c] - e->x;
+            double d2 = fmax(dx * dx + base, MIN_DISTANCE_SQUARED);
+            row[c] += e->free_space ? e->scale / d2 : exp2(e->exponent - e->slope * log2(d2));
+        }
+    }
+}
+
+#ifdef RADIO_SIMD_AVX2
+
+// cols is a multiple of 4 and acc/xs are 32-byte aligned. The map is stored
+// as float, so the reduced precision log2/exp2 are enough (< 1e-6 dB).
+__attribute__((target("avx2,fma")))
+static void accumulate_emitter_avx2(double *acc, const double *xs, int cols, int rows,
+                                    double y0, double cell_size, double z, const HeatmapEmitter *e) {
+    const __m256d ex = _mm256_set1_pd(e->x);
+    const __m256d min_d2 = _mm256_set1_pd(MIN_DISTANCE_SQUARED);
+    const __m256d exponent = _mm256_set1_pd(e->exponent);
+    const __m256d slope = _mm256_set1_pd(e->slope);
+    const __m256d scale = _mm256_set1_pd(e->scale);
+    double dz = z - e->z;
+
+    for (int r = 0; r < rows; r++) {
+        double dy = y0 + r * cell_size - e->y;
+        __m256d base = _mm256_set1_pd(dy * dy + dz * dz);
+        double *row = acc + (size_t)r * cols;
+        if (e->free_space) {
+            for (int c = 0; c < cols; c += 4) {
+                __m256d dx = _mm256_sub_pd(_mm256_load_pd(xs + c), ex);
+                __m256d d2 = _mm256_max_pd(_mm256_fmadd_pd(dx, dx, base), min_d2);
+                _mm256_store_pd(row + c, _mm256_add_pd(_mm256_load_pd(row + c), _mm256_div_pd(scale, d2)));
+            }
+        } else {
+            for (int c = 0; c < cols; c += 4) {
+                __m256d dx = _mm256_sub_pd(_mm256_load_pd(xs + c), ex);
+                __m256d d2 = _mm256_max_pd(_mm256_fmadd_pd(dx, dx, base), min_d2);
+                __m256d power = exp2_lowp_pd(_mm256_fnmadd_pd(slope, log2_lowp_pd(d2), exponent));
+                _mm256_store_pd(row + c, _mm256_add_pd(_mm256_load_pd(row + c), power));
+            }
+        }
+    }
+}
+
+#endif // RADIO_SIMD_AVX2
+
+static void *heatmap_worker(void *arg) {
+    HeatmapJob *job = arg;
+    const HeatmapGrid *grid = job->grid;
+    int tile = job->tile_size;
+    int use_avx2 = radio_simd_have_avx2();
+
+    // Tile accumulator and column positions stay cache resident across emitters
+    double *acc = NULL, *xs = NULL;
+    int *active = malloc(sizeof(int) * (job->num_emitters > 0 ? job->num_emitters : 1));
+    if (posix_memalign((void **)&acc, 64, sizeof(double) * tile * tile) != 0) acc = NULL;
+    if (posix_memalign((void **)&xs, 64, sizeof(double) * tile) != 0) xs = NULL;
+    if (acc == NULL || xs == NULL || active == NULL) {
+        free(acc);
+        free(xs);
+        free(active);
+        return NULL;
+    }
+
+    long long evaluated = 0, culled = 0;
+    int tiles_per_layer = job->tiles_x * job->tiles_y;
+    for (;;) {
+        int t = __atomic_fetch_add(&job->next_tile, 1, __ATOMIC_RELAXED);
+        if (t >= job->total_tiles) break;
+
+        int layer = t / tiles_per_layer;
+        int col0 = (t % tiles_per_layer) % job->tiles_x * tile;
+        int row0 = (t % tiles_per_layer) / job->tiles_x * tile;
+        int cols = grid->width - col0 < tile ? grid->width - col0 : tile;
+        int rows = grid->height - row0 < tile ? grid->height - row0 : tile;
+        int stride = (cols + 3) & ~3;
+        double z = grid->altitude + layer * grid->layer_spacing;
+        double y0 = grid->origin_y + row0 * grid->cell_size;
+        for (int c = 0; c < stride; c++) {
+            xs[c] = grid->origin_x + (col0 + c) * grid->cell_size;
+        }
+
+        // Emitters whose strongest contribution in the tile is below the cutoff
+        int num_active = 0;
+        double x_low = xs[0], x_high = xs[cols - 1];
+        double y_high = y0 + (rows - 1) * grid->cell_size;
+        for (int i = 0; i < job->num_emitters; i++) {
+            const HeatmapEmitter *e = &job->emitters[i];
+            if (job->cull && e->slope > 0) {
+                double dx = axis_gap(e->x, x_low, x_high);
+                double dy = axis_gap(e->y, y0, y_high);
+                double d2 = fmax(dx * dx + dy * dy + (z - e->z) * (z - e->z), MIN_DISTANCE_SQUARED);
+                if (e->exponent - e->slope * log2(d2) < job->cutoff) {
+                    culled += (long long)rows * cols;
+                    continue;
+                }
+            }
+            active[num_active++] = i;
+        }
+
+        memset(acc, 0, sizeof(double) * rows * stride);
+        for (int i = 0; i < num_active; i++) {
+            const HeatmapEmitter *e = &job->emitters[active[i]];
+#ifdef RADIO_SIMD_AVX2
+            if (use_avx2) {
+                accumulate_emitter_avx2(acc, xs, stride, rows, y0, grid->cell_size, z, e);
+                continue;
+            }
+#endif
+            (void)use_avx2;
+            accumulate_emitter_scalar(acc, xs, stride, rows, y0, grid->cell_size, z, e);
+        }
+        evaluated += (long long)num_active * rows * cols;
+
+        for (int r = 0; r < rows; r++) {
+            size_t out = ((size_t)layer * grid->height + row0 + r) * grid->width + col0;
+            for (int c = 0; c < cols; c++) {
+                double total = acc[(size_t)r * stride + c];
+                float level = total > 0 ? (float)(10 * log10(total)) : -INFINITY;
+                job->interference[out + c] = level;
+                job->signal_to_noise[out + c] = level - (float)job->background_noise;
+            }
+        }
+    }
+
+    pthread_mutex_lock(&job->stats_lock);
+    job->pairs_evaluated += evaluated;
+    job->pairs_culled += culled;
+    pthread_mutex_unlock(&job->stats_lock);
+
+    free(acc);
+    free(xs);
+    free(active);
+    return NULL;
+}
+
+int compute_interference_heatmap(const RadioEnvironment *env, const HeatmapGrid *grid,
+                                 const HeatmapOptions *options, InterferenceHeatmap *heatmap) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    memset(heatmap, 0, sizeof(*heatmap));
+
+    if (grid->width <= 0 || grid->height <= 0 || grid->cell_size <= 0) {
+        fprintf(stderr, "Invalid heatmap grid %dx%d\n", grid->width, grid->height);
+        return -1;
+    }
+    HeatmapOptions opts = {0};
+    if (options != NULL) {
+        opts = *options;
+    }
+    if (opts.tile_size <= 0) opts.tile_size = DEFAULT_TILE_SIZE;
+    opts.tile_size = ((opts.tile_size + 7) & ~7) < MAX_TILE_SIZE ? (opts.tile_size + 7) & ~7 : MAX_TILE_SIZE;
+    if (opts.cull_margin_db <= 0) opts.cull_margin_db = DEFAULT_CULL_MARGIN_DB;
+    if (opts.threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        opts.threads = cpus > 0 ? (int)cpus : 1;
+    }
+
+    heatmap->grid = *grid;
+    if (heatmap->grid.layers <= 0) heatmap->grid.layers = 1;
+    size_t cells = (size_t)grid->width * grid->height * heatmap->grid.layers;
+    heatmap->interference = malloc(sizeof(float) * cells);
+    heatmap->signal_to_noise = malloc(sizeof(float) * cells);
+    HeatmapEmitter *emitters = malloc(sizeof(HeatmapEmitter) * (env->num_sources > 0 ? env->num_sources : 1));
+    if (heatmap->interference == NULL || heatmap->signal_to_noise == NULL || emitters == NULL) {
+        free(emitters);
+        free_interference_heatmap(heatmap);
+        return -1;
+    }
+
+    // Per-emitter constants: everything in the path loss except distance
+    double k = 20 * log10(4 * PI * 1e9 / C);
+    int num_emitters = 0;
+    for (int i = 0; i < env->num_sources; i++) {
+        const RadioSource *source = &env->sources[i];
+        if (!(source->frequency > 0)) continue;
+        HeatmapEmitter *e = &emitters[num_emitters++];
+        e->x = source->x;
+        e->y = source->y;
+        e->z = source->altitude;
+        e->exponent = (source->power - k) * RADIO_LOG2_10 / 10 - 2 * log2(source->frequency);
+        e->slope = 1 + source->terrain_factor / 20;
+        e->scale = exp2(e->exponent);
+        e->free_space = source->terrain_factor == 0;
+    }
+
+    HeatmapJob job = {
+        .grid = &heatmap->grid,
+        .emitters = emitters,
+        .num_emitters = num_emitters,
+        .cull = !opts.disable_culling,
+        .cutoff = (env->background_noise - opts.cull_margin_db) * RADIO_LOG2_10 / 10,
+        .background_noise = env->background_noise,
+        .tile_size = opts.tile_size,
+        .interference = heatmap->interference,
+        .signal_to_noise = heatmap->signal_to_noise
+    };
+    job.tiles_x = (grid->width + opts.tile_size - 1) / opts.tile_size;
+    job.tiles_y = (grid->height + opts.tile_size - 1) / opts.tile_size;
+    job.total_tiles = job.tiles_x * job.tiles_y * heatmap->grid.layers;
+    pthread_mutex_init(&job.stats_lock, NULL);
+
+    int threads = opts.threads < job.total_tiles ? opts.threads : job.total_tiles;
+    pthread_t *workers = malloc(sizeof(pthread_t) * threads);
+    int started = 0;
+    for (; workers != NULL && started < threads - 1; started++) {
+        if (pthread_create(&workers[started], NULL, heatmap_worker, &job) != 0) {
+            break;
+        }
+    }
+    // The calling thread works too, so a failed spawn only costs parallelism
+    heatmap_worker(&job);
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+    pthread_mutex_destroy(&job.stats_lock);
+    free(emitters);
+
+    // Tiles are only left unclaimed when no worker could allocate its buffers
+    if (job.next_tile < job.total_tiles) {
+        free_interference_heatmap(heatmap);
+        return -1;
+    }
+    heatmap->pairs_evaluated = job.pairs_evaluated;
+    heatmap->pairs_culled = job.pairs_culled;
+    heatmap->elapsed_ms = elapsed_ms_since(&start);
+    return 0;
+}
+
+void free_interference_heatmap(InterferenceHeatmap *heatmap) {
+    free(heatmap->interference);
+    free(heatmap->signal_to_noise);
+    heatmap->interference = NULL;
+    heatmap->signal_to_noise = NULL;
+}
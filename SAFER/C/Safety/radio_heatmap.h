@@ -0,0 +1,48 @@
+// radio_heatmap.h - Interference and SNR maps over a grid of receiver positions
+#ifndef RADIO_HEATMAP_H
+#define RADIO_HEATMAP_H
+
+#include "radio_interference.h"
+
+// Receiver positions: cell (column, row, layer) sits at
+// (origin_x + column * cell_size, origin_y + row * cell_size,
+//  altitude + layer * layer_spacing), all in km in the sources' frame
+typedef struct {
+    double origin_x, origin_y;
+    double cell_size;
+    int width, height;
+    double altitude;
+    double layer_spacing;
+    int layers;             // 1 for a 2D map
+} HeatmapGrid;
+
+typedef struct {
+    int threads;            // Worker threads (default: online CPUs)
+    int tile_size;          // Cells per tile edge, multiple of 8 (default 64)
+    int disable_culling;
+    // An emitter is skipped for a tile when its strongest contribution
+    // anywhere in the tile is this far below background noise (default 20 dB)
+    double cull_margin_db;
+} HeatmapOptions;
+
+typedef struct {
+    HeatmapGrid grid;
+    // dBm and dB per cell at (layer * height + row) * width + column;
+    // -INFINITY where no emitter contributed
+    float *interference;
+    float *signal_to_noise;
+    long long pairs_evaluated; // Emitter/cell pairs computed
+    long long pairs_culled;    // Emitter/cell pairs skipped by culling
+    double elapsed_ms;
+} InterferenceHeatmap;
+
+// Sources are placed by x, y and altitude; their distance field is
+// ignored. Receivers closer than 1 m to an emitter are evaluated at 1 m.
+// options may be NULL for defaults. Returns 0 on success, -1 on invalid
+// grid or allocation failure.
+int compute_interference_heatmap(const RadioEnvironment *env, const HeatmapGrid *grid,
+                                 const HeatmapOptions *options, InterferenceHeatmap *heatmap);
+
+void free_interference_heatmap(InterferenceHeatmap *heatmap);
+
+#endif // RADIO_HEATMAP_H
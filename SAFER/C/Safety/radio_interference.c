@@ -1,51 +1,177 @@
 // radio_interference.c
 #include "radio_interference.h"
+#include "radio_batch.h"
+#include "path_loss_table.h"
+#include "propagation.h"
+#include "risk_rules.h"
+#include <pthread.h>
 
 #define C 299792458.0  // Speed of light in m/s
 #define PI 3.14159265359
 
+static RadioEngineConfig engine_config = {
+    .path_loss_table_threshold = 64,
+    .path_loss_max_error_db = 0.01,
+    .path_loss_max_terrain_factor = 20
+};
+static PathLossTable path_loss_table;
+static int path_loss_table_ready;
+static pthread_once_t path_loss_table_once = PTHREAD_ONCE_INIT;
+static unsigned long engine_generation;
+
+static void build_default_table(void) {
+    if (!path_loss_table_ready) {
+        path_loss_table_ready = path_loss_table_build(&path_loss_table, engine_config.path_loss_max_error_db,
+                                                      engine_config.path_loss_max_terrain_factor) == 0;
+    }
+}
+
+int radio_engine_configure(const RadioEngineConfig *config) {
+    // Keep a later lazy build from overwriting this one
+    pthread_once(&path_loss_table_once, build_default_table);
+    if (path_loss_table_ready) {
+        path_loss_table_free(&path_loss_table);
+        path_loss_table_ready = 0;
+    }
+    engine_config = *config;
+    __atomic_add_fetch(&engine_generation, 1, __ATOMIC_RELEASE);
+    if (engine_config.path_loss_table_threshold > 0) {
+        if (path_loss_table_build(&path_loss_table, engine_config.path_loss_max_error_db,
+                                  engine_config.path_loss_max_terrain_factor) != 0) {
+            return -1;
+        }
+        path_loss_table_ready = 1;
+    }
+    return 0;
+}
+
+void radio_engine_get_config(RadioEngineConfig *config) {
+    *config = engine_config;
+}
+
+unsigned long radio_engine_generation(void) {
+    // Installing risk rules can regrade a result too. Both counters only
+    // grow, so neither change can go unnoticed in the sum.
+    return __atomic_load_n(&engine_generation, __ATOMIC_ACQUIRE) + risk_rules_generation();
+}
+
 double calculate_path_loss(RadioSource *source) {
-    // Implementation of Extended Hata Model for path loss
+    // Free-space path loss, 20 log10(4 pi d / lambda)
     double wavelength = C / (source->frequency * 1e6);
     double path_loss = 20 * log10(4 * PI * source->distance * 1000 / wavelength);
     
-    // Add terrain and weather effects
+    // Add terrain effects; weather attenuation depends on the environment
+    // and is added by radio_received_power and the bulk kernels
     path_loss += source->terrain_factor * log10(source->distance);
     
     return path_loss;
 }
 
+double radio_received_power(const RadioEnvironment *env, const RadioSource *source) {
+    double path_loss;
+    if (env->propagation != NULL && env->propagation->model != NULL) {
+        env->propagation->model->path_loss_batch(&env->propagation->params, &source->frequency,
+                                                 &source->distance, &source->terrain_factor, 1, &path_loss);
+    } else {
+        RadioSource copy = *source;
+        path_loss = calculate_path_loss(&copy);
+    }
+    return source->power - path_loss - env->weather_factor * source->distance;
+}
+
+RiskLevel assess_radio_risk(RadioInterferenceAnalysis *analysis) {
+    RiskLevel level = risk_rules_radio(risk_rules_acquire(), analysis->signal_to_noise);
+    risk_rules_release();
+    return level;
+}
+
+void finish_radio_analysis(RadioInterferenceAnalysis *analysis, double total_interference,
+                           double background_noise) {
+    // Convert back to dBm
+    analysis->interference_level = 10 * log10(total_interference);
+    
+    // Calculate Signal to Noise Ratio
+    analysis->signal_to_noise = analysis->interference_level - background_noise;
+    
+    // Assess risk level based on interference
+    analysis->risk_level = assess_radio_risk(analysis);
+    switch (analysis->risk_level) {
+    case RISK_LOW:
+        analysis->recommendations = "Normal operations can proceed";
+        break;
+    case RISK_MEDIUM:
+        analysis->recommendations = "Consider frequency adjustment or power increase";
+        break;
+    case RISK_HIGH:
+        analysis->recommendations = "Immediate frequency reallocation recommended";
+        break;
+    default:
+        analysis->recommendations = "Unsafe for critical communications. Abort mission if communication dependent";
+        break;
+    }
+}
+
+int radio_sources_in_domain(const RadioSource *sources, int count) {
+    for (int i = 0; i < count; i++) {
+        if (!(sources[i].frequency > 0) || !(sources[i].distance > 0)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
 RadioInterferenceAnalysis analyze_radio_interference(RadioEnvironment *env) {
     RadioInterferenceAnalysis analysis = {0};
-    double total_interference = 0;
     
-    // Calculate cumulative interference from all sources
-    for (int i = 0; i < env->num_sources; i++) {
-        double path_loss = calculate_path_loss(&env->sources[i]);
-        double received_power = env->sources[i].power - path_loss;
-        total_interference += pow(10, received_power/10);
+    // libm and the vectorised log2 disagree below zero; answer before either runs
+    if (!radio_sources_in_domain(env->sources, env->num_sources)) {
+        finish_radio_analysis(&analysis, NAN, env->background_noise);
+        return analysis;
     }
     
-    // Convert back to dBm
-    analysis.interference_level = 10 * log10(total_interference);
+    if (env->propagation != NULL && env->propagation->model != NULL) {
+        finish_radio_analysis(&analysis,
+                              propagation_total_power_mw(env->propagation, env->sources, env->num_sources,
+                                                         env->weather_factor),
+                              env->background_noise);
+        return analysis;
+    }
     
-    // Calculate Signal to Noise Ratio
-    analysis.signal_to_noise = analysis.interference_level - env->background_noise;
+    // Large emitter sets go through the vectorised SoA kernel, which is
+    // both faster and more accurate than the table when the CPU has it
+    if (env->num_sources >= RADIO_BATCH_MIN_SOURCES && radio_batch_vectorized()) {
+        finish_radio_analysis(&analysis,
+                              radio_sources_total_power_mw(env->sources, env->num_sources, env->weather_factor),
+                              env->background_noise);
+        return analysis;
+    }
+    if (engine_config.path_loss_table_threshold > 0 &&
+        env->num_sources >= engine_config.path_loss_table_threshold) {
+        pthread_once(&path_loss_table_once, build_default_table);
+        if (path_loss_table_ready) {
+            finish_radio_analysis(&analysis,
+                                  path_loss_table_total_power_mw(&path_loss_table, env->sources, env->num_sources,
+                                                                 env->weather_factor),
+                                  env->background_noise);
+            return analysis;
+        }
+    }
     
-    // Assess risk level based on interference
-    if (analysis.signal_to_noise > 30) {
-        analysis.risk_level = RISK_LOW;
-        analysis.recommendations = "Normal operations can proceed";
-    } else if (analysis.signal_to_noise > 20) {
-        analysis.risk_level = RISK_MEDIUM;
-        analysis.recommendations = "Consider frequency adjustment or power increase";
-    } else if (analysis.signal_to_noise > 10) {
-        analysis.risk_level = RISK_HIGH;
-        analysis.recommendations = "Immediate frequency reallocation recommended";
-    } else {
-        analysis.risk_level = RISK_CRITICAL;
-        analysis.recommendations = "Unsafe for critical communications. Abort mission if communication dependent";
+    // Calculate cumulative interference from all sources, with Neumaier
+    // compensation so many small contributions are not lost
+    double total_interference = 0, compensation = 0;
+    for (int i = 0; i < env->num_sources; i++) {
+        double received_power = radio_received_power(env, &env->sources[i]);
+        double linear_power = pow(10, received_power/10);
+        double t = total_interference + linear_power;
+        if (fabs(total_interference) >= fabs(linear_power)) {
+            compensation += (total_interference - t) + linear_power;
+        } else {
+            compensation += (linear_power - t) + total_interference;
+        }
+        total_interference = t;
     }
     
+    finish_radio_analysis(&analysis, total_interference + compensation, env->background_noise);
     return analysis;
-}
+}
\ No newline at end of file
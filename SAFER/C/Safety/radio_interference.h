@@ -4,19 +4,27 @@
 
 #include <math.h>
 #include <complex.h>
+#include "safer.h"
 
 typedef struct {
     double frequency;      // MHz
     double power;         // dBm
     double distance;      // km
     double terrain_factor; // terrain roughness factor
+    double x, y;           // km, planning frame; used by the heatmap instead of distance
+    double altitude;       // km
 } RadioSource;
 
+struct PropagationConfig;
+
 typedef struct {
     RadioSource *sources;
     int num_sources;
     double background_noise; // dBm
-    double weather_factor;   // Attenuation due to weather
+    double weather_factor;   // Attenuation due to weather, dB/km, added to every model's path loss
+    // Model selected for this analysis (see propagation.h); NULL keeps
+    // calculate_path_loss and its fast paths
+    const struct PropagationConfig *propagation;
 } RadioEnvironment;
 
 typedef struct {
@@ -26,8 +34,41 @@ typedef struct {
     char *recommendations;
 } RadioInterferenceAnalysis;
 
+// Engine tuning for analyze_radio_interference; defaults apply until
+// radio_engine_configure is called
+typedef struct {
+    int path_loss_table_threshold;      // Sources at which the lookup table is used, 0 disables (default 64)
+    double path_loss_max_error_db;      // Table error bound (default 0.01 dB)
+    double path_loss_max_terrain_factor; // Larger terrain factors use the exact path (default 20)
+} RadioEngineConfig;
+
+// Rebuilds the path-loss table. Not safe concurrently with analyses;
+// configure at startup.
+int radio_engine_configure(const RadioEngineConfig *config);
+void radio_engine_get_config(RadioEngineConfig *config);
+
+// Advanced by every radio_engine_configure and risk_rules_install, so
+// cached results can tell they were computed under an older configuration
+unsigned long radio_engine_generation(void);
+
+// Whether every source has a positive frequency and distance, the domain of
+// the path-loss models; NaN is outside it. The analyses below give a NaN
+// level for other sources, which the radio rule grades by its nan value,
+// whichever path would have summed them.
+int radio_sources_in_domain(const RadioSource *sources, int count);
+
 RadioInterferenceAnalysis analyze_radio_interference(RadioEnvironment *env);
+// Free-space loss plus terrain_factor * log10(distance), in dB
 double calculate_path_loss(RadioSource *source);
+// Received power of one source in dBm: env's propagation model (or
+// calculate_path_loss without one) less weather_factor * distance, as
+// analyze_radio_interference sums it
+double radio_received_power(const RadioEnvironment *env, const RadioSource *source);
 RiskLevel assess_radio_risk(RadioInterferenceAnalysis *analysis);
 
+// Fill interference level, SNR, risk level and recommendation from the
+// summed linear interference power (mW)
+void finish_radio_analysis(RadioInterferenceAnalysis *analysis, double total_interference,
+                           double background_noise);
+
 #endif // RADIO_INTERFERENCE_H
\ No newline at end of file
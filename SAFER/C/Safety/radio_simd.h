@@ -0,0 +1,117 @@
+// radio_simd.h - AVX2 log2/exp2 helpers shared by the radio kernels
+#ifndef RADIO_SIMD_H
+#define RADIO_SIMD_H
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RADIO_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+
+#define RADIO_LOG2_10 3.32192809488736234787
+
+// Whether the running CPU has AVX2 and FMA; the kernels below must only
+// be called when this returns nonzero
+static inline int radio_simd_have_avx2(void) {
+#ifdef RADIO_SIMD_AVX2
+    static int supported = -1;
+    if (supported < 0) {
+        __builtin_cpu_init();
+        supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    }
+    return supported;
+#else
+    return 0;
+#endif
+}
+
+#ifdef RADIO_SIMD_AVX2
+
+// log2 for positive normal doubles. x = 2^k * m with m in [sqrt(1/2), sqrt(2)),
+// ln(m) = 2 atanh(s), s = (m - 1) / (m + 1), |s| <= 0.1716, with the series
+// cut after s^order (odd, 7..15). Always called with a constant order so
+// the loop unrolls.
+__attribute__((target("avx2,fma")))
+static inline __m256d log2_series_pd(__m256d x, int order) {
+    const __m256i mantissa_mask = _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL);
+    const __m256i one_bits = _mm256_set1_epi64x(0x3FF0000000000000LL);
+    const __m256d exponent_magic = _mm256_set1_pd(4503599627370496.0); // 2^52
+
+    __m256i bits = _mm256_castpd_si256(x);
+    // Biased exponent as a double: OR it into the mantissa of 2^52
+    __m256i biased = _mm256_srli_epi64(bits, 52);
+    __m256d k = _mm256_sub_pd(
+        _mm256_castsi256_pd(_mm256_or_si256(biased, _mm256_castpd_si256(exponent_magic))),
+        _mm256_set1_pd(4503599627370496.0 + 1023.0));
+    __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, mantissa_mask), one_bits));
+
+    __m256d high = _mm256_cmp_pd(m, _mm256_set1_pd(1.41421356237309504880), _CMP_GT_OQ);
+    m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), high);
+    k = _mm256_add_pd(k, _mm256_and_pd(high, _mm256_set1_pd(1.0)));
+
+    __m256d s = _mm256_div_pd(_mm256_sub_pd(m, _mm256_set1_pd(1.0)), _mm256_add_pd(m, _mm256_set1_pd(1.0)));
+    __m256d s2 = _mm256_mul_pd(s, s);
+    static const double inverse_odd[8] = {
+        1.0, 1.0 / 3, 1.0 / 5, 1.0 / 7, 1.0 / 9, 1.0 / 11, 1.0 / 13, 1.0 / 15
+    };
+    __m256d p = _mm256_set1_pd(inverse_odd[order / 2]);
+    for (int i = order / 2 - 1; i >= 0; i--) {
+        p = _mm256_fmadd_pd(p, s2, _mm256_set1_pd(inverse_odd[i]));
+    }
+    // log2(m) = 2 * s * p / ln 2
+    __m256d log2_m = _mm256_mul_pd(_mm256_mul_pd(s, p), _mm256_set1_pd(2.0 * 1.44269504088896340736));
+    return _mm256_add_pd(k, log2_m);
+}
+
+// 2^x: x = n + r with n integral and |r| <= 1/2, 2^r = e^(r ln 2) from a
+// Taylor polynomial of the given degree (constant, up to 12). Results below
+// 2^-1022 flush to zero.
+__attribute__((target("avx2,fma")))
+static inline __m256d exp2_series_pd(__m256d x, int degree) {
+    __m256d underflow = _mm256_cmp_pd(x, _mm256_set1_pd(-1022.0), _CMP_LT_OQ);
+    x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(-1022.0)), _mm256_set1_pd(1023.0));
+
+    __m256d n = _mm256_round_pd(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d z = _mm256_mul_pd(_mm256_sub_pd(x, n), _mm256_set1_pd(0.69314718055994530942));
+
+    static const double inverse_factorials[13] = {
+        1.0, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720, 1.0 / 5040,
+        1.0 / 40320, 1.0 / 362880, 1.0 / 3628800, 1.0 / 39916800, 1.0 / 479001600
+    };
+    __m256d p = _mm256_set1_pd(inverse_factorials[degree]);
+    for (int i = degree - 1; i >= 0; i--) {
+        p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(inverse_factorials[i]));
+    }
+
+    // 2^n: the low mantissa bits of (n + 1023 + 2^52) hold n + 1023
+    __m256d biased = _mm256_add_pd(n, _mm256_set1_pd(4503599627370496.0 + 1023.0));
+    __m256d scale = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(biased), 52));
+    return _mm256_andnot_pd(underflow, _mm256_mul_pd(p, scale));
+}
+
+// Full precision: log2 absolute error below 2e-14, exp2 relative error
+// below 2e-16
+__attribute__((target("avx2,fma")))
+static inline __m256d log2_pd(__m256d x) {
+    return log2_series_pd(x, 15);
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d exp2_pd(__m256d x) {
+    return exp2_series_pd(x, 12);
+}
+
+// Reduced precision for results stored as float: log2 absolute error
+// below 5e-8, exp2 relative error below 1e-8
+__attribute__((target("avx2,fma")))
+static inline __m256d log2_lowp_pd(__m256d x) {
+    return log2_series_pd(x, 7);
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d exp2_lowp_pd(__m256d x) {
+    return exp2_series_pd(x, 7);
+}
+
+#endif // RADIO_SIMD_AVX2
+
+#endif // RADIO_SIMD_H
@@ -0,0 +1,103 @@
+// radio_spectrum.c - Channel histogram and adjacent-channel rejection mask
+#include "radio_spectrum.h"
+
+#define LOG2_10 3.32192809488736234787
+#define RECOMMENDATION_SIZE 192
+
+static const double default_rejection_db[] = {0.0, 30.0, 50.0};
+
+static double channel_centre(const ChannelPlan *plan, int channel) {
+    return plan->start_mhz + (channel + 0.5) * plan->channel_width_mhz;
+}
+
+int analyze_interference_spectrum(const RadioEnvironment *env, const ChannelPlan *plan,
+                                  double receiver_mhz, InterferenceSpectrum *spectrum) {
+    memset(spectrum, 0, sizeof(*spectrum));
+    if (plan->num_channels <= 0 || !(plan->channel_width_mhz > 0)) {
+        fprintf(stderr, "Invalid channel plan: %d channels of %g MHz\n",
+                plan->num_channels, plan->channel_width_mhz);
+        return -1;
+    }
+    const double *rejection_db = plan->rejection_db;
+    int mask_width = plan->mask_width;
+    if (rejection_db == NULL || mask_width <= 0) {
+        rejection_db = default_rejection_db;
+        mask_width = sizeof(default_rejection_db) / sizeof(default_rejection_db[0]);
+    }
+
+    // The histogram extends mask_width - 1 channels past each band edge so
+    // out-of-band emitters still leak into the edge channels
+    int margin = mask_width - 1;
+    int bins = plan->num_channels + 2 * margin;
+    double *histogram = calloc(bins, sizeof(double));
+    double *mask = malloc(sizeof(double) * mask_width);
+    spectrum->interference_dbm = malloc(sizeof(double) * plan->num_channels);
+    spectrum->signal_to_noise = malloc(sizeof(double) * plan->num_channels);
+    char *recommendation = malloc(RECOMMENDATION_SIZE);
+    if (histogram == NULL || mask == NULL || spectrum->interference_dbm == NULL ||
+        spectrum->signal_to_noise == NULL || recommendation == NULL) {
+        free(histogram);
+        free(mask);
+        free(recommendation);
+        free_interference_spectrum(spectrum);
+        return -1;
+    }
+    spectrum->num_channels = plan->num_channels;
+
+    for (int i = 0; i < env->num_sources; i++) {
+        RadioSource source = env->sources[i];
+        double position = (source.frequency - plan->start_mhz) / plan->channel_width_mhz;
+        if (!(position >= -margin && position < plan->num_channels + margin)) {
+            continue;
+        }
+        double received_power = source.power - calculate_path_loss(&source);
+        histogram[(int)floor(position) + margin] += exp2(received_power * (LOG2_10 / 10));
+    }
+
+    for (int k = 0; k < mask_width; k++) {
+        mask[k] = exp2(-rejection_db[k] * (LOG2_10 / 10));
+    }
+
+    spectrum->best_channel = 0;
+    for (int c = 0; c < plan->num_channels; c++) {
+        int bin = c + margin;
+        double total = histogram[bin] * mask[0];
+        for (int k = 1; k < mask_width; k++) {
+            total += (histogram[bin - k] + histogram[bin + k]) * mask[k];
+        }
+        spectrum->interference_dbm[c] = 10 * log10(total);
+        spectrum->signal_to_noise[c] = spectrum->interference_dbm[c] - env->background_noise;
+        if (spectrum->interference_dbm[c] < spectrum->interference_dbm[spectrum->best_channel]) {
+            spectrum->best_channel = c;
+        }
+    }
+    spectrum->best_channel_mhz = channel_centre(plan, spectrum->best_channel);
+    free(histogram);
+    free(mask);
+
+    // Receiver outside the plan: report the best channel as if tuned to it
+    double position = (receiver_mhz - plan->start_mhz) / plan->channel_width_mhz;
+    spectrum->receiver_channel = position >= 0 && position < plan->num_channels ? (int)position : -1;
+    int channel = spectrum->receiver_channel >= 0 ? spectrum->receiver_channel : spectrum->best_channel;
+    finish_radio_analysis(&spectrum->analysis, pow(10, spectrum->interference_dbm[channel] / 10),
+                          env->background_noise);
+
+    // Any advice beyond normal operations points at the quietest channel
+    if (spectrum->analysis.risk_level != RISK_LOW && spectrum->best_channel != channel &&
+        spectrum->interference_dbm[spectrum->best_channel] < spectrum->interference_dbm[channel]) {
+        snprintf(recommendation, RECOMMENDATION_SIZE, "%s; best channel %d (%.3f MHz) at %.1f dBm",
+                 spectrum->analysis.recommendations, spectrum->best_channel, spectrum->best_channel_mhz,
+                 spectrum->interference_dbm[spectrum->best_channel]);
+    } else {
+        snprintf(recommendation, RECOMMENDATION_SIZE, "%s", spectrum->analysis.recommendations);
+    }
+    spectrum->analysis.recommendations = recommendation;
+    return 0;
+}
+
+void free_interference_spectrum(InterferenceSpectrum *spectrum) {
+    free(spectrum->interference_dbm);
+    free(spectrum->signal_to_noise);
+    free(spectrum->analysis.recommendations);
+    memset(spectrum, 0, sizeof(*spectrum));
+}
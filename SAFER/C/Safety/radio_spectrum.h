@@ -0,0 +1,40 @@
+// radio_spectrum.h - Per-channel co-channel/adjacent-channel interference analysis
+#ifndef RADIO_SPECTRUM_H
+#define RADIO_SPECTRUM_H
+
+#include "radio_interference.h"
+
+// Channel c covers [start_mhz + c * width, start_mhz + (c + 1) * width).
+// A source k channels away from a receiver is attenuated by
+// rejection_db[k]; rejection_db[0] is co-channel (normally 0) and sources
+// mask_width or more channels away are rejected entirely.
+typedef struct {
+    double start_mhz;
+    double channel_width_mhz;
+    int num_channels;
+    const double *rejection_db; // NULL for the default mask {0, 30, 50} dB
+    int mask_width;
+} ChannelPlan;
+
+typedef struct {
+    int num_channels;
+    double *interference_dbm;   // Per receiver channel after the rejection mask
+    double *signal_to_noise;    // dB
+    int best_channel;           // Channel with the least interference
+    double best_channel_mhz;    // Its centre frequency
+    int receiver_channel;       // -1 when the receiver is outside the plan
+    // Analysis for the receiver channel. Its recommendations string is
+    // owned by the spectrum and names the best channel when reallocation
+    // is advised.
+    RadioInterferenceAnalysis analysis;
+} InterferenceSpectrum;
+
+// Bins every source's received power into its channel in one pass, then
+// applies the mask to the histogram, O(sources + channels * mask_width).
+// Returns 0 on success, -1 on invalid plan or allocation failure.
+int analyze_interference_spectrum(const RadioEnvironment *env, const ChannelPlan *plan,
+                                  double receiver_mhz, InterferenceSpectrum *spectrum);
+
+void free_interference_spectrum(InterferenceSpectrum *spectrum);
+
+#endif // RADIO_SPECTRUM_H
@@ -0,0 +1,212 @@
+// radio_wire.c - SRB1 request and SRR1 result encoding
+#include "radio_wire.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define HOST_LITTLE_ENDIAN 1
+#else
+#define HOST_LITTLE_ENDIAN 0
+#endif
+
+#define NUM_COLUMNS 4
+
+// Indexed by RadioWireModel
+static const PropagationModel *const wire_models[] = {
+    NULL, &propagation_free_space, &propagation_terrain, &propagation_hata,
+    &propagation_two_ray, &propagation_itu_rain
+};
+#define NUM_WIRE_MODELS (int)(sizeof(wire_models) / sizeof(wire_models[0]))
+
+// RadioWireModel for model, -1 when it has no wire id
+static int wire_model_id(const PropagationModel *model) {
+    for (int id = 0; id < NUM_WIRE_MODELS; id++) {
+        if (wire_models[id] == model) {
+            return id;
+        }
+    }
+    return -1;
+}
+
+static uint32_t load_u32(const unsigned char *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static double load_f64(const unsigned char *p) {
+    uint64_t bits = (uint64_t)load_u32(p) | (uint64_t)load_u32(p + 4) << 32;
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static void store_u32(unsigned char *p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static void store_f64(unsigned char *p, double v) {
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    store_u32(p, (uint32_t)bits);
+    store_u32(p + 4, (uint32_t)(bits >> 32));
+}
+
+static size_t padded_count(int num_sources) {
+    return ((size_t)num_sources + 7) & ~(size_t)7;
+}
+
+size_t radio_wire_request_size(int num_sources) {
+    if (num_sources < 0 || num_sources > INT_MAX - 7) {
+        return 0;
+    }
+    size_t padded = padded_count(num_sources);
+    if (padded > (SIZE_MAX - RADIO_WIRE_HEADER_BYTES) / (NUM_COLUMNS * sizeof(double))) {
+        return 0;
+    }
+    return RADIO_WIRE_HEADER_BYTES + padded * NUM_COLUMNS * sizeof(double);
+}
+
+int radio_wire_encode_request(const RadioEnvironment *env, void *out, size_t size) {
+    size_t expected = radio_wire_request_size(env->num_sources);
+    if (expected == 0 || size < expected) {
+        return -1;
+    }
+    const PropagationConfig *propagation = env->propagation;
+    int model = wire_model_id(propagation != NULL ? propagation->model : NULL);
+    if (model < 0) {
+        return -1;
+    }
+
+    unsigned char *p = out;
+    memset(p, 0, expected);
+    memcpy(p, "SRB1", 4);
+    store_u32(p + 4, (uint32_t)env->num_sources);
+    p[8] = (unsigned char)model;
+    store_f64(p + 16, env->background_noise);
+    store_f64(p + 24, env->weather_factor);
+    if (model != RADIO_WIRE_MODEL_NONE) {
+        p[9] = (unsigned char)propagation->params.environment;
+        p[10] = propagation->params.vertical_polarization != 0;
+        store_f64(p + 32, propagation->params.transmitter_height_m);
+        store_f64(p + 40, propagation->params.receiver_height_m);
+        store_f64(p + 48, propagation->params.rain_rate_mm_h);
+    }
+
+    size_t stride = padded_count(env->num_sources) * sizeof(double);
+    unsigned char *columns = p + RADIO_WIRE_HEADER_BYTES;
+    for (int i = 0; i < env->num_sources; i++) {
+        const RadioSource *source = &env->sources[i];
+        store_f64(columns + i * sizeof(double), source->frequency);
+        store_f64(columns + stride + i * sizeof(double), source->power);
+        store_f64(columns + 2 * stride + i * sizeof(double), source->distance);
+        store_f64(columns + 3 * stride + i * sizeof(double), source->terrain_factor);
+    }
+    return 0;
+}
+
+int radio_wire_decode_request(const void *data, size_t size, RadioWireRequest *request) {
+    const unsigned char *p = data;
+    memset(request, 0, sizeof(*request));
+    if (size < RADIO_WIRE_HEADER_BYTES || memcmp(p, "SRB1", 4) != 0) {
+        return -1;
+    }
+    uint32_t num_sources = load_u32(p + 4);
+    if (num_sources > INT_MAX || radio_wire_request_size((int)num_sources) != size) {
+        return -1;
+    }
+    if (p[8] >= NUM_WIRE_MODELS) {
+        return -2;
+    }
+    if (p[9] > HATA_METROPOLITAN) {
+        return -1;
+    }
+
+    request->env.background_noise = load_f64(p + 16);
+    request->env.weather_factor = load_f64(p + 24);
+    if (p[8] != RADIO_WIRE_MODEL_NONE) {
+        request->propagation.model = wire_models[p[8]];
+        request->propagation.params.environment = (HataEnvironment)p[9];
+        request->propagation.params.vertical_polarization = p[10] != 0;
+        request->propagation.params.transmitter_height_m = load_f64(p + 32);
+        request->propagation.params.receiver_height_m = load_f64(p + 40);
+        request->propagation.params.rain_rate_mm_h = load_f64(p + 48);
+        request->env.propagation = &request->propagation;
+    }
+    request->env.num_sources = (int)num_sources;
+
+    size_t padded = padded_count((int)num_sources);
+    const unsigned char *columns = p + RADIO_WIRE_HEADER_BYTES;
+    RadioSourceBatch *batch = &request->batch;
+    if (HOST_LITTLE_ENDIAN && ((uintptr_t)data & (RADIO_WIRE_ALIGN - 1)) == 0) {
+        // Already the batch layout: borrow the columns. The kernels only
+        // read them, so dropping const here is safe.
+        double *column = (double *)(uintptr_t)columns;
+        batch->frequency = column;
+        batch->power = column + padded;
+        batch->distance = column + 2 * padded;
+        batch->terrain_factor = column + 3 * padded;
+        batch->count = (int)num_sources;
+        batch->capacity = (int)padded;
+        return 0;
+    }
+
+    if (radio_batch_init(batch, (int)num_sources) != 0) {
+        return -3;
+    }
+    request->owns_batch = 1;
+    double *fields[NUM_COLUMNS] = { batch->frequency, batch->power, batch->distance, batch->terrain_factor };
+    for (int c = 0; c < NUM_COLUMNS; c++) {
+        const unsigned char *column = columns + c * padded * sizeof(double);
+        if (HOST_LITTLE_ENDIAN) {
+            memcpy(fields[c], column, num_sources * sizeof(double));
+        } else {
+            for (uint32_t i = 0; i < num_sources; i++) {
+                fields[c][i] = load_f64(column + i * sizeof(double));
+            }
+        }
+    }
+    batch->count = (int)num_sources;
+    return 0;
+}
+
+void radio_wire_request_free(RadioWireRequest *request) {
+    if (request->owns_batch) {
+        radio_batch_free(&request->batch);
+    }
+    memset(request, 0, sizeof(*request));
+}
+
+size_t radio_wire_result_size(const RadioInterferenceAnalysis *analysis) {
+    return RADIO_WIRE_RESULT_BYTES + (analysis->recommendations != NULL ? strlen(analysis->recommendations) : 0);
+}
+
+void radio_wire_encode_result(const RadioInterferenceAnalysis *analysis, void *out) {
+    unsigned char *p = out;
+    size_t length = analysis->recommendations != NULL ? strlen(analysis->recommendations) : 0;
+    memset(p, 0, RADIO_WIRE_RESULT_BYTES);
+    memcpy(p, "SRR1", 4);
+    store_u32(p + 4, (uint32_t)analysis->risk_level);
+    store_f64(p + 8, analysis->interference_level);
+    store_f64(p + 16, analysis->signal_to_noise);
+    store_u32(p + 24, (uint32_t)length);
+    memcpy(p + RADIO_WIRE_RESULT_BYTES, analysis->recommendations != NULL ? analysis->recommendations : "", length);
+}
+
+int radio_wire_decode_result(const void *data, size_t size, RadioInterferenceAnalysis *analysis,
+                             const char **recommendations, size_t *recommendations_length) {
+    const unsigned char *p = data;
+    if (size < RADIO_WIRE_RESULT_BYTES || memcmp(p, "SRR1", 4) != 0 ||
+        load_u32(p + 24) != size - RADIO_WIRE_RESULT_BYTES) {
+        return -1;
+    }
+    memset(analysis, 0, sizeof(*analysis));
+    analysis->risk_level = (RiskLevel)load_u32(p + 4);
+    analysis->interference_level = load_f64(p + 8);
+    analysis->signal_to_noise = load_f64(p + 16);
+    *recommendations = (const char *)p + RADIO_WIRE_RESULT_BYTES;
+    *recommendations_length = size - RADIO_WIRE_RESULT_BYTES;
+    return 0;
+}
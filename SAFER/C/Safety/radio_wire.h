@@ -0,0 +1,74 @@
+// radio_wire.h - Fixed-layout binary encoding of radio analysis requests and results
+#ifndef RADIO_WIRE_H
+#define RADIO_WIRE_H
+
+#include "radio_batch.h"
+#include "propagation.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Media type for both directions; requested with Content-Type or Accept
+#define RADIO_WIRE_CONTENT_TYPE "application/x-safer-radio"
+
+#define RADIO_WIRE_HEADER_BYTES 64
+#define RADIO_WIRE_ALIGN 64      // Buffer alignment that lets decode point into the request
+#define RADIO_WIRE_RESULT_BYTES 32
+
+// Request, all fields little-endian:
+//    0  "SRB1"
+//    4  uint32 num_sources
+//    8  uint8 model (RadioWireModel), uint8 HataEnvironment,
+//       uint8 vertical polarization, 5 bytes zero
+//   16  double background_noise, weather_factor
+//   32  double transmitter_height_m, receiver_height_m, rain_rate_mm_h
+//   56  8 bytes zero
+//   64  double columns frequency, power, distance, terrain_factor, each
+//       padded with zeros to a multiple of 8 entries
+// The columns match RadioSourceBatch, so a request in a 64-byte aligned
+// buffer is analysed in place.
+typedef enum {
+    RADIO_WIRE_MODEL_NONE,       // calculate_path_loss and its fast paths
+    RADIO_WIRE_MODEL_FREE_SPACE,
+    RADIO_WIRE_MODEL_TERRAIN,
+    RADIO_WIRE_MODEL_HATA,
+    RADIO_WIRE_MODEL_TWO_RAY,
+    RADIO_WIRE_MODEL_ITU_RAIN
+} RadioWireModel;
+
+// Result:
+//    0  "SRR1"
+//    4  uint32 risk_level
+//    8  double interference_level, signal_to_noise
+//   24  uint32 recommendations length, 4 bytes zero
+//   32  recommendations, not NUL terminated
+
+// A decoded request. batch borrows the request buffer when it is aligned on
+// a little-endian host and owns a copy otherwise.
+typedef struct {
+    RadioEnvironment env;        // sources stay NULL; num_sources is batch.count
+    PropagationConfig propagation;
+    RadioSourceBatch batch;
+    int owns_batch;
+} RadioWireRequest;
+
+// Encoded size of a request with num_sources sources, 0 when too large
+size_t radio_wire_request_size(int num_sources);
+
+// Encode env into out, which holds radio_wire_request_size bytes. Models
+// other than the built-in ones cannot be encoded. Returns 0 on success, -1
+// on failure.
+int radio_wire_encode_request(const RadioEnvironment *env, void *out, size_t size);
+
+// Returns 0 on success, -1 for a malformed request, -2 for an unknown model
+// and -3 when out of memory. Release with radio_wire_request_free.
+int radio_wire_decode_request(const void *data, size_t size, RadioWireRequest *request);
+void radio_wire_request_free(RadioWireRequest *request);
+
+size_t radio_wire_result_size(const RadioInterferenceAnalysis *analysis);
+void radio_wire_encode_result(const RadioInterferenceAnalysis *analysis, void *out);
+
+// recommendations points into data. Returns 0 on success, -1 if malformed.
+int radio_wire_decode_result(const void *data, size_t size, RadioInterferenceAnalysis *analysis,
+                             const char **recommendations, size_t *recommendations_length);
+
+#endif // RADIO_WIRE_H
@@ -0,0 +1,211 @@
+// read_pool.c - Read connection pool implementation
+#define _POSIX_C_SOURCE 200809L
+#include "read_pool.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+typedef struct {
+    const char *sql; // Query text, owned by the slot
+    uint32_t hash;
+    sqlite3_stmt *stmt;
+} StatementSlot;
+
+typedef struct ReadConnection {
+    ReadPool *pool;
+    sqlite3 *db;
+    StatementSlot statements[READ_POOL_STATEMENT_SLOTS];
+    struct ReadConnection *next_free;
+} ReadConnection;
+
+struct ReadPool {
+    Database *owner;
+    char *path;
+    pthread_key_t thread_connection;
+    pthread_mutex_t lock;
+    pthread_cond_t available;
+    ReadConnection *free_list; // Released by exited threads, still open
+    ReadConnection **all;      // Every connection opened, for close
+    int num_open;
+    int max_connections;
+};
+
+static uint32_t hash_sql(const char *sql) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)sql; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void close_connection(ReadConnection *conn) {
+    for (int i = 0; i < READ_POOL_STATEMENT_SLOTS; i++) {
+        if (conn->statements[i].stmt != NULL) {
+            sqlite3_finalize(conn->statements[i].stmt);
+            free((char *)conn->statements[i].sql);
+        }
+    }
+    sqlite3_close(conn->db);
+    free(conn);
+}
+
+// pthread key destructor: hand the connection back when its thread exits
+static void release_connection(void *arg) {
+    ReadConnection *conn = arg;
+    ReadPool *pool = conn->pool;
+    pthread_mutex_lock(&pool->lock);
+    conn->next_free = pool->free_list;
+    pool->free_list = conn;
+    pthread_cond_signal(&pool->available);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static ReadConnection *open_connection(ReadPool *pool) {
+    ReadConnection *conn = calloc(1, sizeof(ReadConnection));
+    if (conn == NULL) {
+        return NULL;
+    }
+    conn->pool = pool;
+    int rc = sqlite3_open_v2(pool->path, &conn->db,
+                             SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, NULL);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Cannot open read connection: %s\n", sqlite3_errmsg(conn->db));
+        sqlite3_close(conn->db);
+        free(conn);
+        return NULL;
+    }
+    return conn;
+}
+
+static ReadConnection *acquire_connection(ReadPool *pool) {
+    ReadConnection *conn = pthread_getspecific(pool->thread_connection);
+    if (conn != NULL) {
+        return conn;
+    }
+
+    // Connections only come back when their thread exits, so a wait can
+    // be as long as the longest-lived reader; bound it
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += READ_POOL_WAIT_MS / 1000;
+    deadline.tv_nsec += (READ_POOL_WAIT_MS % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    int timed_out = 0;
+    pthread_mutex_lock(&pool->lock);
+    while (pool->free_list == NULL && pool->num_open >= pool->max_connections && !timed_out) {
+        timed_out = pthread_cond_timedwait(&pool->available, &pool->lock, &deadline) == ETIMEDOUT;
+    }
+    if (pool->free_list == NULL && pool->num_open >= pool->max_connections) {
+        pthread_mutex_unlock(&pool->lock);
+        fprintf(stderr, "No read connection freed within %d ms (%d open)\n",
+                READ_POOL_WAIT_MS, pool->num_open);
+        return NULL;
+    }
+    if (pool->free_list != NULL) {
+        conn = pool->free_list;
+        pool->free_list = conn->next_free;
+    } else {
+        conn = open_connection(pool);
+        if (conn != NULL) {
+            pool->all[pool->num_open++] = conn;
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    if (conn != NULL) {
+        pthread_setspecific(pool->thread_connection, conn);
+    }
+    return conn;
+}
+
+int read_pool_open(Database *db, int max_connections) {
+    ReadPool *pool = calloc(1, sizeof(ReadPool));
+    if (pool == NULL) {
+        return -1;
+    }
+    pool->owner = db;
+    pool->max_connections = max_connections > 0 ? max_connections : 64;
+    pool->path = strdup(db->path != NULL ? db->path : "safer.db");
+    pool->all = calloc(pool->max_connections, sizeof(ReadConnection *));
+    if (pool->path == NULL || pool->all == NULL ||
+        pthread_key_create(&pool->thread_connection, release_connection) != 0) {
+        free(pool->path);
+        free(pool->all);
+        free(pool);
+        return -1;
+    }
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->available, &attr);
+    pthread_condattr_destroy(&attr);
+    db->read_pool = pool;
+    return 0;
+}
+
+void read_pool_close(ReadPool *pool) {
+    // Callers must have stopped issuing reads. Connections still attached to
+    // live threads are closed too; those threads must not read afterwards.
+    pthread_setspecific(pool->thread_connection, NULL);
+    pthread_key_delete(pool->thread_connection);
+    for (int i = 0; i < pool->num_open; i++) {
+        close_connection(pool->all[i]);
+    }
+    pool->owner->read_pool = NULL;
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->available);
+    free(pool->all);
+    free(pool->path);
+    free(pool);
+}
+
+sqlite3_stmt *read_pool_statement(ReadPool *pool, const char *sql) {
+    ReadConnection *conn = acquire_connection(pool);
+    if (conn == NULL) {
+        return NULL;
+    }
+
+    uint32_t hash = hash_sql(sql);
+    unsigned mask = READ_POOL_STATEMENT_SLOTS - 1;
+    for (unsigned probe = 0; probe < READ_POOL_STATEMENT_SLOTS; probe++) {
+        StatementSlot *slot = &conn->statements[(hash + probe) & mask];
+        if (slot->stmt == NULL) {
+            // Miss: prepare once and keep it for the life of the connection
+            char *copy = strdup(sql);
+            if (copy == NULL) {
+                return NULL;
+            }
+            if (sqlite3_prepare_v3(conn->db, sql, -1, SQLITE_PREPARE_PERSISTENT,
+                                   &slot->stmt, NULL) != SQLITE_OK) {
+                fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(conn->db));
+                free(copy);
+                slot->stmt = NULL;
+                return NULL;
+            }
+            slot->sql = copy;
+            slot->hash = hash;
+            return slot->stmt;
+        }
+        if (slot->hash == hash && strcmp(slot->sql, sql) == 0) {
+            sqlite3_reset(slot->stmt);
+            sqlite3_clear_bindings(slot->stmt);
+            return slot->stmt;
+        }
+    }
+
+    // Every slot holds a different query; callers use a fixed set of queries
+    fprintf(stderr, "Read pool statement cache full\n");
+    return NULL;
+}
+
+void read_pool_release(sqlite3_stmt *stmt) {
+    if (stmt != NULL) {
+        sqlite3_reset(stmt);
+    }
+}
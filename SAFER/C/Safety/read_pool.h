@@ -0,0 +1,28 @@
+// read_pool.h - Per-thread read-only SQLite connections with statement caching
+#ifndef READ_POOL_H
+#define READ_POOL_H
+
+#include "database.h"
+
+#define READ_POOL_STATEMENT_SLOTS 32 // Cached statements per connection
+#define READ_POOL_WAIT_MS 2000       // How long a new thread waits for a connection to free up
+
+typedef struct ReadPool ReadPool;
+
+// Open a pool of read-only connections to db's file. Each thread that calls
+// read_pool_statement gets its own connection on first use, kept until the
+// thread exits or the pool closes. With WAL, readers never block the single
+// writer or each other. Sets db->read_pool; load_* then read through it.
+int read_pool_open(Database *db, int max_connections);
+void read_pool_close(ReadPool *pool);
+
+// Prepared statement for sql on the calling thread's connection, reset with
+// bindings cleared. Statements are cached per connection keyed by the query
+// text. Call read_pool_release when done so the read snapshot is dropped.
+// NULL if every connection stays held by other live threads for
+// READ_POOL_WAIT_MS, so a pool sized below the thread count fails the
+// read instead of hanging it.
+sqlite3_stmt *read_pool_statement(ReadPool *pool, const char *sql);
+void read_pool_release(sqlite3_stmt *stmt);
+
+#endif // READ_POOL_H
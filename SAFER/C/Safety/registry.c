@@ -0,0 +1,484 @@
+// registry.c - Arena-backed fleet registry implementation
+#define _POSIX_C_SOURCE 200809L
+#include "registry.h"
+#include <stdint.h>
+#include <sys/mman.h>
+
+#define INDEX_INITIAL_CAPACITY 1024
+#define SLAB_ALIGN 64
+
+// Entity pools
+
+static void pool_init(EntityPool *pool, size_t elem_size) {
+    pool->slabs = NULL;
+    pool->num_slabs = 0;
+    pool->slab_capacity = 0;
+    pool->elem_size = elem_size;
+    pool->count = 0;
+}
+
+static void *pool_get(const EntityPool *pool, int index) {
+    unsigned char *slab = pool->slabs[index / REGISTRY_SLAB_SIZE];
+    return slab + (size_t)(index % REGISTRY_SLAB_SIZE) * pool->elem_size;
+}
+
+static void *pool_push(EntityPool *pool, Arena *arena) {
+    if (pool->count == pool->num_slabs * REGISTRY_SLAB_SIZE) {
+        if (pool->num_slabs == pool->slab_capacity) {
+            int new_capacity = pool->slab_capacity ? pool->slab_capacity * 2 : 16;
+            void **slabs = realloc(pool->slabs, sizeof(void *) * new_capacity);
+            if (slabs == NULL) {
+                return NULL;
+            }
+            pool->slabs = slabs;
+            pool->slab_capacity = new_capacity;
+        }
+        void *slab = arena_alloc(arena, pool->elem_size * REGISTRY_SLAB_SIZE, SLAB_ALIGN);
+        if (slab == NULL) {
+            return NULL;
+        }
+        pool->slabs[pool->num_slabs++] = slab;
+    }
+    return pool_get(pool, pool->count++);
+}
+
+static void pool_destroy(EntityPool *pool) {
+    free(pool->slabs);
+    pool->slabs = NULL;
+    pool->num_slabs = 0;
+    pool->slab_capacity = 0;
+    pool->count = 0;
+}
+
+// Id index. Ids are interned to two 64-bit words and kept in the slot, so
+// a probe reads only the slot array; a hit touches the entity once, when
+// the caller uses it.
+
+static int index_init(IdIndex *index, unsigned capacity) {
+    index->slots = malloc(sizeof(IdIndexSlot) * capacity);
+    if (index->slots == NULL) {
+        return -1;
+    }
+    for (unsigned i = 0; i < capacity; i++) {
+        index->slots[i].index = -1;
+    }
+    index->capacity = capacity;
+    index->count = 0;
+    return 0;
+}
+
+// Home slot by multiply-shift rather than a mask, so the capacity need not
+// be a power of two and a reserved index is sized to its count
+static unsigned index_home(unsigned capacity, uint32_t hash) {
+    return (unsigned)(((uint64_t)hash * capacity) >> 32);
+}
+
+static IdIndexSlot *index_probe(const IdIndex *index, SaferId key, uint32_t hash) {
+    unsigned pos = index_home(index->capacity, hash);
+    for (;;) {
+        IdIndexSlot *slot = &index->slots[pos];
+        if (slot->index < 0) {
+            return slot;
+        }
+        if (slot->hash == hash && safer_id_equal(slot->id, key)) {
+            return slot;
+        }
+        pos = pos + 1 < index->capacity ? pos + 1 : 0;
+    }
+}
+
+static int index_resize(IdIndex *index, unsigned capacity) {
+    IdIndex bigger;
+    if (index_init(&bigger, capacity) != 0) {
+        return -1;
+    }
+    for (unsigned i = 0; i < index->capacity; i++) {
+        if (index->slots[i].index >= 0) {
+            // Keys are unique, so only an empty slot is needed
+            unsigned pos = index_home(bigger.capacity, index->slots[i].hash);
+            while (bigger.slots[pos].index >= 0) {
+                pos = pos + 1 < bigger.capacity ? pos + 1 : 0;
+            }
+            bigger.slots[pos] = index->slots[i];
+        }
+    }
+    bigger.count = index->count;
+    free(index->slots);
+    *index = bigger;
+    return 0;
+}
+
+// Fewest slots that hold count entries under the 0.7 load factor
+static int index_reserve(IdIndex *index, unsigned count) {
+    uint64_t capacity = ((uint64_t)count * 10 + 6) / 7;
+    if (capacity > UINT32_MAX) {
+        return -1;
+    }
+    return capacity > index->capacity ? index_resize(index, (unsigned)capacity) : 0;
+}
+
+static int index_find(const IdIndex *index, SaferId key) {
+    return index_probe(index, key, safer_id_hash(key))->index;
+}
+
+// Look up id, or claim a new pool slot for it. On return *created tells which.
+static void *index_get_or_push(IdIndex *index, EntityPool *pool, Arena *arena,
+                               const char *id, int *created) {
+    // Keep the load factor below 0.7
+    if ((uint64_t)(index->count + 1) * 10 > (uint64_t)index->capacity * 7 &&
+        index_resize(index, index->capacity * 2) != 0) {
+        return NULL;
+    }
+    SaferId key = safer_id_from_string(id);
+    uint32_t hash = safer_id_hash(key);
+    IdIndexSlot *slot = index_probe(index, key, hash);
+    if (slot->index >= 0) {
+        *created = 0;
+        return pool_get(pool, slot->index);
+    }
+
+    int pool_index = pool->count;
+    char *entity = pool_push(pool, arena);
+    if (entity == NULL) {
+        return NULL;
+    }
+    safer_id_store(entity, key);
+    slot->id = key;
+    slot->hash = hash;
+    slot->index = pool_index;
+    index->count++;
+    *created = 1;
+    return entity;
+}
+
+// SafetyManagementSystem pointer arrays
+
+static int reserve_pointers(void ***array, int *capacity, int count) {
+    if (count <= *capacity) {
+        return 0;
+    }
+    void **grown = realloc(*array, sizeof(void *) * count);
+    if (grown == NULL) {
+        return -1;
+    }
+    *array = grown;
+    *capacity = count;
+    return 0;
+}
+
+static int append_pointer(void ***array, int *count, int *capacity, void *ptr) {
+    if (*count == *capacity) {
+        int new_capacity = *capacity ? *capacity * 2 : 64;
+        void **grown = realloc(*array, sizeof(void *) * new_capacity);
+        if (grown == NULL) {
+            return -1;
+        }
+        *array = grown;
+        *capacity = new_capacity;
+    }
+    (*array)[(*count)++] = ptr;
+    return 0;
+}
+
+// Undoing a failed add. Until the entity is linked into the sms arrays
+// an add only appends: arena storage, possibly a slab, the pool's last
+// slot and the index slot that points at it.
+
+typedef struct {
+    ArenaMark arena;
+    int pool_count;
+    int num_slabs;
+} AddUndo;
+
+static AddUndo add_begin(FleetRegistry *reg, const EntityPool *pool) {
+    AddUndo undo = {arena_mark(&reg->arena), pool->count, pool->num_slabs};
+    return undo;
+}
+
+// Roll back so lookups do not find a half-written entity and a retry
+// starts from the same state
+static void add_unwind(FleetRegistry *reg, IdIndex *index, EntityPool *pool, const AddUndo *undo,
+                       const char *id) {
+    if (pool->count > undo->pool_count) {
+        // The slot was the last one filled, so emptying it leaves every
+        // probe chain as it was before the insert
+        SaferId key = safer_id_from_string(id);
+        IdIndexSlot *slot = index_probe(index, key, safer_id_hash(key));
+        if (slot->index >= 0) {
+            slot->index = -1;
+            index->count--;
+        }
+        pool->count = undo->pool_count;
+        pool->num_slabs = undo->num_slabs;
+    }
+    arena_rewind(&reg->arena, undo->arena);
+}
+
+// Registry
+
+int registry_init(FleetRegistry *reg, SafetyManagementSystem *sms) {
+    memset(reg, 0, sizeof(*reg));
+    arena_init(&reg->arena, ARENA_DEFAULT_BLOCK_SIZE * 4);
+    pool_init(&reg->aircraft, sizeof(Aircraft));
+    pool_init(&reg->crew, sizeof(CrewMember));
+    pool_init(&reg->missions, sizeof(Mission));
+
+    if (index_init(&reg->aircraft_index, INDEX_INITIAL_CAPACITY) != 0 ||
+        index_init(&reg->crew_index, INDEX_INITIAL_CAPACITY) != 0 ||
+        index_init(&reg->mission_index, INDEX_INITIAL_CAPACITY) != 0) {
+        registry_destroy(reg);
+        return -1;
+    }
+
+    reg->sms = sms;
+    if (sms != NULL) {
+        sms->registry = reg;
+    }
+    return 0;
+}
+
+void registry_destroy(FleetRegistry *reg) {
+    if (reg->sms != NULL) {
+        free(reg->sms->aircraft_registry);
+        free(reg->sms->crew_registry);
+        free(reg->sms->missions);
+        reg->sms->aircraft_registry = NULL;
+        reg->sms->crew_registry = NULL;
+        reg->sms->missions = NULL;
+        reg->sms->num_aircraft = 0;
+        reg->sms->num_crew = 0;
+        reg->sms->num_missions = 0;
+        reg->sms->registry = NULL;
+    }
+
+    free(reg->aircraft_index.slots);
+    free(reg->crew_index.slots);
+    free(reg->mission_index.slots);
+    pool_destroy(&reg->aircraft);
+    pool_destroy(&reg->crew);
+    pool_destroy(&reg->missions);
+    arena_destroy(&reg->arena);
+    if (reg->mapping != NULL) {
+        munmap(reg->mapping, reg->mapping_size);
+    }
+    memset(reg, 0, sizeof(*reg));
+}
+
+// Slab pointer arrays, indexes and sms arrays only; the slabs themselves
+// still come from the arena as entities arrive
+static int pool_reserve(EntityPool *pool, int count) {
+    int num_slabs = (count + REGISTRY_SLAB_SIZE - 1) / REGISTRY_SLAB_SIZE;
+    if (num_slabs <= pool->slab_capacity) {
+        return 0;
+    }
+    void **slabs = realloc(pool->slabs, sizeof(void *) * num_slabs);
+    if (slabs == NULL) {
+        return -1;
+    }
+    pool->slabs = slabs;
+    pool->slab_capacity = num_slabs;
+    return 0;
+}
+
+int registry_reserve(FleetRegistry *reg, int aircraft, int crew, int missions) {
+    if (aircraft < 0 || crew < 0 || missions < 0) {
+        return -1;
+    }
+    if (pool_reserve(&reg->aircraft, aircraft) != 0 || pool_reserve(&reg->crew, crew) != 0 ||
+        pool_reserve(&reg->missions, missions) != 0 ||
+        index_reserve(&reg->aircraft_index, (unsigned)aircraft) != 0 ||
+        index_reserve(&reg->crew_index, (unsigned)crew) != 0 ||
+        index_reserve(&reg->mission_index, (unsigned)missions) != 0) {
+        return -1;
+    }
+    SafetyManagementSystem *sms = reg->sms;
+    if (sms != NULL &&
+        (reserve_pointers((void ***)&sms->aircraft_registry, &reg->sms_aircraft_capacity, aircraft) != 0 ||
+         reserve_pointers((void ***)&sms->crew_registry, &reg->sms_crew_capacity, crew) != 0 ||
+         reserve_pointers((void ***)&sms->missions, &reg->sms_mission_capacity, missions) != 0)) {
+        return -1;
+    }
+    return 0;
+}
+
+static MaintenanceRecord *copy_maintenance_records(FleetRegistry *reg,
+                                                   const MaintenanceRecord *records,
+                                                   int num_records) {
+    if (records == NULL || num_records <= 0) {
+        return NULL;
+    }
+    MaintenanceRecord *copy = arena_alloc(&reg->arena, sizeof(MaintenanceRecord) * num_records,
+                                          _Alignof(MaintenanceRecord));
+    if (copy == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < num_records; i++) {
+        copy[i] = records[i];
+        copy[i].reported_issues = NULL;
+        if (records[i].reported_issues == NULL || records[i].num_issues <= 0) {
+            copy[i].num_issues = 0;
+            continue;
+        }
+        copy[i].reported_issues = arena_alloc(&reg->arena, sizeof(char *) * records[i].num_issues,
+                                              _Alignof(char *));
+        if (copy[i].reported_issues == NULL) {
+            return NULL;
+        }
+        for (int j = 0; j < records[i].num_issues; j++) {
+            copy[i].reported_issues[j] = arena_strdup(&reg->arena, records[i].reported_issues[j]);
+            if (copy[i].reported_issues[j] == NULL) {
+                return NULL;
+            }
+        }
+    }
+    return copy;
+}
+
+Aircraft *registry_add_aircraft(FleetRegistry *reg, const Aircraft *aircraft) {
+    AddUndo undo = add_begin(reg, &reg->aircraft);
+    MaintenanceRecord *records = copy_maintenance_records(reg, aircraft->maintenance_records,
+                                                          aircraft->num_records);
+    if (records == NULL && aircraft->num_records > 0 && aircraft->maintenance_records != NULL) {
+        add_unwind(reg, &reg->aircraft_index, &reg->aircraft, &undo, aircraft->id);
+        return NULL;
+    }
+
+    int created;
+    Aircraft *stored = index_get_or_push(&reg->aircraft_index, &reg->aircraft, &reg->arena,
+                                         aircraft->id, &created);
+    if (stored == NULL) {
+        add_unwind(reg, &reg->aircraft_index, &reg->aircraft, &undo, aircraft->id);
+        return NULL;
+    }
+    if (created) {
+        if (reg->sms != NULL &&
+            append_pointer((void ***)&reg->sms->aircraft_registry, &reg->sms->num_aircraft,
+                           &reg->sms_aircraft_capacity, stored) != 0) {
+            add_unwind(reg, &reg->aircraft_index, &reg->aircraft, &undo, aircraft->id);
+            return NULL;
+        }
+    }
+
+    char id[16];
+    memcpy(id, stored->id, 16);
+    *stored = *aircraft;
+    memcpy(stored->id, id, 16);
+    stored->maintenance_records = records;
+    stored->num_records = records != NULL ? aircraft->num_records : 0;
+    return stored;
+}
+
+CrewMember *registry_add_crew_member(FleetRegistry *reg, const CrewMember *crew) {
+    AddUndo undo = add_begin(reg, &reg->crew);
+    int created;
+    CrewMember *stored = index_get_or_push(&reg->crew_index, &reg->crew, &reg->arena,
+                                           crew->id, &created);
+    if (stored == NULL) {
+        add_unwind(reg, &reg->crew_index, &reg->crew, &undo, crew->id);
+        return NULL;
+    }
+    if (created) {
+        if (reg->sms != NULL &&
+            append_pointer((void ***)&reg->sms->crew_registry, &reg->sms->num_crew,
+                           &reg->sms_crew_capacity, stored) != 0) {
+            add_unwind(reg, &reg->crew_index, &reg->crew, &undo, crew->id);
+            return NULL;
+        }
+    }
+
+    char id[16];
+    memcpy(id, stored->id, 16);
+    *stored = *crew;
+    memcpy(stored->id, id, 16);
+    return stored;
+}
+
+Mission *registry_add_mission(FleetRegistry *reg, const Mission *mission) {
+    AddUndo undo = add_begin(reg, &reg->missions);
+    CrewMember **crew = NULL;
+    if (mission->crew != NULL && mission->crew_size > 0) {
+        crew = arena_alloc(&reg->arena, sizeof(CrewMember *) * mission->crew_size,
+                           _Alignof(CrewMember *));
+        if (crew == NULL) {
+            add_unwind(reg, &reg->mission_index, &reg->missions, &undo, mission->id);
+            return NULL;
+        }
+        memcpy(crew, mission->crew, sizeof(CrewMember *) * mission->crew_size);
+    }
+
+    int created;
+    Mission *stored = index_get_or_push(&reg->mission_index, &reg->missions, &reg->arena,
+                                        mission->id, &created);
+    if (stored == NULL) {
+        add_unwind(reg, &reg->mission_index, &reg->missions, &undo, mission->id);
+        return NULL;
+    }
+    if (created) {
+        if (reg->sms != NULL &&
+            append_pointer((void ***)&reg->sms->missions, &reg->sms->num_missions,
+                           &reg->sms_mission_capacity, stored) != 0) {
+            add_unwind(reg, &reg->mission_index, &reg->missions, &undo, mission->id);
+            return NULL;
+        }
+    }
+
+    char id[16];
+    memcpy(id, stored->id, 16);
+    *stored = *mission;
+    memcpy(stored->id, id, 16);
+    stored->crew = crew;
+    stored->crew_size = crew != NULL ? mission->crew_size : 0;
+    return stored;
+}
+
+int registry_set_mission_crew(FleetRegistry *reg, Mission *mission, CrewMember **crew, int crew_size) {
+    CrewMember **copy = NULL;
+    if (crew != NULL && crew_size > 0) {
+        copy = arena_alloc(&reg->arena, sizeof(CrewMember *) * crew_size, _Alignof(CrewMember *));
+        if (copy == NULL) {
+            return -1;
+        }
+        memcpy(copy, crew, sizeof(CrewMember *) * crew_size);
+    }
+    mission->crew = copy;
+    mission->crew_size = copy != NULL ? crew_size : 0;
+    return 0;
+}
+
+Aircraft *registry_find_aircraft(FleetRegistry *reg, const char *id) {
+    return registry_find_aircraft_id(reg, safer_id_from_string(id));
+}
+
+Aircraft *registry_find_aircraft_id(FleetRegistry *reg, SaferId id) {
+    int index = index_find(&reg->aircraft_index, id);
+    return index >= 0 ? pool_get(&reg->aircraft, index) : NULL;
+}
+
+CrewMember *registry_find_crew_member(FleetRegistry *reg, const char *id) {
+    return registry_find_crew_member_id(reg, safer_id_from_string(id));
+}
+
+CrewMember *registry_find_crew_member_id(FleetRegistry *reg, SaferId id) {
+    int index = index_find(&reg->crew_index, id);
+    return index >= 0 ? pool_get(&reg->crew, index) : NULL;
+}
+
+Mission *registry_find_mission(FleetRegistry *reg, const char *id) {
+    return registry_find_mission_id(reg, safer_id_from_string(id));
+}
+
+Mission *registry_find_mission_id(FleetRegistry *reg, SaferId id) {
+    int index = index_find(&reg->mission_index, id);
+    return index >= 0 ? pool_get(&reg->missions, index) : NULL;
+}
+
+size_t registry_memory_usage(const FleetRegistry *reg) {
+    size_t total = reg->arena.bytes_reserved + reg->mapping_size;
+    total += sizeof(IdIndexSlot) * (reg->aircraft_index.capacity +
+                                    reg->crew_index.capacity +
+                                    reg->mission_index.capacity);
+    total += sizeof(void *) * (reg->sms_aircraft_capacity +
+                               reg->sms_crew_capacity +
+                               reg->sms_mission_capacity);
+    return total;
+}
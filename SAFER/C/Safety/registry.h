@@ -0,0 +1,85 @@
+// registry.h - Arena-backed fleet registry for aircraft, crew and missions
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include "safer.h"
+#include "arena.h"
+#include "safer_id.h"
+#include <stdint.h>
+
+#define REGISTRY_SLAB_SIZE 4096 // Entities per contiguous slab
+
+// Fixed-size slabs of one entity type. Entities never move once added, so
+// pointers held by Mission.aircraft and Mission.crew stay valid.
+typedef struct {
+    void **slabs;
+    int num_slabs;
+    int slab_capacity;
+    size_t elem_size;
+    int count;
+} EntityPool;
+
+// Open-addressing id -> pool index map. Slots carry the id itself, so a
+// probe compares it without touching the pooled entity.
+typedef struct {
+    SaferId id;
+    uint32_t hash;
+    int32_t index; // -1 for empty slots
+} IdIndexSlot;
+
+typedef struct {
+    IdIndexSlot *slots;
+    unsigned capacity;
+    unsigned count;
+} IdIndex;
+
+typedef struct FleetRegistry {
+    Arena arena; // Slabs, maintenance records, crew lists and issue strings
+    EntityPool aircraft;
+    EntityPool crew;
+    EntityPool missions;
+    IdIndex aircraft_index;
+    IdIndex crew_index;
+    IdIndex mission_index;
+    SafetyManagementSystem *sms;
+    int sms_aircraft_capacity;
+    int sms_crew_capacity;
+    int sms_mission_capacity;
+    void *mapping;     // Snapshot the pools were restored into, see snapshot.h
+    size_t mapping_size;
+} FleetRegistry;
+
+// Registry lifecycle. registry_init attaches the registry to sms and keeps its
+// aircraft_registry/crew_registry/missions arrays in sync with the pools.
+int registry_init(FleetRegistry *reg, SafetyManagementSystem *sms);
+void registry_destroy(FleetRegistry *reg);
+
+// Make room for this many entities of each kind in all, so a bulk load of
+// known size neither rehashes the indexes nor regrows the sms arrays
+int registry_reserve(FleetRegistry *reg, int aircraft, int crew, int missions);
+
+// Add or replace an entity by id. The entity is deep-copied into the arena
+// (maintenance records, reported_issues, crew list) and the stored copy is
+// returned. Replacing an entity leaves its old arena storage unreclaimed
+// until registry_destroy. On failure (NULL) the registry is as it was.
+// Mission.aircraft and Mission.crew entries are expected to point at
+// registry-owned entities.
+Aircraft *registry_add_aircraft(FleetRegistry *reg, const Aircraft *aircraft);
+CrewMember *registry_add_crew_member(FleetRegistry *reg, const CrewMember *crew);
+Mission *registry_add_mission(FleetRegistry *reg, const Mission *mission);
+
+// Replace a registered mission's crew list (copied into the arena)
+int registry_set_mission_crew(FleetRegistry *reg, Mission *mission, CrewMember **crew, int crew_size);
+
+// Lookup by id, NULL when unknown. The _id variants take a pre-interned id.
+Aircraft *registry_find_aircraft(FleetRegistry *reg, const char *id);
+CrewMember *registry_find_crew_member(FleetRegistry *reg, const char *id);
+Mission *registry_find_mission(FleetRegistry *reg, const char *id);
+Aircraft *registry_find_aircraft_id(FleetRegistry *reg, SaferId id);
+CrewMember *registry_find_crew_member_id(FleetRegistry *reg, SaferId id);
+Mission *registry_find_mission_id(FleetRegistry *reg, SaferId id);
+
+// Memory accounting for load reports
+size_t registry_memory_usage(const FleetRegistry *reg);
+
+#endif // REGISTRY_H
@@ -0,0 +1,183 @@
+// request_body.c - Pooled incremental JSON and raw request bodies
+#define _POSIX_C_SOURCE 200809L
+#include "request_body.h"
+#include <ctype.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static RequestBody *free_list;
+static int num_free;
+
+RequestBody *request_body_acquire(size_t max_bytes, RequestBodyFormat format) {
+    pthread_mutex_lock(&pool_lock);
+    RequestBody *body = free_list;
+    if (body != NULL) {
+        free_list = body->next_free;
+        num_free--;
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    if (body == NULL) {
+        body = calloc(1, sizeof(RequestBody));
+        if (body == NULL) {
+            return NULL;
+        }
+        body->tokener = json_tokener_new();
+        if (body->tokener == NULL) {
+            free(body);
+            return NULL;
+        }
+    }
+    body->format = format;
+    body->work = NULL;
+    body->json = NULL;
+    body->bytes = 0;
+    body->max_bytes = max_bytes ? max_bytes : REQUEST_BODY_DEFAULT_MAX_BYTES;
+    body->status = REQUEST_BODY_PENDING;
+    body->next_free = NULL;
+    return body;
+}
+
+// Move the first used bytes of the raw buffer into one of capacity bytes
+static int resize_raw(RequestBody *body, size_t capacity, size_t used) {
+    void *raw = NULL;
+    capacity = (capacity + REQUEST_BODY_RAW_ALIGN - 1) & ~(size_t)(REQUEST_BODY_RAW_ALIGN - 1);
+    if (posix_memalign(&raw, REQUEST_BODY_RAW_ALIGN, capacity) != 0) {
+        return -1;
+    }
+    if (used > 0) {
+        memcpy(raw, body->raw, used);
+    }
+    free(body->raw);
+    body->raw = raw;
+    body->raw_capacity = capacity;
+    return 0;
+}
+
+int request_body_reserve(RequestBody *body, size_t size) {
+    if (size > body->max_bytes) {
+        return 0;
+    }
+    if (size > REQUEST_BODY_RESERVE_MAX_BYTES) {
+        size = REQUEST_BODY_RESERVE_MAX_BYTES;
+    }
+    if (size <= body->raw_capacity) {
+        return 0;
+    }
+    return resize_raw(body, size, body->bytes);
+}
+
+// Called after bytes has been advanced past this chunk
+static RequestBodyStatus append_raw(RequestBody *body, const char *data, size_t size) {
+    size_t used = body->bytes - size;
+    if (body->bytes > body->raw_capacity) {
+        size_t capacity = body->raw_capacity > 0 ? body->raw_capacity : 4096;
+        while (capacity < body->bytes) {
+            capacity *= 2;
+        }
+        if (resize_raw(body, capacity < body->max_bytes ? capacity : body->max_bytes, used) != 0) {
+            return body->status = REQUEST_BODY_INVALID;
+        }
+    }
+    memcpy(body->raw + used, data, size);
+    return body->status;
+}
+
+static int only_whitespace(const char *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        if (!isspace((unsigned char)data[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+RequestBodyStatus request_body_feed(RequestBody *body, const char *data, size_t size) {
+    if (body->status == REQUEST_BODY_INVALID || body->status == REQUEST_BODY_TOO_LARGE) {
+        return body->status;
+    }
+    body->bytes += size;
+    if (body->bytes > body->max_bytes) {
+        // Free the partial tree now rather than when the upload ends
+        json_object_put(body->json);
+        body->json = NULL;
+        json_tokener_reset(body->tokener);
+        return body->status = REQUEST_BODY_TOO_LARGE;
+    }
+    if (body->format == REQUEST_BODY_RAW) {
+        return append_raw(body, data, size);
+    }
+
+    while (size > 0) {
+        if (body->status == REQUEST_BODY_COMPLETE) {
+            if (!only_whitespace(data, size)) {
+                body->status = REQUEST_BODY_INVALID;
+            }
+            return body->status;
+        }
+
+        int length = size > INT_MAX ? INT_MAX : (int)size;
+        json_object *json = json_tokener_parse_ex(body->tokener, data, length);
+        if (json != NULL) {
+            body->json = json;
+            body->status = REQUEST_BODY_COMPLETE;
+            size_t used = json_tokener_get_parse_end(body->tokener);
+            data += used;
+            size -= used;
+        } else if (json_tokener_get_error(body->tokener) == json_tokener_continue) {
+            data += length;
+            size -= length;
+        } else {
+            return body->status = REQUEST_BODY_INVALID;
+        }
+    }
+    return body->status;
+}
+
+RequestBodyStatus request_body_finish(RequestBody *body) {
+    if (body->status != REQUEST_BODY_PENDING) {
+        return body->status;
+    }
+    if (body->bytes == 0 || body->format == REQUEST_BODY_RAW) {
+        return body->status = REQUEST_BODY_COMPLETE;
+    }
+    // A bare top-level number only terminates at end of input; the NUL flushes it
+    json_object *json = json_tokener_parse_ex(body->tokener, "", 1);
+    if (json != NULL) {
+        body->json = json;
+        return body->status = REQUEST_BODY_COMPLETE;
+    }
+    return body->status = REQUEST_BODY_INVALID;
+}
+
+void request_body_release(RequestBody *body) {
+    if (body == NULL) {
+        return;
+    }
+    json_object_put(body->json);
+    body->json = NULL;
+    json_tokener_reset(body->tokener);
+    if (body->raw_capacity > REQUEST_BODY_RAW_KEEP_BYTES) {
+        free(body->raw);
+        body->raw = NULL;
+        body->raw_capacity = 0;
+    }
+
+    pthread_mutex_lock(&pool_lock);
+    if (num_free < REQUEST_BODY_POOL_MAX) {
+        body->next_free = free_list;
+        free_list = body;
+        num_free++;
+        body = NULL;
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    if (body != NULL) {
+        json_tokener_free(body->tokener);
+        free(body->raw);
+        free(body);
+    }
+}
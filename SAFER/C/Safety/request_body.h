@@ -0,0 +1,66 @@
+// request_body.h - Incremental JSON parsing and raw buffering of streamed request bodies
+#ifndef REQUEST_BODY_H
+#define REQUEST_BODY_H
+
+#include <json-c/json.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define REQUEST_BODY_DEFAULT_MAX_BYTES ((size_t)64 << 20) // 64 MiB
+#define REQUEST_BODY_POOL_MAX 64                          // Idle bodies kept for reuse
+#define REQUEST_BODY_RAW_ALIGN 64                         // Alignment of raw buffers
+#define REQUEST_BODY_RAW_KEEP_BYTES ((size_t)1 << 20)     // Larger raw buffers are not pooled
+#define REQUEST_BODY_RESERVE_MAX_BYTES ((size_t)1 << 20)  // Most reserved before any data arrives
+
+typedef enum {
+    REQUEST_BODY_JSON,      // Parsed incrementally into json
+    REQUEST_BODY_RAW        // Collected as is into raw, for binary media types
+} RequestBodyFormat;
+
+typedef enum {
+    REQUEST_BODY_PENDING,   // Waiting for more data
+    REQUEST_BODY_COMPLETE,  // json (or raw) holds the document; json is NULL for an empty body
+    REQUEST_BODY_INVALID,   // Malformed JSON or trailing data after the document
+    REQUEST_BODY_TOO_LARGE  // More than max_bytes received; the rest is discarded
+} RequestBodyStatus;
+
+// Per-request parse state, handed to microhttpd through con_cls. Each upload
+// chunk is fed straight to the tokener, so the body is never copied into a
+// contiguous buffer; only the parsed json_object tree is kept. Raw bodies
+// are the exception and are collected whole.
+typedef struct RequestBody {
+    RequestBodyFormat format;
+    json_tokener *tokener;
+    json_object *json;
+    char *raw;              // REQUEST_BODY_RAW_ALIGN aligned, kept across reuse
+    size_t raw_capacity;
+    size_t bytes;
+    size_t max_bytes;
+    RequestBodyStatus status;
+    int route;              // Set by the server for per-route metrics
+    uint64_t started_ns;
+    void *work;             // Server state while the request is suspended
+    struct RequestBody *next_free;
+} RequestBody;
+
+// Take a body from the pool, or allocate one. max_bytes of 0 takes
+// REQUEST_BODY_DEFAULT_MAX_BYTES. Returns NULL when out of memory.
+RequestBody *request_body_acquire(size_t max_bytes, RequestBodyFormat format);
+
+// Size the raw buffer for an announced Content-Length so the upload is
+// not copied as it grows. At most REQUEST_BODY_RESERVE_MAX_BYTES is taken
+// up front, since a client can announce a length it never sends; larger
+// bodies grow as the data arrives. Returns 0 on success, -1 when out of
+// memory.
+int request_body_reserve(RequestBody *body, size_t size);
+
+// Parse (or append) the next chunk as it arrives
+RequestBodyStatus request_body_feed(RequestBody *body, const char *data, size_t size);
+
+// Called once the upload is complete; a truncated document becomes INVALID
+RequestBodyStatus request_body_finish(RequestBody *body);
+
+// Drop the parsed document and return the body to the pool
+void request_body_release(RequestBody *body);
+
+#endif // REQUEST_BODY_H
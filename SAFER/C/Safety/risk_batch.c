@@ -0,0 +1,323 @@
+// risk_batch.c - Shared-result, chunked parallel mission risk assessment
+#define _POSIX_C_SOURCE 200809L
+#include "risk_batch.h"
+#include "risk_rules.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+
+// Open-addressed pointer -> risk map, used only while a batch starts
+typedef struct {
+    const void **keys;
+    RiskLevel *values;
+    size_t mask;
+    size_t count;
+} RiskMemo;
+
+struct RiskBatch {
+    Mission *missions;
+    int num_missions;
+    MissionRisk *results;
+    RadioInterferenceAnalysis radio;
+    RiskLevel radio_risk;
+    const RiskRules *rules;   // The whole batch grades under one rule set and clock
+    RiskRulesHold rules_hold; // Claims rules until the batch is freed, on whichever thread
+    time_t now;
+
+    int num_chunks;
+    int next_chunk;       // Claimed with __atomic_fetch_add
+    int cancelled;
+
+    pthread_mutex_t lock;
+    pthread_cond_t completed_cond;
+    int *completed;       // Chunk indices in completion order
+    int num_completed;
+    int num_reported;
+
+    pthread_t *workers;
+    int num_workers;
+};
+
+static size_t hash_pointer(const void *key) {
+    uint64_t h = (uint64_t)(uintptr_t)key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+#define MEMO_INITIAL_SIZE 64
+
+static int memo_alloc(RiskMemo *memo, size_t size) {
+    memo->keys = calloc(size, sizeof(*memo->keys));
+    memo->values = malloc(size * sizeof(*memo->values));
+    memo->mask = size - 1;
+    memo->count = 0;
+    return memo->keys != NULL && memo->values != NULL ? 0 : -1;
+}
+
+static void memo_free(RiskMemo *memo) {
+    free(memo->keys);
+    free(memo->values);
+}
+
+// Slot holding key, or the empty slot where it belongs
+static size_t memo_slot(const RiskMemo *memo, const void *key) {
+    size_t i = hash_pointer(key) & memo->mask;
+    while (memo->keys[i] != NULL && memo->keys[i] != key) {
+        i = (i + 1) & memo->mask;
+    }
+    return i;
+}
+
+// Double the table once it is half full
+static int memo_grow(RiskMemo *memo) {
+    RiskMemo old = *memo;
+    if (memo_alloc(memo, (old.mask + 1) * 2) != 0) {
+        memo_free(memo);
+        *memo = old;
+        return -1;
+    }
+    for (size_t i = 0; i <= old.mask; i++) {
+        if (old.keys[i] != NULL) {
+            size_t slot = memo_slot(memo, old.keys[i]);
+            memo->keys[slot] = old.keys[i];
+            memo->values[slot] = old.values[i];
+            memo->count++;
+        }
+    }
+    memo_free(&old);
+    return 0;
+}
+
+// Risk for key, computed with risk() the first time key is seen
+static int memo_lookup(RiskMemo *memo, const RiskBatch *batch, const void *key,
+                       RiskLevel (*risk)(const RiskBatch *, const void *), RiskLevel *value) {
+    size_t slot = memo_slot(memo, key);
+    if (memo->keys[slot] == NULL) {
+        if ((memo->count + 1) * 2 > memo->mask + 1) {
+            if (memo_grow(memo) != 0) {
+                return -1;
+            }
+            slot = memo_slot(memo, key);
+        }
+        memo->keys[slot] = key;
+        memo->values[slot] = risk(batch, key);
+        memo->count++;
+    }
+    *value = memo->values[slot];
+    return 0;
+}
+
+static RiskLevel aircraft_maintenance_risk(const RiskBatch *batch, const void *key) {
+    const Aircraft *aircraft = key;
+    return risk_rules_maintenance(risk_rules_profile(batch->rules, aircraft->model),
+                                  aircraft->maintenance_records, batch->now);
+}
+
+static RiskLevel crew_member_risk(const RiskBatch *batch, const void *member) {
+    return risk_rules_crew(batch->rules, member, batch->now);
+}
+
+// Compute maintenance and crew risk once per distinct aircraft and crew
+// member, and resolve each mission's shares into its result in the same
+// pass so the workers never touch the memo tables
+static int resolve_shared_risks(RiskBatch *batch) {
+    RiskMemo maintenance = {0}, crew = {0};
+    if (memo_alloc(&maintenance, MEMO_INITIAL_SIZE) != 0 || memo_alloc(&crew, MEMO_INITIAL_SIZE) != 0) {
+        memo_free(&maintenance);
+        memo_free(&crew);
+        return -1;
+    }
+    int rc = 0;
+    for (int i = 0; i < batch->num_missions && rc == 0; i++) {
+        Mission *mission = &batch->missions[i];
+        MissionRisk *risk = &batch->results[i];
+        risk->maintenance = RISK_LOW;
+        if (mission->aircraft != NULL && mission->aircraft->maintenance_records != NULL) {
+            rc = memo_lookup(&maintenance, batch, mission->aircraft, aircraft_maintenance_risk, &risk->maintenance);
+        }
+        risk->crew = RISK_LOW;
+        for (int c = 0; c < mission->crew_size && rc == 0; c++) {
+            RiskLevel crew_risk;
+            if (mission->crew[c] == NULL) continue;
+            rc = memo_lookup(&crew, batch, mission->crew[c], crew_member_risk, &crew_risk);
+            if (crew_risk > risk->crew) risk->crew = crew_risk;
+        }
+    }
+    memo_free(&maintenance);
+    memo_free(&crew);
+    return rc;
+}
+
+// Weather and the overall level, combined as in perform_risk_assessment
+// plus the shared radio risk
+static void assess_chunk(RiskBatch *batch, int chunk) {
+    int first = chunk * RISK_BATCH_CHUNK;
+    int last = first + RISK_BATCH_CHUNK < batch->num_missions ? first + RISK_BATCH_CHUNK : batch->num_missions;
+    for (int i = first; i < last; i++) {
+        Mission *mission = &batch->missions[i];
+        MissionRisk *risk = &batch->results[i];
+        const RiskProfile *profile =
+            risk_rules_profile(batch->rules, mission->aircraft != NULL ? mission->aircraft->model : NULL);
+        risk->weather = risk_rules_weather(profile, &mission->weather);
+        risk->radio = batch->radio_risk;
+
+        risk->overall = risk->weather;
+        if (risk->maintenance > risk->overall) risk->overall = risk->maintenance;
+        if (risk->crew > risk->overall) risk->overall = risk->crew;
+        if (risk->radio > risk->overall) risk->overall = risk->radio;
+        mission->risk_level = risk->overall;
+    }
+
+    pthread_mutex_lock(&batch->lock);
+    batch->completed[batch->num_completed++] = chunk;
+    pthread_cond_signal(&batch->completed_cond);
+    pthread_mutex_unlock(&batch->lock);
+}
+
+// Claim the next chunk, or -1 when none are left
+static int claim_chunk(RiskBatch *batch) {
+    if (__atomic_load_n(&batch->cancelled, __ATOMIC_RELAXED)) {
+        return -1;
+    }
+    int chunk = __atomic_fetch_add(&batch->next_chunk, 1, __ATOMIC_RELAXED);
+    return chunk < batch->num_chunks ? chunk : -1;
+}
+
+static void *batch_worker(void *arg) {
+    RiskBatch *batch = arg;
+    int chunk;
+    while ((chunk = claim_chunk(batch)) >= 0) {
+        assess_chunk(batch, chunk);
+    }
+    return NULL;
+}
+
+static void free_batch(RiskBatch *batch) {
+    risk_rules_unclaim(&batch->rules_hold);
+    risk_rules_hold_destroy(&batch->rules_hold);
+    free(batch->completed);
+    free(batch->workers);
+    pthread_mutex_destroy(&batch->lock);
+    pthread_cond_destroy(&batch->completed_cond);
+    free(batch);
+}
+
+RiskBatch *risk_batch_start(Mission *missions, int num_missions, RadioEnvironment *env,
+                            int threads, MissionRisk *results) {
+    RiskBatch *batch = calloc(1, sizeof(RiskBatch));
+    if (batch == NULL) {
+        return NULL;
+    }
+    batch->missions = missions;
+    batch->num_missions = num_missions > 0 ? num_missions : 0;
+    batch->results = results;
+    risk_rules_hold_init(&batch->rules_hold);
+    batch->rules = risk_rules_claim(&batch->rules_hold);
+    batch->now = time(NULL);
+    batch->num_chunks = (batch->num_missions + RISK_BATCH_CHUNK - 1) / RISK_BATCH_CHUNK;
+    pthread_mutex_init(&batch->lock, NULL);
+    pthread_cond_init(&batch->completed_cond, NULL);
+    batch->completed = malloc(sizeof(int) * (batch->num_chunks > 0 ? batch->num_chunks : 1));
+    if (batch->completed == NULL || resolve_shared_risks(batch) != 0) {
+        free_batch(batch);
+        return NULL;
+    }
+
+    // Without emitters there is no interference to weigh; radio stays RISK_LOW
+    if (env != NULL && env->num_sources > 0) {
+        batch->radio = analyze_radio_interference(env);
+        batch->radio_risk = batch->radio.risk_level;
+    }
+
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+    if (threads > batch->num_chunks) {
+        threads = batch->num_chunks;
+    }
+    batch->workers = malloc(sizeof(pthread_t) * (threads > 0 ? threads : 1));
+    for (; batch->workers != NULL && batch->num_workers < threads; batch->num_workers++) {
+        if (pthread_create(&batch->workers[batch->num_workers], NULL, batch_worker, batch) != 0) {
+            break;
+        }
+    }
+    return batch;
+}
+
+int risk_batch_next(RiskBatch *batch, int *first) {
+    pthread_mutex_lock(&batch->lock);
+    while (batch->num_reported == batch->num_completed) {
+        if (batch->num_reported == batch->num_chunks) {
+            pthread_mutex_unlock(&batch->lock);
+            return 0;
+        }
+        // Nothing ready: take a chunk ourselves if any are unclaimed
+        pthread_mutex_unlock(&batch->lock);
+        int chunk = claim_chunk(batch);
+        pthread_mutex_lock(&batch->lock);
+        if (chunk >= 0) {
+            pthread_mutex_unlock(&batch->lock);
+            assess_chunk(batch, chunk);
+            pthread_mutex_lock(&batch->lock);
+        } else if (__atomic_load_n(&batch->cancelled, __ATOMIC_RELAXED)) {
+            pthread_mutex_unlock(&batch->lock);
+            return 0;
+        } else if (batch->num_reported == batch->num_completed) {
+            pthread_cond_wait(&batch->completed_cond, &batch->lock);
+        }
+    }
+    int chunk = batch->completed[batch->num_reported++];
+    pthread_mutex_unlock(&batch->lock);
+
+    *first = chunk * RISK_BATCH_CHUNK;
+    int remaining = batch->num_missions - *first;
+    return remaining < RISK_BATCH_CHUNK ? remaining : RISK_BATCH_CHUNK;
+}
+
+const RadioInterferenceAnalysis *risk_batch_radio(const RiskBatch *batch) {
+    return &batch->radio;
+}
+
+void risk_batch_finish(RiskBatch *batch) {
+    if (batch == NULL) {
+        return;
+    }
+    __atomic_store_n(&batch->cancelled, 1, __ATOMIC_RELAXED);
+    for (int i = 0; i < batch->num_workers; i++) {
+        pthread_join(batch->workers[i], NULL);
+    }
+    free_batch(batch);
+}
+
+int risk_batch_assess(Mission *missions, int num_missions, RadioEnvironment *env,
+                      int threads, MissionRisk *results) {
+    RiskBatch *batch = risk_batch_start(missions, num_missions, env, threads, results);
+    if (batch == NULL) {
+        return -1;
+    }
+    int first;
+    while (risk_batch_next(batch, &first) > 0) {
+    }
+    risk_batch_finish(batch);
+    return 0;
+}
+
+RiskLevel risk_assess_mission(Mission *mission, RadioEnvironment *env, RadioInterferenceAnalysis *radio) {
+    RadioInterferenceAnalysis analysis = {0};
+    // The radio grading nests under this claim rather than making its own
+    mission->risk_level = risk_rules_mission(risk_rules_acquire(), mission, time(NULL));
+    if (env != NULL && env->num_sources > 0) {
+        analysis = analyze_radio_interference(env);
+        if (analysis.risk_level > mission->risk_level) {
+            mission->risk_level = analysis.risk_level;
+        }
+    }
+    risk_rules_release();
+    if (radio != NULL) {
+        *radio = analysis;
+    }
+    return mission->risk_level;
+}
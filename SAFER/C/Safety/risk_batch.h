@@ -0,0 +1,53 @@
+// risk_batch.h - Parallel risk assessment for batches of missions
+#ifndef RISK_BATCH_H
+#define RISK_BATCH_H
+
+#include "safer.h"
+#include "radio_interference.h"
+
+#define RISK_BATCH_CHUNK 64 // Missions claimed and reported together
+
+// Per-mission breakdown; overall is the highest of the others
+typedef struct {
+    RiskLevel weather;
+    RiskLevel maintenance;
+    RiskLevel crew;
+    RiskLevel radio;
+    RiskLevel overall;
+} MissionRisk;
+
+typedef struct RiskBatch RiskBatch;
+
+// Start assessing missions on up to threads workers (0: online CPUs).
+// Before returning, maintenance risk for each distinct aircraft and crew
+// risk for each distinct crew member are computed once and shared by every
+// mission that references them, and the shared radio environment (NULL for
+// none) is analysed once. The workers then fill in weather and overall
+// risk; a mission's risk_level and results[i] may not be read until
+// risk_batch_next has reported it. Returns NULL on failure.
+RiskBatch *risk_batch_start(Mission *missions, int num_missions, RadioEnvironment *env,
+                            int threads, MissionRisk *results);
+
+// Block until another chunk of missions is complete, in completion order.
+// Sets *first and returns the number of missions in it, or 0 once every
+// chunk has been reported. The caller helps with the work when nothing is
+// ready, so the batch progresses even if no worker could be started.
+int risk_batch_next(RiskBatch *batch, int *first);
+
+// Analysis of the shared radio environment; zeroed when it had no sources
+const RadioInterferenceAnalysis *risk_batch_radio(const RiskBatch *batch);
+
+// Stop claiming new chunks, wait for the workers and free the batch
+void risk_batch_finish(RiskBatch *batch);
+
+// Assess every mission before returning. Returns 0 on success, -1 on failure.
+int risk_batch_assess(Mission *missions, int num_missions, RadioEnvironment *env,
+                      int threads, MissionRisk *results);
+
+// Grade one mission as a batch would: weather, maintenance and crew, raised
+// to the radio risk only when env has emitters. Sets mission->risk_level
+// and returns it; radio, if not NULL, receives the analysis, zeroed when
+// there were no sources.
+RiskLevel risk_assess_mission(Mission *mission, RadioEnvironment *env, RadioInterferenceAnalysis *radio);
+
+#endif // RISK_BATCH_H
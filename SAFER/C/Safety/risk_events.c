@@ -0,0 +1,279 @@
+// risk_events.c - Shared-buffer risk event history and subscriber wakeups
+#define _POSIX_C_SOURCE 200809L
+#include "risk_events.h"
+#include "json_writer.h"
+#include <pthread.h>
+
+typedef struct {
+    int refs;                 // History slot plus readers copying it out
+    uint64_t seq;
+    char mission_id[16];
+    RiskLevel previous;
+    RiskLevel current;
+    size_t length;
+    char text[];              // "id: ...\nevent: risk\ndata: {...}\n\n"
+} RiskEvent;
+
+struct RiskSubscriber {
+    RiskEventHub *hub;
+    char mission_ids[RISK_EVENTS_MAX_FILTER_IDS][16];
+    int num_ids;
+    RiskLevel min_level;
+    uint64_t next_seq;
+
+    const char *pending;      // Record being copied out
+    size_t pending_length;
+    size_t pending_offset;
+    RiskEvent *pending_event; // Reference held while copying, NULL for resync
+
+    int waiting;
+    RiskEventNotifyFn wait;
+    RiskEventNotifyFn wake;
+    void *context;
+    struct RiskSubscriber *prev, *next;
+};
+
+struct RiskEventHub {
+    pthread_mutex_t lock;
+    RiskEvent **history;      // Ring indexed by seq % capacity
+    int capacity;
+    uint64_t next_seq;        // Sequence number of the next event, from 1
+    RiskSubscriber *subscribers;
+    int closed;
+};
+
+static const char resync_text[] = "event: resync\ndata: {}\n\n";
+
+static void release_event(RiskEvent *event) {
+    if (event != NULL && __atomic_sub_fetch(&event->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(event);
+    }
+}
+
+RiskEventHub *risk_events_create(int history) {
+    RiskEventHub *hub = calloc(1, sizeof(RiskEventHub));
+    if (hub == NULL) {
+        return NULL;
+    }
+    hub->capacity = history > 0 ? history : RISK_EVENTS_DEFAULT_HISTORY;
+    hub->history = calloc(hub->capacity, sizeof(RiskEvent *));
+    if (hub->history == NULL) {
+        free(hub);
+        return NULL;
+    }
+    hub->next_seq = 1;
+    pthread_mutex_init(&hub->lock, NULL);
+    return hub;
+}
+
+void risk_events_close(RiskEventHub *hub) {
+    pthread_mutex_lock(&hub->lock);
+    hub->closed = 1;
+    for (RiskSubscriber *s = hub->subscribers; s != NULL; s = s->next) {
+        if (s->waiting) {
+            s->waiting = 0;
+            s->wake(s->context);
+        }
+    }
+    pthread_mutex_unlock(&hub->lock);
+}
+
+void risk_events_destroy(RiskEventHub *hub) {
+    if (hub == NULL) {
+        return;
+    }
+    while (hub->subscribers != NULL) {
+        risk_events_unsubscribe(hub->subscribers);
+    }
+    for (int i = 0; i < hub->capacity; i++) {
+        release_event(hub->history[i]);
+    }
+    pthread_mutex_destroy(&hub->lock);
+    free(hub->history);
+    free(hub);
+}
+
+static int subscriber_matches(const RiskSubscriber *s, const RiskEvent *event) {
+    if (event->current < s->min_level && event->previous < s->min_level) {
+        return 0;
+    }
+    if (s->num_ids == 0) {
+        return 1;
+    }
+    for (int i = 0; i < s->num_ids; i++) {
+        if (strcmp(s->mission_ids[i], event->mission_id) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// SSE record for the event, built once and shared by every reader
+static RiskEvent *encode_event(uint64_t seq, const char *mission_id, RiskLevel previous, RiskLevel current) {
+    JsonWriter writer;
+    const char *data;
+    size_t length;
+    if (json_writer_init(&writer) != 0) {
+        return NULL;
+    }
+    json_writer_begin_object(&writer);
+    json_writer_key(&writer, "mission_id");
+    json_writer_string(&writer, mission_id);
+    json_writer_key(&writer, "previous");
+    json_writer_int(&writer, previous);
+    json_writer_key(&writer, "risk_level");
+    json_writer_int(&writer, current);
+    json_writer_key(&writer, "time");
+    json_writer_int(&writer, (long long)time(NULL));
+    json_writer_end_object(&writer);
+    JsonBuffer *buffer = json_writer_detach(&writer, &data, &length);
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    size_t capacity = length + 64;
+    RiskEvent *event = malloc(sizeof(RiskEvent) + capacity);
+    if (event != NULL) {
+        event->refs = 1;
+        event->seq = seq;
+        strncpy(event->mission_id, mission_id, sizeof(event->mission_id) - 1);
+        event->mission_id[sizeof(event->mission_id) - 1] = '\0';
+        event->previous = previous;
+        event->current = current;
+        event->length = snprintf(event->text, capacity, "id: %llu\nevent: risk\ndata: %.*s\n\n",
+                                 (unsigned long long)seq, (int)length, data);
+    }
+    json_buffer_release(buffer);
+    return event;
+}
+
+void risk_events_publish(RiskEventHub *hub, const char *mission_id, RiskLevel previous, RiskLevel current) {
+    pthread_mutex_lock(&hub->lock);
+    RiskEvent *event = encode_event(hub->next_seq, mission_id, previous, current);
+    if (event == NULL) {
+        pthread_mutex_unlock(&hub->lock);
+        fprintf(stderr, "Dropped risk event for %s: out of memory\n", mission_id);
+        return;
+    }
+    int slot = (int)(hub->next_seq++ % hub->capacity);
+    RiskEvent *evicted = hub->history[slot];
+    hub->history[slot] = event;
+
+    // Only waiting subscribers need a nudge; the rest pick it up on their next read
+    for (RiskSubscriber *s = hub->subscribers; s != NULL; s = s->next) {
+        if (s->waiting && subscriber_matches(s, event)) {
+            s->waiting = 0;
+            s->wake(s->context);
+        }
+    }
+    pthread_mutex_unlock(&hub->lock);
+    release_event(evicted);
+}
+
+RiskSubscriber *risk_events_subscribe(RiskEventHub *hub, const char *const *mission_ids, int num_ids,
+                                      RiskLevel min_level, uint64_t last_event_id,
+                                      RiskEventNotifyFn wait, RiskEventNotifyFn wake, void *context) {
+    if (num_ids > RISK_EVENTS_MAX_FILTER_IDS) {
+        return NULL;
+    }
+    RiskSubscriber *s = calloc(1, sizeof(RiskSubscriber));
+    if (s == NULL) {
+        return NULL;
+    }
+    s->hub = hub;
+    for (int i = 0; i < num_ids; i++) {
+        strncpy(s->mission_ids[i], mission_ids[i], sizeof(s->mission_ids[i]) - 1);
+    }
+    s->num_ids = num_ids;
+    s->min_level = min_level;
+    s->wait = wait;
+    s->wake = wake;
+    s->context = context;
+
+    pthread_mutex_lock(&hub->lock);
+    s->next_seq = last_event_id > 0 && last_event_id < hub->next_seq ? last_event_id + 1 : hub->next_seq;
+    s->next = hub->subscribers;
+    if (hub->subscribers != NULL) {
+        hub->subscribers->prev = s;
+    }
+    hub->subscribers = s;
+    pthread_mutex_unlock(&hub->lock);
+    return s;
+}
+
+void risk_events_unsubscribe(RiskSubscriber *s) {
+    if (s == NULL) {
+        return;
+    }
+    RiskEventHub *hub = s->hub;
+    pthread_mutex_lock(&hub->lock);
+    if (s->prev != NULL) {
+        s->prev->next = s->next;
+    } else {
+        hub->subscribers = s->next;
+    }
+    if (s->next != NULL) {
+        s->next->prev = s->prev;
+    }
+    pthread_mutex_unlock(&hub->lock);
+    release_event(s->pending_event);
+    free(s);
+}
+
+// Find the next record for s; called with the hub locked
+static int next_record(RiskEventHub *hub, RiskSubscriber *s) {
+    uint64_t oldest = hub->next_seq > (uint64_t)hub->capacity ? hub->next_seq - hub->capacity : 1;
+    if (s->next_seq < oldest) {
+        s->next_seq = oldest;
+        s->pending = resync_text;
+        s->pending_length = sizeof(resync_text) - 1;
+        return 1;
+    }
+    for (; s->next_seq < hub->next_seq; s->next_seq++) {
+        RiskEvent *event = hub->history[s->next_seq % hub->capacity];
+        if (subscriber_matches(s, event)) {
+            __atomic_add_fetch(&event->refs, 1, __ATOMIC_RELAXED);
+            s->pending_event = event;
+            s->pending = event->text;
+            s->pending_length = event->length;
+            s->next_seq++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+ssize_t risk_events_read(RiskSubscriber *s, char *buf, size_t max) {
+    if (s->pending == NULL) {
+        RiskEventHub *hub = s->hub;
+        pthread_mutex_lock(&hub->lock);
+        if (hub->closed) {
+            pthread_mutex_unlock(&hub->lock);
+            return -1;
+        }
+        if (!next_record(hub, s)) {
+            // Waiting is flagged under the lock so a publish cannot slip in
+            // between the check and the wait
+            s->waiting = 1;
+            s->wait(s->context);
+            pthread_mutex_unlock(&hub->lock);
+            return 0;
+        }
+        pthread_mutex_unlock(&hub->lock);
+        s->pending_offset = 0;
+    }
+
+    // Copy outside the lock; the reference keeps the record alive
+    size_t n = s->pending_length - s->pending_offset;
+    if (n > max) {
+        n = max;
+    }
+    memcpy(buf, s->pending + s->pending_offset, n);
+    s->pending_offset += n;
+    if (s->pending_offset == s->pending_length) {
+        release_event(s->pending_event);
+        s->pending_event = NULL;
+        s->pending = NULL;
+    }
+    return n;
+}
@@ -0,0 +1,48 @@
+// risk_events.h - Fan-out of mission risk level transitions to subscribers
+#ifndef RISK_EVENTS_H
+#define RISK_EVENTS_H
+
+#include "safer.h"
+#include <stdint.h>
+#include <sys/types.h>
+
+#define RISK_EVENTS_DEFAULT_HISTORY 1024 // Events kept for late or reconnecting subscribers
+#define RISK_EVENTS_MAX_FILTER_IDS 64
+
+typedef struct RiskEventHub RiskEventHub;
+typedef struct RiskSubscriber RiskSubscriber;
+
+// Called with the hub locked: wait when a subscriber has nothing to read,
+// wake when a matching event arrives or the hub closes. Must not call back
+// into the hub.
+typedef void (*RiskEventNotifyFn)(void *context);
+
+// Each published transition is encoded once as a Server-Sent Events record
+// and shared by reference between every subscriber that reads it; the hub
+// keeps the last history events. history <= 0 uses the default.
+RiskEventHub *risk_events_create(int history);
+
+// Wake every waiting subscriber; reads then report end of stream
+void risk_events_close(RiskEventHub *hub);
+
+// Free the hub and any subscribers still attached
+void risk_events_destroy(RiskEventHub *hub);
+
+void risk_events_publish(RiskEventHub *hub, const char *mission_id, RiskLevel previous, RiskLevel current);
+
+// Subscribe to transitions of the given missions (all when num_ids is 0)
+// that enter or leave levels at or above min_level. Events after
+// last_event_id are replayed while still in the history; 0 starts with the
+// next event. Returns NULL on failure.
+RiskSubscriber *risk_events_subscribe(RiskEventHub *hub, const char *const *mission_ids, int num_ids,
+                                      RiskLevel min_level, uint64_t last_event_id,
+                                      RiskEventNotifyFn wait, RiskEventNotifyFn wake, void *context);
+void risk_events_unsubscribe(RiskSubscriber *subscriber);
+
+// Copy up to max bytes of pending events. Returns 0 after calling wait when
+// nothing is pending (wake follows once something is), or -1 once the hub
+// is closed. A subscriber that falls behind the history gets a resync
+// event and continues from the oldest event kept.
+ssize_t risk_events_read(RiskSubscriber *subscriber, char *buf, size_t max);
+
+#endif // RISK_EVENTS_H
@@ -0,0 +1,652 @@
+// risk_rules.c - Rule table parsing, compilation and hot swapping
+#define _POSIX_C_SOURCE 200809L
+#include "risk_rules.h"
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+
+#define MAX_LINE 1024
+
+const char risk_rules_default_text[] =
+    "# Built-in SAFER risk rules\n"
+    "weather.visibility                below   1000=3 3000=2 5000=1\n"
+    "weather.wind_speed                above   50=3 30=2 15=1\n"
+    "weather.score                     atleast 5=critical 3=high 1=medium\n"
+    "maintenance.days_since_inspection above   180=critical 90=high 45=medium\n"
+    "maintenance.open_issues           above   2=critical 0=high\n"
+    "crew.days_since_training          above   180=critical\n"
+    "crew.flight_hours                 below   100=high 500=medium\n"
+    "radio.signal_to_noise             atmost  10=critical 20=high 30=medium nan=critical\n";
+
+static const struct {
+    const char *name;
+    int is_level;                   // Values are risk levels rather than score points
+    int per_aircraft;               // May be overridden in an [aircraft] section
+} factors[NUM_RISK_FACTORS] = {
+    [RISK_FACTOR_VISIBILITY] = {"weather.visibility", 0, 1},
+    [RISK_FACTOR_WIND_SPEED] = {"weather.wind_speed", 0, 1},
+    [RISK_FACTOR_PRECIPITATION] = {"weather.precipitation", 0, 1},
+    [RISK_FACTOR_TEMPERATURE] = {"weather.temperature", 0, 1},
+    [RISK_FACTOR_WEATHER_SCORE] = {"weather.score", 1, 1},
+    [RISK_FACTOR_DAYS_SINCE_INSPECTION] = {"maintenance.days_since_inspection", 1, 1},
+    [RISK_FACTOR_OPEN_ISSUES] = {"maintenance.open_issues", 1, 1},
+    [RISK_FACTOR_DAYS_SINCE_TRAINING] = {"crew.days_since_training", 1, 0},
+    [RISK_FACTOR_FLIGHT_HOURS] = {"crew.flight_hours", 1, 0},
+    [RISK_FACTOR_SIGNAL_TO_NOISE] = {"radio.signal_to_noise", 1, 0}
+};
+
+static const char *level_names[] = {"low", "medium", "high", "critical"};
+
+typedef enum { CMP_ABOVE, CMP_ATLEAST, CMP_BELOW, CMP_ATMOST } Comparison;
+
+static const char *comparison_names[] = {"above", "atleast", "below", "atmost"};
+
+typedef struct {
+    double threshold;
+    int32_t value;
+} RulePair;
+
+// Profiles being built, with the factors each sets explicitly
+typedef struct {
+    RiskRules *rules;
+    uint32_t *explicit_factors;
+    int capacity;
+} RulesBuilder;
+
+static RiskRules *current;
+static unsigned long generation;
+static pthread_mutex_t retired_lock = PTHREAD_MUTEX_INITIALIZER;
+static RiskRules **retired;
+static int num_retired, retired_capacity;
+static RiskRulesHold *holds;        // Registered holds, guarded by retired_lock
+static int unregistered_readers;    // Acquires without a hold; nothing is freed meanwhile
+
+// Each thread's hold for risk_rules_acquire, unregistered when it exits
+typedef struct {
+    RiskRulesHold hold;
+    const RiskRules *claimed;       // Kept between acquires while registered
+    int depth;
+    int registered;                 // 1 registered, -1 registration failed
+} ThreadHold;
+
+static _Thread_local ThreadHold thread_hold;
+static pthread_key_t thread_hold_key;
+static pthread_once_t thread_hold_once = PTHREAD_ONCE_INIT;
+
+// Grades everything low; only used if the built-in rules fail to compile
+static RiskProfile empty_profile;
+static RiskRules empty_rules = { &empty_profile, 1 };
+
+static int compare_pairs(const void *a, const void *b) {
+    double x = ((const RulePair *)a)->threshold, y = ((const RulePair *)b)->threshold;
+    return x < y ? -1 : x > y;
+}
+
+// Steps that grade every input as fallback
+static void constant_step(RiskStep *step, int32_t fallback) {
+    step->count = 0;
+    for (int i = 0; i < RISK_RULE_MAX_STEPS; i++) {
+        step->thresholds[i] = INFINITY;
+    }
+    for (int i = 0; i <= RISK_RULE_MAX_STEPS; i++) {
+        step->values[i] = fallback;
+    }
+    step->nan_value = fallback;
+}
+
+// Sorted threshold=value pairs to a step table. For above/atleast the
+// value for n thresholds passed is that of the nth lowest; for
+// below/atmost it is that of the next threshold up.
+static void compile_step(RiskStep *step, Comparison cmp, RulePair *pairs, int n, int32_t fallback,
+                         int32_t nan_value) {
+    qsort(pairs, n, sizeof(RulePair), compare_pairs);
+    constant_step(step, fallback);
+    step->nan_value = nan_value;
+    // below passes a threshold once x reaches it, atmost once x exceeds it
+    int inclusive = cmp == CMP_ATLEAST || cmp == CMP_BELOW;
+    step->count = n;
+    for (int i = 0; i < n; i++) {
+        step->thresholds[i] = inclusive ? nextafter(pairs[i].threshold, -INFINITY) : pairs[i].threshold;
+    }
+    if (cmp == CMP_ABOVE || cmp == CMP_ATLEAST) {
+        for (int i = 0; i < n; i++) {
+            step->values[i + 1] = pairs[i].value;
+        }
+        for (int i = n + 1; i <= RISK_RULE_MAX_STEPS; i++) {
+            step->values[i] = pairs[n - 1].value;
+        }
+    } else {
+        for (int i = 0; i < n; i++) {
+            step->values[i] = pairs[i].value;
+        }
+    }
+}
+
+static int parse_value(const char *text, int is_level, int32_t *value) {
+    for (int level = RISK_LOW; level <= RISK_CRITICAL; level++) {
+        if (strcmp(text, level_names[level]) == 0) {
+            *value = level;
+            return 0;
+        }
+    }
+    char *end;
+    errno = 0;
+    long parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0 || parsed < INT32_MIN || parsed > INT32_MAX) {
+        return -1;
+    }
+    if (is_level && (parsed < RISK_LOW || parsed > RISK_CRITICAL)) {
+        return -1;
+    }
+    *value = (int32_t)parsed;
+    return 0;
+}
+
+static char *next_token(char **cursor) {
+    char *start = *cursor;
+    while (isspace((unsigned char)*start)) start++;
+    if (*start == '\0') {
+        *cursor = start;
+        return NULL;
+    }
+    char *end = start;
+    while (*end != '\0' && !isspace((unsigned char)*end)) end++;
+    if (*end != '\0') {
+        *end++ = '\0';
+    }
+    *cursor = end;
+    return start;
+}
+
+static RiskProfile *add_profile(RulesBuilder *builder, const char *model) {
+    RiskRules *rules = builder->rules;
+    if (rules->num_profiles == builder->capacity) {
+        int capacity = builder->capacity ? builder->capacity * 2 : 4;
+        RiskProfile *profiles = realloc(rules->profiles, sizeof(RiskProfile) * capacity);
+        if (profiles == NULL) {
+            return NULL;
+        }
+        rules->profiles = profiles;
+        uint32_t *explicit_factors = realloc(builder->explicit_factors, sizeof(uint32_t) * capacity);
+        if (explicit_factors == NULL) {
+            return NULL;
+        }
+        builder->explicit_factors = explicit_factors;
+        builder->capacity = capacity;
+    }
+    RiskProfile *profile = &rules->profiles[rules->num_profiles];
+    memset(profile, 0, sizeof(*profile));
+    snprintf(profile->aircraft_model, sizeof(profile->aircraft_model), "%s", model);
+    for (int f = 0; f < NUM_RISK_FACTORS; f++) {
+        constant_step(&profile->steps[f], 0);
+    }
+    builder->explicit_factors[rules->num_profiles++] = 0;
+    return profile;
+}
+
+// One factor line into the profile being built. Returns an error message or NULL.
+static const char *parse_rule(RulesBuilder *builder, int profile_index, char *line) {
+    char *cursor = line;
+    char *name = next_token(&cursor);
+    char *comparison = next_token(&cursor);
+    int factor = -1, cmp = -1;
+    for (int f = 0; f < NUM_RISK_FACTORS; f++) {
+        if (strcmp(name, factors[f].name) == 0) factor = f;
+    }
+    if (factor < 0) {
+        return "unknown factor";
+    }
+    if (profile_index > 0 && !factors[factor].per_aircraft) {
+        return "crew and radio rules cannot vary by aircraft";
+    }
+    if (builder->explicit_factors[profile_index] & (1u << factor)) {
+        return "factor given twice in one section";
+    }
+    for (int c = 0; comparison != NULL && c < 4; c++) {
+        if (strcmp(comparison, comparison_names[c]) == 0) cmp = c;
+    }
+    if (cmp < 0) {
+        return "expected above, atleast, below or atmost";
+    }
+
+    RulePair pairs[RISK_RULE_MAX_STEPS];
+    int n = 0;
+    int32_t fallback = 0, nan_value = 0;
+    int has_nan = 0;
+    char *token;
+    while ((token = next_token(&cursor)) != NULL) {
+        char *equals = strchr(token, '=');
+        if (equals == NULL) {
+            return "expected threshold=value";
+        }
+        *equals = '\0';
+        int32_t value;
+        if (parse_value(equals + 1, factors[factor].is_level, &value) != 0) {
+            return factors[factor].is_level ? "expected a risk level" : "expected an integer score";
+        }
+        if (strcmp(token, "else") == 0) {
+            fallback = value;
+            continue;
+        }
+        if (strcmp(token, "nan") == 0) {
+            nan_value = value;
+            has_nan = 1;
+            continue;
+        }
+        char *end;
+        double threshold = strtod(token, &end);
+        if (end == token || *end != '\0' || !isfinite(threshold)) {
+            return "expected a finite threshold";
+        }
+        for (int i = 0; i < n; i++) {
+            if (pairs[i].threshold == threshold) {
+                return "threshold given twice";
+            }
+        }
+        if (n == RISK_RULE_MAX_STEPS) {
+            return "too many thresholds";
+        }
+        pairs[n++] = (RulePair){ threshold, value };
+    }
+    if (n == 0) {
+        return "no thresholds";
+    }
+    compile_step(&builder->rules->profiles[profile_index].steps[factor], (Comparison)cmp, pairs, n, fallback,
+                 has_nan ? nan_value : fallback);
+    builder->explicit_factors[profile_index] |= 1u << factor;
+    return NULL;
+}
+
+// "[aircraft <model>]"; returns an error message or NULL
+static const char *parse_section(RulesBuilder *builder, char *line, int *profile_index) {
+    char *close = strchr(line, ']');
+    if (close == NULL || close[1] != '\0') {
+        return "expected [aircraft <model>]";
+    }
+    *close = '\0';
+    char *cursor = line + 1;
+    char *kind = next_token(&cursor);
+    while (isspace((unsigned char)*cursor)) cursor++;
+    char *model = cursor;
+    for (char *end = model + strlen(model); end > model && isspace((unsigned char)end[-1]); ) *--end = '\0';
+    if (kind == NULL || strcmp(kind, "aircraft") != 0 || model[0] == '\0') {
+        return "expected [aircraft <model>]";
+    }
+    if (strlen(model) >= RISK_RULES_MODEL_LEN) {
+        return "aircraft model too long";
+    }
+    for (int p = 1; p < builder->rules->num_profiles; p++) {
+        if (strcmp(builder->rules->profiles[p].aircraft_model, model) == 0) {
+            return "aircraft section given twice";
+        }
+    }
+    if (add_profile(builder, model) == NULL) {
+        return "out of memory";
+    }
+    *profile_index = builder->rules->num_profiles - 1;
+    return NULL;
+}
+
+RiskRules *risk_rules_parse(const char *text, char *error, size_t error_size) {
+    RulesBuilder builder = {0};
+    builder.rules = calloc(1, sizeof(RiskRules));
+    if (builder.rules == NULL || add_profile(&builder, "") == NULL) {
+        snprintf(error, error_size, "out of memory");
+        free(builder.explicit_factors);
+        risk_rules_free(builder.rules);
+        return NULL;
+    }
+
+    int profile_index = 0, line_number = 0;
+    const char *message = NULL;
+    const char *cursor = text;
+    while (*cursor != '\0' && message == NULL) {
+        const char *end = strchr(cursor, '\n');
+        size_t length = end != NULL ? (size_t)(end - cursor) : strlen(cursor);
+        line_number++;
+        char line[MAX_LINE];
+        if (length >= sizeof(line)) {
+            message = "line too long";
+            break;
+        }
+        memcpy(line, cursor, length);
+        line[length] = '\0';
+        cursor += length + (end != NULL);
+
+        char *comment = strchr(line, '#');
+        if (comment != NULL) *comment = '\0';
+        char *start = line;
+        while (isspace((unsigned char)*start)) start++;
+        for (char *tail = start + strlen(start); tail > start && isspace((unsigned char)tail[-1]); ) *--tail = '\0';
+        if (*start == '\0') {
+            continue;
+        }
+        message = *start == '[' ? parse_section(&builder, start, &profile_index)
+                                : parse_rule(&builder, profile_index, start);
+    }
+    if (message != NULL) {
+        snprintf(error, error_size, "line %d: %s", line_number, message);
+        free(builder.explicit_factors);
+        risk_rules_free(builder.rules);
+        return NULL;
+    }
+
+    // Aircraft sections inherit whatever they do not set, wherever in the
+    // text the default rule appears
+    RiskRules *rules = builder.rules;
+    for (int p = 1; p < rules->num_profiles; p++) {
+        for (int f = 0; f < NUM_RISK_FACTORS; f++) {
+            if (!(builder.explicit_factors[p] & (1u << f))) {
+                rules->profiles[p].steps[f] = rules->profiles[0].steps[f];
+            }
+        }
+    }
+    free(builder.explicit_factors);
+    return rules;
+}
+
+RiskRules *risk_rules_load(const char *path, char *error, size_t error_size) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        snprintf(error, error_size, "%s: %s", path, strerror(errno));
+        return NULL;
+    }
+    char *text = NULL;
+    size_t length = 0, capacity = 0, read;
+    do {
+        if (capacity - length < 4096) {
+            char *grown = realloc(text, capacity + 65536);
+            if (grown == NULL) {
+                free(text);
+                fclose(file);
+                snprintf(error, error_size, "out of memory");
+                return NULL;
+            }
+            text = grown;
+            capacity += 65536;
+        }
+        read = fread(text + length, 1, capacity - length - 1, file);
+        length += read;
+    } while (read > 0);
+    fclose(file);
+    text[length] = '\0';
+    RiskRules *rules = risk_rules_parse(text, error, error_size);
+    free(text);
+    return rules;
+}
+
+void risk_rules_free(RiskRules *rules) {
+    if (rules == NULL) {
+        return;
+    }
+    free(rules->profiles);
+    free(rules);
+}
+
+// First use without an installed set. Racing callers may each compile the
+// built-in rules; one wins and the others free theirs.
+static const RiskRules *install_builtin(void) {
+    char error[128];
+    RiskRules *builtin = risk_rules_parse(risk_rules_default_text, error, sizeof(error));
+    if (builtin == NULL) {
+        fprintf(stderr, "Built-in risk rules failed to compile: %s\n", error);
+        return &empty_rules;
+    }
+    RiskRules *expected = NULL;
+    if (!__atomic_compare_exchange_n(&current, &expected, builtin, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        risk_rules_free(builtin);
+        return expected;
+    }
+    return builtin;
+}
+
+// Free replaced sets no hold claims. Called with retired_lock held; a
+// reader whose claim is checked here either published it before the set
+// was replaced, or sees the replacement when it rechecks and moves on.
+static void reclaim_retired(void) {
+    if (__atomic_load_n(&unregistered_readers, __ATOMIC_SEQ_CST) > 0) {
+        return;
+    }
+    int kept = 0;
+    for (int i = 0; i < num_retired; i++) {
+        int claimed = 0;
+        for (RiskRulesHold *hold = holds; hold != NULL && !claimed; hold = hold->next) {
+            claimed = __atomic_load_n(&hold->rules, __ATOMIC_SEQ_CST) == retired[i];
+        }
+        if (claimed) {
+            retired[kept++] = retired[i];
+        } else {
+            risk_rules_free(retired[i]);
+        }
+    }
+    num_retired = kept;
+}
+
+void risk_rules_hold_init(RiskRulesHold *hold) {
+    hold->rules = NULL;
+    hold->prev = NULL;
+    pthread_mutex_lock(&retired_lock);
+    hold->next = holds;
+    if (holds != NULL) {
+        holds->prev = hold;
+    }
+    holds = hold;
+    pthread_mutex_unlock(&retired_lock);
+}
+
+void risk_rules_hold_destroy(RiskRulesHold *hold) {
+    pthread_mutex_lock(&retired_lock);
+    if (hold->prev != NULL) {
+        hold->prev->next = hold->next;
+    } else {
+        holds = hold->next;
+    }
+    if (hold->next != NULL) {
+        hold->next->prev = hold->prev;
+    }
+    // Sets only this hold kept alive can go now rather than at the next install
+    reclaim_retired();
+    pthread_mutex_unlock(&retired_lock);
+}
+
+const RiskRules *risk_rules_claim(RiskRulesHold *hold) {
+    for (;;) {
+        RiskRules *rules = __atomic_load_n(&current, __ATOMIC_SEQ_CST);
+        if (rules == NULL) {
+            // empty_rules is static and never installed, so needs no claim
+            if (install_builtin() == &empty_rules) {
+                __atomic_store_n(&hold->rules, NULL, __ATOMIC_RELEASE);
+                return &empty_rules;
+            }
+            continue;
+        }
+        // Publish, then confirm the set was not replaced before the claim
+        // became visible to installs
+        __atomic_store_n(&hold->rules, rules, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&current, __ATOMIC_SEQ_CST) == rules) {
+            return rules;
+        }
+    }
+}
+
+void risk_rules_unclaim(RiskRulesHold *hold) {
+    __atomic_store_n(&hold->rules, NULL, __ATOMIC_RELEASE);
+}
+
+static void release_thread_hold(void *arg) {
+    ThreadHold *thread = arg;
+    risk_rules_hold_destroy(&thread->hold);
+    thread->registered = 0;
+}
+
+static void create_thread_hold_key(void) {
+    pthread_key_create(&thread_hold_key, release_thread_hold);
+}
+
+// The key's destructor unregisters the hold at thread exit; without it
+// the hold cannot be registered, and the thread falls back to blocking
+// reclamation while it reads
+static void register_thread_hold(ThreadHold *thread) {
+    pthread_once(&thread_hold_once, create_thread_hold_key);
+    risk_rules_hold_init(&thread->hold);
+    if (pthread_setspecific(thread_hold_key, thread) != 0) {
+        risk_rules_hold_destroy(&thread->hold);
+        thread->registered = -1;
+    } else {
+        thread->registered = 1;
+    }
+}
+
+// Out of line so the common path in risk_rules_acquire stays a few loads
+__attribute__((noinline)) static const RiskRules *acquire_slow(ThreadHold *thread) {
+    if (thread->registered == 0) {
+        register_thread_hold(thread);
+    }
+    if (thread->registered > 0) {
+        thread->claimed = risk_rules_claim(&thread->hold);
+    } else {
+        __atomic_add_fetch(&unregistered_readers, 1, __ATOMIC_SEQ_CST);
+        const RiskRules *rules = __atomic_load_n(&current, __ATOMIC_SEQ_CST);
+        thread->claimed = rules != NULL ? rules : install_builtin();
+    }
+    return thread->claimed;
+}
+
+const RiskRules *risk_rules_acquire(void) {
+    ThreadHold *thread = &thread_hold;
+    if (thread->depth++ > 0) {
+        return thread->claimed;
+    }
+    // A claim published and confirmed by an earlier acquire still pins its
+    // set, so while that set is current there is nothing to write
+    const RiskRules *claimed = thread->claimed;
+    if (claimed != NULL && thread->registered > 0 && __atomic_load_n(&current, __ATOMIC_ACQUIRE) == claimed) {
+        return claimed;
+    }
+    return acquire_slow(thread);
+}
+
+void risk_rules_release(void) {
+    ThreadHold *thread = &thread_hold;
+    if (thread->depth == 0 || --thread->depth > 0) {
+        return;
+    }
+    // Registered claims stay for the next acquire; see risk_rules_quiesce
+    if (thread->registered <= 0) {
+        __atomic_sub_fetch(&unregistered_readers, 1, __ATOMIC_SEQ_CST);
+        thread->claimed = NULL;
+    }
+}
+
+void risk_rules_quiesce(void) {
+    ThreadHold *thread = &thread_hold;
+    if (thread->depth == 0 && thread->registered > 0) {
+        risk_rules_unclaim(&thread->hold);
+        thread->claimed = NULL;
+    }
+}
+
+void risk_rules_install(RiskRules *rules) {
+    pthread_mutex_lock(&retired_lock);
+    reclaim_retired();
+    if (num_retired == retired_capacity) {
+        int capacity = retired_capacity ? retired_capacity * 2 : 8;
+        RiskRules **grown = realloc(retired, sizeof(RiskRules *) * capacity);
+        if (grown == NULL) {
+            // Without room to keep the old set alive, refuse the swap
+            pthread_mutex_unlock(&retired_lock);
+            fprintf(stderr, "Out of memory installing risk rules\n");
+            risk_rules_free(rules);
+            return;
+        }
+        retired = grown;
+        retired_capacity = capacity;
+    }
+    RiskRules *previous = __atomic_exchange_n(&current, rules, __ATOMIC_SEQ_CST);
+    if (previous != NULL) {
+        retired[num_retired++] = previous;
+    }
+    __atomic_add_fetch(&generation, 1, __ATOMIC_RELEASE);
+    reclaim_retired();
+    pthread_mutex_unlock(&retired_lock);
+}
+
+int risk_rules_retired(void) {
+    pthread_mutex_lock(&retired_lock);
+    int count = num_retired;
+    pthread_mutex_unlock(&retired_lock);
+    return count;
+}
+
+unsigned long risk_rules_generation(void) {
+    return __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+}
+
+void risk_rules_cleanup(void) {
+    pthread_mutex_lock(&retired_lock);
+    risk_rules_free(__atomic_exchange_n(&current, NULL, __ATOMIC_ACQ_REL));
+    for (int i = 0; i < num_retired; i++) {
+        risk_rules_free(retired[i]);
+    }
+    free(retired);
+    retired = NULL;
+    num_retired = retired_capacity = 0;
+    pthread_mutex_unlock(&retired_lock);
+}
+
+const RiskProfile *risk_rules_profile(const RiskRules *rules, const char *aircraft_model) {
+    // Fleets have a handful of types, so a scan beats anything cleverer
+    if (aircraft_model != NULL && aircraft_model[0] != '\0') {
+        for (int p = 1; p < rules->num_profiles; p++) {
+            if (strncmp(rules->profiles[p].aircraft_model, aircraft_model, RISK_RULES_MODEL_LEN) == 0) {
+                return &rules->profiles[p];
+            }
+        }
+    }
+    return &rules->profiles[0];
+}
+
+RiskLevel risk_rules_weather(const RiskProfile *profile, const WeatherCondition *weather) {
+    const RiskStep *steps = profile->steps;
+    int32_t score = risk_step_eval(&steps[RISK_FACTOR_VISIBILITY], weather->visibility) +
+                    risk_step_eval(&steps[RISK_FACTOR_WIND_SPEED], weather->wind_speed) +
+                    risk_step_eval(&steps[RISK_FACTOR_PRECIPITATION], weather->precipitation) +
+                    risk_step_eval(&steps[RISK_FACTOR_TEMPERATURE], weather->temperature);
+    return (RiskLevel)risk_step_eval(&steps[RISK_FACTOR_WEATHER_SCORE], score);
+}
+
+RiskLevel risk_rules_maintenance(const RiskProfile *profile, const MaintenanceRecord *record, time_t now) {
+    double days_since_inspection = difftime(now, record->last_inspection) / (24 * 3600);
+    int32_t inspection = risk_step_eval(&profile->steps[RISK_FACTOR_DAYS_SINCE_INSPECTION], days_since_inspection);
+    int32_t issues = risk_step_eval(&profile->steps[RISK_FACTOR_OPEN_ISSUES], record->num_issues);
+    return (RiskLevel)(inspection > issues ? inspection : issues);
+}
+
+RiskLevel risk_rules_crew(const RiskRules *rules, const CrewMember *crew, time_t now) {
+    const RiskStep *steps = rules->profiles[0].steps;
+    double days_since_training = difftime(now, crew->last_training) / (24 * 3600);
+    int32_t training = risk_step_eval(&steps[RISK_FACTOR_DAYS_SINCE_TRAINING], days_since_training);
+    int32_t hours = risk_step_eval(&steps[RISK_FACTOR_FLIGHT_HOURS], crew->flight_hours);
+    return (RiskLevel)(training > hours ? training : hours);
+}
+
+RiskLevel risk_rules_radio(const RiskRules *rules, double signal_to_noise) {
+    return (RiskLevel)risk_step_eval(&rules->profiles[0].steps[RISK_FACTOR_SIGNAL_TO_NOISE], signal_to_noise);
+}
+
+RiskLevel risk_rules_mission(const RiskRules *rules, const Mission *mission, time_t now) {
+    // The aircraft's own weather and maintenance rules where it has them
+    const RiskProfile *profile = risk_rules_profile(rules, mission->aircraft != NULL ? mission->aircraft->model : NULL);
+    RiskLevel risk = risk_rules_weather(profile, &mission->weather);
+    if (mission->aircraft != NULL && mission->aircraft->maintenance_records != NULL) {
+        RiskLevel maintenance_risk = risk_rules_maintenance(profile, mission->aircraft->maintenance_records, now);
+        if (maintenance_risk > risk) risk = maintenance_risk;
+    }
+    for (int i = 0; i < mission->crew_size; i++) {
+        if (mission->crew[i] == NULL) continue;
+        RiskLevel crew_risk = risk_rules_crew(rules, mission->crew[i], now);
+        if (crew_risk > risk) risk = crew_risk;
+    }
+    return risk;
+}
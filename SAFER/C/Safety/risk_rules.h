@@ -0,0 +1,140 @@
+// risk_rules.h - Data-driven risk thresholds, compiled to branch-free step tables
+#ifndef RISK_RULES_H
+#define RISK_RULES_H
+
+#include "safer.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define RISK_RULE_MAX_STEPS 8
+#define RISK_RULES_MODEL_LEN 32
+
+// Inputs the rules can grade. Weather factors add up to a score that
+// weather.score turns into a level; the others are levels themselves and
+// each assessment takes the highest. Aircraft sections may override the
+// weather and maintenance factors; crew and radio rules apply fleet-wide.
+typedef enum {
+    RISK_FACTOR_VISIBILITY,
+    RISK_FACTOR_WIND_SPEED,
+    RISK_FACTOR_PRECIPITATION,
+    RISK_FACTOR_TEMPERATURE,
+    RISK_FACTOR_WEATHER_SCORE,
+    RISK_FACTOR_DAYS_SINCE_INSPECTION,
+    RISK_FACTOR_OPEN_ISSUES,
+    RISK_FACTOR_DAYS_SINCE_TRAINING,
+    RISK_FACTOR_FLIGHT_HOURS,
+    RISK_FACTOR_SIGNAL_TO_NOISE,
+    NUM_RISK_FACTORS
+} RiskFactor;
+
+// Step function of one input: values[n], where n counts the thresholds x
+// exceeds. Thresholds ascend, so a lookup is count compares and a sum with
+// no data-dependent branch to mispredict. A rule passed at x >= t stores
+// the next double below t instead. NaN passes no threshold, which would
+// grade it values[0] whatever the comparison, so it gets its own value.
+typedef struct {
+    int32_t count;                  // Thresholds in use; 0 grades every input values[0]
+    int32_t values[RISK_RULE_MAX_STEPS + 1];
+    int32_t nan_value;              // Grade for NaN inputs
+    double thresholds[RISK_RULE_MAX_STEPS];
+} RiskStep;
+
+typedef struct {
+    char aircraft_model[RISK_RULES_MODEL_LEN]; // Empty for the default profile
+    RiskStep steps[NUM_RISK_FACTORS];
+} RiskProfile;
+
+typedef struct {
+    RiskProfile *profiles;          // [0] is the default
+    int num_profiles;
+} RiskRules;
+
+static inline int32_t risk_step_eval(const RiskStep *step, double x) {
+    int passed = 0;
+    for (int i = 0; i < step->count; i++) {
+        passed += x > step->thresholds[i];
+    }
+    return x == x ? step->values[passed] : step->nan_value;
+}
+
+// Compile rules from text. Each line is a factor, a comparison and
+// threshold=value pairs, with an optional else=value for inputs matching
+// none (default 0, low) and nan=value for inputs that are not a number
+// (default the else value):
+//   weather.wind_speed above 50=3 30=2 15=1
+//   crew.flight_hours  below 100=high 500=medium
+// above and atleast take the value of the highest threshold passed, below
+// and atmost that of the lowest one not reached. Values are integers or
+// low/medium/high/critical. [aircraft <model>] starts the overrides for
+// aircraft of that model; # starts a comment. Factors not given grade 0.
+// Returns NULL with a message naming the line in error on failure.
+RiskRules *risk_rules_parse(const char *text, char *error, size_t error_size);
+RiskRules *risk_rules_load(const char *path, char *error, size_t error_size);
+void risk_rules_free(RiskRules *rules);
+
+// The built-in rules, which grade exactly as the original hard-coded
+// assessments did
+extern const char risk_rules_default_text[];
+
+// A reader's claim on the rule set it grades with. Claims are published
+// in registered holds; a replaced set is freed by the first install or
+// cleanup that finds no hold on it, so an assessment finishes under the
+// rules it started with however many swaps happen meanwhile. Claiming
+// writes only the hold itself, no counter shared between readers.
+typedef struct RiskRulesHold {
+    const RiskRules *rules;         // Claimed set, NULL when none; accessed atomically
+    struct RiskRulesHold *prev;     // Registered holds, guarded by the install lock
+    struct RiskRulesHold *next;
+} RiskRulesHold;
+
+// Register a hold that outlives one call or moves between threads, as a
+// batch's does. Destroy it unclaimed.
+void risk_rules_hold_init(RiskRulesHold *hold);
+void risk_rules_hold_destroy(RiskRulesHold *hold);
+
+// Claim the rules in force (the built-in rules until one is installed)
+// until risk_rules_unclaim
+const RiskRules *risk_rules_claim(RiskRulesHold *hold);
+void risk_rules_unclaim(RiskRulesHold *hold);
+
+// Claim through the calling thread's own hold, for an assessment that
+// starts and ends on one thread. Nested acquires share the outer claim.
+// The claim outlives the release: while the set is still current, the
+// next acquire on the thread only reads the current pointer. A thread
+// therefore keeps at most one replaced set alive until its next acquire,
+// its exit or risk_rules_quiesce.
+const RiskRules *risk_rules_acquire(void);
+void risk_rules_release(void);
+
+// Drop the calling thread's lingering claim, for a thread about to go
+// idle for long. No-op inside an acquire.
+void risk_rules_quiesce(void);
+
+// Swap in rules, which the library then owns. Assessments starting after
+// the call use them; replaced sets nobody claims any more are freed.
+void risk_rules_install(RiskRules *rules);
+
+// Replaced sets still claimed by an assessment, kept until a later
+// install or cleanup finds them released
+int risk_rules_retired(void);
+
+// Incremented by every install, for caches of results graded by the rules
+unsigned long risk_rules_generation(void);
+
+// Free every installed and replaced rule set. Only with no assessment running.
+void risk_rules_cleanup(void);
+
+// Profile for aircraft of this model, the default when none matches or
+// model is NULL
+const RiskProfile *risk_rules_profile(const RiskRules *rules, const char *aircraft_model);
+
+RiskLevel risk_rules_weather(const RiskProfile *profile, const WeatherCondition *weather);
+RiskLevel risk_rules_maintenance(const RiskProfile *profile, const MaintenanceRecord *record, time_t now);
+RiskLevel risk_rules_crew(const RiskRules *rules, const CrewMember *crew, time_t now);
+RiskLevel risk_rules_radio(const RiskRules *rules, double signal_to_noise);
+
+// Highest of weather, maintenance and crew risk, as perform_risk_assessment
+// grades it, for callers that already hold the rules
+RiskLevel risk_rules_mission(const RiskRules *rules, const Mission *mission, time_t now);
+
+#endif // RISK_RULES_H
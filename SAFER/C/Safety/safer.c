@@ -1,81 +1,42 @@
 // safer.c - Implementation file
 #include "safer.h"
+#include "registry.h"
+#include "risk_rules.h"
 
+// Thresholds come from the installed rule set (see risk_rules.h); these
+// entry points grade with its default profile
 RiskLevel assess_weather_risk(WeatherCondition *weather) {
-    int risk_score = 0;
-    
-    // Assess visibility risk
-    if (weather->visibility < 1000) {
-        risk_score += 3;
-    } else if (weather->visibility < 3000) {
-        risk_score += 2;
-    } else if (weather->visibility < 5000) {
-        risk_score += 1;
-    }
-    
-    // Assess wind risk
-    if (weather->wind_speed > 50) {
-        risk_score += 3;
-    } else if (weather->wind_speed > 30) {
-        risk_score += 2;
-    } else if (weather->wind_speed > 15) {
-        risk_score += 1;
-    }
-    
-    // Convert score to risk level
-    if (risk_score >= 5) return RISK_CRITICAL;
-    if (risk_score >= 3) return RISK_HIGH;
-    if (risk_score >= 1) return RISK_MEDIUM;
-    return RISK_LOW;
+    const RiskRules *rules = risk_rules_acquire();
+    RiskLevel level = risk_rules_weather(risk_rules_profile(rules, NULL), weather);
+    risk_rules_release();
+    return level;
 }
 
 RiskLevel assess_maintenance_risk(MaintenanceRecord *record) {
-    time_t current_time = time(NULL);
-    double days_since_inspection = difftime(current_time, record->last_inspection) / (24 * 3600);
-    
-    if (days_since_inspection > 180 || record->num_issues > 2) {
-        return RISK_CRITICAL;
-    } else if (days_since_inspection > 90 || record->num_issues > 0) {
-        return RISK_HIGH;
-    } else if (days_since_inspection > 45) {
-        return RISK_MEDIUM;
-    }
-    return RISK_LOW;
+    const RiskRules *rules = risk_rules_acquire();
+    RiskLevel level = risk_rules_maintenance(risk_rules_profile(rules, NULL), record, time(NULL));
+    risk_rules_release();
+    return level;
 }
 
 RiskLevel assess_crew_risk(CrewMember *crew) {
-    time_t current_time = time(NULL);
-    double days_since_training = difftime(current_time, crew->last_training) / (24 * 3600);
-    
-    if (days_since_training > 180) {
-        return RISK_CRITICAL;
-    }
-    
-    if (crew->flight_hours < 100) {
-        return RISK_HIGH;
-    } else if (crew->flight_hours < 500) {
-        return RISK_MEDIUM;
-    }
-    return RISK_LOW;
+    RiskLevel level = risk_rules_crew(risk_rules_acquire(), crew, time(NULL));
+    risk_rules_release();
+    return level;
 }
 
 void perform_risk_assessment(Mission *mission) {
-    RiskLevel weather_risk = assess_weather_risk(&mission->weather);
-    RiskLevel maintenance_risk = assess_maintenance_risk(mission->aircraft->maintenance_records);
-    
-    // Find highest crew risk
-    RiskLevel max_crew_risk = RISK_LOW;
-    for (int i = 0; i < mission->crew_size; i++) {
-        RiskLevel crew_risk = assess_crew_risk(mission->crew[i]);
-        if (crew_risk > max_crew_risk) {
-            max_crew_risk = crew_risk;
-        }
+    // One claim, one rule set and one clock for the whole mission
+    mission->risk_level = risk_rules_mission(risk_rules_acquire(), mission, time(NULL));
+    risk_rules_release();
+}
+
+Mission* perform_risk_assessment_by_id(SafetyManagementSystem *sms, const char *mission_id) {
+    Mission *mission = find_mission(sms, mission_id);
+    if (mission != NULL) {
+        perform_risk_assessment(mission);
     }
-    
-    // Overall risk is the highest of all risks
-    mission->risk_level = weather_risk;
-    if (maintenance_risk > mission->risk_level) mission->risk_level = maintenance_risk;
-    if (max_crew_risk > mission->risk_level) mission->risk_level = max_crew_risk;
+    return mission;
 }
 
 void generate_safety_report(SafetyManagementSystem *sms, time_t start_date, time_t end_date) {
@@ -104,4 +65,40 @@ void generate_safety_report(SafetyManagementSystem *sms, time_t start_date, time
            (float)risk_distribution[RISK_HIGH] * 100 / total_missions);
     printf("Critical Risk: %d (%.1f%%)\n", risk_distribution[RISK_CRITICAL],
            (float)risk_distribution[RISK_CRITICAL] * 100 / total_missions);
+}
+
+Aircraft* find_aircraft(SafetyManagementSystem *sms, const char *aircraft_id) {
+    if (sms->registry != NULL) {
+        return registry_find_aircraft(sms->registry, aircraft_id);
+    }
+    for (int i = 0; i < sms->num_aircraft; i++) {
+        if (strncmp(sms->aircraft_registry[i]->id, aircraft_id, 15) == 0) {
+            return sms->aircraft_registry[i];
+        }
+    }
+    return NULL;
+}
+
+CrewMember* find_crew_member(SafetyManagementSystem *sms, const char *crew_id) {
+    if (sms->registry != NULL) {
+        return registry_find_crew_member(sms->registry, crew_id);
+    }
+    for (int i = 0; i < sms->num_crew; i++) {
+        if (strncmp(sms->crew_registry[i]->id, crew_id, 15) == 0) {
+            return sms->crew_registry[i];
+        }
+    }
+    return NULL;
+}
+
+Mission* find_mission(SafetyManagementSystem *sms, const char *mission_id) {
+    if (sms->registry != NULL) {
+        return registry_find_mission(sms->registry, mission_id);
+    }
+    for (int i = 0; i < sms->num_missions; i++) {
+        if (strncmp(sms->missions[i]->id, mission_id, 15) == 0) {
+            return sms->missions[i];
+        }
+    }
+    return NULL;
 }
\ No newline at end of file
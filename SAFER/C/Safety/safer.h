@@ -1,4 +1,4 @@
-/ safer.h - Main header file
+// safer.h - Main header file
 #ifndef SAFER_H
 #define SAFER_H
 
@@ -66,6 +66,8 @@ typedef struct {
     RiskLevel risk_level;
 } Mission;
 
+struct FleetRegistry;
+
 // Safety Management System structure
 typedef struct {
     Aircraft **aircraft_registry;
@@ -74,6 +76,7 @@ typedef struct {
     int num_crew;
     Mission **missions;
     int num_missions;
+    struct FleetRegistry *registry; // Owns the entities above when set (see registry.h)
 } SafetyManagementSystem;
 
 // Function declarations
@@ -81,6 +84,12 @@ RiskLevel assess_weather_risk(WeatherCondition *weather);
 RiskLevel assess_maintenance_risk(MaintenanceRecord *record);
 RiskLevel assess_crew_risk(CrewMember *crew);
 void perform_risk_assessment(Mission *mission);
+Mission* perform_risk_assessment_by_id(SafetyManagementSystem *sms, const char *mission_id);
 void generate_safety_report(SafetyManagementSystem *sms, time_t start_date, time_t end_date);
 
+// Id lookups: O(1) through sms->registry when attached, linear scan otherwise
+Aircraft* find_aircraft(SafetyManagementSystem *sms, const char *aircraft_id);
+CrewMember* find_crew_member(SafetyManagementSystem *sms, const char *crew_id);
+Mission* find_mission(SafetyManagementSystem *sms, const char *mission_id);
+
 #endif // SAFER_H
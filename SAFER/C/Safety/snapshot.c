@@ -0,0 +1,651 @@
+// snapshot.c - Registry checkpoint and restore implementation
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE // MADV_POPULATE_WRITE
+#include "snapshot.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define SNAPSHOT_MAGIC "SAFERSNP"
+#define SNAPSHOT_VERSION 2
+#define SECTION_ALIGN 64
+
+typedef struct {
+    uint64_t offset;
+    uint64_t count;                 // Elements
+} SnapshotSection;
+
+// Sizes and slab geometry of the build that wrote the file; a restore
+// refuses any mismatch rather than misread the entities
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t pointer_size;
+    uint32_t slab_size;
+    uint32_t aircraft_size;
+    uint32_t crew_size;
+    uint32_t mission_size;
+    uint32_t record_size;
+    uint32_t index_slot_size;
+    int64_t high_water_mark;
+    int64_t created;
+    uint64_t file_size;
+    SnapshotSection aircraft;       // Pools, whole slabs reserved so appends continue in place
+    SnapshotSection crew;
+    SnapshotSection missions;
+    SnapshotSection records;        // MaintenanceRecord
+    SnapshotSection issues;         // String offsets, become reported_issues entries
+    SnapshotSection crew_lists;     // Crew member offsets, become Mission.crew entries
+    SnapshotSection strings;
+    SnapshotSection aircraft_index; // IdIndexSlot, count is the capacity
+    SnapshotSection crew_index;
+    SnapshotSection mission_index;
+    uint32_t aircraft_index_count;
+    uint32_t crew_index_count;
+    uint32_t mission_index_count;
+    uint32_t reserved;
+} SnapshotHeader;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void *pool_entity(const EntityPool *pool, int index) {
+    unsigned char *slab = pool->slabs[index / REGISTRY_SLAB_SIZE];
+    return slab + (size_t)(index % REGISTRY_SLAB_SIZE) * pool->elem_size;
+}
+
+// Pool index of an entity, -1 when it is not one of the pool's. Pools have
+// a handful of slabs, so checking each range is enough.
+static int pool_index_of(const EntityPool *pool, const void *entity) {
+    uintptr_t address = (uintptr_t)entity;
+    size_t slab_bytes = pool->elem_size * REGISTRY_SLAB_SIZE;
+    for (int k = 0; k < pool->num_slabs; k++) {
+        uintptr_t slab = (uintptr_t)pool->slabs[k];
+        if (address >= slab && address < slab + slab_bytes && (address - slab) % pool->elem_size == 0) {
+            int index = k * REGISTRY_SLAB_SIZE + (int)((address - slab) / pool->elem_size);
+            return index < pool->count ? index : -1;
+        }
+    }
+    return -1;
+}
+
+static uint64_t pool_reserved(uint64_t count) {
+    return (count + REGISTRY_SLAB_SIZE - 1) / REGISTRY_SLAB_SIZE * REGISTRY_SLAB_SIZE;
+}
+
+static int record_count(const Aircraft *aircraft) {
+    return aircraft->maintenance_records != NULL && aircraft->num_records > 0 ? aircraft->num_records : 0;
+}
+
+static int issue_count(const MaintenanceRecord *record) {
+    return record->reported_issues != NULL && record->num_issues > 0 ? record->num_issues : 0;
+}
+
+static int crew_count(const Mission *mission) {
+    return mission->crew != NULL && mission->crew_size > 0 ? mission->crew_size : 0;
+}
+
+// vr_ingest stores last_training and risk_level with __atomic builtins
+// while a checkpoint runs, so those fields are loaded atomically and only
+// the bytes around them are copied plainly
+#define COPY_AROUND(dst, src, type, field) do { \
+    memset((dst), 0, sizeof(type)); \
+    memcpy((dst), (src), offsetof(type, field)); \
+    memcpy((char *)(dst) + offsetof(type, field) + sizeof((src)->field), \
+           (const char *)(src) + offsetof(type, field) + sizeof((src)->field), \
+           sizeof(type) - offsetof(type, field) - sizeof((src)->field)); \
+} while (0)
+
+static void copy_crew_member(CrewMember *stored, const CrewMember *entity) {
+    COPY_AROUND(stored, entity, CrewMember, last_training);
+    stored->last_training = __atomic_load_n(&entity->last_training, __ATOMIC_RELAXED);
+}
+
+static void copy_mission(Mission *stored, const Mission *entity) {
+    COPY_AROUND(stored, entity, Mission, risk_level);
+    stored->risk_level = __atomic_load_n(&entity->risk_level, __ATOMIC_RELAXED);
+}
+
+// Offsets stand in for pointers in the file; 0, the header, is NULL
+static void *offset_pointer(uint64_t offset) {
+    return (void *)(uintptr_t)offset;
+}
+
+static void place(uint64_t *end, SnapshotSection *section, uint64_t count, uint64_t reserved, size_t elem_size) {
+    section->offset = (*end + SECTION_ALIGN - 1) & ~(uint64_t)(SECTION_ALIGN - 1);
+    section->count = count;
+    *end = section->offset + reserved * elem_size;
+}
+
+// Last change_log seq issued; every change up to it is in the registry
+static int read_high_water_mark(sqlite3 *conn, int64_t *mark) {
+    sqlite3_stmt *stmt = NULL;
+    int rc = sqlite3_prepare_v2(conn,
+        "SELECT COALESCE((SELECT seq FROM sqlite_sequence WHERE name = 'change_log'), 0)", -1, &stmt, NULL);
+    if (rc == SQLITE_OK && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        *mark = sqlite3_column_int64(stmt, 0);
+        rc = SQLITE_OK;
+    }
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Failed to read change log: %s\n", sqlite3_errmsg(conn));
+    }
+    sqlite3_finalize(stmt);
+    return rc;
+}
+
+static void prune_change_log(sqlite3 *conn, int64_t through) {
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_prepare_v2(conn, "DELETE FROM change_log WHERE seq <= ?1", -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, through);
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            // Harmless: the next checkpoint prunes these too
+            fprintf(stderr, "Failed to prune change log: %s\n", sqlite3_errmsg(conn));
+        }
+    }
+    sqlite3_finalize(stmt);
+}
+
+static int write_sections(FILE *file, FleetRegistry *reg, const SnapshotHeader *header) {
+    const EntityPool *aircraft = &reg->aircraft, *crew = &reg->crew, *missions = &reg->missions;
+
+    if (fseeko(file, (off_t)header->aircraft.offset, SEEK_SET) != 0) return -1;
+    uint64_t record_cursor = 0;
+    for (int i = 0; i < aircraft->count; i++) {
+        Aircraft stored = *(const Aircraft *)pool_entity(aircraft, i);
+        stored.num_records = record_count(&stored);
+        stored.maintenance_records = stored.num_records > 0
+            ? offset_pointer(header->records.offset + record_cursor * sizeof(MaintenanceRecord)) : NULL;
+        record_cursor += stored.num_records;
+        fwrite(&stored, sizeof(stored), 1, file);
+    }
+
+    // Crew members hold no pointers, but training dates change under us
+    if (fseeko(file, (off_t)header->crew.offset, SEEK_SET) != 0) return -1;
+    for (int i = 0; i < crew->count; i++) {
+        CrewMember stored;
+        copy_crew_member(&stored, pool_entity(crew, i));
+        fwrite(&stored, sizeof(stored), 1, file);
+    }
+
+    if (fseeko(file, (off_t)header->missions.offset, SEEK_SET) != 0) return -1;
+    uint64_t crew_cursor = 0;
+    for (int i = 0; i < missions->count; i++) {
+        Mission stored;
+        copy_mission(&stored, pool_entity(missions, i));
+        if (stored.aircraft != NULL) {
+            int index = pool_index_of(aircraft, stored.aircraft);
+            if (index < 0) {
+                fprintf(stderr, "Mission %.16s references an unregistered aircraft\n", stored.id);
+                return -1;
+            }
+            stored.aircraft = offset_pointer(header->aircraft.offset + (uint64_t)index * sizeof(Aircraft));
+        }
+        stored.crew_size = crew_count(&stored);
+        stored.crew = stored.crew_size > 0
+            ? offset_pointer(header->crew_lists.offset + crew_cursor * sizeof(uintptr_t)) : NULL;
+        crew_cursor += stored.crew_size;
+        fwrite(&stored, sizeof(stored), 1, file);
+    }
+
+    if (fseeko(file, (off_t)header->records.offset, SEEK_SET) != 0) return -1;
+    uint64_t issue_cursor = 0;
+    for (int i = 0; i < aircraft->count; i++) {
+        const Aircraft *entity = pool_entity(aircraft, i);
+        for (int r = 0; r < record_count(entity); r++) {
+            MaintenanceRecord stored = entity->maintenance_records[r];
+            stored.num_issues = issue_count(&stored);
+            stored.reported_issues = stored.num_issues > 0
+                ? offset_pointer(header->issues.offset + issue_cursor * sizeof(uintptr_t)) : NULL;
+            issue_cursor += stored.num_issues;
+            fwrite(&stored, sizeof(stored), 1, file);
+        }
+    }
+
+    if (fseeko(file, (off_t)header->issues.offset, SEEK_SET) != 0) return -1;
+    uint64_t string_cursor = 0;
+    for (int i = 0; i < aircraft->count; i++) {
+        const Aircraft *entity = pool_entity(aircraft, i);
+        for (int r = 0; r < record_count(entity); r++) {
+            const MaintenanceRecord *record = &entity->maintenance_records[r];
+            for (int j = 0; j < issue_count(record); j++) {
+                uintptr_t offset = header->strings.offset + string_cursor;
+                string_cursor += strlen(record->reported_issues[j]) + 1;
+                fwrite(&offset, sizeof(offset), 1, file);
+            }
+        }
+    }
+
+    if (fseeko(file, (off_t)header->crew_lists.offset, SEEK_SET) != 0) return -1;
+    for (int i = 0; i < missions->count; i++) {
+        const Mission *entity = pool_entity(missions, i);
+        for (int c = 0; c < crew_count(entity); c++) {
+            int index = pool_index_of(crew, entity->crew[c]);
+            if (index < 0) {
+                fprintf(stderr, "Mission %.16s references an unregistered crew member\n", entity->id);
+                return -1;
+            }
+            uintptr_t offset = header->crew.offset + (uint64_t)index * sizeof(CrewMember);
+            fwrite(&offset, sizeof(offset), 1, file);
+        }
+    }
+
+    if (fseeko(file, (off_t)header->strings.offset, SEEK_SET) != 0) return -1;
+    for (int i = 0; i < aircraft->count; i++) {
+        const Aircraft *entity = pool_entity(aircraft, i);
+        for (int r = 0; r < record_count(entity); r++) {
+            const MaintenanceRecord *record = &entity->maintenance_records[r];
+            for (int j = 0; j < issue_count(record); j++) {
+                fwrite(record->reported_issues[j], strlen(record->reported_issues[j]) + 1, 1, file);
+            }
+        }
+    }
+
+    const IdIndex *indexes[] = { &reg->aircraft_index, &reg->crew_index, &reg->mission_index };
+    const SnapshotSection *index_sections[] = { &header->aircraft_index, &header->crew_index, &header->mission_index };
+    for (int i = 0; i < 3; i++) {
+        if (fseeko(file, (off_t)index_sections[i]->offset, SEEK_SET) != 0) return -1;
+        fwrite(indexes[i]->slots, sizeof(IdIndexSlot), indexes[i]->capacity, file);
+    }
+
+    if (fseeko(file, 0, SEEK_SET) != 0) return -1;
+    fwrite(header, sizeof(*header), 1, file);
+    return ferror(file) ? -1 : 0;
+}
+
+int snapshot_write(FleetRegistry *reg, Database *db, const char *path, SnapshotStats *stats) {
+    SnapshotStats local;
+    if (stats == NULL) {
+        stats = &local;
+    }
+    memset(stats, 0, sizeof(*stats));
+    double started = now_ms();
+
+    // Its own connection, so a write-behind queue can keep the writer
+    sqlite3 *conn = NULL;
+    if (sqlite3_open_v2(db->path != NULL ? db->path : "safer.db", &conn,
+                        SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Cannot open database for snapshot: %s\n", sqlite3_errmsg(conn));
+        sqlite3_close(conn);
+        return -1;
+    }
+    sqlite3_busy_timeout(conn, 5000);
+    SnapshotHeader header = {0};
+    if (read_high_water_mark(conn, &header.high_water_mark) != SQLITE_OK) {
+        sqlite3_close(conn);
+        return -1;
+    }
+
+    uint64_t num_records = 0, num_issues = 0, string_bytes = 0, num_crew_slots = 0;
+    for (int i = 0; i < reg->aircraft.count; i++) {
+        const Aircraft *aircraft = pool_entity(&reg->aircraft, i);
+        num_records += record_count(aircraft);
+        for (int r = 0; r < record_count(aircraft); r++) {
+            const MaintenanceRecord *record = &aircraft->maintenance_records[r];
+            num_issues += issue_count(record);
+            for (int j = 0; j < issue_count(record); j++) {
+                string_bytes += strlen(record->reported_issues[j]) + 1;
+            }
+        }
+    }
+    for (int i = 0; i < reg->missions.count; i++) {
+        num_crew_slots += crew_count(pool_entity(&reg->missions, i));
+    }
+
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.pointer_size = sizeof(void *);
+    header.slab_size = REGISTRY_SLAB_SIZE;
+    header.aircraft_size = sizeof(Aircraft);
+    header.crew_size = sizeof(CrewMember);
+    header.mission_size = sizeof(Mission);
+    header.record_size = sizeof(MaintenanceRecord);
+    header.index_slot_size = sizeof(IdIndexSlot);
+    header.created = (int64_t)time(NULL);
+    uint64_t end = sizeof(header);
+    place(&end, &header.aircraft, reg->aircraft.count, pool_reserved(reg->aircraft.count), sizeof(Aircraft));
+    place(&end, &header.crew, reg->crew.count, pool_reserved(reg->crew.count), sizeof(CrewMember));
+    place(&end, &header.missions, reg->missions.count, pool_reserved(reg->missions.count), sizeof(Mission));
+    place(&end, &header.records, num_records, num_records, sizeof(MaintenanceRecord));
+    place(&end, &header.issues, num_issues, num_issues, sizeof(uintptr_t));
+    place(&end, &header.crew_lists, num_crew_slots, num_crew_slots, sizeof(uintptr_t));
+    place(&end, &header.strings, string_bytes, string_bytes, 1);
+    place(&end, &header.aircraft_index, reg->aircraft_index.capacity, reg->aircraft_index.capacity, sizeof(IdIndexSlot));
+    place(&end, &header.crew_index, reg->crew_index.capacity, reg->crew_index.capacity, sizeof(IdIndexSlot));
+    place(&end, &header.mission_index, reg->mission_index.capacity, reg->mission_index.capacity, sizeof(IdIndexSlot));
+    header.aircraft_index_count = reg->aircraft_index.count;
+    header.crew_index_count = reg->crew_index.count;
+    header.mission_index_count = reg->mission_index.count;
+    header.file_size = end;
+
+    char tmp_path[4096];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE *file = fopen(tmp_path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot create snapshot %s: %s\n", tmp_path, strerror(errno));
+        sqlite3_close(conn);
+        return -1;
+    }
+    // Unused slab space is skipped over, and stays a hole in the file
+    int rc = write_sections(file, reg, &header);
+    if (rc == 0 && (fflush(file) != 0 || ftruncate(fileno(file), (off_t)end) != 0 || fsync(fileno(file)) != 0)) {
+        rc = -1;
+    }
+    if (fclose(file) != 0) {
+        rc = -1;
+    }
+    if (rc == 0 && rename(tmp_path, path) != 0) {
+        rc = -1;
+    }
+    if (rc != 0) {
+        fprintf(stderr, "Failed to write snapshot %s: %s\n", path, strerror(errno));
+        unlink(tmp_path);
+        sqlite3_close(conn);
+        return -1;
+    }
+
+    // Restores from older snapshots fall back to a full load from here on
+    prune_change_log(conn, header.high_water_mark);
+    sqlite3_close(conn);
+
+    stats->num_aircraft = reg->aircraft.count;
+    stats->num_crew = reg->crew.count;
+    stats->num_missions = reg->missions.count;
+    stats->high_water_mark = header.high_water_mark;
+    stats->file_bytes = end;
+    stats->total_ms = now_ms() - started;
+    return 0;
+}
+
+// Restore
+
+static int section_fits(const SnapshotSection *section, uint64_t reserved, size_t elem_size, uint64_t file_size) {
+    return section->offset >= sizeof(SnapshotHeader) && section->offset % SECTION_ALIGN == 0 &&
+           section->offset <= file_size && reserved <= (file_size - section->offset) / elem_size;
+}
+
+static int check_header(const SnapshotHeader *header, uint64_t file_size) {
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != SNAPSHOT_VERSION) {
+        fprintf(stderr, "Not a snapshot of this version\n");
+        return -1;
+    }
+    if (header->pointer_size != sizeof(void *) || header->slab_size != REGISTRY_SLAB_SIZE ||
+        header->aircraft_size != sizeof(Aircraft) || header->crew_size != sizeof(CrewMember) ||
+        header->mission_size != sizeof(Mission) || header->record_size != sizeof(MaintenanceRecord) ||
+        header->index_slot_size != sizeof(IdIndexSlot)) {
+        fprintf(stderr, "Snapshot was written by a build with a different layout\n");
+        return -1;
+    }
+    const SnapshotSection *indexes[] = { &header->aircraft_index, &header->crew_index, &header->mission_index };
+    const uint32_t counts[] = { header->aircraft_index_count, header->crew_index_count, header->mission_index_count };
+    int ok = header->file_size == file_size &&
+             header->aircraft.count <= INT32_MAX && header->crew.count <= INT32_MAX &&
+             header->missions.count <= INT32_MAX &&
+             section_fits(&header->aircraft, pool_reserved(header->aircraft.count), sizeof(Aircraft), file_size) &&
+             section_fits(&header->crew, pool_reserved(header->crew.count), sizeof(CrewMember), file_size) &&
+             section_fits(&header->missions, pool_reserved(header->missions.count), sizeof(Mission), file_size) &&
+             section_fits(&header->records, header->records.count, sizeof(MaintenanceRecord), file_size) &&
+             section_fits(&header->issues, header->issues.count, sizeof(uintptr_t), file_size) &&
+             section_fits(&header->crew_lists, header->crew_lists.count, sizeof(uintptr_t), file_size) &&
+             section_fits(&header->strings, header->strings.count, 1, file_size);
+    for (int i = 0; ok && i < 3; i++) {
+        uint64_t capacity = indexes[i]->count;
+        ok = capacity > 0 && capacity <= UINT32_MAX && counts[i] < capacity &&
+             section_fits(indexes[i], capacity, sizeof(IdIndexSlot), file_size);
+    }
+    if (!ok) {
+        fprintf(stderr, "Snapshot is truncated or damaged\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Turn the offset in *slot into a pointer to the first of count elements
+// of section. Fails unless they all lie in the section on element
+// boundaries; offset 0 is NULL and only valid for no elements.
+static int relocate(unsigned char *base, void *slot, const SnapshotSection *section,
+                    size_t elem_size, uint64_t count) {
+    uintptr_t offset;
+    memcpy(&offset, slot, sizeof(offset));
+    if (offset == 0) {
+        return count == 0 ? 0 : -1;
+    }
+    if (offset < section->offset || (offset - section->offset) % elem_size != 0 ||
+        (offset - section->offset) / elem_size + count > section->count) {
+        return -1;
+    }
+    void *pointer = base + offset;
+    memcpy(slot, &pointer, sizeof(pointer));
+    return 0;
+}
+
+// Fault in the pages relocation rewrites in one call each, rather than a
+// copy-on-write fault per page; where unsupported they fault as touched
+static void prefault(unsigned char *base, uint64_t start, uint64_t end) {
+#ifdef MADV_POPULATE_WRITE
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t first = ((uintptr_t)base + start) & ~(page - 1);
+    if (end > start) {
+        madvise((void *)first, (uintptr_t)base + end - first, MADV_POPULATE_WRITE);
+    }
+#else
+    (void)base; (void)start; (void)end;
+#endif
+}
+
+static int relocate_all(unsigned char *base, const SnapshotHeader *header) {
+    // Crew members and strings are left to fault in when first read
+    prefault(base, header->aircraft.offset, header->aircraft.offset + header->aircraft.count * sizeof(Aircraft));
+    prefault(base, header->missions.offset, header->crew_lists.offset + header->crew_lists.count * sizeof(uintptr_t));
+    Aircraft *aircraft = (Aircraft *)(base + header->aircraft.offset);
+    for (uint64_t i = 0; i < header->aircraft.count; i++) {
+        if (aircraft[i].num_records < 0 ||
+            relocate(base, &aircraft[i].maintenance_records, &header->records,
+                     sizeof(MaintenanceRecord), aircraft[i].num_records) != 0) {
+            return -1;
+        }
+    }
+    MaintenanceRecord *records = (MaintenanceRecord *)(base + header->records.offset);
+    for (uint64_t i = 0; i < header->records.count; i++) {
+        if (records[i].num_issues < 0 ||
+            relocate(base, &records[i].reported_issues, &header->issues, sizeof(uintptr_t),
+                     records[i].num_issues) != 0) {
+            return -1;
+        }
+    }
+    // Issue strings are NUL-terminated within the section when its last byte is
+    if (header->strings.count > 0 && base[header->strings.offset + header->strings.count - 1] != '\0') {
+        return -1;
+    }
+    char **issues = (char **)(base + header->issues.offset);
+    for (uint64_t i = 0; i < header->issues.count; i++) {
+        if (relocate(base, &issues[i], &header->strings, 1, 1) != 0) {
+            return -1;
+        }
+    }
+    Mission *missions = (Mission *)(base + header->missions.offset);
+    for (uint64_t i = 0; i < header->missions.count; i++) {
+        if ((missions[i].aircraft != NULL &&
+             relocate(base, &missions[i].aircraft, &header->aircraft, sizeof(Aircraft), 1) != 0) ||
+            missions[i].crew_size < 0 ||
+            relocate(base, &missions[i].crew, &header->crew_lists, sizeof(uintptr_t), missions[i].crew_size) != 0) {
+            return -1;
+        }
+    }
+    CrewMember **crew_lists = (CrewMember **)(base + header->crew_lists.offset);
+    for (uint64_t i = 0; i < header->crew_lists.count; i++) {
+        if (relocate(base, &crew_lists[i], &header->crew, sizeof(CrewMember), 1) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Point the pool's slabs into the mapping; appends fill the last one first
+static int attach_pool(EntityPool *pool, unsigned char *base, const SnapshotSection *section) {
+    int num_slabs = (int)(pool_reserved(section->count) / REGISTRY_SLAB_SIZE);
+    if (num_slabs == 0) {
+        return 0;
+    }
+    pool->slabs = malloc(sizeof(void *) * num_slabs);
+    if (pool->slabs == NULL) {
+        return -1;
+    }
+    for (int k = 0; k < num_slabs; k++) {
+        pool->slabs[k] = base + section->offset + (size_t)k * REGISTRY_SLAB_SIZE * pool->elem_size;
+    }
+    pool->num_slabs = num_slabs;
+    pool->slab_capacity = num_slabs;
+    pool->count = (int)section->count;
+    return 0;
+}
+
+// Slots are copied out, since the index grows by reallocating them. Each
+// slot must carry the id of the entity it points at, or lookups would
+// hand back the wrong one.
+static int attach_index(IdIndex *index, unsigned char *base, const SnapshotSection *section,
+                        uint32_t count, const EntityPool *pool) {
+    IdIndexSlot *slots = malloc(sizeof(IdIndexSlot) * section->count);
+    if (slots == NULL) {
+        return -1;
+    }
+    memcpy(slots, base + section->offset, sizeof(IdIndexSlot) * section->count);
+    uint32_t used = 0;
+    for (uint64_t i = 0; i < section->count; i++) {
+        if (slots[i].index >= pool->count || slots[i].index < -1 ||
+            (slots[i].index >= 0 &&
+             !safer_id_equal(slots[i].id, safer_id_load(pool_entity(pool, slots[i].index))))) {
+            free(slots);
+            return -1;
+        }
+        used += slots[i].index >= 0;
+    }
+    if (used != count) {
+        free(slots);
+        return -1;
+    }
+    free(index->slots);
+    index->slots = slots;
+    index->capacity = (unsigned)section->count;
+    index->count = count;
+    return 0;
+}
+
+static int attach_list(void ***array, int *count, int *capacity, const EntityPool *pool) {
+    if (pool->count == 0) {
+        return 0;
+    }
+    *array = malloc(sizeof(void *) * pool->count);
+    if (*array == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < pool->count; i++) {
+        (*array)[i] = pool_entity(pool, i);
+    }
+    *count = pool->count;
+    *capacity = pool->count;
+    return 0;
+}
+
+static int attach(FleetRegistry *reg, unsigned char *base, const SnapshotHeader *header) {
+    if (attach_pool(&reg->aircraft, base, &header->aircraft) != 0 ||
+        attach_pool(&reg->crew, base, &header->crew) != 0 ||
+        attach_pool(&reg->missions, base, &header->missions) != 0 ||
+        attach_index(&reg->aircraft_index, base, &header->aircraft_index, header->aircraft_index_count,
+                     &reg->aircraft) != 0 ||
+        attach_index(&reg->crew_index, base, &header->crew_index, header->crew_index_count,
+                     &reg->crew) != 0 ||
+        attach_index(&reg->mission_index, base, &header->mission_index, header->mission_index_count,
+                     &reg->missions) != 0) {
+        return -1;
+    }
+    SafetyManagementSystem *sms = reg->sms;
+    if (sms == NULL) {
+        return 0;
+    }
+    // The system's lists are in pool order, as registry_add_* built them
+    if (attach_list((void ***)&sms->aircraft_registry, &sms->num_aircraft, &reg->sms_aircraft_capacity,
+                    &reg->aircraft) != 0 ||
+        attach_list((void ***)&sms->crew_registry, &sms->num_crew, &reg->sms_crew_capacity, &reg->crew) != 0 ||
+        attach_list((void ***)&sms->missions, &sms->num_missions, &reg->sms_mission_capacity,
+                    &reg->missions) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int snapshot_restore(FleetRegistry *reg, Database *db, const char *path, SnapshotStats *stats) {
+    SnapshotStats local;
+    if (stats == NULL) {
+        stats = &local;
+    }
+    memset(stats, 0, sizeof(*stats));
+    double started = now_ms();
+
+    if (reg->aircraft.count != 0 || reg->crew.count != 0 || reg->missions.count != 0 || reg->mapping != NULL) {
+        fprintf(stderr, "Snapshots restore into an empty registry\n");
+        return -1;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        if (errno != ENOENT) {
+            fprintf(stderr, "Cannot open snapshot %s: %s\n", path, strerror(errno));
+        }
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(SnapshotHeader)) {
+        fprintf(stderr, "Snapshot %s is truncated\n", path);
+        close(fd);
+        return -1;
+    }
+    // Private, so relocation and later updates never reach the file
+    void *mapping = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "Cannot map snapshot %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    unsigned char *base = mapping;
+    const SnapshotHeader *header = mapping;
+    if (check_header(header, (uint64_t)st.st_size) != 0) {
+        munmap(mapping, (size_t)st.st_size);
+        return -1;
+    }
+    stats->map_ms = now_ms() - started;
+
+    // The registry owns the mapping from here; registry_destroy undoes a failure
+    reg->mapping = mapping;
+    reg->mapping_size = (size_t)st.st_size;
+    double phase = now_ms();
+    int rc = relocate_all(base, header) == 0 && attach(reg, base, header) == 0 ? 0 : -1;
+    if (rc != 0) {
+        fprintf(stderr, "Snapshot %s is damaged\n", path);
+    }
+    stats->relocate_ms = now_ms() - phase;
+
+    stats->high_water_mark = header->high_water_mark;
+    if (rc == 0 && hydrate_registry_changes(db, reg, header->high_water_mark, &stats->replay) != SQLITE_OK) {
+        rc = -1;
+    }
+    if (rc != 0) {
+        SafetyManagementSystem *sms = reg->sms;
+        registry_destroy(reg);
+        registry_init(reg, sms);
+        return -1;
+    }
+    stats->num_aircraft = reg->aircraft.count;
+    stats->num_crew = reg->crew.count;
+    stats->num_missions = reg->missions.count;
+    stats->file_bytes = reg->mapping_size;
+    stats->total_ms = now_ms() - started;
+    return 0;
+}
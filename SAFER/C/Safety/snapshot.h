@@ -0,0 +1,44 @@
+// snapshot.h - Memory-mappable checkpoints of the fleet registry
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "database.h"
+#include "registry.h"
+#include "hydrate.h"
+#include <stdint.h>
+
+#define SNAPSHOT_DEFAULT_PATH "safer.snapshot"
+
+typedef struct {
+    int num_aircraft;
+    int num_crew;
+    int num_missions;
+    int64_t high_water_mark;        // Last change_log seq the snapshot reflects
+    size_t file_bytes;
+    double map_ms;                  // Restore: open, map and check the file
+    double relocate_ms;             // Restore: offsets to pointers, pools and indexes attached
+    HydrateStats replay;            // Restore: changes logged after the high-water mark
+    double total_ms;
+} SnapshotStats;
+
+// Checkpoint reg to path. The file holds the entity pools slab by slab as
+// the registry lays them out (mission risk levels included), the id index
+// slots, maintenance records, crew lists and issue strings, with every
+// pointer stored as a file offset, so it maps at any address. The change
+// log position is read before the registry, which is assumed to hold
+// every change the database does; changes after it are replayed on
+// restore. Written to path.tmp and renamed over path, after which the
+// change log is pruned through the mark. Entities must not be added
+// while it runs; scalar field updates are fine. stats may be NULL.
+int snapshot_write(FleetRegistry *reg, Database *db, const char *path, SnapshotStats *stats);
+
+// Fill an empty, initialised registry from a snapshot: map the file
+// privately, turn its offsets into pointers in place, attach the pools and
+// indexes without copying entities, then reload only what db logged after
+// the snapshot. The mapping is released by registry_destroy. Returns -1,
+// leaving reg empty, when the file is missing, damaged, written by a build
+// with a different layout, or older than what the change log still holds;
+// hydrate_registry in full then.
+int snapshot_restore(FleetRegistry *reg, Database *db, const char *path, SnapshotStats *stats);
+
+#endif // SNAPSHOT_H
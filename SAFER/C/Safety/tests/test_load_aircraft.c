@@ -0,0 +1,151 @@
+// test_load_aircraft.c - Maintenance histories round-trip through SQLite
+//
+// Issue text is sized in bytes, so multibyte UTF-8 must come back whole,
+// through the writer connection and through the read pool. A pool with
+// every connection held fails the read instead of blocking it.
+//
+// Build and run from this directory:
+//   gcc -O2 -I.. test_load_aircraft.c ../database.c ../read_pool.c ../persistence.c ../metrics.c
+//       -lsqlite3 -lpthread -lm -o test_load_aircraft && ./test_load_aircraft
+#define _POSIX_C_SOURCE 200809L
+#include "database.h"
+#include "read_pool.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static char *latest_issues[] = {"Température élevée", "Öldruck niedrig — Motor 2", "水圧低下"};
+static char *older_issues[] = {"Ordinary ASCII issue"};
+
+static void save_fixture(Database *db) {
+    MaintenanceRecord records[3] = {
+        {.last_inspection = 3000, .maintenance_due = 4000, .reported_issues = latest_issues, .num_issues = 3},
+        {.last_inspection = 2000, .maintenance_due = 3000, .reported_issues = older_issues, .num_issues = 1},
+        {.last_inspection = 1000, .maintenance_due = 2000}
+    };
+    Aircraft aircraft = {.id = "A000042", .model = "A400M", .manufacture_date = 500, .total_flight_hours = 1234,
+                         .maintenance_records = records, .num_records = 3};
+    for (int i = 0; i < 3; i++) {
+        memcpy(records[i].aircraft_id, aircraft.id, sizeof(aircraft.id));
+    }
+    CHECK(save_aircraft(db, &aircraft) == SQLITE_OK);
+}
+
+static void check_loaded(Database *db) {
+    Aircraft *aircraft = load_aircraft(db, "A000042");
+    CHECK(aircraft != NULL);
+    if (aircraft == NULL) {
+        return;
+    }
+    CHECK(strcmp(aircraft->model, "A400M") == 0);
+    CHECK(aircraft->total_flight_hours == 1234);
+    CHECK(aircraft->num_records == 3);
+    if (aircraft->num_records == 3) {
+        MaintenanceRecord *latest = &aircraft->maintenance_records[0];
+        CHECK(strcmp(latest->aircraft_id, "A000042") == 0);
+        CHECK(latest->last_inspection == 3000);
+        CHECK(latest->num_issues == 3);
+        for (int i = 0; i < latest->num_issues && i < 3; i++) {
+            CHECK(strcmp(latest->reported_issues[i], latest_issues[i]) == 0);
+        }
+        CHECK(aircraft->maintenance_records[1].num_issues == 1);
+        CHECK(strcmp(aircraft->maintenance_records[1].reported_issues[0], older_issues[0]) == 0);
+        CHECK(aircraft->maintenance_records[2].num_issues == 0);
+    }
+    free(aircraft);
+    CHECK(load_aircraft(db, "A999999") == NULL);
+}
+
+static pthread_barrier_t loaded, done;
+
+static void *load_on_thread(void *arg) {
+    Aircraft *aircraft = load_aircraft(arg, "A000042");
+    free(aircraft);
+    return aircraft != NULL ? arg : NULL;
+}
+
+// Keeps its thread's connection until the main thread lets it go
+static void *load_and_hold(void *arg) {
+    void *result = load_on_thread(arg);
+    pthread_barrier_wait(&loaded);
+    pthread_barrier_wait(&done);
+    return result;
+}
+
+// The main thread holds one of two connections
+static void check_pool_exhaustion(Database *db) {
+    pthread_t holder, reader;
+    void *result;
+    pthread_barrier_init(&loaded, NULL, 2);
+    pthread_barrier_init(&done, NULL, 2);
+    pthread_create(&holder, NULL, load_and_hold, db);
+    pthread_barrier_wait(&loaded);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_create(&reader, NULL, load_on_thread, db);
+    pthread_join(reader, &result);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    CHECK(result == NULL);
+    CHECK(end.tv_sec - start.tv_sec >= READ_POOL_WAIT_MS / 1000 - 1);
+
+    // The holder's connection comes back when it exits
+    pthread_barrier_wait(&done);
+    pthread_join(holder, &result);
+    CHECK(result == db);
+    pthread_create(&reader, NULL, load_on_thread, db);
+    pthread_join(reader, &result);
+    CHECK(result == db);
+    pthread_barrier_destroy(&loaded);
+    pthread_barrier_destroy(&done);
+}
+
+int main(void) {
+    char dir[] = "/tmp/safer-test-XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        perror("mkdtemp");
+        return 1;
+    }
+    char path[64];
+    snprintf(path, sizeof(path), "%s/safer.db", dir);
+    Database db = {.path = path};
+    if (init_database(&db) != SQLITE_OK) {
+        fprintf(stderr, "Failed to initialize database\n");
+        return 1;
+    }
+    save_fixture(&db);
+    check_loaded(&db);
+    if (read_pool_open(&db, 2) == 0) {
+        check_loaded(&db);
+        check_pool_exhaustion(&db);
+    } else {
+        CHECK(!"read_pool_open");
+    }
+    close_database(&db);
+
+    const char *suffixes[] = {"", "-wal", "-shm"};
+    for (int i = 0; i < 3; i++) {
+        char file[80];
+        snprintf(file, sizeof(file), "%s%s", path, suffixes[i]);
+        unlink(file);
+    }
+    rmdir(dir);
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_load_aircraft: ok\n");
+    return 0;
+}
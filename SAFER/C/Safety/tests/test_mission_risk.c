@@ -0,0 +1,152 @@
+// test_mission_risk.c - Single-mission grading as used by POST /api/mission
+//
+// A mission posted without emitters must grade as the batch route grades
+// it: radio stays out of the overall level. With emitters, radio can raise it.
+// Inputs that are not a number grade as the if-chains before the rule tables
+// did.
+//
+// Build and run from this directory:
+//   gcc -O2 -I.. test_mission_risk.c ../risk_batch.c ../safer.c ../registry.c ../arena.c
+//       ../risk_rules.c ../radio_interference.c ../radio_batch.c ../propagation.c ../path_loss_table.c
+//       -lpthread -lm -o test_mission_risk && ./test_mission_risk
+#include "risk_batch.h"
+#include "risk_rules.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+#define DAY (24 * 3600)
+
+// Fair weather, a freshly inspected airframe and an experienced crew
+static void make_mission(Mission *mission, Aircraft *aircraft, MaintenanceRecord *record,
+                         CrewMember *crew, CrewMember **crew_list) {
+    time_t now = time(NULL);
+    memset(record, 0, sizeof(*record));
+    record->last_inspection = now - 10 * DAY;
+    record->maintenance_due = now + 60 * DAY;
+    memset(aircraft, 0, sizeof(*aircraft));
+    snprintf(aircraft->id, sizeof(aircraft->id), "A000001");
+    snprintf(aircraft->model, sizeof(aircraft->model), "C-130J");
+    aircraft->maintenance_records = record;
+    aircraft->num_records = 1;
+    memset(crew, 0, sizeof(*crew));
+    snprintf(crew->id, sizeof(crew->id), "C000001");
+    crew->flight_hours = 3000;
+    crew->last_training = now - 30 * DAY;
+    crew_list[0] = crew;
+    memset(mission, 0, sizeof(*mission));
+    snprintf(mission->id, sizeof(mission->id), "M0000001");
+    mission->weather = (WeatherCondition){.temperature = 15, .visibility = 10000, .wind_speed = 5};
+    mission->aircraft = aircraft;
+    mission->crew = crew_list;
+    mission->crew_size = 1;
+}
+
+static void test_no_emitters_grades_like_batch(void) {
+    Mission mission;
+    Aircraft aircraft;
+    MaintenanceRecord record;
+    CrewMember crew, *crew_list[1];
+    make_mission(&mission, &aircraft, &record, &crew, crew_list);
+
+    RadioEnvironment empty = {0};
+    RadioInterferenceAnalysis radio;
+    CHECK(risk_assess_mission(&mission, &empty, &radio) == RISK_LOW);
+    CHECK(mission.risk_level == RISK_LOW);
+    CHECK(radio.risk_level == RISK_LOW && radio.interference_level == 0);
+    CHECK(risk_assess_mission(&mission, NULL, NULL) == RISK_LOW);
+
+    Mission batch = mission;
+    MissionRisk result;
+    CHECK(risk_batch_assess(&batch, 1, &empty, 1, &result) == 0);
+    CHECK(result.overall == mission.risk_level);
+    CHECK(result.radio == RISK_LOW);
+}
+
+static void test_emitters_raise_the_level(void) {
+    Mission mission;
+    Aircraft aircraft;
+    MaintenanceRecord record;
+    CrewMember crew, *crew_list[1];
+    make_mission(&mission, &aircraft, &record, &crew, crew_list);
+
+    // About -49 dBm received against a -45 dBm floor: within the built-in
+    // signal_to_noise limit, so radio grades critical
+    RadioSource source = {.frequency = 430, .power = 30, .distance = 0.5, .terrain_factor = 0};
+    RadioEnvironment env = {.sources = &source, .num_sources = 1, .background_noise = -45};
+    RadioInterferenceAnalysis radio;
+    RiskLevel level = risk_assess_mission(&mission, &env, &radio);
+    CHECK(radio.risk_level == RISK_CRITICAL);
+    CHECK(level == RISK_CRITICAL);
+
+    Mission batch = mission;
+    MissionRisk result;
+    CHECK(risk_batch_assess(&batch, 1, &env, 1, &result) == 0);
+    CHECK(result.overall == level);
+}
+
+static void test_ground_risk_survives_quiet_radio(void) {
+    Mission mission;
+    Aircraft aircraft;
+    MaintenanceRecord record;
+    CrewMember crew, *crew_list[1];
+    make_mission(&mission, &aircraft, &record, &crew, crew_list);
+    crew.last_training = time(NULL) - 400 * DAY;
+
+    RadioEnvironment empty = {0};
+    CHECK(risk_assess_mission(&mission, &empty, NULL) == RISK_CRITICAL);
+}
+
+// NaN fails every comparison: weather added nothing and the radio ladder
+// fell through to critical
+static void test_nan_grades_as_before(void) {
+    Mission mission;
+    Aircraft aircraft;
+    MaintenanceRecord record;
+    CrewMember crew, *crew_list[1];
+    make_mission(&mission, &aircraft, &record, &crew, crew_list);
+    mission.weather.visibility = NAN;
+    mission.weather.wind_speed = NAN;
+    CHECK(assess_weather_risk(&mission.weather) == RISK_LOW);
+    CHECK(risk_assess_mission(&mission, NULL, NULL) == RISK_LOW);
+
+    RadioInterferenceAnalysis radio = {.signal_to_noise = NAN};
+    CHECK(assess_radio_risk(&radio) == RISK_CRITICAL);
+
+    // A rule can grade NaN on its own terms
+    char error[128];
+    RiskRules *rules = risk_rules_parse("weather.visibility below 1000=3 nan=2\n"
+                                        "weather.score atleast 2=high\n", error, sizeof(error));
+    CHECK(rules != NULL);
+    if (rules != NULL) {
+        CHECK(risk_rules_weather(risk_rules_profile(rules, NULL), &mission.weather) == RISK_HIGH);
+        mission.weather.visibility = 500;
+        CHECK(risk_rules_weather(risk_rules_profile(rules, NULL), &mission.weather) == RISK_HIGH);
+        mission.weather.visibility = 5000;
+        CHECK(risk_rules_weather(risk_rules_profile(rules, NULL), &mission.weather) == RISK_LOW);
+        risk_rules_free(rules);
+    }
+}
+
+int main(void) {
+    test_no_emitters_grades_like_batch();
+    test_emitters_raise_the_level();
+    test_ground_risk_survives_quiet_radio();
+    test_nan_grades_as_before();
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_mission_risk: ok\n");
+    return 0;
+}
@@ -0,0 +1,101 @@
+// test_radio_domain.c - Sources without a positive distance grade alike on every path
+//
+// log10 of a zero or negative distance is -inf or NaN in libm, while the
+// AVX2 log2 series returns a finite -1023, so the batch kernel used to
+// answer differently from the scalar loop. Such sources now make the total
+// NaN whichever path sums them, and the rules grade that as critical.
+//
+// Build and run from this directory:
+//   gcc -O2 -I.. test_radio_domain.c ../radio_interference.c ../radio_batch.c ../propagation.c
+//       ../path_loss_table.c ../risk_rules.c -lm -lpthread -o test_radio_domain && ./test_radio_domain
+#include "radio_batch.h"
+#include "risk_rules.h"
+#include <stdio.h>
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+#define MAX_SOURCES 300
+
+static void make_sources(RadioSource *sources, int count) {
+    for (int i = 0; i < count; i++) {
+        sources[i] = (RadioSource){
+            .frequency = 100 + 37 * (i % 50),
+            .power = 20 + i % 17,
+            .distance = 0.5 + 0.25 * (i % 23),
+            .terrain_factor = i % 7
+        };
+    }
+}
+
+// Exact loop, lookup table and batch kernel, plus the batch entry points
+static void check_every_path(RadioSource *sources, int count, int expect_nan) {
+    RadioEnvironment env = {.sources = sources, .num_sources = count, .background_noise = -100,
+                            .weather_factor = 1};
+    RadioInterferenceAnalysis analysis = analyze_radio_interference(&env);
+    CHECK(isnan(analysis.interference_level) == expect_nan);
+    if (expect_nan) {
+        CHECK(analysis.risk_level == RISK_CRITICAL);
+    }
+
+    RadioSourceBatch batch;
+    CHECK(radio_batch_init(&batch, count) == 0);
+    CHECK(radio_batch_append(&batch, sources, count) == 0);
+    double scalar = radio_batch_total_power_mw_scalar(&batch, 1);
+    double kernel = radio_batch_total_power_mw(&batch, 1);
+    CHECK(isnan(scalar) == expect_nan && isnan(kernel) == expect_nan);
+    CHECK(isnan(radio_sources_total_power_mw(sources, count, 1)) == expect_nan);
+    if (!expect_nan) {
+        CHECK(fabs(kernel - scalar) <= 1e-11 * scalar);
+    }
+    CHECK(isnan(analyze_radio_environment_batch(&env, &batch).interference_level) == expect_nan);
+    CHECK(isnan(analyze_radio_batch(&batch, -100).interference_level) == expect_nan);
+    radio_batch_free(&batch);
+}
+
+static void test_non_positive_distance(void) {
+    static RadioSource sources[MAX_SOURCES];
+    int counts[] = {10, 100, RADIO_BATCH_MIN_SOURCES + 44};
+    double bad[] = {0.0, -2.5, NAN};
+    for (int c = 0; c < 3; c++) {
+        make_sources(sources, counts[c]);
+        check_every_path(sources, counts[c], 0);
+        // First lane, a lane of the unrolled loop and the last (tail) lane
+        int positions[] = {0, counts[c] / 2, counts[c] - 1};
+        for (int b = 0; b < 3; b++) {
+            for (int p = 0; p < 3; p++) {
+                make_sources(sources, counts[c]);
+                sources[positions[p]].distance = bad[b];
+                check_every_path(sources, counts[c], 1);
+            }
+        }
+    }
+}
+
+static void test_non_positive_frequency(void) {
+    static RadioSource sources[MAX_SOURCES];
+    int count = RADIO_BATCH_MIN_SOURCES + 44;
+    make_sources(sources, count);
+    sources[count / 3].frequency = 0;
+    check_every_path(sources, count, 1);
+    sources[count / 3].frequency = -430;
+    check_every_path(sources, count, 1);
+}
+
+int main(void) {
+    test_non_positive_distance();
+    test_non_positive_frequency();
+    risk_rules_cleanup();
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_radio_domain: ok\n");
+    return 0;
+}
@@ -0,0 +1,131 @@
+// test_radio_weather.c - Weather attenuation applies on every radio path
+//
+// analyze_radio_interference picks the exact loop, the lookup table or the
+// batch kernel by source count; each must charge weather_factor * distance,
+// and Monte Carlo must grade with the propagation model the analysis uses
+// and spread the weather factor when asked to.
+//
+// Build and run from this directory:
+//   gcc -O2 -I.. test_radio_weather.c ../monte_carlo.c ../radio_interference.c ../radio_batch.c
+//       ../propagation.c ../path_loss_table.c ../risk_rules.c -lm -lpthread
+//       -o test_radio_weather && ./test_radio_weather
+#include "monte_carlo.h"
+#include "propagation.h"
+#include "radio_batch.h"
+#include "risk_rules.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+#define MAX_SOURCES 300
+
+static void make_sources(RadioSource *sources, int count) {
+    for (int i = 0; i < count; i++) {
+        sources[i] = (RadioSource){
+            .frequency = 100 + 37 * (i % 50),
+            .power = 20 + i % 17,
+            .distance = 0.5 + 0.25 * (i % 23),
+            .terrain_factor = i % 7
+        };
+    }
+}
+
+// Reference total in dBm, one source at a time
+static double reference_level(const RadioEnvironment *env) {
+    double total = 0;
+    for (int i = 0; i < env->num_sources; i++) {
+        total += pow(10, radio_received_power(env, &env->sources[i]) / 10);
+    }
+    return 10 * log10(total);
+}
+
+static void test_every_path_charges_weather(void) {
+    static RadioSource sources[MAX_SOURCES];
+    make_sources(sources, MAX_SOURCES);
+    PropagationConfig terrain = {.model = &propagation_terrain};
+
+    // Exact loop, lookup table and (where the CPU has it) the batch kernel
+    int counts[] = {10, 100, RADIO_BATCH_MIN_SOURCES + 44};
+    for (int c = 0; c < 3; c++) {
+        RadioEnvironment dry = {.sources = sources, .num_sources = counts[c], .background_noise = -100};
+        RadioEnvironment wet = dry;
+        wet.weather_factor = 2;
+        double dry_level = analyze_radio_interference(&dry).interference_level;
+        double wet_level = analyze_radio_interference(&wet).interference_level;
+        CHECK(fabs(wet_level - reference_level(&wet)) < 0.02);
+        CHECK(wet_level < dry_level - 1);
+
+        // The terrain model is calculate_path_loss evaluated per batch
+        wet.propagation = &terrain;
+        CHECK(fabs(analyze_radio_interference(&wet).interference_level - wet_level) < 0.02);
+        wet.propagation = NULL;
+
+        RadioSourceBatch batch;
+        CHECK(radio_batch_init(&batch, counts[c]) == 0);
+        CHECK(radio_batch_append(&batch, sources, counts[c]) == 0);
+        CHECK(fabs(analyze_radio_environment_batch(&wet, &batch).interference_level - wet_level) < 0.02);
+        radio_batch_free(&batch);
+    }
+}
+
+// One emitter at 0.5 km: about -49 dBm in free space, 15 dB less in 30
+// dB/km of weather, and around 28 dB less again under Hata
+static void test_monte_carlo_uses_the_environment(void) {
+    RadioSource source = {.frequency = 430, .power = 30, .distance = 0.5};
+    PropagationConfig hata = {.model = &propagation_hata};
+    RadioEnvironment env = {.sources = &source, .num_sources = 1, .background_noise = -90,
+                            .weather_factor = 30, .propagation = &hata};
+    RadioInterferenceAnalysis analysis = analyze_radio_interference(&env);
+    CHECK(analysis.risk_level == RISK_CRITICAL);
+
+    Mission mission = {.weather = {.temperature = 15, .visibility = 10000, .wind_speed = 5}};
+    MonteCarloConfig config = {.samples = 4096, .seed = 7, .threads = 2};
+    RiskDistribution result;
+    CHECK(monte_carlo_risk(&mission, &env, &config, &result) == 0);
+    CHECK(result.radio[analysis.risk_level] == result.samples);
+
+    env.propagation = NULL;
+    env.weather_factor = 0;
+    analysis = analyze_radio_interference(&env);
+    CHECK(analysis.risk_level == RISK_LOW);
+    CHECK(monte_carlo_risk(&mission, &env, &config, &result) == 0);
+    CHECK(result.radio[RISK_LOW] == result.samples);
+}
+
+// Dry on average, so no sample may gain power from the weather: about half
+// stay dry, and the wettest lose enough to leave LOW
+static void test_monte_carlo_samples_weather(void) {
+    RadioSource source = {.frequency = 430, .power = 30, .distance = 0.5};
+    RadioEnvironment env = {.sources = &source, .num_sources = 1, .background_noise = -90};
+    Mission mission = {.weather = {.temperature = 15, .visibility = 10000, .wind_speed = 5}};
+    MonteCarloConfig config = {.samples = 20000, .seed = 11, .threads = 1, .weather_factor_stddev = 20};
+    RiskDistribution one, three;
+    CHECK(monte_carlo_risk(&mission, &env, &config, &one) == 0);
+    CHECK(one.radio[RISK_LOW] > one.samples / 2);
+    CHECK(one.radio[RISK_LOW] < one.samples * 0.95);
+
+    config.threads = 3;
+    CHECK(monte_carlo_risk(&mission, &env, &config, &three) == 0);
+    CHECK(memcmp(one.radio, three.radio, sizeof(one.radio)) == 0);
+}
+
+int main(void) {
+    test_every_path_charges_weather();
+    test_monte_carlo_uses_the_environment();
+    test_monte_carlo_samples_weather();
+    risk_rules_cleanup();
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_radio_weather: ok\n");
+    return 0;
+}
@@ -0,0 +1,143 @@
+// test_registry_unwind.c - A failed registry add leaves no trace
+//
+// realloc is wrapped so the sms pointer arrays can be made to fail to grow
+// after the entity is already in the pool and index. The add must return
+// NULL, the id must stay unknown, the arena must give its storage back and
+// a retry must succeed.
+//
+// Build and run from this directory:
+//   gcc -O2 -I.. test_registry_unwind.c ../registry.c ../arena.c -Wl,--wrap=realloc
+//       -o test_registry_unwind && ./test_registry_unwind
+#include "registry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+void *__real_realloc(void *ptr, size_t size);
+
+static int fail_realloc;
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    if (fail_realloc) {
+        return NULL;
+    }
+    return __real_realloc(ptr, size);
+}
+
+// The sms arrays start at 64 entries, so the 65th add has to grow them
+#define FILLED 64
+
+static void make_aircraft(Aircraft *aircraft, MaintenanceRecord *record, char **issues, int i) {
+    memset(record, 0, sizeof(*record));
+    record->reported_issues = issues;
+    record->num_issues = 1;
+    memset(aircraft, 0, sizeof(*aircraft));
+    snprintf(aircraft->id, sizeof(aircraft->id), "A%06d", i);
+    snprintf(aircraft->model, sizeof(aircraft->model), "C-130J");
+    aircraft->maintenance_records = record;
+    aircraft->num_records = 1;
+}
+
+static void test_aircraft_add_unwinds(void) {
+    SafetyManagementSystem sms = {0};
+    FleetRegistry reg;
+    CHECK(registry_init(&reg, &sms) == 0);
+
+    char *issues[] = {"Hydraulic leak"};
+    Aircraft aircraft;
+    MaintenanceRecord record;
+    for (int i = 0; i < FILLED; i++) {
+        make_aircraft(&aircraft, &record, issues, i);
+        CHECK(registry_add_aircraft(&reg, &aircraft) != NULL);
+    }
+
+    // An issue larger than a quarter block gets a dedicated arena block
+    size_t big_size = 2 << 20;
+    char *big = malloc(big_size);
+    memset(big, 'x', big_size - 1);
+    big[big_size - 1] = '\0';
+    char *big_issues[] = {big};
+    size_t used = reg.arena.bytes_used, reserved = reg.arena.bytes_reserved;
+    unsigned indexed = reg.aircraft_index.count;
+
+    make_aircraft(&aircraft, &record, big_issues, FILLED);
+    fail_realloc = 1;
+    CHECK(registry_add_aircraft(&reg, &aircraft) == NULL);
+    fail_realloc = 0;
+    CHECK(registry_find_aircraft(&reg, aircraft.id) == NULL);
+    CHECK(reg.aircraft.count == FILLED && reg.aircraft_index.count == indexed);
+    CHECK(sms.num_aircraft == FILLED);
+    CHECK(reg.arena.bytes_used == used && reg.arena.bytes_reserved == reserved);
+
+    Aircraft *stored = registry_add_aircraft(&reg, &aircraft);
+    CHECK(stored != NULL);
+    CHECK(registry_find_aircraft(&reg, aircraft.id) == stored);
+    CHECK(sms.num_aircraft == FILLED + 1 && sms.aircraft_registry[FILLED] == stored);
+    CHECK(stored != NULL && strcmp(stored->maintenance_records[0].reported_issues[0], big) == 0);
+    // Earlier entities are untouched
+    Aircraft *first = registry_find_aircraft(&reg, "A000000");
+    CHECK(first != NULL && strcmp(first->maintenance_records[0].reported_issues[0], "Hydraulic leak") == 0);
+
+    free(big);
+    registry_destroy(&reg);
+}
+
+static void test_crew_and_mission_adds_unwind(void) {
+    SafetyManagementSystem sms = {0};
+    FleetRegistry reg;
+    CHECK(registry_init(&reg, &sms) == 0);
+
+    CrewMember crew = {0};
+    Mission mission = {0};
+    CrewMember *crew_list[1];
+    for (int i = 0; i < FILLED; i++) {
+        snprintf(crew.id, sizeof(crew.id), "C%06d", i);
+        crew_list[0] = registry_add_crew_member(&reg, &crew);
+        snprintf(mission.id, sizeof(mission.id), "M%07d", i);
+        mission.crew = crew_list;
+        mission.crew_size = 1;
+        CHECK(registry_add_mission(&reg, &mission) != NULL);
+    }
+
+    fail_realloc = 1;
+    snprintf(crew.id, sizeof(crew.id), "C%06d", FILLED);
+    CHECK(registry_add_crew_member(&reg, &crew) == NULL);
+    snprintf(mission.id, sizeof(mission.id), "M%07d", FILLED);
+    CHECK(registry_add_mission(&reg, &mission) == NULL);
+    fail_realloc = 0;
+    CHECK(registry_find_crew_member(&reg, crew.id) == NULL);
+    CHECK(registry_find_mission(&reg, mission.id) == NULL);
+    CHECK(sms.num_crew == FILLED && sms.num_missions == FILLED);
+
+    // Replacing an existing entity never grows the arrays, so it succeeds
+    fail_realloc = 1;
+    snprintf(mission.id, sizeof(mission.id), "M%07d", 0);
+    CHECK(registry_add_mission(&reg, &mission) != NULL);
+    fail_realloc = 0;
+
+    CHECK(registry_add_crew_member(&reg, &crew) != NULL);
+    snprintf(mission.id, sizeof(mission.id), "M%07d", FILLED);
+    CHECK(registry_add_mission(&reg, &mission) != NULL);
+    CHECK(sms.num_crew == FILLED + 1 && sms.num_missions == FILLED + 1);
+    registry_destroy(&reg);
+}
+
+int main(void) {
+    test_aircraft_add_unwinds();
+    test_crew_and_mission_adds_unwind();
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_registry_unwind: ok\n");
+    return 0;
+}
@@ -0,0 +1,147 @@
+// test_risk_rules_reclaim.c - Replaced rule sets are freed once unclaimed
+//
+// A long-running service installs rules over and over; each replaced set
+// must be freed as soon as no assessment holds it, and kept intact while
+// one does. Build with -fsanitize=address to catch a set freed early.
+//
+// Build and run from this directory:
+//   gcc -O2 -I.. test_risk_rules_reclaim.c ../risk_rules.c -lm -lpthread
+//       -o test_risk_rules_reclaim && ./test_risk_rules_reclaim
+#define _POSIX_C_SOURCE 200809L
+#include "risk_rules.h"
+#include <pthread.h>
+#include <stdio.h>
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static void install_text(const char *text) {
+    char error[128];
+    RiskRules *rules = risk_rules_parse(text, error, sizeof(error));
+    CHECK(rules != NULL);
+    if (rules != NULL) {
+        risk_rules_install(rules);
+    }
+}
+
+static void install_builtin_copy(void) {
+    install_text(risk_rules_default_text);
+}
+
+// Wind alone decides: above 10 is critical
+static const char strict_text[] = "weather.wind_speed above 10=5\nweather.score atleast 5=critical\n";
+
+static RiskLevel grade_wind(const RiskRules *rules, float wind_speed) {
+    WeatherCondition weather = {.temperature = 15, .visibility = 10000, .wind_speed = wind_speed};
+    return risk_rules_weather(risk_rules_profile(rules, NULL), &weather);
+}
+
+static void test_unclaimed_sets_are_freed(void) {
+    for (int i = 0; i < 1000; i++) {
+        install_builtin_copy();
+    }
+    CHECK(risk_rules_retired() == 0);
+}
+
+static void test_claimed_set_survives_swaps(void) {
+    install_text(strict_text);
+    const RiskRules *held = risk_rules_acquire();
+    CHECK(grade_wind(held, 12) == RISK_CRITICAL);
+
+    for (int i = 0; i < 100; i++) {
+        install_builtin_copy();
+    }
+    // Only the claimed set is kept, and it still grades as it did
+    CHECK(risk_rules_retired() == 1);
+    CHECK(grade_wind(held, 12) == RISK_CRITICAL);
+
+    // Nested acquires share the claim
+    CHECK(risk_rules_acquire() == held);
+    risk_rules_release();
+    CHECK(risk_rules_retired() == 1);
+
+    // The claim lingers past the release until the thread acquires again
+    // or quiesces
+    risk_rules_release();
+    install_builtin_copy();
+    CHECK(risk_rules_retired() == 1);
+    risk_rules_quiesce();
+    install_builtin_copy();
+    CHECK(risk_rules_retired() == 0);
+    const RiskRules *now = risk_rules_acquire();
+    CHECK(grade_wind(now, 12) == RISK_LOW);
+    risk_rules_release();
+
+    // While the set stays current, acquiring again reuses the claim
+    CHECK(risk_rules_acquire() == now);
+    risk_rules_release();
+    install_text(strict_text);
+    CHECK(risk_rules_retired() == 1);
+    CHECK(grade_wind(risk_rules_acquire(), 12) == RISK_CRITICAL);
+    risk_rules_release();
+    install_builtin_copy();
+    CHECK(risk_rules_retired() == 1);
+    risk_rules_quiesce();
+}
+
+static void *claim_on_thread(void *arg) {
+    risk_rules_claim(arg);
+    return NULL;
+}
+
+// As a batch does: claimed on one thread, released on another, and freed
+// when the hold goes without waiting for another install
+static void test_hold_moves_between_threads(void) {
+    install_text(strict_text);
+    RiskRulesHold hold;
+    risk_rules_hold_init(&hold);
+    pthread_t thread;
+    pthread_create(&thread, NULL, claim_on_thread, &hold);
+    pthread_join(thread, NULL);
+
+    install_builtin_copy();
+    CHECK(risk_rules_retired() == 1);
+    CHECK(grade_wind(hold.rules, 12) == RISK_CRITICAL);
+
+    risk_rules_unclaim(&hold);
+    risk_rules_hold_destroy(&hold);
+    CHECK(risk_rules_retired() == 0);
+}
+
+static void *acquire_and_exit(void *arg) {
+    (void)arg;
+    risk_rules_acquire();
+    risk_rules_release();
+    return NULL;
+}
+
+// Threads that come and go leave no registered hold behind to scan
+static void test_thread_holds_are_unregistered(void) {
+    for (int i = 0; i < 200; i++) {
+        pthread_t thread;
+        pthread_create(&thread, NULL, acquire_and_exit, NULL);
+        pthread_join(thread, NULL);
+        install_builtin_copy();
+    }
+    CHECK(risk_rules_retired() == 0);
+}
+
+int main(void) {
+    test_unclaimed_sets_are_freed();
+    test_claimed_set_survives_swaps();
+    test_hold_moves_between_threads();
+    test_thread_holds_are_unregistered();
+    risk_rules_cleanup();
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_risk_rules_reclaim: ok\n");
+    return 0;
+}
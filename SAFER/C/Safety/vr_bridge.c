@@ -0,0 +1,268 @@
+// vr_bridge.c - Lock-free SPSC event ring in POSIX shared memory
+#define _POSIX_C_SOURCE 200809L
+#include "vr_bridge.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define VR_BRIDGE_MAGIC 0x31425653 // "SVB1"
+#define VR_BRIDGE_CACHE_LINE 64
+#define VR_BRIDGE_MAX_CAPACITY (1u << 24)
+
+_Static_assert(sizeof(VREvent) == VR_BRIDGE_CACHE_LINE, "VREvent should fill one cache line");
+
+// Layout of the segment. The producer's and the consumer's indices sit on
+// their own cache lines so neither side's stores invalidate the other's.
+// Indices count events since creation and wrap through the ring by mask.
+typedef struct {
+    uint32_t magic;                 // Stored last, with release, once the rest is set
+    uint32_t capacity;
+    uint32_t event_size;
+    int32_t producer_pid;           // 0 when no producer is attached
+
+    _Alignas(VR_BRIDGE_CACHE_LINE) uint64_t head; // Written only by the producer
+    uint64_t dropped;
+
+    _Alignas(VR_BRIDGE_CACHE_LINE) uint64_t tail; // Written only by the consumer
+
+    _Alignas(VR_BRIDGE_CACHE_LINE) VREvent events[];
+} SharedRing;
+
+struct VRBridge {
+    SharedRing *ring;
+    size_t size;
+    uint32_t mask;
+    int producer;
+    uint64_t position;              // Our own index: head for the producer, tail for the consumer
+    uint64_t peer;                  // Last index read from the other side; reread only when it seems to block
+};
+
+static size_t ring_size(uint32_t capacity) {
+    return sizeof(SharedRing) + (size_t)capacity * sizeof(VREvent);
+}
+
+static uint32_t round_capacity(uint32_t capacity) {
+    if (capacity == 0) {
+        capacity = VR_BRIDGE_DEFAULT_CAPACITY;
+    }
+    if (capacity > VR_BRIDGE_MAX_CAPACITY) {
+        capacity = VR_BRIDGE_MAX_CAPACITY;
+    }
+    uint32_t rounded = 2;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+// A segment this build can use as is
+static int compatible(const SharedRing *ring, size_t size) {
+    return size >= sizeof(SharedRing) &&
+           __atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) == VR_BRIDGE_MAGIC &&
+           ring->event_size == sizeof(VREvent) &&
+           ring->capacity >= 2 && (ring->capacity & (ring->capacity - 1)) == 0 &&
+           size == ring_size(ring->capacity);
+}
+
+static VRBridge *attach(int fd, size_t size, int producer) {
+    void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+    VRBridge *bridge = calloc(1, sizeof(VRBridge));
+    if (bridge == NULL) {
+        munmap(mapping, size);
+        return NULL;
+    }
+    bridge->ring = mapping;
+    bridge->size = size;
+    bridge->producer = producer;
+    return bridge;
+}
+
+static void detach(VRBridge *bridge) {
+    munmap(bridge->ring, bridge->size);
+    free(bridge);
+}
+
+VRBridge *vr_bridge_create(const char *name, uint32_t capacity) {
+    capacity = round_capacity(capacity);
+    size_t size = ring_size(capacity);
+    int fd = shm_open(name, O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open VR bridge %s: %s\n", name, strerror(errno));
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size == size) {
+        VRBridge *bridge = attach(fd, size, 0);
+        if (bridge != NULL && compatible(bridge->ring, size) && bridge->ring->capacity == capacity) {
+            close(fd);
+            bridge->mask = capacity - 1;
+            bridge->position = __atomic_load_n(&bridge->ring->tail, __ATOMIC_RELAXED);
+            bridge->peer = bridge->position;
+            return bridge;
+        }
+        if (bridge != NULL) {
+            detach(bridge);
+        }
+    }
+
+    // Nothing usable there. Replace the name rather than resize in place,
+    // so a producer still mapped to the old segment cannot scribble on this one.
+    close(fd);
+    shm_unlink(name);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 || ftruncate(fd, (off_t)size) != 0) {
+        fprintf(stderr, "Failed to create VR bridge %s: %s\n", name, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+            shm_unlink(name);
+        }
+        return NULL;
+    }
+    VRBridge *bridge = attach(fd, size, 0);
+    close(fd);
+    if (bridge == NULL) {
+        shm_unlink(name);
+        return NULL;
+    }
+    bridge->ring->capacity = capacity;
+    bridge->ring->event_size = sizeof(VREvent);
+    __atomic_store_n(&bridge->ring->magic, VR_BRIDGE_MAGIC, __ATOMIC_RELEASE);
+    bridge->mask = capacity - 1;
+    return bridge;
+}
+
+// Take the producer slot if it is free or its holder has exited. A second
+// handle in the holding process is refused too; it would be a second producer.
+static int claim_producer(SharedRing *ring) {
+    int32_t self = (int32_t)getpid();
+    int32_t holder = __atomic_load_n(&ring->producer_pid, __ATOMIC_ACQUIRE);
+    for (;;) {
+        if (holder != 0 && !(kill(holder, 0) != 0 && errno == ESRCH)) {
+            return -1;
+        }
+        if (__atomic_compare_exchange_n(&ring->producer_pid, &holder, self, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return 0;
+        }
+    }
+}
+
+VRBridge *vr_bridge_open(const char *name) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    VRBridge *bridge = NULL;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(SharedRing)) {
+        bridge = attach(fd, (size_t)st.st_size, 1);
+    }
+    close(fd);
+    if (bridge == NULL) {
+        return NULL;
+    }
+    if (!compatible(bridge->ring, bridge->size) || claim_producer(bridge->ring) != 0) {
+        detach(bridge);
+        return NULL;
+    }
+    bridge->mask = bridge->ring->capacity - 1;
+    bridge->position = __atomic_load_n(&bridge->ring->head, __ATOMIC_RELAXED);
+    bridge->peer = __atomic_load_n(&bridge->ring->tail, __ATOMIC_ACQUIRE);
+    return bridge;
+}
+
+void vr_bridge_close(VRBridge *bridge) {
+    if (bridge == NULL) {
+        return;
+    }
+    if (bridge->producer) {
+        int32_t self = (int32_t)getpid();
+        __atomic_compare_exchange_n(&bridge->ring->producer_pid, &self, 0, 0,
+                                    __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+    }
+    detach(bridge);
+}
+
+int vr_bridge_unlink(const char *name) {
+    return shm_unlink(name);
+}
+
+int vr_bridge_publish(VRBridge *bridge, const VREvent *event) {
+    SharedRing *ring = bridge->ring;
+    uint64_t head = bridge->position;
+    if (head - bridge->peer > bridge->mask) {
+        bridge->peer = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if (head - bridge->peer > bridge->mask) {
+            __atomic_store_n(&ring->dropped, ring->dropped + 1, __ATOMIC_RELAXED);
+            return -1;
+        }
+    }
+    VREvent *slot = &ring->events[head & bridge->mask];
+    *slot = *event;
+    slot->published_ns = monotonic_ns();
+    bridge->position = head + 1;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int vr_bridge_consume(VRBridge *bridge, VREvent *events, int max) {
+    SharedRing *ring = bridge->ring;
+    uint64_t tail = bridge->position;
+    if (bridge->peer == tail) {
+        bridge->peer = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    }
+    uint64_t available = bridge->peer - tail;
+    if (available > (uint64_t)bridge->mask + 1) {
+        // Only a producer that broke the protocol gets here; skip to its head
+        fprintf(stderr, "VR bridge indices inconsistent, skipping %llu events\n",
+                (unsigned long long)available);
+        bridge->position = bridge->peer;
+        __atomic_store_n(&ring->tail, bridge->peer, __ATOMIC_RELEASE);
+        return 0;
+    }
+    int count = available < (uint64_t)max ? (int)available : max;
+    if (count <= 0) {
+        return 0;
+    }
+
+    // At most two runs: up to the end of the ring, then from its start
+    uint32_t first = (uint32_t)(tail & bridge->mask);
+    int run = (int)(bridge->mask + 1 - first);
+    if (run > count) {
+        run = count;
+    }
+    memcpy(events, &ring->events[first], sizeof(VREvent) * run);
+    memcpy(events + run, &ring->events[0], sizeof(VREvent) * (count - run));
+
+    bridge->position = tail + count;
+    __atomic_store_n(&ring->tail, tail + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+void vr_bridge_stats(VRBridge *bridge, VRBridgeStats *stats) {
+    SharedRing *ring = bridge->ring;
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    stats->published = head;
+    stats->consumed = tail;
+    stats->dropped = __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+    stats->pending = (uint32_t)(head - tail);
+    stats->capacity = ring->capacity;
+}
@@ -0,0 +1,79 @@
+// vr_bridge.h - Shared-memory event ring from the VR trainer to the safety service
+#ifndef VR_BRIDGE_H
+#define VR_BRIDGE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VR_BRIDGE_DEFAULT_NAME "/safer-vr-bridge"
+#define VR_BRIDGE_DEFAULT_CAPACITY 4096 // Events; about 45 s of one event per 90 Hz frame
+
+typedef enum {
+    VR_EVENT_ZONE_WARNING = 1,      // level: proximity to a safety zone, 0 to 1
+    VR_EVENT_TRAINING_COMPLETE = 2  // level: scenario score, 0 to 1
+} VREventType;
+
+#define VR_EVENT_PASSED 0x1 // Training completed to standard
+
+// One cache line per event. Ids are NUL padded and need not be terminated.
+typedef struct {
+    uint32_t type;
+    uint32_t flags;
+    float level;
+    char crew_id[16];
+    char subject_id[20];            // Zone or scenario id
+    int64_t wall_time;              // When it happened, Unix seconds
+    uint64_t published_ns;          // CLOCK_MONOTONIC, stamped by vr_bridge_publish
+} VREvent;
+
+typedef struct {
+    uint64_t published;
+    uint64_t dropped;               // Refused because the ring was full
+    uint64_t consumed;
+    uint32_t pending;
+    uint32_t capacity;
+} VRBridgeStats;
+
+typedef struct VRBridge VRBridge;
+
+// Single producer, single consumer ring in a POSIX shared memory segment.
+// The service creates the segment and consumes; the VR process attaches
+// and publishes. Publishing is a copy and a release store, with no system
+// calls and no waiting, so it is safe from the frame loop: when the service
+// falls behind, new events are dropped and counted rather than stalling
+// the frame.
+
+// Consumer side. Reattaches to a compatible segment left by an earlier run,
+// keeping any events still in it, so the VR process need not reconnect
+// when the service restarts. capacity is rounded up to a power of two
+// (0 for the default). Returns NULL on failure.
+VRBridge *vr_bridge_create(const char *name, uint32_t capacity);
+
+// Producer side. Returns NULL when the service has not created the
+// segment yet, or while another handle, in this process or another live
+// one, is publishing to it.
+VRBridge *vr_bridge_open(const char *name);
+
+// Unmap; a producer also gives up its claim on the ring
+void vr_bridge_close(VRBridge *bridge);
+
+// Remove the segment name; attached processes keep their mapping
+int vr_bridge_unlink(const char *name);
+
+// Producer: copy event into the ring. Returns 0, or -1 when it was full.
+int vr_bridge_publish(VRBridge *bridge, const VREvent *event);
+
+// Consumer: move up to max events into events, oldest first. Returns the
+// number moved, 0 when the ring is empty.
+int vr_bridge_consume(VRBridge *bridge, VREvent *events, int max);
+
+void vr_bridge_stats(VRBridge *bridge, VRBridgeStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VR_BRIDGE_H
@@ -0,0 +1,207 @@
+// vr_ingest.c - VR bridge consumer thread
+#define _POSIX_C_SOURCE 200809L
+#include "vr_ingest.h"
+#include <pthread.h>
+#include <time.h>
+
+#define DEFAULT_BATCH_SIZE 256
+#define DEFAULT_POLL_INTERVAL_MS 10
+
+struct VRIngest {
+    VRIngestConfig config;
+    VRBridge *bridge;
+    pthread_t thread;
+    int stopping;
+    VREvent *events;
+    CrewMember **touched;           // Crew whose records the current batch changed
+    int num_touched;
+
+    pthread_mutex_t stats_lock;
+    VRIngestStats stats;
+};
+
+// Copy a NUL-padded id into a terminated string
+static void copy_id(char *dst, const char *src, size_t size) {
+    memcpy(dst, src, size);
+    dst[size] = '\0';
+}
+
+static void touch(VRIngest *ingest, CrewMember *crew) {
+    for (int i = 0; i < ingest->num_touched; i++) {
+        if (ingest->touched[i] == crew) {
+            return;
+        }
+    }
+    ingest->touched[ingest->num_touched++] = crew;
+}
+
+static int crewed_by_touched(const VRIngest *ingest, const Mission *mission) {
+    for (int c = 0; c < mission->crew_size; c++) {
+        for (int i = 0; i < ingest->num_touched; i++) {
+            if (mission->crew[c] == ingest->touched[i]) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// One pass over the missions however many crew records the batch changed
+static uint64_t reassess_missions(VRIngest *ingest) {
+    SafetyManagementSystem *sms = ingest->config.sms;
+    uint64_t reassessed = 0;
+    int num_missions = sms->num_missions;
+    for (int m = 0; m < num_missions; m++) {
+        Mission *mission = sms->missions[m];
+        if (!crewed_by_touched(ingest, mission)) {
+            continue;
+        }
+        // Assess a copy so readers never see a half-updated level
+        Mission assessed = *mission;
+        perform_risk_assessment(&assessed);
+        RiskLevel previous = __atomic_exchange_n(&mission->risk_level, assessed.risk_level, __ATOMIC_ACQ_REL);
+        if (previous != assessed.risk_level && ingest->config.risk_events != NULL) {
+            risk_events_publish(ingest->config.risk_events, mission->id, previous, assessed.risk_level);
+        }
+        reassessed++;
+    }
+    return reassessed;
+}
+
+static void apply_batch(VRIngest *ingest, int count) {
+    VRIngestStats batch = {0};
+    uint64_t now = metrics_now_ns();
+    ingest->num_touched = 0;
+
+    for (int i = 0; i < count; i++) {
+        const VREvent *event = &ingest->events[i];
+        metric_snapshot_observe_ns(&batch.lag, now > event->published_ns ? now - event->published_ns : 0);
+        if (event->type == VR_EVENT_ZONE_WARNING) {
+            batch.zone_warnings++;
+            continue;
+        }
+        if (event->type != VR_EVENT_TRAINING_COMPLETE || !(event->flags & VR_EVENT_PASSED)) {
+            continue;
+        }
+        char crew_id[sizeof(event->crew_id) + 1];
+        copy_id(crew_id, event->crew_id, sizeof(event->crew_id));
+        CrewMember *crew = find_crew_member(ingest->config.sms, crew_id);
+        if (crew == NULL) {
+            batch.unknown_crew++;
+            continue;
+        }
+        batch.trainings++;
+        if ((time_t)event->wall_time > crew->last_training) {
+            __atomic_store_n(&crew->last_training, (time_t)event->wall_time, __ATOMIC_RELAXED);
+            touch(ingest, crew);
+        }
+    }
+
+    if (ingest->num_touched > 0) {
+        for (int i = 0; ingest->config.db != NULL && i < ingest->num_touched; i++) {
+            if (save_crew_member(ingest->config.db, ingest->touched[i]) != 0) {
+                fprintf(stderr, "Failed to save training for crew %s\n", ingest->touched[i]->id);
+            }
+        }
+        batch.missions_reassessed = reassess_missions(ingest);
+    }
+
+    pthread_mutex_lock(&ingest->stats_lock);
+    VRIngestStats *stats = &ingest->stats;
+    stats->batches++;
+    stats->zone_warnings += batch.zone_warnings;
+    stats->trainings += batch.trainings;
+    stats->unknown_crew += batch.unknown_crew;
+    stats->missions_reassessed += batch.missions_reassessed;
+    for (int b = 0; b <= METRIC_HISTOGRAM_BUCKETS; b++) {
+        stats->lag.buckets[b] += batch.lag.buckets[b];
+    }
+    stats->lag.sum_seconds += batch.lag.sum_seconds;
+    pthread_mutex_unlock(&ingest->stats_lock);
+}
+
+static void *ingest_thread(void *arg) {
+    VRIngest *ingest = arg;
+    struct timespec poll = {
+        .tv_sec = ingest->config.poll_interval_ms / 1000,
+        .tv_nsec = (long)(ingest->config.poll_interval_ms % 1000) * 1000000
+    };
+    for (;;) {
+        int count = vr_bridge_consume(ingest->bridge, ingest->events, ingest->config.batch_size);
+        if (count > 0) {
+            apply_batch(ingest, count);
+        }
+        // Stop only once a short batch shows the ring drained
+        if (count < ingest->config.batch_size && __atomic_load_n(&ingest->stopping, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        // The producer never signals, so an empty ring is polled
+        if (count == 0) {
+            nanosleep(&poll, NULL);
+        }
+    }
+    return NULL;
+}
+
+VRIngest *vr_ingest_start(const VRIngestConfig *config) {
+    if (config == NULL || config->sms == NULL) {
+        return NULL;
+    }
+    VRIngest *ingest = calloc(1, sizeof(VRIngest));
+    if (ingest == NULL) {
+        return NULL;
+    }
+    ingest->config = *config;
+    if (ingest->config.name == NULL) ingest->config.name = VR_BRIDGE_DEFAULT_NAME;
+    if (ingest->config.batch_size <= 0) ingest->config.batch_size = DEFAULT_BATCH_SIZE;
+    if (ingest->config.poll_interval_ms <= 0) ingest->config.poll_interval_ms = DEFAULT_POLL_INTERVAL_MS;
+
+    ingest->events = malloc(sizeof(VREvent) * ingest->config.batch_size);
+    ingest->touched = malloc(sizeof(CrewMember *) * ingest->config.batch_size);
+    if (ingest->events == NULL || ingest->touched == NULL) {
+        free(ingest->events);
+        free(ingest->touched);
+        free(ingest);
+        return NULL;
+    }
+    ingest->bridge = vr_bridge_create(ingest->config.name, ingest->config.capacity);
+    if (ingest->bridge == NULL) {
+        free(ingest->events);
+        free(ingest->touched);
+        free(ingest);
+        return NULL;
+    }
+    pthread_mutex_init(&ingest->stats_lock, NULL);
+    if (pthread_create(&ingest->thread, NULL, ingest_thread, ingest) != 0) {
+        fprintf(stderr, "Failed to start VR ingest thread\n");
+        pthread_mutex_destroy(&ingest->stats_lock);
+        vr_bridge_close(ingest->bridge);
+        free(ingest->events);
+        free(ingest->touched);
+        free(ingest);
+        return NULL;
+    }
+    return ingest;
+}
+
+void vr_ingest_stop(VRIngest *ingest) {
+    if (ingest == NULL) {
+        return;
+    }
+    __atomic_store_n(&ingest->stopping, 1, __ATOMIC_RELEASE);
+    pthread_join(ingest->thread, NULL);
+    // The segment stays, so a running VR process can keep publishing into
+    // it for the next service run to pick up
+    vr_bridge_close(ingest->bridge);
+    pthread_mutex_destroy(&ingest->stats_lock);
+    free(ingest->events);
+    free(ingest->touched);
+    free(ingest);
+}
+
+void vr_ingest_stats(VRIngest *ingest, VRIngestStats *stats) {
+    pthread_mutex_lock(&ingest->stats_lock);
+    *stats = ingest->stats;
+    pthread_mutex_unlock(&ingest->stats_lock);
+    vr_bridge_stats(ingest->bridge, &stats->bridge);
+}
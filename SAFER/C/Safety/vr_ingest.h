@@ -0,0 +1,46 @@
+// vr_ingest.h - Applies VR bridge events to crew records and mission risk
+#ifndef VR_INGEST_H
+#define VR_INGEST_H
+
+#include "safer.h"
+#include "database.h"
+#include "risk_events.h"
+#include "metrics.h"
+#include "vr_bridge.h"
+
+// Zero fields take the defaults noted
+typedef struct {
+    const char *name;               // Segment name (default VR_BRIDGE_DEFAULT_NAME)
+    uint32_t capacity;              // Ring size in events (default VR_BRIDGE_DEFAULT_CAPACITY)
+    int batch_size;                 // Events applied together (default 256)
+    int poll_interval_ms;           // Sleep while the ring is empty (default 10)
+    SafetyManagementSystem *sms;
+    Database *db;                   // Crew updates are saved here when set
+    RiskEventHub *risk_events;      // Mission risk transitions are published here when set
+} VRIngestConfig;
+
+typedef struct {
+    uint64_t batches;
+    uint64_t zone_warnings;
+    uint64_t trainings;             // Passed trainings applied to a known crew member
+    uint64_t unknown_crew;          // Events for crew ids not in the registry
+    uint64_t missions_reassessed;
+    VRBridgeStats bridge;
+    MetricHistogramSnapshot lag;    // Publish to apply, per event
+} VRIngestStats;
+
+typedef struct VRIngest VRIngest;
+
+// Create the bridge segment and start a thread that drains it in batches.
+// A passed training moves the crew member's last_training forward; after
+// each batch, every mission crewed by someone whose record changed is
+// reassessed once, and level changes are stored on the mission and
+// published. Zone warnings are counted only. Returns NULL on failure.
+VRIngest *vr_ingest_start(const VRIngestConfig *config);
+
+// Apply whatever is still in the ring, then stop the thread
+void vr_ingest_stop(VRIngest *ingest);
+
+void vr_ingest_stats(VRIngest *ingest, VRIngestStats *stats);
+
+#endif // VR_INGEST_H